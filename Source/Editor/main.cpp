@@ -1,15 +1,1531 @@
+#include <Runtime/Core/Core.h>
 #include <Runtime/Render/Interface/Vulkan/GlfwGeneral.hpp>
+#include <Runtime/Render/Interface/Vulkan/HeadlessGeneral.hpp>
+#include <Runtime/Render/Interface/Vulkan/VulkanTextureLoader.h>
 
-int main() {
-    if (!InitializeWindow(VkExtent2D { 1280, 720 })) {
+// 通用堆(operator new)的分配次数, 只在--alloc-benchmark的测量期间置位heapAllocationCounting时计数, 其他模式只多一次relaxed读取
+// 替换了所有普通、数组、对齐和nothrow版本, 驱动和C库直接调用的malloc不计入
+static std::atomic<bool>     heapAllocationCounting = false;
+static std::atomic<uint64_t> heapAllocationCount    = 0;
+
+// 对齐不超过默认值时使用malloc, 否则使用对齐分配; 释放时必须传入同样的对齐
+static void* AllocateHeap(size_t size, size_t alignment) noexcept {
+    if (heapAllocationCounting.load(std::memory_order_relaxed)) {
+        heapAllocationCount.fetch_add(1, std::memory_order_relaxed);
+    }
+    size = size == 0 ? 1 : size;
+    if (alignment <= __STDCPP_DEFAULT_NEW_ALIGNMENT__) {
+        return std::malloc(size);
+    }
+#if defined(_WIN32)
+    return _aligned_malloc(size, alignment);
+#else
+    // aligned_alloc要求大小是对齐的整数倍
+    return std::aligned_alloc(alignment, (size + alignment - 1) / alignment * alignment);
+#endif
+}
+
+static void FreeHeap(void* pointer, size_t alignment) noexcept {
+#if defined(_WIN32)
+    if (alignment > __STDCPP_DEFAULT_NEW_ALIGNMENT__) {
+        _aligned_free(pointer);
+        return;
+    }
+#else
+    (void)alignment;
+#endif
+    std::free(pointer);
+}
+
+static void* AllocateHeapOrThrow(size_t size, size_t alignment) {
+    if (void* pointer = AllocateHeap(size, alignment)) {
+        return pointer;
+    }
+    throw std::bad_alloc();
+}
+
+void* operator new(size_t size) {
+    return AllocateHeapOrThrow(size, __STDCPP_DEFAULT_NEW_ALIGNMENT__);
+}
+
+void* operator new[](size_t size) {
+    return AllocateHeapOrThrow(size, __STDCPP_DEFAULT_NEW_ALIGNMENT__);
+}
+
+void* operator new(size_t size, std::align_val_t alignment) {
+    return AllocateHeapOrThrow(size, size_t(alignment));
+}
+
+void* operator new[](size_t size, std::align_val_t alignment) {
+    return AllocateHeapOrThrow(size, size_t(alignment));
+}
+
+void* operator new(size_t size, const std::nothrow_t&) noexcept {
+    return AllocateHeap(size, __STDCPP_DEFAULT_NEW_ALIGNMENT__);
+}
+
+void* operator new[](size_t size, const std::nothrow_t&) noexcept {
+    return AllocateHeap(size, __STDCPP_DEFAULT_NEW_ALIGNMENT__);
+}
+
+void* operator new(size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept {
+    return AllocateHeap(size, size_t(alignment));
+}
+
+void* operator new[](size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept {
+    return AllocateHeap(size, size_t(alignment));
+}
+
+void operator delete(void* pointer) noexcept {
+    FreeHeap(pointer, __STDCPP_DEFAULT_NEW_ALIGNMENT__);
+}
+
+void operator delete[](void* pointer) noexcept {
+    FreeHeap(pointer, __STDCPP_DEFAULT_NEW_ALIGNMENT__);
+}
+
+void operator delete(void* pointer, size_t) noexcept {
+    FreeHeap(pointer, __STDCPP_DEFAULT_NEW_ALIGNMENT__);
+}
+
+void operator delete[](void* pointer, size_t) noexcept {
+    FreeHeap(pointer, __STDCPP_DEFAULT_NEW_ALIGNMENT__);
+}
+
+void operator delete(void* pointer, std::align_val_t alignment) noexcept {
+    FreeHeap(pointer, size_t(alignment));
+}
+
+void operator delete[](void* pointer, std::align_val_t alignment) noexcept {
+    FreeHeap(pointer, size_t(alignment));
+}
+
+void operator delete(void* pointer, size_t, std::align_val_t alignment) noexcept {
+    FreeHeap(pointer, size_t(alignment));
+}
+
+void operator delete[](void* pointer, size_t, std::align_val_t alignment) noexcept {
+    FreeHeap(pointer, size_t(alignment));
+}
+
+void operator delete(void* pointer, const std::nothrow_t&) noexcept {
+    FreeHeap(pointer, __STDCPP_DEFAULT_NEW_ALIGNMENT__);
+}
+
+void operator delete[](void* pointer, const std::nothrow_t&) noexcept {
+    FreeHeap(pointer, __STDCPP_DEFAULT_NEW_ALIGNMENT__);
+}
+
+void operator delete(void* pointer, std::align_val_t alignment, const std::nothrow_t&) noexcept {
+    FreeHeap(pointer, size_t(alignment));
+}
+
+void operator delete[](void* pointer, std::align_val_t alignment, const std::nothrow_t&) noexcept {
+    FreeHeap(pointer, size_t(alignment));
+}
+
+// 将交换链图像清屏并转换为帧结束时的布局
+static void RecordClearSwapChainImage(VkCommandBuffer commandBuffer, VkImage image, VkImageLayout finalLayout, const VkClearColorValue& clearColor) {
+    VkImageSubresourceRange subresourceRange = { VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1 };
+
+    VkImageMemoryBarrier barrier = {
+        .sType               = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
+        .srcAccessMask       = 0,
+        .dstAccessMask       = VK_ACCESS_TRANSFER_WRITE_BIT,
+        .oldLayout           = VK_IMAGE_LAYOUT_UNDEFINED,
+        .newLayout           = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+        .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+        .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+        .image               = image,
+        .subresourceRange    = subresourceRange,
+    };
+    vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, nullptr, 0, nullptr, 1, &barrier);
+
+    vkCmdClearColorImage(commandBuffer, image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, &clearColor, 1, &subresourceRange);
+
+    barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    barrier.dstAccessMask = 0;
+    barrier.oldLayout     = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+    barrier.newLayout     = finalLayout;
+    vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, 0, 0, nullptr, 0, nullptr, 1, &barrier);
+}
+
+// 无窗口运行指定帧数, 将最后一帧读回并写入PPM文件
+static int RunHeadless(uint32_t frameCount, const char* outputPath) {
+    auto& swapchain = Nova::VulkanRHI::Singleton().GetSwapchain();
+
+    for (uint32_t i = 0; i < frameCount; i++) {
+        if (swapchain.BeginFrame() != VK_SUCCESS) {
+            continue;
+        }
+        RecordClearSwapChainImage(
+            swapchain.GetCurrentCommandBuffer(),
+            swapchain.GetSwapChainImage(swapchain.GetCurrentImageIndex()),
+            swapchain.GetSwapChainFinalLayout(),
+            { { 0.1f, 0.1f, 0.1f, 1.0f } }
+        );
+        swapchain.EndFrame().Ignore();
+    }
+
+    // 离屏图像格式为R8G8B8A8_UNORM
+    VkExtent2D           extent = swapchain.GetSwapChainCreateInfo().imageExtent;
+    VkImage              image  = swapchain.GetSwapChainImage(swapchain.GetCurrentImageIndex());
+    std::vector<uint8_t> pixels;
+    if (swapchain.GetDevice().ReadbackImage(image, swapchain.GetSwapChainFinalLayout(), extent, 4, pixels) != VK_SUCCESS) {
+        return -1;
+    }
+
+    std::ofstream file(outputPath, std::ios::binary);
+    file << std::format("P6\n{} {}\n255\n", extent.width, extent.height);
+    for (size_t i = 0; i < pixels.size(); i += 4) {
+        file.write(reinterpret_cast<const char*>(&pixels[i]), 3);
+    }
+    NOVA_LOG_INFO(Core, "Rendered {} headless frames to {}", frameCount, outputPath);
+    swapchain.GetDevice().LogMemoryReport();
+    return 0;
+}
+
+// 无窗口运行指定帧数并采集GPU和CPU作用域, 写入Chrome trace文件(chrome://tracing或Perfetto可以打开)
+// 分析器的结果滞后飞行帧数个帧, 采集结束前多运行这些帧, 保证每个录制的帧都被解析
+static int RunProfileCapture(uint32_t frameCount, const char* outputPath) {
+    auto&                 swapchain = Nova::VulkanRHI::Singleton().GetSwapchain();
+    Nova::VulkanProfiler& profiler  = swapchain.GetProfiler();
+    if (!profiler.IsEnabled()) {
+        NOVA_LOG_ERROR(Core, "The GPU profiler is not available on this device");
+        return 1;
+    }
+
+    profiler.StartCapture();
+    uint32_t totalFrames = frameCount + swapchain.GetFramesInFlight();
+    for (uint32_t i = 0; i < totalFrames; i++) {
+        if (swapchain.BeginFrame() != VK_SUCCESS) {
+            continue;
+        }
+        {
+            Nova::VulkanCpuProfileScope cpuScope(profiler, "Record");
+            Nova::VulkanGpuProfileScope gpuScope(profiler, swapchain.GetCurrentCommandBuffer(), "Clear");
+            RecordClearSwapChainImage(
+                swapchain.GetCurrentCommandBuffer(),
+                swapchain.GetSwapChainImage(swapchain.GetCurrentImageIndex()),
+                swapchain.GetSwapChainFinalLayout(),
+                { { 0.1f, 0.1f, 0.1f, 1.0f } }
+            );
+        }
+        swapchain.EndFrame().Ignore();
+    }
+    if (profiler.StopCapture(outputPath) != VK_SUCCESS) {
+        return 1;
+    }
+
+    Nova::VulkanProfileFrame lastFrame = profiler.GetLastFrame();
+    NOVA_LOG_INFO(Core, "Last resolved frame {}: {:.3f} ms GPU, {:.3f} ms CPU", lastFrame.frameNumber, lastFrame.gpuMs, lastFrame.cpuMs);
+    return 0;
+}
+
+// 经过MemoryTracker的各类别累计分配次数之和, 不含驱动经由回调的分配
+static uint64_t GetEngineTrackedAllocationCount() {
+    uint64_t count = 0;
+    for (uint32_t i = 0; i < Nova::MemoryTracker::CATEGORY_COUNT; i++) {
+        if (Nova::MemoryCategory(i) != Nova::MemoryCategory::Driver) {
+            count += Nova::MemoryTracker::GetStats(Nova::MemoryCategory(i)).totalAllocations;
+        }
+    }
+    return count;
+}
+
+// 无窗口运行, 预热之后统计稳态帧中通用堆的分配次数, 除驱动经由回调的分配之外还有任何分配时返回1
+// arena追加或合并块也是失败: 预热之后arena的容量应当已经稳定
+// 每帧在帧arena和临时分配栈上构造逐帧的临时容器, 模拟渲染器收集和排序绘制项
+static int RunAllocationBenchmark(uint32_t frameCount) {
+    // 预热期间arena合并为单块, 分析器、删除队列等复用的容器达到稳定容量
+    constexpr uint32_t WARMUP_FRAMES = 16;
+    constexpr uint32_t DRAW_COUNT    = 4096;
+
+    auto& swapchain = Nova::VulkanRHI::Singleton().GetSwapchain();
+
+    auto renderFrame = [&swapchain] {
+        if (swapchain.BeginFrame() != VK_SUCCESS) {
+            return;
+        }
+        // 整帧有效的数据放在帧arena上
+        std::pmr::vector<uint32_t> drawList(swapchain.GetFrameArena().GetMemoryResource());
+        drawList.reserve(DRAW_COUNT);
+        for (uint32_t i = 0; i < DRAW_COUNT; i++) {
+            drawList.push_back((i * 2654435761u) >> 20);
+        }
+        // 只在排序期间使用的数据放在临时分配栈上
+        {
+            Nova::ScratchScope         scratch;
+            std::pmr::vector<uint64_t> sortKeys(scratch.GetMemoryResource());
+            sortKeys.reserve(drawList.size());
+            for (uint32_t i = 0; i < drawList.size(); i++) {
+                sortKeys.push_back(uint64_t(drawList[i]) << 32 | i);
+            }
+            std::sort(sortKeys.begin(), sortKeys.end());
+        }
+        RecordClearSwapChainImage(
+            swapchain.GetCurrentCommandBuffer(),
+            swapchain.GetSwapChainImage(swapchain.GetCurrentImageIndex()),
+            swapchain.GetSwapChainFinalLayout(),
+            { { 0.1f, 0.1f, 0.1f, 1.0f } }
+        );
+        swapchain.EndFrame().Ignore();
+    };
+
+    for (uint32_t i = 0; i < WARMUP_FRAMES; i++) {
+        renderFrame();
+    }
+    // 驱动经由回调的分配也经过上面替换的operator new, 只有这部分可以豁免, 它由驱动决定, 引擎无法消除
+    // 驱动的统计区间在计数区间之内, 豁免的次数不会多于实际计入的次数
+    heapAllocationCount.store(0, std::memory_order_relaxed);
+    heapAllocationCounting.store(true, std::memory_order_relaxed);
+    uint64_t driverAllocationsBefore = Nova::MemoryTracker::GetStats(Nova::MemoryCategory::Driver).totalAllocations;
+    uint64_t engineAllocationsBefore = GetEngineTrackedAllocationCount();
+    for (uint32_t i = 0; i < frameCount; i++) {
+        renderFrame();
+    }
+    uint64_t engineAllocations = GetEngineTrackedAllocationCount() - engineAllocationsBefore;
+    uint64_t driverAllocations = Nova::MemoryTracker::GetStats(Nova::MemoryCategory::Driver).totalAllocations - driverAllocationsBefore;
+    heapAllocationCounting.store(false, std::memory_order_relaxed);
+    uint64_t allocations = heapAllocationCount.load(std::memory_order_relaxed);
+
+    // arena的块经由MemoryTracker计入引擎的类别, 其余的分配没有经过MemoryTracker
+    uint64_t failedAllocations = allocations - std::min(driverAllocations, allocations);
+    NOVA_LOG_INFO(Core, "{} heap allocations in {} steady-state frames, {} by the driver", allocations, frameCount, driverAllocations);
+    if (engineAllocations > 0) {
+        NOVA_LOG_ERROR(Core, "{} allocations through MemoryTracker after warm-up, such as arena blocks", engineAllocations);
+    }
+    if (failedAllocations > engineAllocations) {
+        NOVA_LOG_ERROR(Core, "{} heap allocations not made by the driver or an arena", failedAllocations - engineAllocations);
+    }
+    swapchain.GetDevice().LogMemoryReport();
+    return failedAllocations == 0 ? 0 : 1;
+}
+
+// 无窗口加载目录下所有PNG/JPG纹理和烘焙过的.ntex纹理, 渲染循环持续运行直到全部常驻, 报告每张纹理的解码速度、显存占用和常驻耗时
+static int RunTextureBenchmark(const char* directory) {
+    std::vector<std::filesystem::path> paths;
+    std::error_code                    error;
+    for (const auto& entry: std::filesystem::directory_iterator(directory, error)) {
+        std::string extension = entry.path().extension().string();
+        std::transform(extension.begin(), extension.end(), extension.begin(), [](unsigned char c) { return char(std::tolower(c)); });
+        if (entry.is_regular_file() && (extension == ".png" || extension == ".jpg" || extension == ".jpeg" || extension == ".ntex")) {
+            paths.push_back(entry.path());
+        }
+    }
+    if (paths.empty()) {
+        NOVA_LOG_WARN(Core, "No PNG, JPG or NTEX textures found in {}", directory);
+        return -1;
+    }
+
+    auto& swapchain = Nova::VulkanRHI::Singleton().GetSwapchain();
+
+    Nova::VulkanTextureLoader loader;
+    loader.Initialize(swapchain.GetDevice());
+
+    auto                                   startTime = std::chrono::steady_clock::now();
+    std::vector<Nova::VulkanTextureHandle> handles;
+    for (const auto& path: paths) {
+        handles.push_back(loader.Load(path));
+    }
+
+    // 帧循环不等待解码和上传, 每帧只录制已经就绪的纹理的mip链
+    // 交换链持续过期或者出现其他错误时不再等待, 避免加载永远无法完成时卡死
+    constexpr uint32_t MAX_SKIPPED_FRAMES = 1000;
+
+    uint32_t frameCount    = 0;
+    uint32_t skippedFrames = 0;
+    bool     frameFailed   = false;
+    while (loader.GetStats().pending > 0) {
+        VkResult result = swapchain.BeginFrame();
+        if (result == VK_ERROR_OUT_OF_DATE_KHR && ++skippedFrames < MAX_SKIPPED_FRAMES) {
+            continue;
+        }
+        if (result != VK_SUCCESS) {
+            NOVA_LOG_ERROR(Core, "Failed to begin a frame after {} skipped frames: {}", skippedFrames, int32_t(result));
+            frameFailed = true;
+            break;
+        }
+        skippedFrames = 0;
+        loader.BeginFrame(swapchain.GetCurrentCommandBuffer());
+        RecordClearSwapChainImage(
+            swapchain.GetCurrentCommandBuffer(),
+            swapchain.GetSwapChainImage(swapchain.GetCurrentImageIndex()),
+            swapchain.GetSwapChainFinalLayout(),
+            { { 0.1f, 0.1f, 0.1f, 1.0f } }
+        );
+        swapchain.EndFrame().Ignore();
+        frameCount++;
+    }
+    double totalMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - startTime).count();
+
+    uint64_t imageBytes = 0;
+    for (size_t i = 0; i < paths.size(); i++) {
+        Nova::VulkanTextureInfo info = loader.GetInfo(handles[i]);
+        // 帧循环提前结束时纹理可能还在加载中
+        if (info.state != Nova::VulkanTextureState::Resident) {
+            NOVA_LOG_WARN(Core, "{}: {}", paths[i].filename().string(), info.state == Nova::VulkanTextureState::Failed ? "failed" : "not resident");
+            continue;
+        }
+        imageBytes += info.imageBytes;
+        if (info.cooked) {
+            NOVA_LOG_INFO(
+                Core,
+                "{}: {}x{}, {} mips (cooked), {:.1f} KB file, mapped in {:.2f} ms, {:.1f} KB video memory, resident after {:.2f} ms",
+                paths[i].filename().string(),
+                info.extent.width,
+                info.extent.height,
+                info.mipLevels,
+                double(info.fileBytes) / 1024.0,
+                info.decodeMs,
+                double(info.imageBytes) / 1024.0,
+                info.residentMs
+            );
+            continue;
+        }
+        double decodeMBps = info.decodeMs > 0.0 ? double(info.decodedBytes) / (1024.0 * 1024.0) / (info.decodeMs / 1000.0) : 0.0;
+        NOVA_LOG_INFO(
+            Core,
+            "{}: {}x{}, {} mips ({}), {:.1f} KB file, decode {:.2f} ms ({:.1f} MB/s), {:.1f} KB video memory, resident after {:.2f} ms",
+            paths[i].filename().string(),
+            info.extent.width,
+            info.extent.height,
+            info.mipLevels,
+            info.gpuMips ? "GPU" : "CPU",
+            double(info.fileBytes) / 1024.0,
+            info.decodeMs,
+            decodeMBps,
+            double(info.imageBytes) / 1024.0,
+            info.residentMs
+        );
+    }
+    Nova::VulkanTextureLoaderStats stats = loader.GetStats();
+    NOVA_LOG_INFO(
+        Core,
+        "{} textures resident ({:.1f} MB video memory), {} failed, {} pending in {:.2f} ms over {} frames",
+        stats.resident,
+        double(imageBytes) / (1024.0 * 1024.0),
+        stats.failed,
+        stats.pending,
+        totalMs,
+        frameCount
+    );
+    swapchain.GetDevice().LogMemoryReport();
+
+    loader.Terminate();
+    return !frameFailed && stats.failed == 0 ? 0 : 1;
+}
+
+// 无窗口上传指定兆字节的数据, 交替上传12 MiB的缓冲和带完整mip链的2048x2048 RGBA8图像(约21 MiB, 超过暂存环形缓冲的一半),
+// 渲染循环持续运行直到最后一次上传可以在图形队列上使用, 报告墙钟和上传服务统计的吞吐量
+static int RunUploadBenchmark(uint32_t megabytes) {
+    constexpr VkDeviceSize BUFFER_BYTES = VkDeviceSize(12) << 20;
+    constexpr uint32_t     IMAGE_SIZE   = 2048;
+    constexpr uint32_t     MIP_LEVELS   = 12;
+
+    auto&                 swapchain = Nova::VulkanRHI::Singleton().GetSwapchain();
+    Nova::VulkanDevice&   device    = swapchain.GetDevice();
+    Nova::VulkanUploader& uploader  = device.GetUploader();
+
+    VkBufferCreateInfo bufferCreateInfo = {
+        .sType       = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO,
+        .size        = BUFFER_BYTES,
+        .usage       = VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+        .sharingMode = VK_SHARING_MODE_EXCLUSIVE,
+    };
+    VkImageCreateInfo imageCreateInfo = {
+        .sType       = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO,
+        .imageType   = VK_IMAGE_TYPE_2D,
+        .format      = VK_FORMAT_R8G8B8A8_UNORM,
+        .extent      = { IMAGE_SIZE, IMAGE_SIZE, 1 },
+        .mipLevels   = MIP_LEVELS,
+        .arrayLayers = 1,
+        .samples     = VK_SAMPLE_COUNT_1_BIT,
+        .tiling      = VK_IMAGE_TILING_OPTIMAL,
+        .usage       = VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT,
+    };
+    Nova::VulkanBufferHandle buffer = device.GetResources().CreateBuffer(bufferCreateInfo, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+    Nova::VulkanImageHandle  image  = device.GetResources().CreateImage(imageCreateInfo, VK_IMAGE_ASPECT_COLOR_BIT);
+    if (!buffer || !image) {
+        device.GetResources().DestroyBuffer(buffer);
+        device.GetResources().DestroyImage(image);
+        return -1;
+    }
+
+    // 缓冲和所有mip共用同一份源数据(mip 0为16 MiB), 只测量拷贝本身
+    std::vector<uint8_t>                       data(size_t(IMAGE_SIZE) * IMAGE_SIZE * 4, 0x5A);
+    std::vector<Nova::VulkanImageUploadRegion> regions;
+    VkDeviceSize                               imageBytes = 0;
+    for (uint32_t level = 0; level < MIP_LEVELS; level++) {
+        uint32_t size = std::max(IMAGE_SIZE >> level, 1u);
+        regions.push_back({ .data = data.data(), .size = VkDeviceSize(size) * size * 4, .mipLevel = level, .extent = { size, size, 1 } });
+        imageBytes += regions.back().size;
+    }
+
+    VkBuffer     vkBuffer  = device.GetResources().GetBuffer(buffer)->buffer;
+    VkImage      vkImage   = device.GetResources().GetImage(image)->image;
+    VkDeviceSize target    = VkDeviceSize(megabytes) << 20;
+    VkDeviceSize submitted = 0;
+    uint64_t     ticket    = 0;
+    VkResult     result    = VK_SUCCESS;
+    auto         startTime = std::chrono::steady_clock::now();
+    while (submitted < target && result == VK_SUCCESS) {
+        result = uploader.UploadBuffer(vkBuffer, 0, data.data(), BUFFER_BYTES, &ticket);
+        if (result == VK_SUCCESS) {
+            VkImageLayout finalLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+            result                    = uploader.UploadImage(vkImage, VK_IMAGE_ASPECT_COLOR_BIT, MIP_LEVELS, 1, regions, finalLayout, 4, &ticket);
+        }
+        submitted += BUFFER_BYTES + imageBytes;
+    }
+    if (result == VK_SUCCESS) {
+        result = uploader.Flush();
+    }
+
+    // 所有权转移在图形队列的BeginFrame中完成, 之后上传才算可用
+    uint32_t frameCount = 0;
+    while (result == VK_SUCCESS && !uploader.IsReady(ticket)) {
+        result = swapchain.BeginFrame();
+        if (result != VK_SUCCESS) {
+            break;
+        }
+        RecordClearSwapChainImage(
+            swapchain.GetCurrentCommandBuffer(),
+            swapchain.GetSwapChainImage(swapchain.GetCurrentImageIndex()),
+            swapchain.GetSwapChainFinalLayout(),
+            { { 0.1f, 0.1f, 0.1f, 1.0f } }
+        );
+        result = swapchain.EndFrame();
+        frameCount++;
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+
+    if (result != VK_SUCCESS) {
+        NOVA_LOG_ERROR(Core, "Upload benchmark failed: {}", int32_t(result));
+    } else {
+        Nova::VulkanUploadStats stats = uploader.GetStats();
+        NOVA_LOG_INFO(
+            Core,
+            "Uploaded {:.1f} MB in {:.2f} ms over {} frames: {:.1f} MB/s wall clock, {:.1f} MB/s on the transfer queue",
+            double(submitted) / (1024.0 * 1024.0),
+            seconds * 1000.0,
+            frameCount,
+            double(submitted) / (1024.0 * 1024.0) / seconds,
+            stats.throughputMBps
+        );
+        NOVA_LOG_INFO(
+            Core,
+            "{} batches, {:.2f} ms average latency, {} stalls, ring peak {:.1f} of {:.1f} MB",
+            stats.batchCount,
+            stats.averageLatencyMs,
+            stats.stallCount,
+            double(stats.ringPeakUsed) / (1024.0 * 1024.0),
+            double(stats.ringCapacity) / (1024.0 * 1024.0)
+        );
+    }
+
+    device.GetResources().DestroyBuffer(buffer);
+    device.GetResources().DestroyImage(image);
+    return result == VK_SUCCESS ? 0 : 1;
+}
+
+// 上传服务的回归测试: 上传队列与图形队列属于同一队列族时不需要转移所有权, 批次完成后的几帧之内上传就应当可用
+// 在图形队列上单独建立上传服务, 不依赖设备是否有独立的传输队列族; 超过MAX_FRAMES帧仍未可用时返回1
+static int RunUploadTest() {
+    constexpr VkDeviceSize BUFFER_BYTES = VkDeviceSize(1) << 20;
+    constexpr uint32_t     MAX_FRAMES   = 64;
+
+    auto&               swapchain = Nova::VulkanRHI::Singleton().GetSwapchain();
+    Nova::VulkanDevice& device    = swapchain.GetDevice();
+
+    Nova::VulkanUploader uploader;
+    VkResult             result = uploader.Initialize(
+        device.GetDevice(), device.GetMemoryAllocator(), device.GetGraphicsQueue(), device.GetQueueFamilyIndexGraphics(), BUFFER_BYTES * 4
+    );
+    VkBufferCreateInfo bufferCreateInfo = {
+        .sType       = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO,
+        .size        = BUFFER_BYTES,
+        .usage       = VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+        .sharingMode = VK_SHARING_MODE_EXCLUSIVE,
+    };
+    Nova::VulkanBufferHandle buffer = device.GetResources().CreateBuffer(bufferCreateInfo, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+    if (result != VK_SUCCESS || !buffer) {
+        device.GetResources().DestroyBuffer(buffer);
+        return -1;
+    }
+
+    std::vector<uint8_t> data(BUFFER_BYTES, 0x5A);
+    uint64_t             ticket = 0;
+    result                      = uploader.UploadBuffer(device.GetResources().GetBuffer(buffer)->buffer, 0, data.data(), BUFFER_BYTES, &ticket);
+    if (result == VK_SUCCESS) {
+        result = uploader.Flush();
+    }
+
+    uint32_t frameCount = 0;
+    while (result == VK_SUCCESS && !uploader.IsReady(ticket) && frameCount < MAX_FRAMES) {
+        result = swapchain.BeginFrame();
+        if (result != VK_SUCCESS) {
+            break;
+        }
+        uploader.BeginFrame(swapchain.GetCurrentCommandBuffer());
+        RecordClearSwapChainImage(
+            swapchain.GetCurrentCommandBuffer(),
+            swapchain.GetSwapChainImage(swapchain.GetCurrentImageIndex()),
+            swapchain.GetSwapChainFinalLayout(),
+            { { 0.1f, 0.1f, 0.1f, 1.0f } }
+        );
+        result = swapchain.EndFrame();
+        frameCount++;
+    }
+
+    bool passed = result == VK_SUCCESS && uploader.IsReady(ticket);
+    NOVA_LOG_INFO(
+        Core, "Upload test {}: ticket {} ready after {} frames, result {}", passed ? "passed" : "failed", ticket, frameCount, int32_t(result)
+    );
+
+    uploader.Terminate();
+    device.GetResources().DestroyBuffer(buffer);
+    return passed ? 0 : 1;
+}
+
+// 无窗口运行, 作业系统依次以1到N个线程在每帧并行录制itemCount个命令, 报告每帧录制耗时和相对单线程的加速比
+// 每个命令向缓冲的独立位置填充一个值, 渲染通道外即可录制, 只衡量录制和调度的开销
+static int RunParallelRecordBenchmark(uint32_t itemCount) {
+    constexpr uint32_t WARMUP_FRAMES  = 8;
+    constexpr uint32_t MEASURE_FRAMES = 64;
+
+    uint32_t            maxThreadCount = Nova::JobSystem::Singleton().GetWorkerCount();
+    auto&               swapchain      = Nova::VulkanRHI::Singleton().GetSwapchain();
+    Nova::VulkanDevice& device         = swapchain.GetDevice();
+
+    VkBufferCreateInfo bufferCreateInfo = {
+        .sType       = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO,
+        .size        = VkDeviceSize(itemCount) * 4,
+        .usage       = VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+        .sharingMode = VK_SHARING_MODE_EXCLUSIVE,
+    };
+    Nova::VulkanBufferHandle buffer = device.GetResources().CreateBuffer(bufferCreateInfo, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+    if (!buffer) {
         return -1;
     }
+    VkBuffer vkBuffer = device.GetResources().GetBuffer(buffer)->buffer;
 
-    while (glfwWindowShouldClose(kWindow) == 0) {
-        glfwPollEvents();
-        UpdateWindowTitleWithFps();
+    VkCommandBufferInheritanceInfo inheritanceInfo = { .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_INFO };
+    auto recordItems = [vkBuffer](VkCommandBuffer commandBuffer, uint32_t, uint32_t begin, uint32_t end) {
+        for (uint32_t i = begin; i < end; i++) {
+            vkCmdFillBuffer(commandBuffer, vkBuffer, VkDeviceSize(i) * 4, 4, i);
+        }
+    };
+
+    // 返回每帧的平均录制耗时, 失败时返回负数
+    auto measure = [&](uint32_t frameCount) {
+        double totalMs = 0.0;
+        for (uint32_t frame = 0; frame < frameCount; frame++) {
+            if (swapchain.BeginFrame() != VK_SUCCESS) {
+                return -1.0;
+            }
+            VkCommandBuffer commandBuffer = swapchain.GetCurrentCommandBuffer();
+
+            // 上一帧对同一位置的写入完成后再写
+            VkMemoryBarrier barrier = {
+                .sType         = VK_STRUCTURE_TYPE_MEMORY_BARRIER,
+                .srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT,
+                .dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT,
+            };
+            VkPipelineStageFlags stage = VK_PIPELINE_STAGE_TRANSFER_BIT;
+            vkCmdPipelineBarrier(commandBuffer, stage, stage, 0, 1, &barrier, 0, nullptr, 0, nullptr);
+
+            Nova::VulkanParallelRecorder& recorder = swapchain.GetParallelRecorder();
+            VkResult                      result   = recorder.Record(commandBuffer, itemCount, inheritanceInfo, recordItems);
+            totalMs                               += recorder.GetLastRecordMilliseconds();
+
+            // 录制失败时也要结束该帧, 保证帧栅栏能够被触发
+            VkResult endResult = swapchain.EndFrame();
+            if (result != VK_SUCCESS || endResult != VK_SUCCESS) {
+                return -1.0;
+            }
+        }
+        return totalMs / frameCount;
+    };
+
+    // 录制器的命令池按初始的线程数创建, 作业系统重新初始化时线程数不超过它
+    int    exitCode       = 0;
+    double singleThreadMs = 0.0;
+    for (uint32_t threadCount = 1; threadCount <= maxThreadCount; threadCount++) {
+        Nova::JobSystem::Singleton().Terminate();
+        Nova::JobSystem::Singleton().Initialize(threadCount);
+
+        measure(WARMUP_FRAMES);
+        double frameMs = measure(MEASURE_FRAMES);
+        if (frameMs < 0.0) {
+            NOVA_LOG_ERROR(Core, "Parallel recording failed with {} threads", threadCount);
+            exitCode = 1;
+            break;
+        }
+        if (threadCount == 1) {
+            singleThreadMs = frameMs;
+        }
+        NOVA_LOG_INFO(
+            Core,
+            "{} threads: {:.3f} ms to record {} commands, {:.2f}x the single-threaded speed",
+            threadCount,
+            frameMs,
+            itemCount,
+            frameMs > 0.0 ? singleThreadMs / frameMs : 0.0
+        );
+    }
+
+    device.GetResources().DestroyBuffer(buffer);
+    return exitCode;
+}
+
+// 计算着色器: data[gl_GlobalInvocationID.x] = gl_GlobalInvocationID.x * SCALE, SCALE为0号特化常量, 局部大小64
+// 每个管线使用不同的SCALE, 驱动必须分别编译, 同一轮创建之内不会互相命中缓存
+static constexpr uint32_t PIPELINE_CACHE_BENCHMARK_SHADER[] = {
+    0x07230203, 0x00010000, 0x00000000, 0x00000015, 0x00000000, 0x00020011, 0x00000001, 0x0003000e,
+    0x00000000, 0x00000001, 0x0006000f, 0x00000005, 0x00000001, 0x6e69616d, 0x00000000, 0x00000007,
+    0x00060010, 0x00000001, 0x00000011, 0x00000040, 0x00000001, 0x00000001, 0x00040047, 0x00000007,
+    0x0000000b, 0x0000001c, 0x00040047, 0x0000000f, 0x00000001, 0x00000000, 0x00040047, 0x0000000a,
+    0x00000006, 0x00000004, 0x00050048, 0x0000000b, 0x00000000, 0x00000023, 0x00000000, 0x00030047,
+    0x0000000b, 0x00000003, 0x00040047, 0x0000000d, 0x00000022, 0x00000000, 0x00040047, 0x0000000d,
+    0x00000021, 0x00000000, 0x00020013, 0x00000002, 0x00030021, 0x00000003, 0x00000002, 0x00040015,
+    0x00000004, 0x00000020, 0x00000000, 0x00040017, 0x00000005, 0x00000004, 0x00000003, 0x00040020,
+    0x00000006, 0x00000001, 0x00000005, 0x0004003b, 0x00000006, 0x00000007, 0x00000001, 0x00040020,
+    0x00000008, 0x00000001, 0x00000004, 0x0004002b, 0x00000004, 0x00000009, 0x00000000, 0x0003001d,
+    0x0000000a, 0x00000004, 0x0003001e, 0x0000000b, 0x0000000a, 0x00040020, 0x0000000c, 0x00000002,
+    0x0000000b, 0x0004003b, 0x0000000c, 0x0000000d, 0x00000002, 0x00040020, 0x0000000e, 0x00000002,
+    0x00000004, 0x00040032, 0x00000004, 0x0000000f, 0x00000001, 0x00050036, 0x00000002, 0x00000001,
+    0x00000000, 0x00000003, 0x000200f8, 0x00000010, 0x00050041, 0x00000008, 0x00000011, 0x00000007,
+    0x00000009, 0x0004003d, 0x00000004, 0x00000012, 0x00000011, 0x00060041, 0x0000000e, 0x00000013,
+    0x0000000d, 0x00000009, 0x00000012, 0x00050084, 0x00000004, 0x00000014, 0x00000012, 0x0000000f,
+    0x0003003e, 0x00000013, 0x00000014, 0x000100fd, 0x00010038,
+};
+
+// 无窗口创建pipelineCount个计算管线: 先使用空的管线缓存(冷启动), 保存到磁盘并重新加载后再创建同样的管线(热启动), 报告两次的耗时
+// 驱动自带的着色器磁盘缓存(如Mesa的MESA_SHADER_CACHE_DISABLE)会让冷启动偏快, 测量前应将其关闭
+static int RunPipelineCacheBenchmark(uint32_t pipelineCount) {
+    Nova::VulkanDevice& device    = Nova::VulkanRHI::Singleton().GetSwapchain().GetDevice();
+    VkDevice            vkDevice  = device.GetDevice();
+    auto                callbacks = Nova::VulkanHostMemory::GetCallbacks();
+
+    VkShaderModuleCreateInfo shaderModuleCreateInfo = {
+        .sType    = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO,
+        .codeSize = sizeof(PIPELINE_CACHE_BENCHMARK_SHADER),
+        .pCode    = PIPELINE_CACHE_BENCHMARK_SHADER,
+    };
+    VkDescriptorSetLayoutBinding binding = {
+        .binding         = 0,
+        .descriptorType  = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+        .descriptorCount = 1,
+        .stageFlags      = VK_SHADER_STAGE_COMPUTE_BIT,
+    };
+    VkDescriptorSetLayoutCreateInfo setLayoutCreateInfo = {
+        .sType        = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO,
+        .bindingCount = 1,
+        .pBindings    = &binding,
+    };
+    VkShaderModule        shaderModule   = VK_NULL_HANDLE;
+    VkDescriptorSetLayout setLayout      = VK_NULL_HANDLE;
+    VkPipelineLayout      pipelineLayout = VK_NULL_HANDLE;
+
+    VkResult result = vkCreateShaderModule(vkDevice, &shaderModuleCreateInfo, callbacks, &shaderModule);
+    if (result == VK_SUCCESS) {
+        result = vkCreateDescriptorSetLayout(vkDevice, &setLayoutCreateInfo, callbacks, &setLayout);
+    }
+    if (result == VK_SUCCESS) {
+        VkPipelineLayoutCreateInfo pipelineLayoutCreateInfo = {
+            .sType          = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO,
+            .setLayoutCount = 1,
+            .pSetLayouts    = &setLayout,
+        };
+        result = vkCreatePipelineLayout(vkDevice, &pipelineLayoutCreateInfo, callbacks, &pipelineLayout);
+    }
+
+    // 通过给定的缓存创建所有管线, 计时结束后再销毁
+    std::vector<VkPipeline> pipelines(pipelineCount, VK_NULL_HANDLE);
+    auto createPipelines = [&](VkPipelineCache cache, double& milliseconds) {
+        VkResult createResult = VK_SUCCESS;
+        auto     startTime    = std::chrono::steady_clock::now();
+        for (uint32_t i = 0; i < pipelineCount && createResult == VK_SUCCESS; i++) {
+            uint32_t                 scale               = i + 1;
+            VkSpecializationMapEntry specializationEntry = { .constantID = 0, .offset = 0, .size = sizeof(scale) };
+
+            VkSpecializationInfo specializationInfo = {
+                .mapEntryCount = 1,
+                .pMapEntries   = &specializationEntry,
+                .dataSize      = sizeof(scale),
+                .pData         = &scale,
+            };
+            VkComputePipelineCreateInfo pipelineCreateInfo = {
+                .sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO,
+                .stage = {
+                    .sType               = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO,
+                    .stage               = VK_SHADER_STAGE_COMPUTE_BIT,
+                    .module              = shaderModule,
+                    .pName               = "main",
+                    .pSpecializationInfo = &specializationInfo,
+                },
+                .layout = pipelineLayout,
+            };
+            createResult = vkCreateComputePipelines(vkDevice, cache, 1, &pipelineCreateInfo, callbacks, &pipelines[i]);
+        }
+        milliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - startTime).count();
+
+        for (auto& pipeline: pipelines) {
+            if (pipeline != VK_NULL_HANDLE) {
+                vkDestroyPipeline(vkDevice, pipeline, callbacks);
+                pipeline = VK_NULL_HANDLE;
+            }
+        }
+        return createResult;
+    };
+
+    // 使用单独的缓存文件, 不影响编辑器自己的管线缓存
+    std::filesystem::path cachePath = "Cache/PipelineCacheBenchmark.bin";
+    std::error_code       errorCode;
+    std::filesystem::remove(cachePath, errorCode);
+
+    double coldMs = 0.0;
+    if (result == VK_SUCCESS) {
+        Nova::VulkanPipelineCache coldCache;
+        result = coldCache.Initialize(vkDevice, device.GetPhysicalDeviceProperties(), cachePath);
+        if (result == VK_SUCCESS) {
+            result = createPipelines(coldCache.GetCache(), coldMs);
+        }
+        // 销毁时写入磁盘
+        coldCache.Terminate();
+    }
+
+    double warmMs      = 0.0;
+    bool   warmLoaded  = false;
+    size_t loadedBytes = 0;
+    double loadMs      = 0.0;
+    if (result == VK_SUCCESS) {
+        Nova::VulkanPipelineCache warmCache;
+        result = warmCache.Initialize(vkDevice, device.GetPhysicalDeviceProperties(), cachePath);
+        if (result == VK_SUCCESS) {
+            warmLoaded  = warmCache.IsLoadedFromDisk();
+            loadedBytes = warmCache.GetLoadedBytes();
+            loadMs      = warmCache.GetLoadMilliseconds();
+            result      = createPipelines(warmCache.GetCache(), warmMs);
+        }
+        warmCache.Terminate();
+    }
+
+    int exitCode = 0;
+    if (result != VK_SUCCESS) {
+        NOVA_LOG_ERROR(Core, "Pipeline cache benchmark failed: {}", int32_t(result));
+        exitCode = 1;
+    } else if (!warmLoaded) {
+        NOVA_LOG_ERROR(Core, "The saved pipeline cache was not loaded back from {}", cachePath.string());
+        exitCode = 1;
+    } else {
+        NOVA_LOG_INFO(
+            Core,
+            "{} pipelines: {:.2f} ms with a cold cache, {:.2f} ms with a warm cache ({} bytes loaded in {:.2f} ms), {:.2f}x faster",
+            pipelineCount,
+            coldMs,
+            warmMs,
+            loadedBytes,
+            loadMs,
+            warmMs > 0.0 ? coldMs / warmMs : 0.0
+        );
+    }
+
+    vkDestroyPipelineLayout(vkDevice, pipelineLayout, callbacks);
+    vkDestroyDescriptorSetLayout(vkDevice, setLayout, callbacks);
+    vkDestroyShaderModule(vkDevice, shaderModule, callbacks);
+    std::filesystem::remove(cachePath, errorCode);
+    return exitCode;
+}
+
+// 在窗口中依次以FIFO和MAILBOX、不限制(0)和限制为1帧的最大帧延迟各清屏frameCount帧, 报告每种组合的CPU帧耗时和呈现间隔
+// 设备支持呈现等待(VK_KHR_present_id/present_wait)且限制了帧延迟时, 间隔为图像实际显示的间隔, 否则为调用vkQueuePresentKHR的间隔
+// 呈现间隔只保留最近PRESENT_INTERVAL_HISTORY个样本
+static int RunPresentPacingBenchmark(uint32_t frameCount) {
+    // 超过该次数仍然无法开始一帧(如窗口一直最小化)时放弃
+    constexpr uint32_t MAX_SKIPPED_FRAMES = 1000;
+    constexpr uint32_t WARMUP_FRAMES      = 30;
+
+    auto window = InitializeWindow(VkExtent2D { 1280, 720 });
+    if (window == nullptr) {
+        return -1;
+    }
+    auto& swapchain = Nova::VulkanRHI::Singleton().GetSwapchain();
+    if (!swapchain.GetDevice().IsPresentWaitEnabled()) {
+        NOVA_LOG_WARN(Core, "Present wait is not supported, intervals are timed at vkQueuePresentKHR");
+    }
+
+    // 返回每帧的平均CPU耗时, 失败或窗口关闭时返回负数
+    auto renderFrames = [&](uint32_t count) {
+        uint32_t skippedFrames = 0;
+        auto     startTime     = std::chrono::steady_clock::now();
+        for (uint32_t i = 0; i < count;) {
+            glfwPollEvents();
+            if (window->ShouldClose()) {
+                return -1.0;
+            }
+            VkResult result = swapchain.BeginFrame();
+            if (result == VK_ERROR_OUT_OF_DATE_KHR && ++skippedFrames < MAX_SKIPPED_FRAMES) {
+                continue;
+            }
+            if (result != VK_SUCCESS) {
+                NOVA_LOG_ERROR(Core, "Failed to begin a frame: {}", int32_t(result));
+                return -1.0;
+            }
+            RecordClearSwapChainImage(
+                swapchain.GetCurrentCommandBuffer(),
+                swapchain.GetSwapChainImage(swapchain.GetCurrentImageIndex()),
+                swapchain.GetSwapChainFinalLayout(),
+                { { 0.1f, 0.1f, 0.1f, 1.0f } }
+            );
+            result = swapchain.EndFrame();
+            if (result != VK_SUCCESS && result != VK_ERROR_OUT_OF_DATE_KHR && result != VK_SUBOPTIMAL_KHR) {
+                return -1.0;
+            }
+            i++;
+        }
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - startTime).count() / count;
+    };
+
+    int exitCode = 0;
+    for (VkPresentModeKHR presentMode: { VK_PRESENT_MODE_FIFO_KHR, VK_PRESENT_MODE_MAILBOX_KHR }) {
+        if (swapchain.SetPresentMode(presentMode) != VK_SUCCESS) {
+            exitCode = 1;
+            break;
+        }
+        // 表面不支持MAILBOX时回退到FIFO, 结果与上一轮重复
+        if (swapchain.GetPresentMode() != presentMode) {
+            NOVA_LOG_WARN(Core, "{} is not supported by the surface, skipped", Nova::VulkanSwapchain::GetPresentModeName(presentMode));
+            continue;
+        }
+
+        for (uint32_t latency: { 0u, 1u }) {
+            // 设置最大帧延迟会丢弃之前的样本, 预热之后再设置一次, 只统计测量的帧
+            swapchain.SetMaxFrameLatency(latency);
+            double frameMs = renderFrames(WARMUP_FRAMES);
+            swapchain.SetMaxFrameLatency(latency);
+            if (frameMs >= 0.0) {
+                frameMs = renderFrames(frameCount);
+            }
+            if (frameMs < 0.0) {
+                exitCode = 1;
+                break;
+            }
+
+            auto                stats     = swapchain.GetPresentStats();
+            std::vector<double> intervals = swapchain.GetPresentIntervals();
+            std::sort(intervals.begin(), intervals.end());
+            NOVA_LOG_INFO(
+                Core,
+                "{}, max frame latency {}: {:.3f} ms CPU per frame, present interval {:.3f}/{:.3f}/{:.3f}/{:.3f} ms avg/min/p99/max, "
+                "{:.3f} ms jitter, {} samples timed {}",
+                Nova::VulkanSwapchain::GetPresentModeName(presentMode),
+                latency,
+                frameMs,
+                stats.averageIntervalMs,
+                stats.minIntervalMs,
+                intervals.empty() ? 0.0 : intervals[intervals.size() * 99 / 100],
+                stats.maxIntervalMs,
+                stats.jitterMs,
+                stats.sampleCount,
+                stats.measuredOnDisplay ? "on display" : "at present"
+            );
+        }
+        if (exitCode != 0) {
+            break;
+        }
+    }
+
+    swapchain.SetMaxFrameLatency(0);
+    TerminateWindow(window);
+    return exitCode;
+}
+
+#if defined(_MSC_VER)
+    #define NOVA_NOINLINE __declspec(noinline)
+#else
+    #define NOVA_NOINLINE __attribute__((noinline))
+#endif
+
+// 改为按策略选择之前的VulkanResult, 作为--vulkan-result-benchmark的对照
+// 回调为std::optional<std::function>, 析构函数总是noexcept(false), 有符号比较只会捕获VK_RESULT_MAX_ENUM
+class LegacyVulkanResult {
+private:
+    VkResult result;
+
+    static inline std::optional<std::function<void(VkResult)>> callback_throw;
+
+public:
+    constexpr LegacyVulkanResult(VkResult result) noexcept: result(result) {}
+    constexpr LegacyVulkanResult(LegacyVulkanResult&& other) noexcept: result(other.result) {
+        other.result = VK_SUCCESS;
+    }
+
+    LegacyVulkanResult(const LegacyVulkanResult&)            = delete;
+    LegacyVulkanResult& operator=(const LegacyVulkanResult&) = delete;
+    LegacyVulkanResult& operator=(LegacyVulkanResult&&)      = delete;
+
+    ~LegacyVulkanResult() noexcept(false) {
+        if (result >= VK_RESULT_MAX_ENUM) {
+            if (callback_throw) {
+                (*callback_throw)(result);
+            }
+            throw result;
+        }
+    }
+
+    constexpr operator VkResult() noexcept {
+        VkResult temp = result;
+        result        = VK_SUCCESS;
+        return temp;
+    }
+};
+
+// 两层不内联的调用, 内层产生结果, 外层原样转发, 与RHI中逐层返回错误码的方式相同
+template<typename Result>
+NOVA_NOINLINE static Result ProduceVulkanResult(VkResult value) {
+    return value;
+}
+
+template<typename Result>
+NOVA_NOINLINE static Result ForwardVulkanResult(VkResult value) {
+    return ProduceVulkanResult<Result>(value);
+}
+
+// 测量roundCount轮, 每轮callCount次经由ForwardVulkanResult的调用, 报告最快和最慢一轮中每次调用的平均耗时; 有调用失败时返回false
+template<typename Result>
+static bool MeasureVulkanResult(const char* name, uint32_t callCount, uint32_t roundCount) {
+    // 经由volatile读取, 编译器无法把结果当作常量折叠掉
+    static volatile VkResult input = VK_SUCCESS;
+
+    uint32_t failures = 0;
+    double   minNs    = 0.0;
+    double   maxNs    = 0.0;
+    for (uint32_t round = 0; round < roundCount; round++) {
+        auto startTime = std::chrono::steady_clock::now();
+        for (uint32_t i = 0; i < callCount; i++) {
+            VkResult result  = ForwardVulkanResult<Result>(input);
+            failures        += result != VK_SUCCESS;
+        }
+        double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - startTime).count() / callCount;
+        minNs     = round == 0 ? ns : std::min(minNs, ns);
+        maxNs     = round == 0 ? ns : std::max(maxNs, ns);
+    }
+    NOVA_LOG_INFO(Core, "{:<10} {:.2f}-{:.2f} ns per call", name, minNs, maxNs);
+    return failures == 0;
+}
+
+// 比较VkResult、旧版VulkanResult以及各策略下的BasicVulkanResult在成功路径上每次调用的耗时
+static int RunVulkanResultBenchmark(uint32_t callCount) {
+    constexpr uint32_t ROUND_COUNT = 5;
+
+    using Nova::BasicVulkanResult;
+    using Nova::VulkanResultPolicy;
+
+    NOVA_LOG_INFO(Core, "{} calls x {} rounds, each result forwarded through one non-inlined call", callCount, ROUND_COUNT);
+    bool passed = MeasureVulkanResult<VkResult>("VkResult", callCount, ROUND_COUNT);
+    passed      = MeasureVulkanResult<LegacyVulkanResult>("Legacy", callCount, ROUND_COUNT) && passed;
+    passed      = MeasureVulkanResult<BasicVulkanResult<VulkanResultPolicy::Throw>>("Throw", callCount, ROUND_COUNT) && passed;
+    passed      = MeasureVulkanResult<BasicVulkanResult<VulkanResultPolicy::Abort>>("Abort", callCount, ROUND_COUNT) && passed;
+    passed      = MeasureVulkanResult<BasicVulkanResult<VulkanResultPolicy::NoDiscard>>("NoDiscard", callCount, ROUND_COUNT) && passed;
+    passed      = MeasureVulkanResult<BasicVulkanResult<VulkanResultPolicy::Propagate>>("Propagate", callCount, ROUND_COUNT) && passed;
+    return passed ? 0 : 1;
+}
+
+// 作业系统的回归测试: 单个线程提交的作业数远超作业池和队列容量时, 每个作业仍然恰好执行一次;
+// 非作业系统线程和通过RegisterThread加入的线程提交的作业同样恰好执行一次, 并计入统计
+static int RunJobSystemTest() {
+    int exitCode = 0;
+    for (uint32_t count: { 5000u, 200000u }) {
+        std::atomic<uint64_t> sum = 0;
+        Nova::JobSystem::Singleton().ParallelFor(count, 1, [&sum](uint32_t begin, uint32_t end) {
+            for (uint32_t i = begin; i < end; i++) {
+                sum.fetch_add(i, std::memory_order_relaxed);
+            }
+        });
+        uint64_t expected = uint64_t(count) * (count - 1) / 2;
+        if (sum.load() != expected) {
+            NOVA_LOG_ERROR(Core, "ParallelFor({}) summed to {}, expected {}", count, sum.load(), expected);
+            exitCode = 1;
+        }
+    }
+
+    // 非作业系统线程提交的作业数超过共用作业池的容量, 作业由本线程在Wait中执行
+    constexpr uint32_t EXTERNAL_JOB_COUNT = Nova::JobSystem::EXTERNAL_JOB_POOL_SIZE * 4;
+
+    Nova::JobCounter      externalCounter;
+    std::atomic<uint32_t> externalExecuted = 0;
+    std::thread           externalThread([&externalCounter, &externalExecuted] {
+        for (uint32_t i = 0; i < EXTERNAL_JOB_COUNT; i++) {
+            Nova::JobSystem::Singleton().Run([&externalExecuted] { externalExecuted.fetch_add(1, std::memory_order_relaxed); }, &externalCounter);
+        }
+    });
+    externalThread.join();
+    Nova::JobSystem::Singleton().Wait(externalCounter);
+
+    // 加入作业系统的线程在Wait中执行自己的作业, 没有工作线程时也能完成, 作业不超过作业池的容量时不从堆上分配
+    uint64_t    heapJobsBefore = Nova::JobSystem::Singleton().GetStats().heapJobs;
+    bool        registered     = false;
+    uint64_t    registeredSum  = 0;
+    std::thread registeredThread([&registered, &registeredSum] {
+        registered                = Nova::JobSystem::Singleton().RegisterThread();
+        std::atomic<uint64_t> sum = 0;
+        Nova::JobSystem::Singleton().ParallelFor(EXTERNAL_JOB_COUNT, 1, [&sum](uint32_t begin, uint32_t) {
+            sum.fetch_add(begin, std::memory_order_relaxed);
+        });
+        registeredSum = sum.load();
+        Nova::JobSystem::Singleton().UnregisterThread();
+    });
+    registeredThread.join();
+    uint64_t registeredHeapJobs = Nova::JobSystem::Singleton().GetStats().heapJobs - heapJobsBefore;
+    if (!registered || registeredSum != uint64_t(EXTERNAL_JOB_COUNT) * (EXTERNAL_JOB_COUNT - 1) / 2 || registeredHeapJobs != 0) {
+        NOVA_LOG_ERROR(Core, "Registered thread: registered {}, sum {}, {} heap jobs", registered, registeredSum, registeredHeapJobs);
+        exitCode = 1;
     }
 
-    TerminateWindow();
+    Nova::JobSystemStats stats = Nova::JobSystem::Singleton().GetStats();
+    if (externalExecuted.load() != EXTERNAL_JOB_COUNT || stats.externalJobs != EXTERNAL_JOB_COUNT) {
+        NOVA_LOG_ERROR(
+            Core, "{} external jobs submitted, {} counted and {} executed", EXTERNAL_JOB_COUNT, stats.externalJobs, externalExecuted.load()
+        );
+        exitCode = 1;
+    }
+    NOVA_LOG_INFO(
+        Core,
+        "Job system test {}: {} jobs, {} external, {} overflowed, {} heap jobs",
+        exitCode == 0 ? "passed" : "failed",
+        stats.executed,
+        stats.externalJobs,
+        stats.overflowed,
+        stats.heapJobs
+    );
+    return exitCode;
+}
+
+// 句柄池的多线程压力测试: 多个线程并发地分配和随机释放句柄, 检查以下各项, 任意一项不满足时返回1
+// 1. 存活的句柄读到的记录都是自己写入的, 即同一个槽位不会同时分给两个线程
+// 2. 释放后的句柄立即失效, 重复释放返回false
+// 3. 全部释放后存活数归零, 槽位高水位不超过同时存活的句柄数上限, 即空闲槽位都被复用
+static int RunHandlePoolTest(uint32_t roundCount) {
+    constexpr uint32_t MAX_LIVE_PER_THREAD = 256;
+
+    struct Record {
+        uint32_t thread;
+        uint32_t serial;
+    };
+    using Pool = Nova::HandlePool<Record>;
+
+    Pool                  pool;
+    uint32_t              threadCount = std::max(4u, std::thread::hardware_concurrency());
+    std::atomic<uint32_t> errorCount  = 0;
+
+    auto worker = [&](uint32_t threadIndex) {
+        std::vector<Pool::HandleType> handles;
+        std::vector<uint32_t>         serials;
+        uint32_t                      serial      = 0;
+        uint32_t                      randomState = (threadIndex + 1) * 2654435761u;
+
+        auto nextRandom = [&randomState] {
+            randomState ^= randomState << 13;
+            randomState ^= randomState >> 17;
+            randomState ^= randomState << 5;
+            return randomState;
+        };
+
+        for (uint32_t round = 0; round < roundCount; round++) {
+            // 分配到上限的随机比例, 再随机释放一部分, 使各线程的分配和释放交错进行
+            uint32_t target = nextRandom() % (MAX_LIVE_PER_THREAD + 1);
+            while (handles.size() < target) {
+                Pool::HandleType handle = pool.Allocate(Record { threadIndex, serial });
+                if (!handle) {
+                    errorCount.fetch_add(1, std::memory_order_relaxed);
+                    return;
+                }
+                handles.push_back(handle);
+                serials.push_back(serial++);
+            }
+
+            for (size_t i = 0; i < handles.size(); i++) {
+                Record* record = pool.TryGet(handles[i]);
+                if (record == nullptr || record->thread != threadIndex || record->serial != serials[i]) {
+                    errorCount.fetch_add(1, std::memory_order_relaxed);
+                }
+            }
+
+            uint32_t freeCount = handles.empty() ? 0 : nextRandom() % (uint32_t(handles.size()) + 1);
+            for (uint32_t i = 0; i < freeCount; i++) {
+                size_t           victim = nextRandom() % handles.size();
+                Pool::HandleType handle = handles[victim];
+                if (!pool.Free(handle) || pool.IsValid(handle)) {
+                    errorCount.fetch_add(1, std::memory_order_relaxed);
+                }
+                handles[victim] = handles.back();
+                serials[victim] = serials.back();
+                handles.pop_back();
+                serials.pop_back();
+            }
+        }
+
+        for (Pool::HandleType handle: handles) {
+            if (!pool.Free(handle)) {
+                errorCount.fetch_add(1, std::memory_order_relaxed);
+            }
+        }
+        // 重复释放只检查一次, NOVA_DEBUG下每次都会输出警告
+        if (!handles.empty() && pool.Free(handles.front())) {
+            errorCount.fetch_add(1, std::memory_order_relaxed);
+        }
+    };
+
+    auto                     startTime = std::chrono::steady_clock::now();
+    std::vector<std::thread> threads;
+    for (uint32_t i = 0; i < threadCount; i++) {
+        threads.emplace_back(worker, i);
+    }
+    for (auto& thread: threads) {
+        thread.join();
+    }
+    double milliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - startTime).count();
+
+    if (pool.GetLiveCount() != 0) {
+        NOVA_LOG_ERROR(Core, "{} handles still live after every thread freed its handles", pool.GetLiveCount());
+        errorCount.fetch_add(1, std::memory_order_relaxed);
+    }
+    if (pool.GetSlotCount() > threadCount * MAX_LIVE_PER_THREAD) {
+        NOVA_LOG_ERROR(
+            Core, "{} slots used for at most {} live handles, freed slots are not reused", pool.GetSlotCount(), threadCount * MAX_LIVE_PER_THREAD
+        );
+        errorCount.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    uint32_t errors = errorCount.load();
+    NOVA_LOG_INFO(
+        Core,
+        "Handle pool test {}: {} threads, {} rounds in {:.1f} ms, {} slots used, {} errors",
+        errors == 0 ? "passed" : "failed",
+        threadCount,
+        roundCount,
+        milliseconds,
+        pool.GetSlotCount(),
+        errors
+    );
+    return errors == 0 ? 0 : 1;
+}
+
+// 作业系统的基准测试, 依次报告:
+// 1. 提交开销: 0号线程提交jobCount个空作业后等待, 以及逐个提交并等待, 每个作业的平均耗时
+// 2. 窃取延迟: 0号线程提交一个作业后自旋而不执行它, 从提交到工作线程开始执行的耗时, 包含唤醒休眠线程的时间
+// 3. 扇出/扇入的扩展性: 依次以1到N个线程用ParallelFor完成同样的计算, 报告耗时和相对单线程的加速比
+static int RunJobBenchmark(uint32_t jobCount) {
+    constexpr uint32_t STEAL_SAMPLES   = 1000;
+    constexpr uint32_t SCALING_ITEMS   = 1u << 20;
+    constexpr uint32_t SCALING_BATCH   = 256;
+    constexpr uint32_t SCALING_ROUNDS  = 16;
+    constexpr uint32_t ITEM_ITERATIONS = 64;
+
+    using Clock = std::chrono::steady_clock;
+
+    Nova::JobSystem& jobSystem      = Nova::JobSystem::Singleton();
+    uint32_t         maxThreadCount = jobSystem.GetWorkerCount();
+
+    // 1. 提交开销
+    {
+        Nova::JobCounter counter;
+        auto             startTime = Clock::now();
+        for (uint32_t i = 0; i < jobCount; i++) {
+            jobSystem.Run([] {}, &counter);
+        }
+        jobSystem.Wait(counter);
+        double batchNs = std::chrono::duration<double, std::nano>(Clock::now() - startTime).count() / jobCount;
+
+        startTime = Clock::now();
+        for (uint32_t i = 0; i < jobCount; i++) {
+            Nova::JobCounter single;
+            jobSystem.Run([] {}, &single);
+            jobSystem.Wait(single);
+        }
+        double roundTripNs = std::chrono::duration<double, std::nano>(Clock::now() - startTime).count() / jobCount;
+
+        NOVA_LOG_INFO(
+            Core, "Spawn: {:.1f} ns per job submitted in a batch of {}, {:.1f} ns per Run + Wait round trip", batchNs, jobCount, roundTripNs
+        );
+    }
+
+    // 2. 窃取延迟, 只有一个线程时没有其他线程能够窃取
+    if (maxThreadCount > 1) {
+        std::vector<double> samples;
+        samples.reserve(STEAL_SAMPLES);
+        for (uint32_t i = 0; i < STEAL_SAMPLES; i++) {
+            std::atomic<int64_t> startedNs  = -1;
+            auto                 submitTime = Clock::now();
+            jobSystem.Run([&startedNs, submitTime] {
+                startedNs.store(std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - submitTime).count(), std::memory_order_release);
+            });
+            // 只让出时间片而不执行作业, 迫使工作线程窃取
+            while (startedNs.load(std::memory_order_acquire) < 0) {
+                std::this_thread::yield();
+            }
+            samples.push_back(double(startedNs.load(std::memory_order_relaxed)) / 1000.0);
+        }
+        std::sort(samples.begin(), samples.end());
+        NOVA_LOG_INFO(
+            Core,
+            "Steal: {:.2f} us median, {:.2f} us p99, {:.2f} us max over {} jobs",
+            samples[samples.size() / 2],
+            samples[samples.size() * 99 / 100],
+            samples.back(),
+            STEAL_SAMPLES
+        );
+    }
+
+    // 3. 扇出/扇入的扩展性, 每个元素做固定次数的xorshift, 按批次累加, 结果用于校验各线程数下计算一致
+    auto work = [](uint32_t begin, uint32_t end) {
+        uint64_t sum = 0;
+        for (uint32_t i = begin; i < end; i++) {
+            uint32_t state = i * 2654435761u + 1;
+            for (uint32_t j = 0; j < ITEM_ITERATIONS; j++) {
+                state ^= state << 13;
+                state ^= state >> 17;
+                state ^= state << 5;
+            }
+            sum += state;
+        }
+        return sum;
+    };
+
+    int      exitCode       = 0;
+    uint64_t expected       = work(0, SCALING_ITEMS);
+    double   singleThreadMs = 0.0;
+    for (uint32_t threadCount = 1; threadCount <= maxThreadCount; threadCount++) {
+        jobSystem.Terminate();
+        jobSystem.Initialize(threadCount);
+
+        std::atomic<uint64_t> sum       = 0;
+        auto                  startTime = Clock::now();
+        for (uint32_t round = 0; round < SCALING_ROUNDS; round++) {
+            sum.store(0, std::memory_order_relaxed);
+            jobSystem.ParallelFor(SCALING_ITEMS, SCALING_BATCH, [&sum, &work](uint32_t begin, uint32_t end) {
+                sum.fetch_add(work(begin, end), std::memory_order_relaxed);
+            });
+        }
+        double roundMs = std::chrono::duration<double, std::milli>(Clock::now() - startTime).count() / SCALING_ROUNDS;
+
+        if (sum.load() != expected) {
+            NOVA_LOG_ERROR(Core, "ParallelFor with {} threads summed to {}, expected {}", threadCount, sum.load(), expected);
+            exitCode = 1;
+            break;
+        }
+        if (threadCount == 1) {
+            singleThreadMs = roundMs;
+        }
+        NOVA_LOG_INFO(
+            Core,
+            "{} threads: {:.3f} ms to fan out {} jobs and join, {:.2f}x the single-threaded speed",
+            threadCount,
+            roundMs,
+            SCALING_ITEMS / SCALING_BATCH,
+            roundMs > 0.0 ? singleThreadMs / roundMs : 0.0
+        );
+    }
+    return exitCode;
+}
+
+// 无头表面(VK_EXT_headless_surface)没有当前尺寸, 交换链按备用尺寸创建; 依次改变备用尺寸, 检查交换链在几帧之内按新尺寸重建,
+// 且重建期间BeginFrame不会持续返回VK_ERROR_OUT_OF_DATE_KHR; 任意一项不满足时返回1
+static int RunHeadlessResizeTest() {
+    constexpr VkExtent2D SIZES[]    = { { 960, 540 }, { 1920, 1080 }, { 1, 1 }, { 1280, 720 } };
+    constexpr uint32_t   MAX_FRAMES = 8;
+
+    auto& swapchain = Nova::VulkanRHI::Singleton().GetSwapchain();
+    int   exitCode  = 0;
+    for (VkExtent2D size: SIZES) {
+        swapchain.SetFallbackExtent(size);
+
+        uint32_t   frameCount = 0;
+        uint32_t   failures   = 0;
+        VkExtent2D extent     = swapchain.GetSwapChainCreateInfo().imageExtent;
+        while ((extent.width != size.width || extent.height != size.height) && frameCount < MAX_FRAMES) {
+            frameCount++;
+            if (swapchain.BeginFrame() != VK_SUCCESS) {
+                failures++;
+                continue;
+            }
+            RecordClearSwapChainImage(
+                swapchain.GetCurrentCommandBuffer(),
+                swapchain.GetSwapChainImage(swapchain.GetCurrentImageIndex()),
+                swapchain.GetSwapChainFinalLayout(),
+                { { 0.1f, 0.1f, 0.1f, 1.0f } }
+            );
+            swapchain.EndFrame().Ignore();
+            extent = swapchain.GetSwapChainCreateInfo().imageExtent;
+        }
+
+        if (extent.width != size.width || extent.height != size.height) {
+            NOVA_LOG_ERROR(
+                Core, "Swap chain is still {}x{} after {} frames, expected {}x{}", extent.width, extent.height, frameCount, size.width, size.height
+            );
+            exitCode = 1;
+        } else {
+            NOVA_LOG_INFO(Core, "Swap chain recreated at {}x{} after {} frames, {} failed to begin", size.width, size.height, frameCount, failures);
+        }
+    }
+    NOVA_LOG_INFO(Core, "Headless resize test {}", exitCode == 0 ? "passed" : "failed");
+    return exitCode;
+}
+
+// 命令行模式运行前的准备: None不初始化RHI, Headless以1280x720离屏初始化默认RHI并在运行后销毁,
+// HeadlessSurface与Headless相同, 但交换链建立在无头表面上
+enum class EditorModeContext {
+    None,
+    Headless,
+    HeadlessSurface,
+};
+
+// Editor <flag> [参数...], minArgumentCount包含程序名和flag本身; 没有匹配的模式时打开编辑器窗口
+struct EditorMode {
+    const char*       flag;
+    int               minArgumentCount;
+    EditorModeContext context;
+    int (*run)(int argc, char** argv);
+};
+
+// 第index个命令行参数作为数量, 缺省时为defaultValue, 至少为1
+static uint32_t GetCountArgument(int argc, char** argv, int index, uint32_t defaultValue) {
+    uint32_t value = argc > index ? static_cast<uint32_t>(std::strtoul(argv[index], nullptr, 10)) : defaultValue;
+    return std::max(value, 1u);
+}
+
+static constexpr EditorMode EDITOR_MODES[] = {
+    // Editor --headless [frameCount] [output.ppm]
+    { "--headless", 2, EditorModeContext::Headless,
+      [](int argc, char** argv) { return RunHeadless(GetCountArgument(argc, argv, 2, 1), argc > 3 ? argv[3] : "headless.ppm"); } },
+    // Editor --profile-capture [frameCount] [trace.json]
+    { "--profile-capture", 2, EditorModeContext::Headless,
+      [](int argc, char** argv) { return RunProfileCapture(GetCountArgument(argc, argv, 2, 16), argc > 3 ? argv[3] : "profile.json"); } },
+    // Editor --alloc-benchmark [frameCount]
+    { "--alloc-benchmark", 2, EditorModeContext::Headless,
+      [](int argc, char** argv) { return RunAllocationBenchmark(GetCountArgument(argc, argv, 2, 1000)); } },
+    // Editor --job-system-test
+    { "--job-system-test", 2, EditorModeContext::None, [](int, char**) { return RunJobSystemTest(); } },
+    // Editor --vulkan-result-benchmark [callCount]
+    { "--vulkan-result-benchmark", 2, EditorModeContext::None,
+      [](int argc, char** argv) { return RunVulkanResultBenchmark(GetCountArgument(argc, argv, 2, 200'000'000)); } },
+    // Editor --handle-pool-test [roundCount]
+    { "--handle-pool-test", 2, EditorModeContext::None,
+      [](int argc, char** argv) { return RunHandlePoolTest(GetCountArgument(argc, argv, 2, 2000)); } },
+    // Editor --job-benchmark [jobCount]
+    { "--job-benchmark", 2, EditorModeContext::None,
+      [](int argc, char** argv) { return RunJobBenchmark(GetCountArgument(argc, argv, 2, 100000)); } },
+    // Editor --upload-benchmark [megabytes]
+    { "--upload-benchmark", 2, EditorModeContext::Headless,
+      [](int argc, char** argv) { return RunUploadBenchmark(GetCountArgument(argc, argv, 2, 1024)); } },
+    // Editor --upload-test
+    { "--upload-test", 2, EditorModeContext::Headless, [](int, char**) { return RunUploadTest(); } },
+    // Editor --parallel-record-benchmark [itemCount]
+    { "--parallel-record-benchmark", 2, EditorModeContext::Headless,
+      [](int argc, char** argv) { return RunParallelRecordBenchmark(GetCountArgument(argc, argv, 2, 100000)); } },
+    // Editor --pipeline-cache-benchmark [pipelineCount]
+    { "--pipeline-cache-benchmark", 2, EditorModeContext::Headless,
+      [](int argc, char** argv) { return RunPipelineCacheBenchmark(GetCountArgument(argc, argv, 2, 256)); } },
+    // Editor --present-pacing-benchmark [frameCount], 自己创建窗口
+    { "--present-pacing-benchmark", 2, EditorModeContext::None,
+      [](int argc, char** argv) { return RunPresentPacingBenchmark(GetCountArgument(argc, argv, 2, 600)); } },
+    // Editor --headless-resize-test
+    { "--headless-resize-test", 2, EditorModeContext::HeadlessSurface, [](int, char**) { return RunHeadlessResizeTest(); } },
+    // Editor --texture-benchmark <directory>
+    { "--texture-benchmark", 3, EditorModeContext::Headless, [](int, char** argv) { return RunTextureBenchmark(argv[2]); } },
+};
+
+// 按模式的要求准备RHI后运行, 运行结束后销毁准备的RHI; 初始化失败时返回-1
+static int RunEditorMode(const EditorMode& mode, int argc, char** argv) {
+    if (mode.context == EditorModeContext::None) {
+        return mode.run(argc, argv);
+    }
+    int exitCode = -1;
+    if (InitializeHeadless(VkExtent2D { 1280, 720 }, mode.context == EditorModeContext::HeadlessSurface)) {
+        exitCode = mode.run(argc, argv);
+    }
+    TerminateHeadless();
+    return exitCode;
+}
+
+// 模拟线程: 取出输入事件, 推进模拟并生成帧包, 渲染线程停止后退出
+static void RunSimulation(Nova::WindowSystem& window, Nova::VulkanRenderThread& renderThread) {
+    uint64_t frameNumber = 0;
+    auto     startTime   = std::chrono::steady_clock::now();
+    double   lastTime    = 0.0;
+
+    for (;;) {
+        // 编辑器暂不处理输入, 只取出事件避免队列填满
+        Nova::InputEvent event;
+        while (window.PopInputEvent(event)) {
+        }
+        VkExtent2D framebufferSize = window.GetLatestFramebufferSize();
+
+        Nova::FramePacket* packet = renderThread.BeginPacket();
+        if (packet == nullptr) {
+            break;
+        }
+        double time = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+        *packet     = {
+                .frameNumber = frameNumber++,
+                .time        = time,
+                .deltaTime   = time - lastTime,
+                .width       = framebufferSize.width,
+                .height      = framebufferSize.height,
+                .clearColor  = { 0.1f, 0.1f, 0.1f, 1.0f },
+        };
+        lastTime = time;
+        renderThread.SubmitPacket();
+
+        // 窗口最小化时渲染线程不提交帧, 帧包不再受呈现节奏限制, 降低模拟频率而不是空转
+        if (framebufferSize.width == 0 || framebufferSize.height == 0) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+    }
+}
+
+int main(int argc, char** argv) {
+    Nova::JobSystem::Singleton().Initialize();
+
+    Nova::VulkanRHI::Singleton().SetFramesInFlight(Nova::VulkanRHI::DEFAULT_FRAMES_IN_FLIGHT);
+
+    for (const EditorMode& mode: EDITOR_MODES) {
+        if (argc >= mode.minArgumentCount && strcmp(argv[1], mode.flag) == 0) {
+            int exitCode = RunEditorMode(mode, argc, argv);
+            Nova::JobSystem::Singleton().Terminate();
+            Nova::Log::Shutdown();
+            return exitCode;
+        }
+    }
+
+    auto window = InitializeWindow(VkExtent2D { 1280, 720 });
+    if (window == nullptr) {
+        Nova::Log::Shutdown();
+        return -1;
+    }
+
+    // 渲染线程独占交换链的提交和呈现, 模拟线程生成帧包, 主线程只处理窗口事件
+    Nova::VulkanRenderThread renderThread;
+    renderThread.Start(Nova::VulkanRHI::Singleton().GetSwapchain(), [](Nova::VulkanSwapchain& swapchain, const Nova::FramePacket& packet) {
+        const auto& color = packet.clearColor;
+        RecordClearSwapChainImage(
+            swapchain.GetCurrentCommandBuffer(),
+            swapchain.GetSwapChainImage(swapchain.GetCurrentImageIndex()),
+            swapchain.GetSwapChainFinalLayout(),
+            { { color[0], color[1], color[2], color[3] } }
+        );
+    });
+    std::thread simulationThread(RunSimulation, std::ref(*window), std::ref(renderThread));
+
+    PumpWindowEvents(*window, renderThread);
+
+    // 停止渲染线程会关闭帧包队列, 模拟线程随之退出; 交换链在窗口销毁之前销毁
+    renderThread.Stop();
+    simulationThread.join();
+
+    TerminateWindow(window);
+    Nova::JobSystem::Singleton().Terminate();
+    Nova::Log::Shutdown();
     return 0;
 }
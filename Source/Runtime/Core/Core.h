@@ -1 +1,11 @@
 #pragma once
+
+#include "Core/DoubleBuffer.h"
+#include "Core/HandlePool.h"
+#include "Core/JobSystem.h"
+#include "Core/LinearArena.h"
+#include "Core/Log.h"
+#include "Core/MappedFile.h"
+#include "Core/MemoryTracker.h"
+#include "Core/ScratchArena.h"
+#include "Core/SpscQueue.h"
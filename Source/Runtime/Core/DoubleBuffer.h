@@ -0,0 +1,80 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+namespace Nova {
+
+// 单写者单读者的双缓冲, 用于模拟线程向渲染线程逐帧交接数据
+// 第k个数据写入槽位k%2; 写者在第k-2个数据被读完之前等待, 读者在第k个数据发布之前等待, 因此写者最多领先读者一帧
+// 每个数据都会被读到, 不会丢帧也不会重复读取
+template<typename T>
+class DoubleBuffer {
+    // 已发布和已读完的数据个数, 最高位表示已关闭
+    static constexpr uint64_t CLOSED_BIT = 1ull << 63;
+
+    alignas(64) std::atomic<uint64_t> mPublished = 0;
+    alignas(64) std::atomic<uint64_t> mConsumed = 0;
+    alignas(64) T mSlots[2]                     = {};
+
+public:
+    DoubleBuffer() = default;
+
+    DoubleBuffer(const DoubleBuffer&)            = delete;
+    DoubleBuffer& operator=(const DoubleBuffer&) = delete;
+
+    // 返回下一个可写的槽位, 已关闭时返回nullptr; 写完后调用EndWrite发布
+    T* BeginWrite() {
+        uint64_t published = mPublished.load(std::memory_order_relaxed) & ~CLOSED_BIT;
+        for (;;) {
+            // 与EndRead中的release配对, 确保读者已经不再访问该槽位
+            uint64_t consumed = mConsumed.load(std::memory_order_acquire);
+            if ((consumed & CLOSED_BIT) != 0) {
+                return nullptr;
+            }
+            if (consumed + 1 >= published) {
+                return &mSlots[published & 1];
+            }
+            mConsumed.wait(consumed, std::memory_order_acquire);
+        }
+    }
+
+    void EndWrite() {
+        // 与BeginRead中的acquire配对, 发布槽位内容
+        mPublished.fetch_add(1, std::memory_order_release);
+        mPublished.notify_one();
+    }
+
+    // 返回下一个待读的槽位, 已关闭时返回nullptr, 未读的数据被丢弃; 读完后调用EndRead归还
+    const T* BeginRead() {
+        uint64_t consumed = mConsumed.load(std::memory_order_relaxed) & ~CLOSED_BIT;
+        for (;;) {
+            uint64_t published = mPublished.load(std::memory_order_acquire);
+            if ((published & CLOSED_BIT) != 0) {
+                return nullptr;
+            }
+            if (published > consumed) {
+                return &mSlots[consumed & 1];
+            }
+            mPublished.wait(published, std::memory_order_acquire);
+        }
+    }
+
+    void EndRead() {
+        mConsumed.fetch_add(1, std::memory_order_release);
+        mConsumed.notify_one();
+    }
+
+    // 唤醒并结束两端的等待, 之后BeginWrite和BeginRead都返回nullptr
+    void Close() {
+        mPublished.fetch_or(CLOSED_BIT, std::memory_order_release);
+        mConsumed.fetch_or(CLOSED_BIT, std::memory_order_release);
+        mPublished.notify_all();
+        mConsumed.notify_all();
+    }
+
+    bool IsClosed() const {
+        return (mPublished.load(std::memory_order_acquire) & CLOSED_BIT) != 0;
+    }
+};
+} // namespace Nova
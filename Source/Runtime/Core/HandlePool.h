@@ -0,0 +1,263 @@
+#pragma once
+
+#include "Core/Log.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <utility>
+
+namespace Nova {
+
+// 32位代数句柄: 低20位为槽位索引, 高12位为代数, 值为0的句柄无效
+// Tag只用于区分类型, 不同资源的句柄不能互相赋值
+template<typename Tag>
+struct Handle {
+    static constexpr uint32_t INDEX_BITS      = 20;
+    static constexpr uint32_t GENERATION_BITS = 32 - INDEX_BITS;
+    static constexpr uint32_t INDEX_MASK      = (1u << INDEX_BITS) - 1;
+    static constexpr uint32_t GENERATION_MASK = (1u << GENERATION_BITS) - 1;
+
+    uint32_t value = 0;
+
+    static constexpr Handle Make(uint32_t index, uint32_t generation) {
+        return Handle{ (generation << INDEX_BITS) | index };
+    }
+
+    constexpr uint32_t GetIndex() const {
+        return value & INDEX_MASK;
+    }
+
+    constexpr uint32_t GetGeneration() const {
+        return value >> INDEX_BITS;
+    }
+
+    constexpr bool IsNull() const {
+        return value == 0;
+    }
+
+    constexpr explicit operator bool() const {
+        return value != 0;
+    }
+
+    constexpr bool operator==(const Handle&) const = default;
+};
+
+// 无锁的代数句柄池
+// 槽位按块分配, 块一旦分配就不会移动或释放, 记录的地址在其句柄释放之前保持稳定
+// 空闲槽位组成带ABA计数的无锁栈, 任意线程都可以并发地Allocate和Free
+// 释放时槽位代数加一, 旧句柄随即失效; NOVA_DEBUG下Get会检查代数并报告过期句柄, 发布版只由TryGet检查
+// 同一个句柄的Get和Free之间的先后关系由调用方保证(如延迟销毁)
+template<typename T, typename Tag = T>
+class HandlePool {
+public:
+    using HandleType = Handle<Tag>;
+
+    static constexpr uint32_t BLOCK_SIZE = 1024;
+    static constexpr uint32_t MAX_SLOTS  = HandleType::INDEX_MASK + 1;
+    static constexpr uint32_t MAX_BLOCKS = MAX_SLOTS / BLOCK_SIZE;
+
+private:
+    static constexpr uint32_t INVALID_INDEX = UINT32_MAX;
+
+    struct Slot {
+        std::atomic<uint32_t> generation = 1;
+        std::atomic<uint32_t> nextFree   = INVALID_INDEX;
+        std::atomic<bool>     alive      = false;
+
+        alignas(T) std::byte storage[sizeof(T)];
+    };
+
+    struct Block {
+        Slot slots[BLOCK_SIZE];
+    };
+
+    std::atomic<Block*> mBlocks[MAX_BLOCKS] = {};
+
+    // 从未使用过的第一个槽位
+    std::atomic<uint32_t> mNextUnused = 0;
+
+    // 低32位为栈顶槽位索引, 高32位为每次修改递增的计数, 防止ABA
+    std::atomic<uint64_t> mFreeHead = INVALID_INDEX;
+
+    std::atomic<uint32_t> mLiveCount = 0;
+
+public:
+    HandlePool() = default;
+
+    HandlePool(const HandlePool&)            = delete;
+    HandlePool& operator=(const HandlePool&) = delete;
+
+    ~HandlePool() {
+        Clear();
+        for (auto& block: mBlocks) {
+            delete block.load(std::memory_order_relaxed);
+        }
+    }
+
+    // 池已满时返回空句柄
+    template<typename... Args>
+    HandleType Allocate(Args&&... args) {
+        uint32_t index = PopFree();
+        if (index == INVALID_INDEX) {
+            index = mNextUnused.fetch_add(1, std::memory_order_relaxed);
+            if (index >= MAX_SLOTS) {
+                NOVA_LOG_ERROR(Core, "Pool is full, capacity: {}", MAX_SLOTS);
+                return {};
+            }
+            EnsureBlock(index / BLOCK_SIZE);
+        }
+
+        Slot& slot = GetSlot(index);
+        new (slot.storage) T(std::forward<Args>(args)...);
+        slot.alive.store(true, std::memory_order_release);
+        mLiveCount.fetch_add(1, std::memory_order_relaxed);
+        return HandleType::Make(index, slot.generation.load(std::memory_order_relaxed));
+    }
+
+    // 过期句柄或重复释放返回false
+    bool Free(HandleType handle) {
+        if (!IsValid(handle)) {
+            ReportStale(handle, "Free");
+            return false;
+        }
+
+        // 并发释放同一个句柄时只有一个线程能推进代数
+        Slot&    slot           = GetSlot(handle.GetIndex());
+        uint32_t generation     = handle.GetGeneration();
+        uint32_t nextGeneration = generation == HandleType::GENERATION_MASK ? 1 : generation + 1;
+        if (!slot.generation.compare_exchange_strong(generation, nextGeneration, std::memory_order_acq_rel)) {
+            ReportStale(handle, "Free");
+            return false;
+        }
+
+        slot.alive.store(false, std::memory_order_relaxed);
+        std::launder(reinterpret_cast<T*>(slot.storage))->~T();
+        mLiveCount.fetch_sub(1, std::memory_order_relaxed);
+        PushFree(handle.GetIndex());
+        return true;
+    }
+
+    bool IsValid(HandleType handle) const {
+        uint32_t index = handle.GetIndex();
+        if (handle.IsNull() || index >= std::min(mNextUnused.load(std::memory_order_acquire), MAX_SLOTS)) {
+            return false;
+        }
+        const Block* block = mBlocks[index / BLOCK_SIZE].load(std::memory_order_acquire);
+        if (block == nullptr) {
+            return false;
+        }
+        const Slot& slot = block->slots[index % BLOCK_SIZE];
+        return slot.alive.load(std::memory_order_acquire) && slot.generation.load(std::memory_order_acquire) == handle.GetGeneration();
+    }
+
+    // 热路径使用, 发布版不检查代数
+    T* Get(HandleType handle) {
+#ifdef NOVA_DEBUG
+        if (!IsValid(handle)) {
+            ReportStale(handle, "Get");
+            return nullptr;
+        }
+#else
+        if (handle.IsNull()) {
+            return nullptr;
+        }
+#endif
+        return std::launder(reinterpret_cast<T*>(GetSlot(handle.GetIndex()).storage));
+    }
+
+    // 总是检查代数, 句柄过期时返回nullptr
+    T* TryGet(HandleType handle) {
+        if (!IsValid(handle)) {
+            return nullptr;
+        }
+        return std::launder(reinterpret_cast<T*>(GetSlot(handle.GetIndex()).storage));
+    }
+
+    uint32_t GetLiveCount() const {
+        return mLiveCount.load(std::memory_order_relaxed);
+    }
+
+    // 使用过的槽位数, 即槽位数组的高水位
+    uint32_t GetSlotCount() const {
+        return std::min(mNextUnused.load(std::memory_order_relaxed), MAX_SLOTS);
+    }
+
+    // 遍历所有存活的记录, 不能与Allocate和Free并发调用
+    template<typename Function>
+    void ForEach(Function&& function) {
+        uint32_t slotCount = GetSlotCount();
+        for (uint32_t i = 0; i < slotCount; i++) {
+            Slot& slot = GetSlot(i);
+            if (slot.alive.load(std::memory_order_relaxed)) {
+                function(HandleType::Make(i, slot.generation.load(std::memory_order_relaxed)), *std::launder(reinterpret_cast<T*>(slot.storage)));
+            }
+        }
+    }
+
+    // 释放所有存活的记录, 不能与Allocate和Free并发调用
+    void Clear() {
+        uint32_t slotCount = GetSlotCount();
+        for (uint32_t i = 0; i < slotCount; i++) {
+            Slot& slot = GetSlot(i);
+            if (slot.alive.load(std::memory_order_relaxed)) {
+                Free(HandleType::Make(i, slot.generation.load(std::memory_order_relaxed)));
+            }
+        }
+    }
+
+private:
+    Slot& GetSlot(uint32_t index) const {
+        return mBlocks[index / BLOCK_SIZE].load(std::memory_order_acquire)->slots[index % BLOCK_SIZE];
+    }
+
+    // 多个线程同时需要同一个块时只有一个线程的块会被安装, 其余释放
+    void EnsureBlock(uint32_t blockIndex) {
+        Block* block = mBlocks[blockIndex].load(std::memory_order_acquire);
+        if (block != nullptr) {
+            return;
+        }
+        Block* newBlock = new Block;
+        if (!mBlocks[blockIndex].compare_exchange_strong(block, newBlock, std::memory_order_acq_rel, std::memory_order_acquire)) {
+            delete newBlock;
+        }
+    }
+
+    uint32_t PopFree() {
+        uint64_t head = mFreeHead.load(std::memory_order_acquire);
+        while (true) {
+            uint32_t index = static_cast<uint32_t>(head);
+            if (index == INVALID_INDEX) {
+                return INVALID_INDEX;
+            }
+            // 槽位可能已被其他线程弹出并重新压入, 此时计数不同, 比较交换会失败
+            uint32_t next    = GetSlot(index).nextFree.load(std::memory_order_relaxed);
+            uint64_t newHead = (((head >> 32) + 1) << 32) | next;
+            if (mFreeHead.compare_exchange_weak(head, newHead, std::memory_order_acquire, std::memory_order_acquire)) {
+                return index;
+            }
+        }
+    }
+
+    void PushFree(uint32_t index) {
+        Slot&    slot = GetSlot(index);
+        uint64_t head = mFreeHead.load(std::memory_order_relaxed);
+        uint64_t newHead;
+        do {
+            slot.nextFree.store(static_cast<uint32_t>(head), std::memory_order_relaxed);
+            newHead = (((head >> 32) + 1) << 32) | index;
+        } while (!mFreeHead.compare_exchange_weak(head, newHead, std::memory_order_release, std::memory_order_relaxed));
+    }
+
+    static void ReportStale(HandleType handle, const char* operation) {
+#ifdef NOVA_DEBUG
+        NOVA_LOG_WARN(Core, "{} with a stale handle: index {}, generation {}", operation, handle.GetIndex(), handle.GetGeneration());
+#else
+        (void)handle;
+        (void)operation;
+#endif
+    }
+};
+} // namespace Nova
@@ -0,0 +1,417 @@
+#include "JobSystem.h"
+#include "Log.h"
+
+#if defined(_WIN32)
+    #ifndef NOMINMAX
+        #define NOMINMAX
+    #endif
+    #ifndef WIN32_LEAN_AND_MEAN
+        #define WIN32_LEAN_AND_MEAN
+    #endif
+    #include <windows.h>
+#elif defined(__linux__)
+    #include <pthread.h>
+    #include <sched.h>
+#endif
+
+namespace Nova {
+
+// 将线程固定到指定核心, 避免工作线程在核心之间迁移导致缓存失效
+static void PinThreadToCore(std::thread& thread, uint32_t core) {
+#if defined(_WIN32)
+    SetThreadAffinityMask(thread.native_handle(), DWORD_PTR(1) << (core % (sizeof(DWORD_PTR) * 8)));
+#elif defined(__linux__)
+    cpu_set_t cpuSet;
+    CPU_ZERO(&cpuSet);
+    CPU_SET(core % CPU_SETSIZE, &cpuSet);
+    pthread_setaffinity_np(thread.native_handle(), sizeof(cpuSet), &cpuSet);
+#else
+    (void)thread;
+    (void)core;
+#endif
+}
+
+static uint32_t NextRandom(uint32_t& state) {
+    // xorshift32
+    state ^= state << 13;
+    state ^= state >> 17;
+    state ^= state << 5;
+    return state;
+}
+
+void JobSystem::Initialize(uint32_t threadCount) {
+    if (IsInitialized()) {
+        return;
+    }
+
+    // 至少启动一个工作线程, 只有一个核心时调用线程提交后不等待的作业(如纹理解码)也能执行
+    uint32_t coreCount = std::max(1u, std::thread::hardware_concurrency());
+    if (threadCount == 0) {
+        threadCount = std::max(coreCount, 2u);
+    }
+
+    mWorkerCount = threadCount;
+    mThreadContexts.resize(threadCount + REGISTERED_THREAD_COUNT);
+    for (uint32_t i = 0; i < mThreadContexts.size(); i++) {
+        mThreadContexts[i]     = std::make_unique<ThreadContext>();
+        ThreadContext& context = *mThreadContexts[i];
+        context.jobPool        = std::make_unique<Job[]>(JOB_POOL_SIZE);
+        context.randomState    = (i + 1) * 2654435761u;
+
+        // 作业池初始全部空闲
+        for (uint32_t j = 0; j < JOB_POOL_SIZE; j++) {
+            context.jobPool[j].ownerThread = i;
+            context.jobPool[j].next        = j + 1 < JOB_POOL_SIZE ? &context.jobPool[j + 1] : nullptr;
+        }
+        context.freeJobs = &context.jobPool[0];
+    }
+
+    mExternalJobPool = std::make_unique<Job[]>(EXTERNAL_JOB_POOL_SIZE);
+    for (uint32_t j = 0; j < EXTERNAL_JOB_POOL_SIZE; j++) {
+        mExternalJobPool[j].ownerThread = INVALID_THREAD_INDEX;
+        mExternalJobPool[j].next        = j + 1 < EXTERNAL_JOB_POOL_SIZE ? &mExternalJobPool[j + 1] : nullptr;
+    }
+    mExternalFreeJobs = &mExternalJobPool[0];
+    mExternalCounters.Reset();
+
+    sThreadIndex = 0;
+    mQuit.store(false, std::memory_order_relaxed);
+
+    // 0号线程(通常是主线程)不固定核心, 工作线程依次固定到其余核心上
+    for (uint32_t i = 1; i < threadCount; i++) {
+        mWorkers.emplace_back(&JobSystem::WorkerMain, this, i);
+        PinThreadToCore(mWorkers.back(), i % coreCount);
+    }
+
+    NOVA_LOG_INFO(Core, "{} threads on {} cores", threadCount, coreCount);
+}
+
+void JobSystem::Terminate() {
+    if (!IsInitialized()) {
+        return;
+    }
+
+    mQuit.store(true, std::memory_order_release);
+    mWakeEpoch.fetch_add(1, std::memory_order_seq_cst);
+    mWakeEpoch.notify_all();
+    for (auto& worker: mWorkers) {
+        worker.join();
+    }
+    mWorkers.resize(0);
+
+    // 在调用线程上执行完剩余的作业, 保证所有计数器都能归零
+    sThreadIndex = 0;
+    while (TryExecuteOne()) {
+    }
+    sThreadIndex = INVALID_THREAD_INDEX;
+
+    mThreadContexts.resize(0);
+    mWorkerCount      = 0;
+    mExternalFreeJobs = nullptr;
+    mExternalJobPool.reset();
+}
+
+bool JobSystem::RegisterThread() {
+    if (sThreadIndex != INVALID_THREAD_INDEX) {
+        return true;
+    }
+    if (!IsInitialized()) {
+        return false;
+    }
+    for (uint32_t i = mWorkerCount; i < mThreadContexts.size(); i++) {
+        // 与UnregisterThread中的release配对, 上一个线程对作业池的访问都已结束
+        bool expected = false;
+        if (mThreadContexts[i]->registered.compare_exchange_strong(expected, true, std::memory_order_acquire, std::memory_order_relaxed)) {
+            sThreadIndex = i;
+            return true;
+        }
+    }
+    NOVA_LOG_WARN(Core, "All {} registered thread slots are taken", REGISTERED_THREAD_COUNT);
+    return false;
+}
+
+void JobSystem::UnregisterThread() {
+    uint32_t threadIndex = sThreadIndex;
+    if (threadIndex == INVALID_THREAD_INDEX || threadIndex < mWorkerCount) {
+        return;
+    }
+
+    // 工作线程可能都在休眠或不存在, 剩余的作业不能只留给窃取
+    ThreadContext& context = *mThreadContexts[threadIndex];
+    while (Job* job = context.queue.Pop()) {
+        Execute(job);
+    }
+    sThreadIndex = INVALID_THREAD_INDEX;
+    context.registered.store(false, std::memory_order_release);
+}
+
+void JobSystem::Wait(const JobCounter& counter) {
+    while (!counter.IsDone()) {
+        if (sThreadIndex != INVALID_THREAD_INDEX && TryExecuteOne()) {
+            continue;
+        }
+        std::this_thread::yield();
+    }
+}
+
+JobSystemStats JobSystem::GetStats() const {
+    JobSystemStats stats;
+    for (auto& context: mThreadContexts) {
+        const ThreadCounters& counters = context->counters;
+        stats.submitted += counters.submitted.load(std::memory_order_relaxed);
+        stats.executed += counters.executed.load(std::memory_order_relaxed);
+        stats.stolen += counters.stolen.load(std::memory_order_relaxed);
+        stats.failedSteals += counters.failedSteals.load(std::memory_order_relaxed);
+        stats.overflowed += counters.overflowed.load(std::memory_order_relaxed);
+        stats.heapJobs += counters.heapJobs.load(std::memory_order_relaxed);
+        stats.sleeps += counters.sleeps.load(std::memory_order_relaxed);
+    }
+    stats.heapJobs += mExternalCounters.heapJobs.load(std::memory_order_relaxed);
+    stats.externalJobs = mExternalCounters.submitted.load(std::memory_order_relaxed);
+    return stats;
+}
+
+Job* JobSystem::AllocateJob() {
+    uint32_t threadIndex = sThreadIndex;
+    if (threadIndex == INVALID_THREAD_INDEX || !IsInitialized()) {
+        Job* job = nullptr;
+        if (IsInitialized()) {
+            std::lock_guard<std::mutex> lock(mExternalMutex);
+            job = mExternalFreeJobs;
+            if (job != nullptr) {
+                mExternalFreeJobs = job->next;
+                job->next         = nullptr;
+                return job;
+            }
+        }
+        // 共用的作业池耗尽或作业系统未初始化(作业在提交时直接执行)时从堆上分配
+        mExternalCounters.heapJobs.fetch_add(1, std::memory_order_relaxed);
+        job                = new Job();
+        job->heapAllocated = true;
+        return job;
+    }
+
+    ThreadContext& context = *mThreadContexts[threadIndex];
+    if (context.freeJobs == nullptr) {
+        // 与FreeJob中的release配对, 其他线程对作业的访问都已结束
+        context.freeJobs = context.returnedJobs.exchange(nullptr, std::memory_order_acquire);
+    }
+
+    // 作业池耗尽(同时未完成的作业过多)时从堆上分配
+    Job* job = context.freeJobs;
+    if (job == nullptr) {
+        context.counters.heapJobs.fetch_add(1, std::memory_order_relaxed);
+        job                = new Job();
+        job->heapAllocated = true;
+        return job;
+    }
+    context.freeJobs = job->next;
+    job->next        = nullptr;
+    return job;
+}
+
+void JobSystem::FreeJob(Job* job) {
+    if (job->heapAllocated) {
+        delete job;
+        return;
+    }
+
+    if (job->ownerThread == INVALID_THREAD_INDEX) {
+        std::lock_guard<std::mutex> lock(mExternalMutex);
+        job->next         = mExternalFreeJobs;
+        mExternalFreeJobs = job;
+        return;
+    }
+
+    ThreadContext& owner = *mThreadContexts[job->ownerThread];
+    if (job->ownerThread == sThreadIndex) {
+        job->next      = owner.freeJobs;
+        owner.freeJobs = job;
+        return;
+    }
+
+    Job* head = owner.returnedJobs.load(std::memory_order_relaxed);
+    do {
+        job->next = head;
+    } while (!owner.returnedJobs.compare_exchange_weak(head, job, std::memory_order_release, std::memory_order_relaxed));
+}
+
+void JobSystem::Submit(Job* job) {
+    // 作业系统未初始化时直接执行, 保证调用者的逻辑在单线程下依然正确
+    if (!IsInitialized()) {
+        Execute(job);
+        return;
+    }
+
+    uint32_t threadIndex = sThreadIndex;
+    if (threadIndex == INVALID_THREAD_INDEX) {
+        mExternalCounters.submitted.fetch_add(1, std::memory_order_relaxed);
+        std::lock_guard<std::mutex> lock(mExternalMutex);
+        mExternalJobs.push_back(job);
+        mHasExternalJobs.store(true, std::memory_order_release);
+    } else {
+        ThreadContext& context = *mThreadContexts[threadIndex];
+        context.counters.submitted.fetch_add(1, std::memory_order_relaxed);
+        if (!context.queue.Push(job)) {
+            context.counters.overflowed.fetch_add(1, std::memory_order_relaxed);
+            Execute(job);
+            return;
+        }
+    }
+
+    mWakeEpoch.fetch_add(1, std::memory_order_seq_cst);
+    if (mSleepingCount.load(std::memory_order_seq_cst) > 0) {
+        mWakeEpoch.notify_one();
+    }
+}
+
+void JobSystem::Execute(Job* job) {
+    job->entry(*job);
+
+    uint32_t threadIndex = sThreadIndex;
+    if (threadIndex != INVALID_THREAD_INDEX && threadIndex < mThreadContexts.size()) {
+        mThreadContexts[threadIndex]->counters.executed.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    // 计数器归零后等待者可能立即销毁它, 必须放在最后; 作业归还后拥有者线程可能立即复用, 之后不能再访问job
+    JobCounter* counter = job->counter;
+    FreeJob(job);
+    if (counter != nullptr) {
+        ReleaseCounter(*counter);
+    }
+}
+
+// 依赖已经归零时返回false, 由调用者直接提交
+bool JobSystem::ParkJob(Job* job, const JobCounter& dependency) {
+    uint32_t value = dependency.mValue.load(std::memory_order_acquire);
+    while (true) {
+        if ((value & JobCounter::COUNT_MASK) == 0) {
+            return false;
+        }
+        if ((value & JobCounter::LOCK_BIT) != 0) {
+            std::this_thread::yield();
+            value = dependency.mValue.load(std::memory_order_acquire);
+            continue;
+        }
+        // 与计数同时检查, 计数在此之前归零时CAS失败并重新检查
+        uint32_t locked = value | JobCounter::LOCK_BIT | JobCounter::WAITERS_BIT;
+        if (dependency.mValue.compare_exchange_weak(value, locked, std::memory_order_acquire, std::memory_order_acquire)) {
+            break;
+        }
+    }
+
+    job->next           = dependency.mWaiters;
+    dependency.mWaiters = job;
+    dependency.mValue.fetch_and(~JobCounter::LOCK_BIT, std::memory_order_release);
+    return true;
+}
+
+void JobSystem::ReleaseCounter(JobCounter& counter) {
+    uint32_t value = counter.mValue.load(std::memory_order_relaxed);
+    while (true) {
+        // 没有挂起的作业或不是最后一个作业时只需递减, 归零后等待者可能立即销毁计数器, 之后不能再访问
+        if ((value & JobCounter::COUNT_MASK) > 1 || (value & JobCounter::WAITERS_BIT) == 0) {
+            if (counter.mValue.compare_exchange_weak(value, value - 1, std::memory_order_acq_rel, std::memory_order_relaxed)) {
+                return;
+            }
+            continue;
+        }
+        if ((value & JobCounter::LOCK_BIT) != 0) {
+            std::this_thread::yield();
+            value = counter.mValue.load(std::memory_order_relaxed);
+            continue;
+        }
+        if (counter.mValue.compare_exchange_weak(value, value | JobCounter::LOCK_BIT, std::memory_order_acquire, std::memory_order_relaxed)) {
+            break;
+        }
+    }
+
+    // 取出挂起的作业, 递减计数的同时清除两个标记位, 这是最后一次访问计数器
+    Job* waiters     = counter.mWaiters;
+    counter.mWaiters = nullptr;
+    counter.mValue.fetch_sub(1 + JobCounter::LOCK_BIT + JobCounter::WAITERS_BIT, std::memory_order_acq_rel);
+
+    while (waiters != nullptr) {
+        Job* next = waiters->next;
+        Submit(waiters);
+        waiters = next;
+    }
+}
+
+Job* JobSystem::FindJob(uint32_t threadIndex) {
+    ThreadContext& context = *mThreadContexts[threadIndex];
+
+    if (Job* job = context.queue.Pop()) {
+        return job;
+    }
+
+    if (mHasExternalJobs.load(std::memory_order_acquire)) {
+        std::lock_guard<std::mutex> lock(mExternalMutex);
+        if (!mExternalJobs.empty()) {
+            Job* job = mExternalJobs.back();
+            mExternalJobs.pop_back();
+            mHasExternalJobs.store(!mExternalJobs.empty(), std::memory_order_release);
+            return job;
+        }
+    }
+
+    // 从随机的线程开始依次尝试窃取
+    uint32_t threadCount = static_cast<uint32_t>(mThreadContexts.size());
+    if (threadCount > 1) {
+        uint32_t start = NextRandom(context.randomState) % threadCount;
+        for (uint32_t i = 0; i < threadCount; i++) {
+            uint32_t victim = (start + i) % threadCount;
+            if (victim == threadIndex) {
+                continue;
+            }
+            if (Job* job = mThreadContexts[victim]->queue.Steal()) {
+                context.counters.stolen.fetch_add(1, std::memory_order_relaxed);
+                return job;
+            }
+        }
+        context.counters.failedSteals.fetch_add(1, std::memory_order_relaxed);
+    }
+    return nullptr;
+}
+
+bool JobSystem::TryExecuteOne() {
+    Job* job = FindJob(sThreadIndex);
+    if (job == nullptr) {
+        return false;
+    }
+    Execute(job);
+    return true;
+}
+
+void JobSystem::WorkerMain(uint32_t threadIndex) {
+    // 休眠前的自旋次数, 连续提交作业时避免频繁休眠唤醒
+    constexpr uint32_t SPIN_COUNT = 64;
+
+    sThreadIndex           = threadIndex;
+    ThreadContext& context = *mThreadContexts[threadIndex];
+
+    while (!mQuit.load(std::memory_order_acquire)) {
+        bool executed = false;
+        for (uint32_t i = 0; i < SPIN_COUNT && !executed; i++) {
+            executed = TryExecuteOne();
+            if (!executed) {
+                std::this_thread::yield();
+            }
+        }
+        if (executed) {
+            continue;
+        }
+
+        // 先记录纪元再做最后一次检查, 检查之后提交的作业会改变纪元, 不会丢失唤醒
+        uint32_t epoch = mWakeEpoch.load(std::memory_order_seq_cst);
+        mSleepingCount.fetch_add(1, std::memory_order_seq_cst);
+        if (!mQuit.load(std::memory_order_acquire) && !TryExecuteOne()) {
+            context.counters.sleeps.fetch_add(1, std::memory_order_relaxed);
+            mWakeEpoch.wait(epoch, std::memory_order_seq_cst);
+        }
+        mSleepingCount.fetch_sub(1, std::memory_order_seq_cst);
+    }
+
+    sThreadIndex = INVALID_THREAD_INDEX;
+}
+} // namespace Nova
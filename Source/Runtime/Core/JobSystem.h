@@ -0,0 +1,310 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace Nova {
+
+struct Job;
+
+// 记录未完成的作业数, 归零即表示这一组作业全部完成
+// 作为依赖使用时, 依赖它的作业挂起在计数器上, 由最后完成的作业在归零时提交, 不占用任何线程
+class JobCounter {
+    friend class JobSystem;
+
+    // 低位为未完成的作业数; 有作业挂起时置位WAITERS_BIT, 修改挂起列表时置位LOCK_BIT
+    static constexpr uint32_t LOCK_BIT    = 1u << 31;
+    static constexpr uint32_t WAITERS_BIT = 1u << 30;
+    static constexpr uint32_t COUNT_MASK  = WAITERS_BIT - 1;
+
+    mutable std::atomic<uint32_t> mValue   = 0;
+    mutable Job*                  mWaiters = nullptr;
+
+public:
+    JobCounter() = default;
+
+    JobCounter(const JobCounter&)            = delete;
+    JobCounter& operator=(const JobCounter&) = delete;
+
+    uint32_t GetValue() const {
+        return mValue.load(std::memory_order_acquire) & COUNT_MASK;
+    }
+
+    // 挂起的作业提交之后才算完成, 之后才能销毁计数器
+    bool IsDone() const {
+        return mValue.load(std::memory_order_acquire) == 0;
+    }
+};
+
+struct Job {
+    // 闭包直接存放在作业内, 避免每次提交都进行堆分配
+    static constexpr size_t PAYLOAD_SIZE = 64;
+
+    using Entry = void (*)(Job& job);
+
+    Entry       entry         = nullptr;
+    JobCounter* counter       = nullptr;
+    bool        heapAllocated = false;
+    uint32_t    ownerThread   = 0; // 作业池所属的线程, 执行完毕后归还到该线程的空闲列表
+
+    // 在空闲列表中时链接下一个空闲的作业, 挂起在依赖计数器上时链接同一计数器上的其他作业
+    Job* next = nullptr;
+
+    alignas(std::max_align_t) std::byte payload[PAYLOAD_SIZE];
+};
+
+// 固定容量的Chase-Lev工作窃取队列
+// 只有拥有者线程调用Push/Pop(从底部), 其他线程调用Steal(从顶部)
+class WorkStealingQueue {
+public:
+    static constexpr int64_t CAPACITY = 4096;
+
+private:
+    static constexpr int64_t MASK = CAPACITY - 1;
+    static_assert((CAPACITY & MASK) == 0, "CAPACITY must be a power of two");
+
+    alignas(64) std::atomic<int64_t> mTop = 0;
+    alignas(64) std::atomic<int64_t> mBottom = 0;
+    alignas(64) std::atomic<Job*> mBuffer[CAPACITY] = {};
+
+public:
+    // 队列已满时返回false, 由调用者直接执行该作业
+    bool Push(Job* job) {
+        int64_t bottom = mBottom.load(std::memory_order_relaxed);
+        int64_t top    = mTop.load(std::memory_order_acquire);
+        if (bottom - top >= CAPACITY) {
+            return false;
+        }
+        mBuffer[bottom & MASK].store(job, std::memory_order_relaxed);
+        // 与Steal中对mBottom的acquire配对, 发布作业内容
+        mBottom.store(bottom + 1, std::memory_order_release);
+        return true;
+    }
+
+    Job* Pop() {
+        int64_t bottom = mBottom.load(std::memory_order_relaxed) - 1;
+        mBottom.store(bottom, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        int64_t top = mTop.load(std::memory_order_relaxed);
+
+        if (top > bottom) {
+            mBottom.store(bottom + 1, std::memory_order_relaxed);
+            return nullptr;
+        }
+
+        Job* job = mBuffer[bottom & MASK].load(std::memory_order_relaxed);
+        // 只剩最后一个作业时与窃取者竞争
+        if (top == bottom) {
+            if (!mTop.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) {
+                job = nullptr;
+            }
+            mBottom.store(bottom + 1, std::memory_order_relaxed);
+        }
+        return job;
+    }
+
+    Job* Steal() {
+        int64_t top = mTop.load(std::memory_order_acquire);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        int64_t bottom = mBottom.load(std::memory_order_acquire);
+        if (top >= bottom) {
+            return nullptr;
+        }
+
+        Job* job = mBuffer[top & MASK].load(std::memory_order_relaxed);
+        if (!mTop.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) {
+            return nullptr;
+        }
+        return job;
+    }
+
+    int64_t GetSize() const {
+        int64_t bottom = mBottom.load(std::memory_order_relaxed);
+        int64_t top    = mTop.load(std::memory_order_relaxed);
+        return bottom > top ? bottom - top : 0;
+    }
+};
+
+struct JobSystemStats {
+    uint64_t submitted    = 0;
+    uint64_t executed     = 0;
+    uint64_t stolen       = 0;
+    uint64_t failedSteals = 0;
+    uint64_t overflowed   = 0; // 队列已满而直接执行的作业
+    uint64_t heapJobs     = 0; // 作业池没有空闲的作业而从堆上分配的作业, 包括非作业系统线程分配的
+    uint64_t externalJobs = 0; // 非作业系统线程提交的作业
+    uint64_t sleeps       = 0;
+};
+
+// 工作窃取作业系统
+// 调用Initialize的线程是0号线程, 其余为固定在各核心上的工作线程; 每个线程拥有自己的作业队列和作业池,
+// 空闲时随机窃取其他线程的作业. Wait在等待期间会执行其他作业, 主线程不会空等
+// 另外预留REGISTERED_THREAD_COUNT个线程下标, 渲染线程等长期存在的线程通过RegisterThread加入, 与工作线程同等对待
+class JobSystem {
+public:
+    static constexpr uint32_t INVALID_THREAD_INDEX = ~0u;
+
+    // 每个线程的作业池大小, 同一线程分配的未完成作业数超过该值时, 多出的作业从堆上分配
+    static constexpr uint32_t JOB_POOL_SIZE = 4096;
+
+    // 非作业系统线程共用的作业池大小, 由mExternalMutex保护
+    static constexpr uint32_t EXTERNAL_JOB_POOL_SIZE = 1024;
+
+    // 可以通过RegisterThread加入的线程数
+    static constexpr uint32_t REGISTERED_THREAD_COUNT = 2;
+
+private:
+    struct alignas(64) ThreadCounters {
+        std::atomic<uint64_t> submitted    = 0;
+        std::atomic<uint64_t> executed     = 0;
+        std::atomic<uint64_t> stolen       = 0;
+        std::atomic<uint64_t> failedSteals = 0;
+        std::atomic<uint64_t> overflowed   = 0;
+        std::atomic<uint64_t> heapJobs     = 0;
+        std::atomic<uint64_t> sleeps       = 0;
+
+        void Reset() {
+            for (std::atomic<uint64_t>* counter: { &submitted, &executed, &stolen, &failedSteals, &overflowed, &heapJobs, &sleeps }) {
+                counter->store(0, std::memory_order_relaxed);
+            }
+        }
+    };
+
+    // 作业由拥有者线程分配, 由任意线程执行并归还: 拥有者线程执行完毕的作业直接放回freeJobs,
+    // 其他线程压入returnedJobs, freeJobs为空时拥有者线程一次取回整个returnedJobs, 不存在ABA问题
+    struct ThreadContext {
+        WorkStealingQueue      queue;
+        std::unique_ptr<Job[]> jobPool;
+        Job*                   freeJobs     = nullptr;
+        std::atomic<Job*>      returnedJobs = nullptr;
+        ThreadCounters         counters;
+        uint32_t               randomState = 0;
+        std::atomic<bool>      registered  = false; // 预留的线程下标是否已被RegisterThread占用
+    };
+
+    JobSystem() = default;
+
+    std::vector<std::unique_ptr<ThreadContext>> mThreadContexts;
+    std::vector<std::thread>                    mWorkers;
+    uint32_t                                    mWorkerCount = 0; // Initialize的threadCount, 包括调用线程
+    std::atomic<bool>                           mQuit = false;
+
+    // 非作业系统线程提交的作业, 以及这些线程共用的作业池, 池中作业的ownerThread为INVALID_THREAD_INDEX
+    std::mutex             mExternalMutex;
+    std::vector<Job*>      mExternalJobs;
+    std::unique_ptr<Job[]> mExternalJobPool;
+    Job*                   mExternalFreeJobs = nullptr;
+    ThreadCounters         mExternalCounters;
+    std::atomic<bool>      mHasExternalJobs = false;
+
+    // 空闲的工作线程在mWakeEpoch上休眠, 提交作业时递增并唤醒
+    std::atomic<uint32_t> mWakeEpoch     = 0;
+    std::atomic<uint32_t> mSleepingCount = 0;
+
+    static inline thread_local uint32_t sThreadIndex = INVALID_THREAD_INDEX;
+
+public:
+    JobSystem(const JobSystem&)            = delete;
+    JobSystem& operator=(const JobSystem&) = delete;
+
+    static JobSystem& Singleton() {
+        static JobSystem jobSystem;
+        return jobSystem;
+    }
+
+    ~JobSystem() {
+        Terminate();
+    }
+
+    // threadCount包含调用线程, 为0时使用硬件线程数, 但至少为2
+    void Initialize(uint32_t threadCount = 0);
+    void Terminate();
+
+    // 线程下标的上限, 包括预留给RegisterThread的下标, 按线程分配的资源应该使用该值
+    uint32_t GetThreadCount() const {
+        return static_cast<uint32_t>(mThreadContexts.size());
+    }
+
+    // Initialize启动的线程数, 包括调用线程
+    uint32_t GetWorkerCount() const {
+        return mWorkerCount;
+    }
+
+    // 让调用线程加入作业系统: 提交的作业使用自己的队列和作业池, Wait期间执行其他作业
+    // 没有空闲的线程下标时返回false, 之后按非作业系统线程处理; 线程退出和作业系统Terminate之前需要调用UnregisterThread
+    bool RegisterThread();
+    // 执行完自己队列中剩余的作业后归还线程下标
+    void UnregisterThread();
+
+    // 当前线程在作业系统中的下标, 不属于作业系统的线程返回INVALID_THREAD_INDEX
+    static uint32_t GetThreadIndex() {
+        return sThreadIndex;
+    }
+
+    bool IsInitialized() const {
+        return !mThreadContexts.empty();
+    }
+
+    // 提交一个作业, counter会在提交时加一, 执行完毕后减一
+    // dependency不为空时, 作业挂起在dependency上, 归零后才会提交; 挂起期间dependency不能再提交新的作业
+    template<typename F>
+    void Run(F&& function, JobCounter* counter = nullptr, const JobCounter* dependency = nullptr) {
+        using Function = std::decay_t<F>;
+        static_assert(sizeof(Function) <= Job::PAYLOAD_SIZE, "Job closure is too large, capture by reference or pointer");
+        static_assert(alignof(Function) <= alignof(std::max_align_t), "Job closure is over-aligned");
+
+        Job* job = AllocateJob();
+        new (job->payload) Function(std::forward<F>(function));
+        job->entry = [](Job& job) {
+            Function* function = std::launder(reinterpret_cast<Function*>(job.payload));
+            (*function)();
+            function->~Function();
+        };
+        job->counter = counter;
+
+        if (counter != nullptr) {
+            counter->mValue.fetch_add(1, std::memory_order_relaxed);
+        }
+        if (dependency == nullptr || !ParkJob(job, *dependency)) {
+            Submit(job);
+        }
+    }
+
+    // 将[0, count)按batchSize划分为多个作业并等待全部完成, function的签名为void(uint32_t begin, uint32_t end)
+    template<typename F>
+    void ParallelFor(uint32_t count, uint32_t batchSize, const F& function) {
+        JobCounter counter;
+        batchSize = std::max(batchSize, 1u);
+        for (uint32_t begin = 0; begin < count; begin += batchSize) {
+            uint32_t end = std::min(begin + batchSize, count);
+            Run([&function, begin, end] { function(begin, end); }, &counter);
+        }
+        Wait(counter);
+    }
+
+    // 等待计数器归零, 期间执行其他作业
+    void Wait(const JobCounter& counter);
+
+    JobSystemStats GetStats() const;
+
+private:
+    Job* AllocateJob();
+    void FreeJob(Job* job);
+    void Submit(Job* job);
+    void Execute(Job* job);
+    bool ParkJob(Job* job, const JobCounter& dependency);
+    void ReleaseCounter(JobCounter& counter);
+    Job* FindJob(uint32_t threadIndex);
+    bool TryExecuteOne();
+    void WorkerMain(uint32_t threadIndex);
+};
+} // namespace Nova
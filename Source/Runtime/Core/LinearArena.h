@@ -0,0 +1,270 @@
+#pragma once
+
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <memory_resource>
+#include <new>
+#include <span>
+#include <type_traits>
+#include <vector>
+
+#include "Core/MemoryTracker.h"
+
+namespace Nova {
+
+// 指针递增分配的线性arena, 只能整体重置或回退到之前的标记, 不能单独释放
+// 内存按块从堆上申请并计入MemoryTracker的类别, 块用尽时追加新块; Reset时若用到了多个块则合并为一个能容纳峰值的块,
+// 因此用量稳定之后Allocate和Reset都不再访问堆. 不是线程安全的, 多线程使用时每个线程一个arena
+class LinearArena {
+public:
+    static constexpr size_t DEFAULT_BLOCK_SIZE = 64 * 1024;
+
+    // 回退点, 回退后该标记之后的分配全部失效
+    struct Marker {
+        void*      block  = nullptr;
+        std::byte* cursor = nullptr;
+        size_t     used   = 0;
+    };
+
+private:
+    // 块头放在块的起始处, 之后是可分配的空间
+    struct alignas(std::max_align_t) Block {
+        Block* next = nullptr;
+        size_t size = 0; // 含块头
+
+        std::byte* Begin() {
+            return reinterpret_cast<std::byte*>(this + 1);
+        }
+
+        std::byte* End() {
+            return reinterpret_cast<std::byte*>(this) + size;
+        }
+    };
+
+    // 供std::pmr容器使用, 释放是空操作, 内存随arena的Reset或Rewind回收
+    class Resource final: public std::pmr::memory_resource {
+        LinearArena& mArena;
+
+    public:
+        explicit Resource(LinearArena& arena): mArena(arena) {}
+
+    private:
+        void* do_allocate(size_t bytes, size_t alignment) override {
+            return mArena.Allocate(bytes, alignment);
+        }
+
+        void do_deallocate(void*, size_t, size_t) override {}
+
+        bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override {
+            return this == &other;
+        }
+    };
+
+    size_t         mBlockSize;
+    MemoryCategory mCategory;
+
+    // mBlocks为正在使用的块, 最新的在前; mFreeBlocks为回退后空出的块
+    Block*     mBlocks     = nullptr;
+    Block*     mFreeBlocks = nullptr;
+    std::byte* mCursor     = nullptr;
+    std::byte* mEnd        = nullptr;
+
+    size_t   mUsed            = 0; // 当前使用的字节数, 含对齐填充
+    size_t   mPeakUsed        = 0;
+    size_t   mCapacity        = 0; // 所有块的字节数
+    uint64_t mHeapAllocations = 0; // 从堆上申请块的次数
+
+    Resource mResource { *this };
+
+public:
+    explicit LinearArena(size_t blockSize = DEFAULT_BLOCK_SIZE, MemoryCategory category = MemoryCategory::Core):
+        mBlockSize(std::max(blockSize, sizeof(Block) * 2)), mCategory(category) {}
+
+    LinearArena(const LinearArena&)            = delete;
+    LinearArena& operator=(const LinearArena&) = delete;
+
+    ~LinearArena() {
+        Release();
+    }
+
+    // alignment必须是2的幂
+    void* Allocate(size_t size, size_t alignment = alignof(std::max_align_t)) {
+        uintptr_t aligned = AlignUp(reinterpret_cast<uintptr_t>(mCursor), alignment);
+        if (mCursor == nullptr || aligned + size > reinterpret_cast<uintptr_t>(mEnd)) {
+            Grow(size + alignment);
+            aligned = AlignUp(reinterpret_cast<uintptr_t>(mCursor), alignment);
+        }
+        std::byte* cursor = reinterpret_cast<std::byte*>(aligned + size);
+        mUsed             += size_t(cursor - mCursor);
+        mPeakUsed          = std::max(mPeakUsed, mUsed);
+        mCursor            = cursor;
+        return reinterpret_cast<void*>(aligned);
+    }
+
+    // 不会调用析构函数, 只用于可平凡析构的类型
+    template<typename T, typename... Args>
+    T* New(Args&&... args) {
+        static_assert(std::is_trivially_destructible_v<T>, "T must be trivially destructible");
+        return new (Allocate(sizeof(T), alignof(T))) T(std::forward<Args>(args)...);
+    }
+
+    // 元素被值初始化
+    template<typename T>
+    std::span<T> NewArray(size_t count) {
+        static_assert(std::is_trivially_destructible_v<T>, "T must be trivially destructible");
+        T* data = static_cast<T*>(Allocate(sizeof(T) * count, alignof(T)));
+        std::uninitialized_value_construct_n(data, count);
+        return { data, count };
+    }
+
+    Marker GetMarker() const {
+        return { mBlocks, mCursor, mUsed };
+    }
+
+    // 标记之后追加的块留作之后的分配使用, 不归还给堆
+    void Rewind(const Marker& marker) {
+        while (mBlocks != marker.block) {
+            Block* block = mBlocks;
+            mBlocks      = block->next;
+            block->next  = mFreeBlocks;
+            mFreeBlocks  = block;
+        }
+        mCursor = marker.cursor;
+        mEnd    = mBlocks != nullptr ? mBlocks->End() : nullptr;
+        mUsed   = marker.used;
+    }
+
+    // 释放全部分配, 用到了多个块时合并为一个
+    void Reset() {
+        Rewind({});
+        if (mFreeBlocks != nullptr && mFreeBlocks->next != nullptr) {
+            // 按峰值向上取2的幂, 留出对齐填充的余量
+            size_t size = std::max(mBlockSize, std::bit_ceil(mPeakUsed + sizeof(Block)));
+            FreeBlocks(mFreeBlocks);
+            mCapacity = 0;
+            PushBlock(AllocateBlock(size));
+            return;
+        }
+        if (mFreeBlocks != nullptr) {
+            PushBlock(PopFreeBlock(&mFreeBlocks));
+        }
+    }
+
+    // 归还所有块
+    void Release() {
+        FreeBlocks(mBlocks);
+        FreeBlocks(mFreeBlocks);
+        mCursor   = nullptr;
+        mEnd      = nullptr;
+        mUsed     = 0;
+        mCapacity = 0;
+    }
+
+    // 供std::pmr::vector等容器使用, 容器扩容时旧的存储不会被回收, 应尽量预先reserve
+    std::pmr::memory_resource* GetMemoryResource() {
+        return &mResource;
+    }
+
+    size_t GetUsed() const {
+        return mUsed;
+    }
+
+    size_t GetPeakUsed() const {
+        return mPeakUsed;
+    }
+
+    size_t GetCapacity() const {
+        return mCapacity;
+    }
+
+    uint64_t GetHeapAllocationCount() const {
+        return mHeapAllocations;
+    }
+
+private:
+    static uintptr_t AlignUp(uintptr_t value, size_t alignment) {
+        return (value + alignment - 1) & ~uintptr_t(alignment - 1);
+    }
+
+    // 优先复用回退时空出的块
+    void Grow(size_t minSize) {
+        size_t required = minSize + sizeof(Block);
+        for (Block** link = &mFreeBlocks; *link != nullptr; link = &(*link)->next) {
+            if ((*link)->size >= required) {
+                PushBlock(PopFreeBlock(link));
+                return;
+            }
+        }
+        PushBlock(AllocateBlock(std::max(mBlockSize, required)));
+    }
+
+    Block* AllocateBlock(size_t size) {
+        mHeapAllocations++;
+        mCapacity += size;
+        return new (MemoryTracker::Allocate(mCategory, size, alignof(Block))) Block { .size = size };
+    }
+
+    static Block* PopFreeBlock(Block** link) {
+        Block* block = *link;
+        *link        = block->next;
+        return block;
+    }
+
+    void PushBlock(Block* block) {
+        block->next = mBlocks;
+        mBlocks     = block;
+        mCursor     = block->Begin();
+        mEnd        = block->End();
+    }
+
+    void FreeBlocks(Block*& blocks) {
+        while (blocks != nullptr) {
+            Block* next = blocks->next;
+            MemoryTracker::Free(mCategory, blocks, blocks->size, alignof(Block));
+            blocks = next;
+        }
+    }
+};
+
+// 每个飞行帧一个arena, 用于逐帧的CPU临时数据, 帧栅栏等待完成后重置该帧的arena
+// 数据可以一直使用到该飞行帧下一次开始, 例如在帧完成的回调中读取
+class FrameArena {
+private:
+    std::vector<std::unique_ptr<LinearArena>> mArenas;
+    uint32_t                                  mCurrentFrame = 0;
+
+public:
+    FrameArena() = default;
+
+    FrameArena(const FrameArena&)            = delete;
+    FrameArena& operator=(const FrameArena&) = delete;
+
+    void Initialize(uint32_t frameCount, MemoryCategory category = MemoryCategory::Render) {
+        mArenas.resize(0);
+        for (uint32_t i = 0; i < frameCount; i++) {
+            mArenas.push_back(std::make_unique<LinearArena>(LinearArena::DEFAULT_BLOCK_SIZE, category));
+        }
+        mCurrentFrame = 0;
+    }
+
+    void Terminate() {
+        mArenas.resize(0);
+    }
+
+    void BeginFrame(uint32_t frameIndex) {
+        mCurrentFrame = frameIndex;
+        mArenas[frameIndex]->Reset();
+    }
+
+    LinearArena& GetCurrent() {
+        return *mArenas[mCurrentFrame];
+    }
+
+    uint32_t GetFrameCount() const {
+        return static_cast<uint32_t>(mArenas.size());
+    }
+};
+} // namespace Nova
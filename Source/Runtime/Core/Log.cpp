@@ -0,0 +1,70 @@
+#include "Log.h"
+
+#include <spdlog/async.h>
+#include <spdlog/sinks/stdout_color_sinks.h>
+
+namespace Nova {
+
+static constexpr const char* CATEGORY_NAMES[] = {
+    "Core",
+    "RHI",
+    "Render",
+    "Window",
+    "Assets",
+};
+static_assert(std::size(CATEGORY_NAMES) == Log::CATEGORY_COUNT);
+
+Log::Log() {
+    // 单个后台线程按提交顺序输出, 各子系统的日志不会交错乱序
+    mThreadPool = std::make_shared<spdlog::details::thread_pool>(QUEUE_SIZE, 1);
+
+    auto sink = std::make_shared<spdlog::sinks::stdout_color_sink_mt>();
+    sink->set_pattern("[%H:%M:%S.%e] [%^%l%$] [ %n ] %v");
+
+    for (uint32_t i = 0; i < CATEGORY_COUNT; i++) {
+        // 队列满时丢弃最旧的消息而不是阻塞调用线程
+        mLoggers[i] = std::make_shared<spdlog::async_logger>(
+            CATEGORY_NAMES[i], sink, mThreadPool, spdlog::async_overflow_policy::overrun_oldest
+        );
+        mLoggers[i]->set_level(spdlog::level::trace);
+        mLoggers[i]->flush_on(spdlog::level::err);
+    }
+}
+
+void Log::SetLevel(LogCategory category, spdlog::level::level_enum level) {
+    Get(category)->set_level(level);
+}
+
+void Log::SetLevel(spdlog::level::level_enum level) {
+    for (auto& logger: GetInstance().mLoggers) {
+        logger->set_level(level);
+    }
+}
+
+void Log::Flush() {
+    for (auto& logger: GetInstance().mLoggers) {
+        logger->flush();
+    }
+}
+
+void Log::Shutdown() {
+    Log& instance = GetInstance();
+    if (instance.mThreadPool == nullptr) {
+        return;
+    }
+
+    // 换成使用同一组输出的同步日志器, 再销毁线程池; 线程池析构时会输出队列中剩余的消息
+    for (auto& logger: instance.mLoggers) {
+        auto syncLogger = std::make_shared<spdlog::logger>(logger->name(), logger->sinks().begin(), logger->sinks().end());
+        syncLogger->set_level(logger->level());
+        syncLogger->flush_on(spdlog::level::err);
+        logger->flush();
+        logger = std::move(syncLogger);
+    }
+    instance.mThreadPool.reset();
+}
+
+const char* Log::GetCategoryName(LogCategory category) {
+    return CATEGORY_NAMES[uint32_t(category)];
+}
+} // namespace Nova
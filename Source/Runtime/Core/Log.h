@@ -0,0 +1,107 @@
+#pragma once
+
+// 编译期日志等级, 低于该等级的日志调用连同参数的求值一起被剔除
+// 可以在构建配置中定义SPDLOG_ACTIVE_LEVEL覆盖默认值
+#ifndef SPDLOG_ACTIVE_LEVEL
+    #ifdef NOVA_DEBUG
+        #define SPDLOG_ACTIVE_LEVEL SPDLOG_LEVEL_TRACE
+    #else
+        #define SPDLOG_ACTIVE_LEVEL SPDLOG_LEVEL_INFO
+    #endif
+#endif
+
+#include <spdlog/spdlog.h>
+
+#include <array>
+#include <cstdint>
+#include <memory>
+
+namespace Nova {
+
+enum class LogCategory : uint32_t {
+    Core,
+    RHI,
+    Render,
+    Window,
+    Assets,
+    Count,
+};
+
+// 按子系统划分的日志
+// 所有日志器共享一个后台线程和固定容量的环形队列, 队列满时覆盖最旧的消息, 渲染线程和工作线程不会因为输出而阻塞
+// 第一次使用时自动创建, 实例不会被销毁, 静态对象析构期间仍然可以记录日志
+class Log {
+public:
+    static constexpr size_t   QUEUE_SIZE     = 8192;
+    static constexpr uint32_t CATEGORY_COUNT = uint32_t(LogCategory::Count);
+
+private:
+    std::array<std::shared_ptr<spdlog::logger>, CATEGORY_COUNT> mLoggers;
+    std::shared_ptr<spdlog::details::thread_pool>               mThreadPool;
+
+    Log();
+
+    static Log& GetInstance() {
+        static Log* instance = new Log();
+        return *instance;
+    }
+
+public:
+    Log(const Log&)            = delete;
+    Log& operator=(const Log&) = delete;
+
+    static spdlog::logger* Get(LogCategory category) {
+        return GetInstance().mLoggers[uint32_t(category)].get();
+    }
+
+    // 运行期等级, 只能在编译期等级之上进一步过滤
+    static void SetLevel(LogCategory category, spdlog::level::level_enum level);
+    static void SetLevel(spdlog::level::level_enum level);
+
+    static void Flush();
+
+    // 输出队列中剩余的消息并停止后台线程, 之后的日志同步输出
+    // 调用时其他线程不能再记录日志, 通常在JobSystem终止之后调用
+    static void Shutdown();
+
+    static const char* GetCategoryName(LogCategory category);
+};
+} // namespace Nova
+
+#define NOVA_LOG(category, level, ...) SPDLOG_LOGGER_CALL(::Nova::Log::Get(::Nova::LogCategory::category), level, __VA_ARGS__)
+
+#if SPDLOG_ACTIVE_LEVEL <= SPDLOG_LEVEL_TRACE
+    #define NOVA_LOG_TRACE(category, ...) NOVA_LOG(category, spdlog::level::trace, __VA_ARGS__)
+#else
+    #define NOVA_LOG_TRACE(category, ...) (void)0
+#endif
+
+#if SPDLOG_ACTIVE_LEVEL <= SPDLOG_LEVEL_DEBUG
+    #define NOVA_LOG_DEBUG(category, ...) NOVA_LOG(category, spdlog::level::debug, __VA_ARGS__)
+#else
+    #define NOVA_LOG_DEBUG(category, ...) (void)0
+#endif
+
+#if SPDLOG_ACTIVE_LEVEL <= SPDLOG_LEVEL_INFO
+    #define NOVA_LOG_INFO(category, ...) NOVA_LOG(category, spdlog::level::info, __VA_ARGS__)
+#else
+    #define NOVA_LOG_INFO(category, ...) (void)0
+#endif
+
+#if SPDLOG_ACTIVE_LEVEL <= SPDLOG_LEVEL_WARN
+    #define NOVA_LOG_WARN(category, ...) NOVA_LOG(category, spdlog::level::warn, __VA_ARGS__)
+#else
+    #define NOVA_LOG_WARN(category, ...) (void)0
+#endif
+
+#if SPDLOG_ACTIVE_LEVEL <= SPDLOG_LEVEL_ERROR
+    #define NOVA_LOG_ERROR(category, ...) NOVA_LOG(category, spdlog::level::err, __VA_ARGS__)
+#else
+    #define NOVA_LOG_ERROR(category, ...) (void)0
+#endif
+
+#if SPDLOG_ACTIVE_LEVEL <= SPDLOG_LEVEL_CRITICAL
+    #define NOVA_LOG_CRITICAL(category, ...) NOVA_LOG(category, spdlog::level::critical, __VA_ARGS__)
+#else
+    #define NOVA_LOG_CRITICAL(category, ...) (void)0
+#endif
@@ -0,0 +1,91 @@
+#include "MappedFile.h"
+#include "Log.h"
+
+#if defined(_WIN32)
+    #ifndef NOMINMAX
+        #define NOMINMAX
+    #endif
+    #ifndef WIN32_LEAN_AND_MEAN
+        #define WIN32_LEAN_AND_MEAN
+    #endif
+    #include <windows.h>
+#else
+    #include <cerrno>
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+#endif
+
+namespace Nova {
+
+bool MappedFile::Open(const std::filesystem::path& path) {
+    Close();
+
+#if defined(_WIN32)
+    HANDLE file = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if (file == INVALID_HANDLE_VALUE) {
+        NOVA_LOG_ERROR(Core, "Failed to open {}: {}", path.string(), GetLastError());
+        return false;
+    }
+    LARGE_INTEGER fileSize = {};
+    if (!GetFileSizeEx(file, &fileSize) || fileSize.QuadPart == 0) {
+        CloseHandle(file);
+        return false;
+    }
+    HANDLE mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    void*  data    = mapping != nullptr ? MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0) : nullptr;
+    if (data == nullptr) {
+        NOVA_LOG_ERROR(Core, "Failed to map {}: {}", path.string(), GetLastError());
+        if (mapping != nullptr) {
+            CloseHandle(mapping);
+        }
+        CloseHandle(file);
+        return false;
+    }
+    mFile    = file;
+    mMapping = mapping;
+    mData    = static_cast<const std::byte*>(data);
+    mSize    = static_cast<size_t>(fileSize.QuadPart);
+#else
+    int file = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (file < 0) {
+        NOVA_LOG_ERROR(Core, "Failed to open {}: {}", path.string(), errno);
+        return false;
+    }
+    struct stat fileStat = {};
+    if (fstat(file, &fileStat) != 0 || fileStat.st_size == 0) {
+        close(file);
+        return false;
+    }
+    // 映射建立之后即可关闭文件描述符
+    void* data = mmap(nullptr, static_cast<size_t>(fileStat.st_size), PROT_READ, MAP_PRIVATE, file, 0);
+    close(file);
+    if (data == MAP_FAILED) {
+        NOVA_LOG_ERROR(Core, "Failed to map {}: {}", path.string(), errno);
+        return false;
+    }
+    mData = static_cast<const std::byte*>(data);
+    mSize = static_cast<size_t>(fileStat.st_size);
+#endif
+    return true;
+}
+
+void MappedFile::Close() {
+    if (mData == nullptr) {
+        return;
+    }
+
+#if defined(_WIN32)
+    UnmapViewOfFile(mData);
+    CloseHandle(mMapping);
+    CloseHandle(mFile);
+#else
+    munmap(const_cast<std::byte*>(mData), mSize);
+#endif
+    mData    = nullptr;
+    mSize    = 0;
+    mFile    = nullptr;
+    mMapping = nullptr;
+}
+} // namespace Nova
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <span>
+#include <utility>
+
+namespace Nova {
+
+// 只读的内存映射文件, 页面在首次访问时由操作系统按需读入, 不经过堆分配和额外的拷贝
+// 映射在Close或析构之前保持有效, 不能复制, 可以移动
+class MappedFile {
+private:
+    const std::byte* mData = nullptr;
+    size_t           mSize = 0;
+
+    // Windows上为文件和映射对象的句柄
+    void* mFile    = nullptr;
+    void* mMapping = nullptr;
+
+public:
+    MappedFile() = default;
+
+    MappedFile(const MappedFile&)            = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    MappedFile(MappedFile&& other) noexcept {
+        *this = std::move(other);
+    }
+
+    MappedFile& operator=(MappedFile&& other) noexcept {
+        if (this != &other) {
+            Close();
+            mData    = std::exchange(other.mData, nullptr);
+            mSize    = std::exchange(other.mSize, 0);
+            mFile    = std::exchange(other.mFile, nullptr);
+            mMapping = std::exchange(other.mMapping, nullptr);
+        }
+        return *this;
+    }
+
+    ~MappedFile() {
+        Close();
+    }
+
+    // 失败或文件为空时返回false
+    bool Open(const std::filesystem::path& path);
+    void Close();
+
+    bool IsOpen() const {
+        return mData != nullptr;
+    }
+
+    std::span<const std::byte> GetData() const {
+        return { mData, mSize };
+    }
+
+    size_t GetSize() const {
+        return mSize;
+    }
+};
+} // namespace Nova
@@ -0,0 +1,127 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory_resource>
+#include <new>
+
+namespace Nova {
+
+enum class MemoryCategory : uint32_t {
+    Core,
+    RHI,
+    Render,
+    Window,
+    Assets,
+    Driver, // Vulkan驱动通过VkAllocationCallbacks申请的主机内存
+    Count,
+};
+
+struct MemoryCategoryStats {
+    uint64_t currentBytes     = 0;
+    uint64_t peakBytes        = 0;
+    uint64_t liveAllocations  = 0;
+    uint64_t totalAllocations = 0; // 累计分配次数, 用于观察分配频率
+};
+
+// 按类别统计CPU内存, 只统计经过这里分配的内存(arena的块、带类别的pmr容器、驱动分配), 不替换全局operator new
+// 计数全部是relaxed原子操作, 可以在任意线程调用
+class MemoryTracker {
+public:
+    static constexpr uint32_t CATEGORY_COUNT = uint32_t(MemoryCategory::Count);
+
+private:
+    struct alignas(64) Counters {
+        std::atomic<uint64_t> currentBytes     = 0;
+        std::atomic<uint64_t> peakBytes        = 0;
+        std::atomic<uint64_t> liveAllocations  = 0;
+        std::atomic<uint64_t> totalAllocations = 0;
+    };
+
+    // 把分配转发给new_delete_resource并计入类别, 供std::pmr容器使用
+    class Resource final: public std::pmr::memory_resource {
+        MemoryCategory mCategory = MemoryCategory::Core;
+
+    public:
+        constexpr Resource() = default;
+
+        explicit constexpr Resource(MemoryCategory category): mCategory(category) {}
+
+    private:
+        void* do_allocate(size_t bytes, size_t alignment) override {
+            return MemoryTracker::Allocate(mCategory, bytes, alignment);
+        }
+
+        void do_deallocate(void* pointer, size_t bytes, size_t alignment) override {
+            MemoryTracker::Free(mCategory, pointer, bytes, alignment);
+        }
+
+        bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override {
+            return this == &other;
+        }
+    };
+
+    // 在类外定义, 嵌套类的默认成员初始化在外层类定义结束之后才可用
+    static std::array<Counters, CATEGORY_COUNT> counters;
+
+public:
+    static void OnAllocate(MemoryCategory category, size_t bytes) {
+        Counters& counter = counters[uint32_t(category)];
+        uint64_t  current = counter.currentBytes.fetch_add(bytes, std::memory_order_relaxed) + bytes;
+        counter.liveAllocations.fetch_add(1, std::memory_order_relaxed);
+        counter.totalAllocations.fetch_add(1, std::memory_order_relaxed);
+
+        uint64_t peak = counter.peakBytes.load(std::memory_order_relaxed);
+        while (current > peak && !counter.peakBytes.compare_exchange_weak(peak, current, std::memory_order_relaxed)) {
+        }
+    }
+
+    static void OnFree(MemoryCategory category, size_t bytes) {
+        Counters& counter = counters[uint32_t(category)];
+        counter.currentBytes.fetch_sub(bytes, std::memory_order_relaxed);
+        counter.liveAllocations.fetch_sub(1, std::memory_order_relaxed);
+    }
+
+    // 释放时必须传入相同的类别、大小和对齐
+    static void* Allocate(MemoryCategory category, size_t bytes, size_t alignment = __STDCPP_DEFAULT_NEW_ALIGNMENT__) {
+        void* pointer = ::operator new(bytes, std::align_val_t(alignment));
+        OnAllocate(category, bytes);
+        return pointer;
+    }
+
+    static void Free(MemoryCategory category, void* pointer, size_t bytes, size_t alignment = __STDCPP_DEFAULT_NEW_ALIGNMENT__) {
+        if (pointer == nullptr) {
+            return;
+        }
+        ::operator delete(pointer, bytes, std::align_val_t(alignment));
+        OnFree(category, bytes);
+    }
+
+    static std::pmr::memory_resource* GetMemoryResource(MemoryCategory category) {
+        static Resource resources[CATEGORY_COUNT] = {
+            Resource(MemoryCategory::Core),   Resource(MemoryCategory::RHI),    Resource(MemoryCategory::Render),
+            Resource(MemoryCategory::Window), Resource(MemoryCategory::Assets), Resource(MemoryCategory::Driver),
+        };
+        return &resources[uint32_t(category)];
+    }
+
+    static MemoryCategoryStats GetStats(MemoryCategory category) {
+        const Counters& counter = counters[uint32_t(category)];
+        return {
+            .currentBytes     = counter.currentBytes.load(std::memory_order_relaxed),
+            .peakBytes        = counter.peakBytes.load(std::memory_order_relaxed),
+            .liveAllocations  = counter.liveAllocations.load(std::memory_order_relaxed),
+            .totalAllocations = counter.totalAllocations.load(std::memory_order_relaxed),
+        };
+    }
+
+    static const char* GetCategoryName(MemoryCategory category) {
+        static constexpr const char* NAMES[CATEGORY_COUNT] = { "Core", "RHI", "Render", "Window", "Assets", "Driver" };
+        return NAMES[uint32_t(category)];
+    }
+};
+
+inline std::array<MemoryTracker::Counters, MemoryTracker::CATEGORY_COUNT> MemoryTracker::counters;
+} // namespace Nova
@@ -0,0 +1,46 @@
+#pragma once
+
+#include "Core/LinearArena.h"
+
+namespace Nova {
+
+// 每个线程一个的临时分配栈, 工作线程和渲染线程各自使用, 互不加锁
+// 通过ScratchScope按作用域分配和回收, 作用域可以嵌套; 最外层作用域结束时重置arena, 用量稳定后不再访问堆
+class ScratchScope {
+public:
+    static constexpr size_t BLOCK_SIZE = 256 * 1024;
+
+private:
+    LinearArena&        mArena;
+    LinearArena::Marker mMarker;
+
+public:
+    ScratchScope(): mArena(GetThreadArena()), mMarker(mArena.GetMarker()) {}
+
+    ScratchScope(const ScratchScope&)            = delete;
+    ScratchScope& operator=(const ScratchScope&) = delete;
+
+    ~ScratchScope() {
+        if (mMarker.used == 0) {
+            mArena.Reset();
+        } else {
+            mArena.Rewind(mMarker);
+        }
+    }
+
+    LinearArena& GetArena() {
+        return mArena;
+    }
+
+    // 在该作用域中创建的std::pmr容器不能逃出作用域
+    std::pmr::memory_resource* GetMemoryResource() {
+        return mArena.GetMemoryResource();
+    }
+
+    // 线程退出时释放
+    static LinearArena& GetThreadArena() {
+        thread_local LinearArena arena(BLOCK_SIZE);
+        return arena;
+    }
+};
+} // namespace Nova
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+namespace Nova {
+
+// 固定容量的无锁单生产者单消费者环形队列
+// 只有生产者线程调用Push, 只有消费者线程调用Pop; 两端各自缓存对方的索引, 只在缓存看起来已满(空)时才读取对方的原子变量
+template<typename T, size_t CAPACITY>
+class SpscQueue {
+    static constexpr size_t MASK = CAPACITY - 1;
+    static_assert(CAPACITY > 0 && (CAPACITY & MASK) == 0, "CAPACITY must be a power of two");
+    static_assert(std::is_trivially_copyable_v<T>, "T must be trivially copyable");
+
+    // 消费者拥有mHead, 生产者拥有mTail, 索引单调递增, 取模后定位元素
+    alignas(64) std::atomic<size_t> mHead = 0;
+    alignas(64) size_t mCachedTail        = 0; // 消费者持有
+    alignas(64) std::atomic<size_t> mTail = 0;
+    alignas(64) size_t mCachedHead        = 0; // 生产者持有
+    alignas(64) T mBuffer[CAPACITY];
+
+public:
+    SpscQueue() = default;
+
+    SpscQueue(const SpscQueue&)            = delete;
+    SpscQueue& operator=(const SpscQueue&) = delete;
+
+    // 队列已满时返回false, 由调用者决定丢弃还是重试
+    bool Push(const T& value) {
+        size_t tail = mTail.load(std::memory_order_relaxed);
+        if (tail - mCachedHead >= CAPACITY) {
+            // 与Pop中对mHead的release配对, 确保消费者已经读完该元素
+            mCachedHead = mHead.load(std::memory_order_acquire);
+            if (tail - mCachedHead >= CAPACITY) {
+                return false;
+            }
+        }
+        mBuffer[tail & MASK] = value;
+        // 与Pop中对mTail的acquire配对, 发布元素内容
+        mTail.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    bool Pop(T& value) {
+        size_t head = mHead.load(std::memory_order_relaxed);
+        if (head == mCachedTail) {
+            mCachedTail = mTail.load(std::memory_order_acquire);
+            if (head == mCachedTail) {
+                return false;
+            }
+        }
+        value = mBuffer[head & MASK];
+        mHead.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    // 其他线程调用时只是近似值
+    size_t GetSize() const {
+        size_t tail = mTail.load(std::memory_order_relaxed);
+        size_t head = mHead.load(std::memory_order_relaxed);
+        return tail > head ? tail - head : 0;
+    }
+};
+} // namespace Nova
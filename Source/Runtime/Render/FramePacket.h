@@ -0,0 +1,21 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+
+namespace Nova {
+
+// 模拟线程交给渲染线程的一帧数据, 渲染线程只读取帧包而不访问模拟状态
+// 帧包在双缓冲中复用, 模拟线程每帧需要写入全部字段
+struct FramePacket {
+    uint64_t frameNumber = 0; // 模拟帧编号
+    double   time        = 0.0; // 模拟时间, 单位秒
+    double   deltaTime   = 0.0;
+
+    // 模拟线程看到的帧缓冲尺寸, 为0时窗口已最小化, 渲染线程不提交帧
+    uint32_t width  = 0;
+    uint32_t height = 0;
+
+    std::array<float, 4> clearColor = { 0.0f, 0.0f, 0.0f, 1.0f };
+};
+} // namespace Nova
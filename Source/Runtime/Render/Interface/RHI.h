@@ -10,15 +10,24 @@
 namespace Nova {
 class WindowSystem;
 struct RHIInitInfo {
+    // 为空时以无头模式初始化
     std::shared_ptr<WindowSystem> windowSystem;
+
+    // 无头模式下离屏图像的尺寸; headlessSurface为true时通过VK_EXT_headless_surface创建真正的交换链
+    VkExtent2D offscreenExtent = { 1280, 720 };
+    bool       headlessSurface = false;
+
+    // 为false且没有指定呈现模式时使用MAILBOX
+    bool limitFrameRate = true;
 };
 class RHI {
 public:
     virtual ~RHI() {}
-    virtual void Initialize(RHIInitInfo initInfo) = 0;
+    virtual bool Initialize(RHIInitInfo initInfo) = 0;
 
-    virtual void PrepareContext() = 0;
+    // 创建飞行帧等逐帧使用的资源, 飞行帧数等设置需要在此之前完成
+    virtual bool PrepareContext() = 0;
 
     // create
 };
-} // namespace Nova
\ No newline at end of file
+} // namespace Nova
@@ -2,138 +2,82 @@
 
 #include "VulkanHelper.hpp"
 #include "VulkanRHI.h"
+#include "VulkanRenderThread.h"
 
 #define GLFW_INCLUDE_VULKAN
 #include <GLFW/glfw3.h>
 
-inline GLFWwindow* kWindow;
-
-inline GLFWmonitor* kMonitor;
-
-inline bool InitializeWindow(const VkExtent2D size, const bool fullScreen = false, const bool isResizable = true, bool limitFrameRate = true) {
+// 创建窗口并以其初始化默认RHI, 失败时返回nullptr
+inline std::shared_ptr<Nova::WindowSystem>
+    InitializeWindow(const VkExtent2D size, const bool fullScreen = false, const bool isResizable = true, bool limitFrameRate = true) {
     auto& rhi = Nova::VulkanRHI::Singleton();
 
-    if (glfwInit() == 0) {
-        std::cout << std::format("[ InitializeWindow ] ERROR\nFailed to initialize GLFW!\n");
-        return false;
+    auto window = std::make_shared<Nova::WindowSystem>();
+    if (!window->Initialize(size, fullScreen, isResizable)) {
+        return nullptr;
     }
 
-    // 设置窗口属性
-    glfwWindowHint(GLFW_CLIENT_API, GLFW_NO_API);
-    glfwWindowHint(GLFW_RESIZABLE, static_cast<int>(isResizable));
-
-    // 获取显示器
-    kMonitor = glfwGetPrimaryMonitor();
-
-    // 获取视频模式
-    const GLFWvidmode* pMode = glfwGetVideoMode(kMonitor);
-
-    // 根据模式创建窗口
-    kWindow = fullScreen
-                  ? glfwCreateWindow(pMode->width, pMode->height, Nova::DEFAULT_WINDOW_TITLE, kMonitor, nullptr)
-                  : glfwCreateWindow(static_cast<int>(size.width), static_cast<int>(size.height), Nova::DEFAULT_WINDOW_TITLE, nullptr, nullptr);
-    if (kWindow == nullptr) {
-        std::cout << std::format("[ InitializeWindow ] ERROR\nFailed to create GLFW window!\n");
-        glfwTerminate();
-        return false;
+    // 创建实例、设备和交换链, 再创建飞行帧资源, 帧数可以在此之前通过SetFramesInFlight设置
+    // 失败时先销毁交换链持有的表面, 再随window销毁窗口
+    if (!rhi.Initialize({ .windowSystem = window, .limitFrameRate = limitFrameRate }) || !rhi.PrepareContext()) {
+        rhi.Terminal();
+        return nullptr;
     }
 
-    // 添加实例扩展
-    rhi.AddInstanceExtensionName(VK_KHR_SURFACE_EXTENSION_NAME);
-    rhi.AddInstanceExtensionName(VK_KHR_WIN32_SURFACE_EXTENSION_NAME);
-
-    // 添加交换链扩展
-    rhi.AddDeviceExtension(VK_KHR_SWAPCHAIN_EXTENSION_NAME);
-    //
-    // 使用最新的Vulkan API版本
-    rhi.UseLatestApiVersion();
-
-    // 创建Vulkan实例
-    if (rhi.CreateInstance() != VK_SUCCESS) {
-        std::cout << std::format("[ InitializeWindow ] ERROR\nFailed to create Vulkan instance!\n");
-        return false;
-    }
-
-    // 获取GLFW所需的实例扩展
-    uint32_t     extensionCount = 0;
-    const char** extensionNames = glfwGetRequiredInstanceExtensions(&extensionCount);
-    if (extensionNames == nullptr) {
-        std::cout << std::format("[ InitializeWindow ] ERROR\nFailed to get GLFW required extensions!\n");
-        glfwTerminate();
-        return false;
-    }
-    // 添加GLFW所需的实例扩展
-    for (size_t i = 0; i < extensionCount; i++) {
-        rhi.AddInstanceExtensionName(extensionNames[i]);
-    }
-
-    //window surface
-    VkSurfaceKHR surface = VK_NULL_HANDLE;
-
-    VkResult result = glfwCreateWindowSurface(rhi.GetInstance(), kWindow, nullptr, &surface);
-    if (result != VK_SUCCESS) {
-        std::cout << std::format("[ InitializeWindow ] ERROR\nFailed to create GLFW surface!\n");
-        glfwTerminate();
-        return false;
-    }
+    return window;
+}
 
-    // 设置窗口表面
-    rhi.SetSurface(surface);
+inline void TerminateWindow(std::shared_ptr<Nova::WindowSystem>& window) {
+    // 终止窗口前应该确保交换链已经销毁, 没有和窗口系统的呈现引擎进行交互
+    Nova::VulkanRHI::Singleton().Terminal();
+    window.reset();
+}
 
-    if (rhi.GetPhysicalDevice() != VK_SUCCESS) {
-        return false;
-    }
+// 只能在主线程调用, 帧率由渲染线程已提交的帧数计算, 不受事件处理频率影响
+inline void UpdateWindowTitleWithFps(Nova::WindowSystem& window, const Nova::VulkanRenderThread& renderThread) {
+    static double            lastTime       = glfwGetTime();
+    static uint64_t          lastFrameCount = 0;
+    static std::stringstream ss;
 
-    if (rhi.DeterminePhysicalDevice(0, true, false) != VK_SUCCESS) {
-        return false;
+    double currentTime = glfwGetTime();
+    double timeDiff    = currentTime - lastTime;
+    if (timeDiff < 0.1) {
+        return;
     }
 
-    if (rhi.CreateDevice() != VK_SUCCESS) {
-        return false;
+    Nova::RenderThreadStats stats = renderThread.GetStats();
+    ss.precision(1);
+    ss << Nova::DEFAULT_WINDOW_TITLE << "     " << std::fixed << double(stats.frameCount - lastFrameCount) / timeDiff << " FPS";
+    // GPU耗时来自时间戳查询, 滞后几帧
+    if (stats.gpuTimingEnabled) {
+        ss.precision(2);
+        ss << "     GPU " << stats.gpuMs << " ms";
     }
-
-    // 创建交换链
-    result = rhi.TryCreateSwapchain(limitFrameRate);
-    if (result != VK_SUCCESS) {
-        std::cout << std::format("[ InitializeWindow ] ERROR\nFailed to create swapchain: ") << result << '\n';
-        return false;
+    // 呈现间隔的平均值和抖动, 用于检查帧节奏
+    if (stats.presentStats.sampleCount > 0) {
+        ss.precision(2);
+        ss << "     Present " << stats.presentStats.averageIntervalMs << " +- " << stats.presentStats.jitterMs << " ms";
     }
-
-    return true;
+    window.SetTitle(ss.str().c_str()); // 更新窗口标题
+    ss.str("");
+    lastTime       = currentTime;
+    lastFrameCount = stats.frameCount;
 }
 
-inline void TerminateWindow() {
-    // 终止窗口前应该确保vulkan device已经空闲, 没有和窗口系统的呈现引擎进行交互
-    Nova::VulkanRHI::Singleton().WaitIdleDevice();
-    glfwTerminate();
-}
-
-inline void UpdateWindowTitleWithFps() {
-    static double            currentTime = 0.0; // 当前时间
-    static double            lastTime    = glfwGetTime();
-    static double            timeDiff;
-    static int               frameCount = -1;
-    static std::stringstream ss;
-
-    currentTime = glfwGetTime(); // 获取当前时间
-    frameCount++;
-
-    if ((timeDiff = currentTime - lastTime) >= 0.1) {
-        ss.precision(1);
-        ss << Nova::DEFAULT_WINDOW_TITLE << "     " << std::fixed << frameCount / timeDiff << " FPS";
-        glfwSetWindowTitle(kWindow, ss.str().c_str()); // 更新窗口标题
-        ss.str("");
-        lastTime   = currentTime; // 更新上一帧时间
-        frameCount = 0; // 重置帧计数器
+// 窗口线程(主线程)的循环, 只处理窗口事件并刷新标题, 输入事件经由窗口的输入队列交给模拟线程
+// 拖动窗口等事件会阻塞这里, 但不会阻塞模拟和渲染; 等待事件时设置超时, 以便没有事件时也能定期刷新标题
+inline void PumpWindowEvents(Nova::WindowSystem& window, const Nova::VulkanRenderThread& renderThread) {
+    constexpr double TITLE_UPDATE_INTERVAL = 0.1;
+    while (!window.ShouldClose()) {
+        glfwWaitEventsTimeout(TITLE_UPDATE_INTERVAL);
+        UpdateWindowTitleWithFps(window, renderThread);
     }
 }
 
-inline void MakeWindowFullScreen() {
-    const GLFWvidmode* mode = glfwGetVideoMode(kMonitor);
-    glfwSetWindowMonitor(kWindow, kMonitor, 0, 0, mode->width, mode->height, mode->refreshRate);
+inline void MakeWindowFullScreen(Nova::WindowSystem& window) {
+    window.MakeFullScreen();
 }
 
-inline void RestoreWindow(const VkOffset2D position, const VkExtent2D size) {
-    const GLFWvidmode* mode = glfwGetVideoMode(kMonitor);
-    glfwSetWindowMonitor(kWindow, kMonitor, position.x, position.y, static_cast<int>(size.width), static_cast<int>(size.height), mode->refreshRate);
-}
\ No newline at end of file
+inline void RestoreWindow(Nova::WindowSystem& window, const VkOffset2D position, const VkExtent2D size) {
+    window.Restore(position, size);
+}
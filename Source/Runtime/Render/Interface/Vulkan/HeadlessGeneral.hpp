@@ -0,0 +1,22 @@
+#pragma once
+
+#include "VulkanHelper.hpp"
+#include "VulkanRHI.h"
+
+// 无窗口初始化, 用于服务器上的离线渲染和在软件实现(如lavapipe)上运行的性能回归测试
+// useHeadlessSurface为false时不创建任何表面, 渲染到离屏图像; 为true时通过VK_EXT_headless_surface创建真正的交换链
+inline bool InitializeHeadless(const VkExtent2D size, bool useHeadlessSurface = false) {
+    auto& rhi = Nova::VulkanRHI::Singleton();
+
+    // 创建实例、设备和交换链(或离屏图像)
+    if (!rhi.Initialize({ .offscreenExtent = size, .headlessSurface = useHeadlessSurface })) {
+        return false;
+    }
+
+    // 创建飞行帧资源, 帧数可以在此之前通过SetFramesInFlight设置
+    return rhi.PrepareContext();
+}
+
+inline void TerminateHeadless() {
+    Nova::VulkanRHI::Singleton().Terminal();
+}
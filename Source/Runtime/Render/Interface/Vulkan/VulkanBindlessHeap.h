@@ -0,0 +1,363 @@
+#pragma once
+#include "VulkanHostMemory.h"
+#include "VulkanResult.h"
+
+#include <array>
+#include <mutex>
+
+namespace Nova {
+
+// 每种资源类型一个描述符集, 集号与枚举值相同
+enum class VulkanBindlessType : uint32_t {
+    SampledImage  = 0,
+    Sampler       = 1,
+    StorageImage  = 2,
+    StorageBuffer = 3,
+    Count,
+};
+
+struct VulkanBindlessStats {
+    uint32_t capacity[uint32_t(VulkanBindlessType::Count)]  = {};
+    uint32_t allocated[uint32_t(VulkanBindlessType::Count)] = {};
+    uint32_t pendingFree                                    = 0;
+};
+
+// 无绑定描述符堆
+// 每种资源类型一个update-after-bind的大描述符集, 资源创建时从空闲列表分配索引, 着色器通过整数索引访问:
+//   layout(set = 0, binding = 0) uniform texture2D gTextures[];
+//   layout(set = 1, binding = 0) uniform sampler   gSamplers[];
+//   layout(set = 2, binding = 0, rgba8) uniform image2D gImages[];
+//   layout(set = 3, binding = 0) buffer Buffers { uint data[]; } gBuffers[];
+// 索引通过推送常量或缓冲传入, 索引值不一致时需要nonuniformEXT修饰
+// 所有管线共用GetPipelineLayout, 每个命令缓冲只需要绑定一次
+class VulkanBindlessHeap {
+public:
+    static constexpr uint32_t INVALID_INDEX = UINT32_MAX;
+
+    // 推送常量的最小保证大小
+    static constexpr uint32_t PUSH_CONSTANT_SIZE = 128;
+
+    static constexpr uint32_t DEFAULT_SAMPLED_IMAGE_CAPACITY  = 65536;
+    static constexpr uint32_t DEFAULT_SAMPLER_CAPACITY        = 1024;
+    static constexpr uint32_t DEFAULT_STORAGE_IMAGE_CAPACITY  = 8192;
+    static constexpr uint32_t DEFAULT_STORAGE_BUFFER_CAPACITY = 65536;
+
+private:
+    static constexpr uint32_t TYPE_COUNT = uint32_t(VulkanBindlessType::Count);
+
+    static constexpr VkDescriptorType DESCRIPTOR_TYPES[TYPE_COUNT] = {
+        VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE,
+        VK_DESCRIPTOR_TYPE_SAMPLER,
+        VK_DESCRIPTOR_TYPE_STORAGE_IMAGE,
+        VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+    };
+
+    struct Table {
+        VkDescriptorSetLayout setLayout = VK_NULL_HANDLE;
+        VkDescriptorSet       set       = VK_NULL_HANDLE;
+        uint32_t              capacity  = 0;
+        uint32_t              next      = 0; // 从未分配过的第一个索引
+        std::vector<uint32_t> freeList;
+    };
+
+    // 释放的索引可能仍被飞行中的帧引用, 等这些帧完成后才回到空闲列表
+    struct PendingFree {
+        VulkanBindlessType type;
+        uint32_t           index;
+        uint64_t           frameNumber;
+    };
+
+    VkDevice         mDevice         = VK_NULL_HANDLE;
+    VkDescriptorPool mDescriptorPool = VK_NULL_HANDLE;
+    VkPipelineLayout mPipelineLayout = VK_NULL_HANDLE;
+
+    std::array<Table, TYPE_COUNT> mTables;
+    std::vector<PendingFree>      mPendingFrees;
+    uint64_t                      mFrameNumber    = 0;
+    uint32_t                      mFramesInFlight = 1;
+
+    std::mutex mMutex;
+
+public:
+    VulkanBindlessHeap() = default;
+
+    VulkanBindlessHeap(const VulkanBindlessHeap&)            = delete;
+    VulkanBindlessHeap& operator=(const VulkanBindlessHeap&) = delete;
+
+    ~VulkanBindlessHeap() {
+        Terminate();
+    }
+
+    bool IsInitialized() const {
+        return mDescriptorPool != VK_NULL_HANDLE;
+    }
+
+    // 所有管线使用的布局: 集0~3依次为采样图像、采样器、存储图像、存储缓冲, 推送常量对所有阶段可见
+    VkPipelineLayout GetPipelineLayout() const {
+        return mPipelineLayout;
+    }
+
+    VkDescriptorSetLayout GetDescriptorSetLayout(VulkanBindlessType type) const {
+        return mTables[uint32_t(type)].setLayout;
+    }
+
+    VkDescriptorSet GetDescriptorSet(VulkanBindlessType type) const {
+        return mTables[uint32_t(type)].set;
+    }
+
+    // 容量按设备的update-after-bind上限截断, 需要设备启用描述符索引相关特性
+    VulkanResult Initialize(VkDevice device, const VkPhysicalDeviceVulkan12Properties& properties) {
+        mDevice = device;
+
+        uint32_t capacities[TYPE_COUNT] = {
+            std::min({ DEFAULT_SAMPLED_IMAGE_CAPACITY,
+                       properties.maxPerStageDescriptorUpdateAfterBindSampledImages,
+                       properties.maxDescriptorSetUpdateAfterBindSampledImages }),
+            std::min({ DEFAULT_SAMPLER_CAPACITY,
+                       properties.maxPerStageDescriptorUpdateAfterBindSamplers,
+                       properties.maxDescriptorSetUpdateAfterBindSamplers }),
+            std::min({ DEFAULT_STORAGE_IMAGE_CAPACITY,
+                       properties.maxPerStageDescriptorUpdateAfterBindStorageImages,
+                       properties.maxDescriptorSetUpdateAfterBindStorageImages }),
+            std::min({ DEFAULT_STORAGE_BUFFER_CAPACITY,
+                       properties.maxPerStageDescriptorUpdateAfterBindStorageBuffers,
+                       properties.maxDescriptorSetUpdateAfterBindStorageBuffers }),
+        };
+
+        VkDescriptorPoolSize poolSizes[TYPE_COUNT];
+        for (uint32_t i = 0; i < TYPE_COUNT; i++) {
+            poolSizes[i] = { DESCRIPTOR_TYPES[i], capacities[i] };
+        }
+        VkDescriptorPoolCreateInfo descriptorPoolCreateInfo = {
+            .sType         = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO,
+            .flags         = VK_DESCRIPTOR_POOL_CREATE_UPDATE_AFTER_BIND_BIT,
+            .maxSets       = TYPE_COUNT,
+            .poolSizeCount = TYPE_COUNT,
+            .pPoolSizes    = poolSizes,
+        };
+        VkResult result = vkCreateDescriptorPool(mDevice, &descriptorPoolCreateInfo, VulkanHostMemory::GetCallbacks(), &mDescriptorPool);
+        if (result != VK_SUCCESS) {
+            NOVA_LOG_ERROR(RHI, "Failed to create the bindless descriptor pool: {}", int32_t(result));
+            return result;
+        }
+
+        // 部分绑定: 未写入的索引只要不被访问就合法; 等待中更新: 可以写入正在执行的命令缓冲未使用的索引
+        VkDescriptorBindingFlags bindingFlags = VK_DESCRIPTOR_BINDING_UPDATE_AFTER_BIND_BIT | VK_DESCRIPTOR_BINDING_UPDATE_UNUSED_WHILE_PENDING_BIT |
+                                                VK_DESCRIPTOR_BINDING_PARTIALLY_BOUND_BIT;
+
+        VkDescriptorSetLayout setLayouts[TYPE_COUNT];
+        for (uint32_t i = 0; i < TYPE_COUNT; i++) {
+            Table& table   = mTables[i];
+            table.capacity = capacities[i];
+
+            VkDescriptorSetLayoutBindingFlagsCreateInfo bindingFlagsCreateInfo = {
+                .sType         = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_BINDING_FLAGS_CREATE_INFO,
+                .bindingCount  = 1,
+                .pBindingFlags = &bindingFlags,
+            };
+            VkDescriptorSetLayoutBinding binding = {
+                .binding         = 0,
+                .descriptorType  = DESCRIPTOR_TYPES[i],
+                .descriptorCount = table.capacity,
+                .stageFlags      = VK_SHADER_STAGE_ALL,
+            };
+            VkDescriptorSetLayoutCreateInfo descriptorSetLayoutCreateInfo = {
+                .sType        = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO,
+                .pNext        = &bindingFlagsCreateInfo,
+                .flags        = VK_DESCRIPTOR_SET_LAYOUT_CREATE_UPDATE_AFTER_BIND_POOL_BIT,
+                .bindingCount = 1,
+                .pBindings    = &binding,
+            };
+            result = vkCreateDescriptorSetLayout(mDevice, &descriptorSetLayoutCreateInfo, VulkanHostMemory::GetCallbacks(), &table.setLayout);
+            if (result != VK_SUCCESS) {
+                NOVA_LOG_ERROR(RHI, "Failed to create a bindless descriptor set layout: {}", int32_t(result));
+                return result;
+            }
+            setLayouts[i] = table.setLayout;
+
+            VkDescriptorSetAllocateInfo descriptorSetAllocateInfo = {
+                .sType              = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO,
+                .descriptorPool     = mDescriptorPool,
+                .descriptorSetCount = 1,
+                .pSetLayouts        = &table.setLayout,
+            };
+            result = vkAllocateDescriptorSets(mDevice, &descriptorSetAllocateInfo, &table.set);
+            if (result != VK_SUCCESS) {
+                NOVA_LOG_ERROR(RHI, "Failed to allocate a bindless descriptor set: {}", int32_t(result));
+                return result;
+            }
+        }
+
+        VkPushConstantRange pushConstantRange = {
+            .stageFlags = VK_SHADER_STAGE_ALL,
+            .offset     = 0,
+            .size       = PUSH_CONSTANT_SIZE,
+        };
+        VkPipelineLayoutCreateInfo pipelineLayoutCreateInfo = {
+            .sType                  = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO,
+            .setLayoutCount         = TYPE_COUNT,
+            .pSetLayouts            = setLayouts,
+            .pushConstantRangeCount = 1,
+            .pPushConstantRanges    = &pushConstantRange,
+        };
+        result = vkCreatePipelineLayout(mDevice, &pipelineLayoutCreateInfo, VulkanHostMemory::GetCallbacks(), &mPipelineLayout);
+        if (result != VK_SUCCESS) {
+            NOVA_LOG_ERROR(RHI, "Failed to create the bindless pipeline layout: {}", int32_t(result));
+            return result;
+        }
+
+        NOVA_LOG_INFO(
+            RHI,
+            "Bindless heap: {} sampled images, {} samplers, {} storage images, {} storage buffers",
+            capacities[0],
+            capacities[1],
+            capacities[2],
+            capacities[3]
+        );
+        return VK_SUCCESS;
+    }
+
+    // 需要在销毁逻辑设备之前调用, 调用前需要确保设备空闲
+    void Terminate() {
+        if (mDevice == VK_NULL_HANDLE) {
+            return;
+        }
+        if (mPipelineLayout != VK_NULL_HANDLE) {
+            vkDestroyPipelineLayout(mDevice, mPipelineLayout, VulkanHostMemory::GetCallbacks());
+        }
+        for (auto& table: mTables) {
+            if (table.setLayout != VK_NULL_HANDLE) {
+                vkDestroyDescriptorSetLayout(mDevice, table.setLayout, VulkanHostMemory::GetCallbacks());
+            }
+            table = {};
+        }
+        // 销毁描述符池会一并释放其中的描述符集
+        if (mDescriptorPool != VK_NULL_HANDLE) {
+            vkDestroyDescriptorPool(mDevice, mDescriptorPool, VulkanHostMemory::GetCallbacks());
+        }
+        mPendingFrees.resize(0);
+        mPipelineLayout = VK_NULL_HANDLE;
+        mDescriptorPool = VK_NULL_HANDLE;
+        mDevice         = VK_NULL_HANDLE;
+    }
+
+    // 在帧栅栏等待之后调用, 此时编号不大于frameNumber - framesInFlight的帧都已完成
+    void BeginFrame(uint64_t frameNumber, uint32_t framesInFlight) {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mFrameNumber    = frameNumber;
+        mFramesInFlight = framesInFlight;
+
+        size_t kept = 0;
+        for (auto& pending: mPendingFrees) {
+            if (pending.frameNumber + framesInFlight <= frameNumber) {
+                mTables[uint32_t(pending.type)].freeList.push_back(pending.index);
+            } else {
+                mPendingFrees[kept++] = pending;
+            }
+        }
+        mPendingFrees.resize(kept);
+    }
+
+    // 分配索引并写入描述符, 容量耗尽时返回INVALID_INDEX
+    uint32_t AllocateSampledImage(VkImageView imageView, VkImageLayout imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL) {
+        VkDescriptorImageInfo imageInfo = { .imageView = imageView, .imageLayout = imageLayout };
+        return Allocate(VulkanBindlessType::SampledImage, &imageInfo, nullptr);
+    }
+
+    uint32_t AllocateSampler(VkSampler sampler) {
+        VkDescriptorImageInfo imageInfo = { .sampler = sampler };
+        return Allocate(VulkanBindlessType::Sampler, &imageInfo, nullptr);
+    }
+
+    uint32_t AllocateStorageImage(VkImageView imageView) {
+        VkDescriptorImageInfo imageInfo = { .imageView = imageView, .imageLayout = VK_IMAGE_LAYOUT_GENERAL };
+        return Allocate(VulkanBindlessType::StorageImage, &imageInfo, nullptr);
+    }
+
+    uint32_t AllocateStorageBuffer(VkBuffer buffer, VkDeviceSize offset = 0, VkDeviceSize range = VK_WHOLE_SIZE) {
+        VkDescriptorBufferInfo bufferInfo = { .buffer = buffer, .offset = offset, .range = range };
+        return Allocate(VulkanBindlessType::StorageBuffer, nullptr, &bufferInfo);
+    }
+
+    // 原地替换索引指向的资源(如纹理流送完成后切换到完整的mip链), 索引必须当前没有被在途的命令缓冲使用
+    void UpdateSampledImage(uint32_t index, VkImageView imageView, VkImageLayout imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL) {
+        VkDescriptorImageInfo imageInfo = { .imageView = imageView, .imageLayout = imageLayout };
+        Write(VulkanBindlessType::SampledImage, index, &imageInfo, nullptr);
+    }
+
+    void UpdateStorageBuffer(uint32_t index, VkBuffer buffer, VkDeviceSize offset = 0, VkDeviceSize range = VK_WHOLE_SIZE) {
+        VkDescriptorBufferInfo bufferInfo = { .buffer = buffer, .offset = offset, .range = range };
+        Write(VulkanBindlessType::StorageBuffer, index, nullptr, &bufferInfo);
+    }
+
+    // 释放索引, 飞行中的帧完成后才会被重新分配, 资源本身仍需调用方延迟销毁
+    void Free(VulkanBindlessType type, uint32_t index) {
+        if (index == INVALID_INDEX) {
+            return;
+        }
+        std::lock_guard<std::mutex> lock(mMutex);
+        mPendingFrees.push_back({ type, index, mFrameNumber });
+    }
+
+    // 把所有无绑定描述符集绑定到命令缓冲, 之后只需要推送常量传入索引
+    void Bind(VkCommandBuffer commandBuffer, VkPipelineBindPoint pipelineBindPoint) const {
+        VkDescriptorSet sets[TYPE_COUNT];
+        for (uint32_t i = 0; i < TYPE_COUNT; i++) {
+            sets[i] = mTables[i].set;
+        }
+        vkCmdBindDescriptorSets(commandBuffer, pipelineBindPoint, mPipelineLayout, 0, TYPE_COUNT, sets, 0, nullptr);
+    }
+
+    void PushConstants(VkCommandBuffer commandBuffer, const void* data, uint32_t size, uint32_t offset = 0) const {
+        vkCmdPushConstants(commandBuffer, mPipelineLayout, VK_SHADER_STAGE_ALL, offset, size, data);
+    }
+
+    VulkanBindlessStats GetStats() {
+        std::lock_guard<std::mutex> lock(mMutex);
+
+        VulkanBindlessStats stats;
+        for (uint32_t i = 0; i < TYPE_COUNT; i++) {
+            stats.capacity[i]  = mTables[i].capacity;
+            stats.allocated[i] = mTables[i].next - static_cast<uint32_t>(mTables[i].freeList.size());
+        }
+        stats.pendingFree = static_cast<uint32_t>(mPendingFrees.size());
+        return stats;
+    }
+
+private:
+    uint32_t Allocate(VulkanBindlessType type, const VkDescriptorImageInfo* imageInfo, const VkDescriptorBufferInfo* bufferInfo) {
+        uint32_t index;
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            Table&                      table = mTables[uint32_t(type)];
+            if (!table.freeList.empty()) {
+                index = table.freeList.back();
+                table.freeList.pop_back();
+            } else if (table.next < table.capacity) {
+                index = table.next++;
+            } else {
+                NOVA_LOG_ERROR(RHI, "Bindless heap is full, type: {}", uint32_t(type));
+                return INVALID_INDEX;
+            }
+        }
+        Write(type, index, imageInfo, bufferInfo);
+        return index;
+    }
+
+    // vkUpdateDescriptorSets要求对目标描述符集外部同步
+    void Write(VulkanBindlessType type, uint32_t index, const VkDescriptorImageInfo* imageInfo, const VkDescriptorBufferInfo* bufferInfo) {
+        std::lock_guard<std::mutex> lock(mMutex);
+        VkWriteDescriptorSet writeDescriptorSet = {
+            .sType           = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
+            .dstSet          = mTables[uint32_t(type)].set,
+            .dstBinding      = 0,
+            .dstArrayElement = index,
+            .descriptorCount = 1,
+            .descriptorType  = DESCRIPTOR_TYPES[uint32_t(type)],
+            .pImageInfo      = imageInfo,
+            .pBufferInfo     = bufferInfo,
+        };
+        vkUpdateDescriptorSets(mDevice, 1, &writeDescriptorSet, 0, nullptr);
+    }
+};
+} // namespace Nova
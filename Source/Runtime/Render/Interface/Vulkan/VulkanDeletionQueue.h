@@ -0,0 +1,150 @@
+#pragma once
+#include "VulkanQueue.h"
+
+#include <functional>
+#include <mutex>
+
+namespace Nova {
+
+struct VulkanDeletionStats {
+    uint32_t     pendingCount   = 0; // 等待GPU越过退役点的销毁数
+    VkDeviceSize pendingBytes   = 0; // 等待释放的内存字节数
+    uint64_t     destroyedCount = 0; // 累计销毁数
+    VkDeviceSize destroyedBytes = 0; // 累计释放的内存字节数
+};
+
+// 延迟销毁队列
+// 资源以最后一次使用它的帧编号或队列时间线值退役, GPU越过该点后才真正销毁, 不需要等待整个设备空闲
+// 帧编号的含义与VulkanBindlessHeap一致: BeginFrame(frameNumber, framesInFlight)时编号不大于frameNumber - framesInFlight的帧都已完成
+// Retire可以在任意线程调用; 销毁函数在BeginFrame和Flush的调用线程上执行, 执行时不持有锁, 销毁函数中可以再次Retire
+class VulkanDeletionQueue {
+public:
+    using DestroyFunction = std::function<void()>;
+
+private:
+    struct Entry {
+        DestroyFunction    destroy;
+        VkDeviceSize       bytes = 0;
+        uint64_t           value = 0;       // 帧编号或时间线值
+        const VulkanQueue* queue = nullptr; // 为nullptr时value是帧编号
+    };
+
+    std::vector<Entry> mPending;
+    uint64_t           mFrameNumber    = 0;
+    uint32_t           mFramesInFlight = 1;
+
+    VulkanDeletionStats mStats;
+    std::mutex          mMutex;
+
+    // BeginFrame时复用, 避免每帧分配
+    std::vector<Entry>                                   mReady;
+    std::vector<std::pair<const VulkanQueue*, uint64_t>> mCompletedValues;
+
+public:
+    VulkanDeletionQueue() = default;
+
+    VulkanDeletionQueue(const VulkanDeletionQueue&)            = delete;
+    VulkanDeletionQueue& operator=(const VulkanDeletionQueue&) = delete;
+
+    ~VulkanDeletionQueue() {
+        if (!mPending.empty()) {
+            NOVA_LOG_WARN(RHI, "{} deferred destructions were never flushed", mPending.size());
+        }
+    }
+
+    // 以当前帧退役, 当前帧及之前的帧都完成后销毁; bytes只用于统计
+    void Retire(DestroyFunction destroy, VkDeviceSize bytes = 0) {
+        std::lock_guard<std::mutex> lock(mMutex);
+        Push({ std::move(destroy), bytes, mFrameNumber, nullptr });
+    }
+
+    // 以队列时间线值退役, 用于帧之外提交的工作(上传、异步计算等); 队列没有时间线时退化为按当前帧退役
+    void Retire(const VulkanQueue& queue, uint64_t value, DestroyFunction destroy, VkDeviceSize bytes = 0) {
+        std::lock_guard<std::mutex> lock(mMutex);
+        if (queue.HasTimeline()) {
+            Push({ std::move(destroy), bytes, value, &queue });
+        } else {
+            Push({ std::move(destroy), bytes, mFrameNumber, nullptr });
+        }
+    }
+
+    // 在帧栅栏等待之后调用, 销毁GPU已经越过退役点的资源, 返回本次销毁的数量
+    uint32_t BeginFrame(uint64_t frameNumber, uint32_t framesInFlight) {
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            mFrameNumber    = frameNumber;
+            mFramesInFlight = framesInFlight;
+
+            // 每个队列的时间线只查询一次
+            mCompletedValues.resize(0);
+            size_t kept = 0;
+            for (size_t i = 0; i < mPending.size(); i++) {
+                Entry& entry = mPending[i];
+                if (IsCompleted(entry)) {
+                    mStats.pendingCount--;
+                    mStats.pendingBytes   -= entry.bytes;
+                    mStats.destroyedCount += 1;
+                    mStats.destroyedBytes += entry.bytes;
+                    mReady.push_back(std::move(entry));
+                } else if (kept++ != i) {
+                    mPending[kept - 1] = std::move(entry);
+                }
+            }
+            mPending.resize(kept);
+        }
+
+        uint32_t destroyedCount = static_cast<uint32_t>(mReady.size());
+        for (auto& entry: mReady) {
+            entry.destroy();
+        }
+        mReady.resize(0);
+        return destroyedCount;
+    }
+
+    // 销毁所有待销毁的资源, 调用前需要确保设备空闲
+    void Flush() {
+        std::vector<Entry> pending;
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            pending.swap(mPending);
+            mStats.destroyedCount += mStats.pendingCount;
+            mStats.destroyedBytes += mStats.pendingBytes;
+            mStats.pendingCount    = 0;
+            mStats.pendingBytes    = 0;
+        }
+        for (auto& entry: pending) {
+            entry.destroy();
+        }
+        // 销毁函数中新退役的资源
+        if (GetStats().pendingCount > 0) {
+            Flush();
+        }
+    }
+
+    VulkanDeletionStats GetStats() {
+        std::lock_guard<std::mutex> lock(mMutex);
+        return mStats;
+    }
+
+private:
+    void Push(Entry&& entry) {
+        mStats.pendingCount++;
+        mStats.pendingBytes += entry.bytes;
+        mPending.push_back(std::move(entry));
+    }
+
+    bool IsCompleted(const Entry& entry) {
+        if (entry.queue == nullptr) {
+            return entry.value + mFramesInFlight <= mFrameNumber;
+        }
+        for (auto& [queue, value]: mCompletedValues) {
+            if (queue == entry.queue) {
+                return entry.value <= value;
+            }
+        }
+        uint64_t value = entry.queue->GetCompletedValue();
+        mCompletedValues.push_back({ entry.queue, value });
+        return entry.value <= value;
+    }
+};
+} // namespace Nova
@@ -0,0 +1,1385 @@
+#pragma once
+#include "VulkanBindlessHeap.h"
+#include "VulkanDeletionQueue.h"
+#include "VulkanFeatures.h"
+#include "VulkanInstance.h"
+#include "VulkanMemoryAllocator.h"
+#include "VulkanPipelineCache.h"
+#include "VulkanQueue.h"
+#include "VulkanResources.h"
+#include "VulkanUploader.h"
+
+#include "Core/ScratchArena.h"
+
+#include <charconv>
+
+namespace Nova {
+
+// 依附于设备、向设备提交帧的对象(交换链)
+// 设备据此计算所有子对象在途的帧, 并在重建设备前后通知它们释放和重新创建属于设备的对象
+class VulkanDeviceChild {
+public:
+    virtual ~VulkanDeviceChild() = default;
+
+    // 最早的可能仍在GPU上执行的设备帧编号, 没有在途的帧时返回VulkanDevice::NO_PENDING_FRAME
+    // 在设备的帧锁内调用
+    virtual uint64_t GetOldestPendingFrame() const = 0;
+
+    // 调用前设备已经空闲
+    virtual void         ReleaseDeviceObjects() = 0;
+    virtual VulkanResult RestoreDeviceObjects() = 0;
+};
+
+// 物理设备和在其上创建的逻辑设备, 包括队列、设备特性以及属于设备的分配器、管线缓存、上传器、无绑定描述符堆和延迟销毁队列
+// 同一个实例上可以创建多个设备(例如一个用于渲染, 另一个用于编码), 一个设备上可以创建多个交换链
+class VulkanDevice {
+public:
+    static constexpr uint64_t NO_PENDING_FRAME = UINT64_MAX;
+    // 没有VK_EXT_memory_budget时, 估算的预算占堆大小的百分比
+    static constexpr VkDeviceSize ESTIMATED_BUDGET_PERCENT = 80;
+
+private:
+    VulkanInstance& mInstance;
+
+    // 选择物理设备时用于查找呈现队列族的表面, 不归设备所有; 为空时不创建呈现队列
+    VkSurfaceKHR mSurface = VK_NULL_HANDLE;
+
+    VkPhysicalDevice mPhysicalDevice = VK_NULL_HANDLE;
+
+    VkPhysicalDeviceProperties       mPhysicalDeviceProperties       = {};
+    VkPhysicalDeviceMemoryProperties mPhysicalDeviceMemoryProperties = {};
+
+    static constexpr uint32_t QUEUE_FAMILY_NOT_FOUND = INT32_MAX;
+
+    struct QueueIndex {
+        uint32_t index  = VK_QUEUE_FAMILY_IGNORED;
+        bool     enable = false;
+
+        bool IsInvalid() const {
+            return (index == QUEUE_FAMILY_NOT_FOUND) && enable;
+        }
+
+        bool ShouldGet() const {
+            return (index == VK_QUEUE_FAMILY_IGNORED) && enable;
+        }
+    };
+
+    struct QueueFamilyIndices {
+        QueueIndex graphics;
+        QueueIndex present;
+        QueueIndex compute;
+    };
+
+    // 每个物理设备所需队列族索引的查询结果, 与实例的可用物理设备一一对应, 重新枚举时清空
+    std::vector<QueueFamilyIndices> mQueueFamilyIndicesCache;
+
+    VkDevice mDevice = VK_NULL_HANDLE;
+
+    uint32_t mQueueFamilyIndexGraphics     = VK_QUEUE_FAMILY_IGNORED;
+    uint32_t mQueueFamilyIndexPresentation = VK_QUEUE_FAMILY_IGNORED;
+    uint32_t mQueueFamilyIndexCompute      = VK_QUEUE_FAMILY_IGNORED;
+
+    VkQueue mQueueGraphics     = VK_NULL_HANDLE;
+    VkQueue mQueuePresentation = VK_NULL_HANDLE;
+    VkQueue mQueueCompute      = VK_NULL_HANDLE;
+
+    // 异步计算队列, 优先使用不支持图形的独立计算队列族, 其次是图形队列族中的第二个队列
+    bool     mAsyncComputeRequested        = false;
+    bool     mAsyncComputeDedicated        = false;
+    uint32_t mQueueFamilyIndexAsyncCompute = VK_QUEUE_FAMILY_IGNORED;
+    uint32_t mQueueIndexAsyncCompute       = 0;
+    VkQueue  mQueueAsyncCompute            = VK_NULL_HANDLE;
+
+    // 只支持传输的队列族通常对应独立的DMA引擎, 没有时上传使用图形队列
+    uint32_t mQueueFamilyIndexTransfer = VK_QUEUE_FAMILY_IGNORED;
+    VkQueue  mQueueTransfer            = VK_NULL_HANDLE;
+
+    // 带时间线的队列包装, 异步计算或传输与图形共用同一个VkQueue时只使用mGraphicsQueue
+    VulkanQueue mGraphicsQueue;
+    VulkanQueue mAsyncComputeQueue;
+    VulkanQueue mTransferQueue;
+    // 呈现队列与图形队列不同时才使用, 只用于加锁
+    VulkanQueue mPresentationQueue;
+
+    std::vector<const char*> mDeviceExtensionNames;
+
+    // 申请的设备特性, 只启用申请且支持的特性, 必需特性不支持时Initialize失败
+    // 默认申请的特性是RHI自身各条路径所依赖的, 缺失时对应功能退化
+    VulkanFeatureMask mRequiredFeatures = 0;
+    VulkanFeatureMask mOptionalFeatures = ToFeatureMask(VulkanFeature::TimelineSemaphore) | ToFeatureMask(VulkanFeature::Synchronization2) |
+                                          ToFeatureMask(VulkanFeature::DynamicRendering) | ToFeatureMask(VulkanFeature::DescriptorIndexing) |
+                                          ToFeatureMask(VulkanFeature::TextureCompressionBC);
+    VulkanFeatureMask mEnabledFeatures  = 0;
+
+    // 呈现等待的扩展在设备上启用, 各个交换链共用
+    bool                    mPresentWaitRequested = true;
+    PFN_vkWaitForPresentKHR mVkWaitForPresentKHR  = nullptr;
+
+    VulkanMemoryAllocator mMemoryAllocator;
+
+    // 支持VK_EXT_memory_budget时总是启用, 预算和用量由驱动提供, 否则按堆大小估算
+    bool mMemoryBudgetEnabled = false;
+
+    VulkanPipelineCache   mPipelineCache;
+    std::filesystem::path mPipelineCachePath; // 为空时按设备ID生成
+
+    VulkanUploader mUploader;
+    VkDeviceSize   mUploadRingCapacity = VulkanUploader::DEFAULT_CAPACITY;
+
+    VulkanBindlessHeap mBindlessHeap;
+
+    // 按设备帧编号或时间线值延迟销毁, 注册表的Destroy*经由它销毁
+    VulkanDeletionQueue mDeletionQueue;
+
+    VulkanResourceRegistry mResources;
+
+    // 一次性命令使用的命令池, 第一次使用时创建
+    VkCommandPool mImmediateCommandPool = VK_NULL_HANDLE;
+    std::mutex    mImmediateMutex;
+
+    // 设备帧在该设备的所有交换链之间统一编号, 多个交换链可以在不同线程上同时开始帧
+    uint64_t                        mFrameNumber = 0;
+    std::vector<VulkanDeviceChild*> mChildren;
+    std::mutex                      mFrameMutex;
+
+private:
+    std::vector<void (*)()> mCreateDeviceCallbacks;
+    std::vector<void (*)()> mDestroyDeviceCallbacks;
+
+public:
+    explicit VulkanDevice(VulkanInstance& instance): mInstance(instance) {}
+
+    VulkanDevice(const VulkanDevice&)            = delete;
+    VulkanDevice& operator=(const VulkanDevice&) = delete;
+
+    ~VulkanDevice() {
+        Terminate();
+    }
+
+    VulkanInstance& GetInstance() const {
+        return mInstance;
+    }
+
+    VkSurfaceKHR GetSurface() const {
+        return mSurface;
+    }
+
+    // 设置选择物理设备时用于查找呈现队列族的表面, 需要在SelectPhysicalDevice之前调用
+    void SetSurface(VkSurfaceKHR surface) {
+        if (mSurface == VK_NULL_HANDLE) {
+            mSurface = surface;
+        }
+    }
+
+    VkPhysicalDevice GetPhysicalDevice() const {
+        return mPhysicalDevice;
+    }
+
+    const VkPhysicalDeviceProperties& GetPhysicalDeviceProperties() const {
+        return mPhysicalDeviceProperties;
+    }
+
+    const VkPhysicalDeviceMemoryProperties& GetPhysicalDeviceMemoryProperties() const {
+        return mPhysicalDeviceMemoryProperties;
+    }
+
+    VkDevice GetDevice() const {
+        return mDevice;
+    }
+
+    // 设备不支持时Initialize失败, 需要在Initialize之前调用
+    void RequireFeature(VulkanFeature feature) {
+        mRequiredFeatures |= ToFeatureMask(feature);
+    }
+
+    // 设备支持时启用, 需要在Initialize之前调用
+    void RequestFeature(VulkanFeature feature) {
+        mOptionalFeatures |= ToFeatureMask(feature);
+    }
+
+    bool IsFeatureEnabled(VulkanFeature feature) const {
+        return (mEnabledFeatures & ToFeatureMask(feature)) != 0;
+    }
+
+    VulkanFeatureMask GetEnabledFeatures() const {
+        return mEnabledFeatures;
+    }
+
+    bool IsSynchronization2Enabled() const {
+        return IsFeatureEnabled(VulkanFeature::Synchronization2);
+    }
+
+    bool IsTimelineSemaphoreEnabled() const {
+        return IsFeatureEnabled(VulkanFeature::TimelineSemaphore);
+    }
+
+    bool IsDescriptorIndexingEnabled() const {
+        return IsFeatureEnabled(VulkanFeature::DescriptorIndexing);
+    }
+
+    // 设备不支持描述符索引时未初始化, IsInitialized返回false
+    VulkanBindlessHeap& GetBindlessHeap() {
+        return mBindlessHeap;
+    }
+
+    VulkanResourceRegistry& GetResources() {
+        return mResources;
+    }
+
+    VulkanDeletionQueue& GetDeletionQueue() {
+        return mDeletionQueue;
+    }
+
+    // 以当前设备帧退役, 该设备所有交换链在途的帧都越过当前帧后在BeginFrame中执行destroy
+    void DeferDestroy(VulkanDeletionQueue::DestroyFunction destroy, VkDeviceSize bytes = 0) {
+        mDeletionQueue.Retire(std::move(destroy), bytes);
+    }
+
+    // 以队列时间线值退役, 用于帧之外提交的工作
+    void DeferDestroy(const VulkanQueue& queue, uint64_t value, VulkanDeletionQueue::DestroyFunction destroy, VkDeviceSize bytes = 0) {
+        mDeletionQueue.Retire(queue, value, std::move(destroy), bytes);
+    }
+
+    VulkanDeletionStats GetDeletionStats() {
+        return mDeletionQueue.GetStats();
+    }
+
+    VulkanMemoryAllocator& GetMemoryAllocator() {
+        return mMemoryAllocator;
+    }
+
+    bool IsMemoryBudgetEnabled() const {
+        return mMemoryBudgetEnabled;
+    }
+
+    // 每个堆的预算和用量, 每次调用都会查询驱动, 适合每帧或每隔几帧调用一次; 任意线程可以调用
+    // 没有VK_EXT_memory_budget时预算取堆大小的ESTIMATED_BUDGET_PERCENT, 用量只计入分配器申请的内存
+    VulkanMemoryBudget QueryMemoryBudget() const {
+        VkPhysicalDeviceMemoryBudgetPropertiesEXT memoryBudgetProperties = {
+            .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MEMORY_BUDGET_PROPERTIES_EXT,
+        };
+        if (mMemoryBudgetEnabled) {
+            VkPhysicalDeviceMemoryProperties2 memoryProperties2 = {
+                .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MEMORY_PROPERTIES_2,
+                .pNext = &memoryBudgetProperties,
+            };
+            vkGetPhysicalDeviceMemoryProperties2(mPhysicalDevice, &memoryProperties2);
+        }
+
+        VulkanMemoryBudget budget;
+        budget.heapCount  = mPhysicalDeviceMemoryProperties.memoryHeapCount;
+        budget.fromDriver = mMemoryBudgetEnabled;
+        for (uint32_t i = 0; i < budget.heapCount; i++) {
+            const VkMemoryHeap& heap       = mPhysicalDeviceMemoryProperties.memoryHeaps[i];
+            VulkanHeapBudget&   heapBudget = budget.heaps[i];
+            heapBudget.size                = heap.size;
+            heapBudget.flags               = heap.flags;
+            heapBudget.allocatorBytes      = mMemoryAllocator.GetHeapBytes(i);
+            if (mMemoryBudgetEnabled) {
+                heapBudget.budget = memoryBudgetProperties.heapBudget[i];
+                heapBudget.usage  = memoryBudgetProperties.heapUsage[i];
+            } else {
+                heapBudget.budget = heap.size / 100 * ESTIMATED_BUDGET_PERCENT;
+                heapBudget.usage  = heapBudget.allocatorBytes;
+            }
+        }
+        return budget;
+    }
+
+    // 打印设备内存各堆的预算和用量、驱动的主机内存以及各类别的CPU内存
+    void LogMemoryReport() const {
+        constexpr double MEGABYTE = 1024.0 * 1024.0;
+
+        VulkanMemoryBudget budget = QueryMemoryBudget();
+        NOVA_LOG_INFO(RHI, "Device memory ({}):", budget.fromDriver ? "VK_EXT_memory_budget" : "estimated");
+        for (uint32_t i = 0; i < budget.heapCount; i++) {
+            const VulkanHeapBudget& heap = budget.heaps[i];
+            NOVA_LOG_INFO(
+                RHI,
+                "  heap {}{}: usage {:.1f} / budget {:.1f} MB (allocator {:.1f} MB, size {:.1f} MB)",
+                i,
+                (heap.flags & VK_MEMORY_HEAP_DEVICE_LOCAL_BIT) != 0 ? " [device local]" : "",
+                heap.usage / MEGABYTE,
+                heap.budget / MEGABYTE,
+                heap.allocatorBytes / MEGABYTE,
+                heap.size / MEGABYTE
+            );
+        }
+
+        VulkanHostMemoryStats hostStats = VulkanHostMemory::GetStats();
+        std::string           scopes;
+        for (uint32_t i = 0; i < VulkanHostMemoryStats::SCOPE_COUNT; i++) {
+            scopes += std::format(" {} {:.1f}", VulkanHostMemory::GetScopeName(i), hostStats.scopeBytes[i] / MEGABYTE);
+        }
+        NOVA_LOG_INFO(
+            RHI,
+            "Driver host memory: {:.2f} MB in {} allocations (peak {:.2f} MB, internal {:.2f} MB), by scope:{}",
+            hostStats.currentBytes / MEGABYTE,
+            hostStats.liveAllocations,
+            hostStats.peakBytes / MEGABYTE,
+            hostStats.internalBytes / MEGABYTE,
+            scopes
+        );
+
+        for (uint32_t i = 0; i < MemoryTracker::CATEGORY_COUNT; i++) {
+            MemoryCategory      category = MemoryCategory(i);
+            MemoryCategoryStats stats    = MemoryTracker::GetStats(category);
+            NOVA_LOG_INFO(
+                RHI,
+                "CPU memory {}: {:.2f} MB (peak {:.2f} MB), {} live / {} total allocations",
+                MemoryTracker::GetCategoryName(category),
+                stats.currentBytes / MEGABYTE,
+                stats.peakBytes / MEGABYTE,
+                stats.liveAllocations,
+                stats.totalAllocations
+            );
+        }
+    }
+
+    VulkanPipelineCache& GetPipelineCache() {
+        return mPipelineCache;
+    }
+
+    // 设置管线缓存文件路径, 需要在Initialize之前调用; 不设置时为VulkanPipelineCache::GetDefaultPath, 每个设备各不相同
+    void SetPipelineCachePath(const std::filesystem::path& path) {
+        mPipelineCachePath = path;
+    }
+
+    uint32_t GetQueueFamilyIndexGraphics() const {
+        return mQueueFamilyIndexGraphics;
+    }
+
+    uint32_t GetQueueFamilyIndexPresentation() const {
+        return mQueueFamilyIndexPresentation;
+    }
+
+    uint32_t GetQueueFamilyIndexCompute() const {
+        return mQueueFamilyIndexCompute;
+    }
+
+    // 请求创建异步计算队列, 需要在Initialize之前调用
+    void EnableAsyncCompute(bool enable = true) {
+        mAsyncComputeRequested = enable;
+    }
+
+    bool IsAsyncComputeEnabled() const {
+        return mQueueFamilyIndexAsyncCompute != VK_QUEUE_FAMILY_IGNORED;
+    }
+
+    // 为false时异步计算队列就是图形队列, 提交会串行执行, 但跨队列同步的写法不需要改变
+    bool IsAsyncComputeDedicated() const {
+        return mAsyncComputeDedicated;
+    }
+
+    uint32_t GetQueueFamilyIndexAsyncCompute() const {
+        return mQueueFamilyIndexAsyncCompute;
+    }
+
+    VulkanQueue& GetGraphicsQueue() {
+        return mGraphicsQueue;
+    }
+
+    VulkanQueue& GetAsyncComputeQueue() {
+        return mAsyncComputeDedicated ? mAsyncComputeQueue : mGraphicsQueue;
+    }
+
+    bool IsTransferQueueDedicated() const {
+        return mQueueTransfer != VK_NULL_HANDLE;
+    }
+
+    uint32_t GetQueueFamilyIndexTransfer() const {
+        return IsTransferQueueDedicated() ? mQueueFamilyIndexTransfer : mQueueFamilyIndexGraphics;
+    }
+
+    VulkanQueue& GetTransferQueue() {
+        return IsTransferQueueDedicated() ? mTransferQueue : mGraphicsQueue;
+    }
+
+    VulkanQueue& GetPresentationQueue() {
+        return mQueuePresentation != mQueueGraphics ? mPresentationQueue : mGraphicsQueue;
+    }
+
+    VulkanUploader& GetUploader() {
+        return mUploader;
+    }
+
+    // 设置暂存环形缓冲的容量, 需要在Initialize之前调用
+    void SetUploadRingCapacity(VkDeviceSize capacity) {
+        mUploadRingCapacity = capacity;
+    }
+
+    const std::vector<const char*>& GetDeviceExtensions() const {
+        return mDeviceExtensionNames;
+    }
+
+    void SetDeviceExtensionNames(const std::vector<const char*>& extensionNames) {
+        mDeviceExtensionNames = extensionNames;
+    }
+
+    void AddDeviceExtension(const char* extensionName) {
+        AddNameToContainer(extensionName, mDeviceExtensionNames);
+    }
+
+    // 是否申请VK_KHR_present_id和VK_KHR_present_wait, 需要在Initialize之前调用
+    void SetPresentWaitRequested(bool requested) {
+        mPresentWaitRequested = requested;
+    }
+
+    bool IsPresentWaitEnabled() const {
+        return mVkWaitForPresentKHR != nullptr;
+    }
+
+    VkResult WaitForPresent(VkSwapchainKHR swapChain, uint64_t presentId, uint64_t timeout) const {
+        return mVkWaitForPresentKHR(mDevice, swapChain, presentId, timeout);
+    }
+
+    // 呈现队列族是否支持在surface上呈现, 在同一设备上为其他窗口创建交换链之前检查
+    bool IsSurfaceSupported(VkSurfaceKHR surface) const {
+        if (mQueueFamilyIndexPresentation == VK_QUEUE_FAMILY_IGNORED) {
+            return false;
+        }
+        VkBool32 support = VK_FALSE;
+        VkResult result  = vkGetPhysicalDeviceSurfaceSupportKHR(mPhysicalDevice, mQueueFamilyIndexPresentation, surface, &support);
+        return result == VK_SUCCESS && ConvertToBool(support);
+    }
+
+public:
+    void AddCreateDeviceCallback(void (*function)()) {
+        mCreateDeviceCallbacks.push_back(function);
+    }
+
+    void AddDestroyDeviceCallback(void (*function)()) {
+        mDestroyDeviceCallbacks.push_back(function);
+    }
+
+    // 子对象在构造时登记, 析构时注销
+    void AttachChild(VulkanDeviceChild* child) {
+        std::lock_guard<std::mutex> lock(mFrameMutex);
+        mChildren.push_back(child);
+    }
+
+    void DetachChild(VulkanDeviceChild* child) {
+        std::lock_guard<std::mutex> lock(mFrameMutex);
+        std::erase(mChildren, child);
+    }
+
+public:
+    VulkanResult GetQueueFamilyIndices(VkPhysicalDevice physicalDevice, bool enableGraphics, bool enableCompute, uint32_t (&queueFamilyIndices)[3]) {
+        // 获取队列族数量
+        uint32_t QueueFamilyCount = 0;
+        vkGetPhysicalDeviceQueueFamilyProperties(physicalDevice, &QueueFamilyCount, nullptr);
+        if (QueueFamilyCount == 0) {
+            return VK_RESULT_MAX_ENUM;
+        }
+
+        // 获取队列族属性
+        ScratchScope                              scratch;
+        std::pmr::vector<VkQueueFamilyProperties> queueFamilyProperties(QueueFamilyCount, scratch.GetMemoryResource());
+        vkGetPhysicalDeviceQueueFamilyProperties(physicalDevice, &QueueFamilyCount, queueFamilyProperties.data());
+
+        // 初始化三种队列族索引
+        auto& [ig, ip, ic] = queueFamilyIndices;
+        ig = ip = ic = VK_QUEUE_FAMILY_IGNORED;
+
+        // 遍历队列族
+        for (uint32_t i = 0; i < QueueFamilyCount; i++) {
+            // 检查当前队列族是否支持三种队列
+            bool supportGraphics     = enableGraphics && ((queueFamilyProperties[i].queueFlags & VK_QUEUE_GRAPHICS_BIT) != 0);
+            bool supportPresentation = false;
+            bool supportCompute      = enableCompute && ((queueFamilyProperties[i].queueFlags & VK_QUEUE_COMPUTE_BIT) != 0);
+
+            // 只有当surface存在时，才检查是否支持Presentation
+            if (mSurface != nullptr) {
+                VkBool32 support = ConvertToVkBool32(supportPresentation);
+                VkResult result  = vkGetPhysicalDeviceSurfaceSupportKHR(physicalDevice, i, mSurface, &support);
+                if (result != VK_SUCCESS) {
+                    NOVA_LOG_ERROR(RHI, "Failed to get vkGetPhysicalDeviceSurfaceSupportKHR: {}", int32_t(result));
+                    return result;
+                }
+                supportPresentation = ConvertToBool(support);
+            }
+
+            // 同时支持图形管线和计算管线时
+            if (supportGraphics && supportCompute) {
+                // 若需要呈现，则三者队列族索引应当相同
+                if (supportPresentation) {
+                    ig = ip = ic = i;
+                    break;
+                }
+
+                // 若不需要呈现，则确保图形和计算管线的队列族相同
+                if (ig != ic || ig == VK_QUEUE_FAMILY_IGNORED) {
+                    ig = ic = i;
+                }
+
+                //surface不存在，直接结束
+                if (mSurface == nullptr) {
+                    break;
+                }
+            }
+
+            // 如果任一种虽然支持但是没有获得索引，则设置为当前队列族的索引
+            if (supportGraphics && ig == VK_QUEUE_FAMILY_IGNORED) {
+                ig = i;
+            }
+
+            if (supportCompute && ic == VK_QUEUE_FAMILY_IGNORED) {
+                ic = i;
+            }
+
+            if (supportPresentation && ip == VK_QUEUE_FAMILY_IGNORED) {
+                ip = i;
+            }
+        }
+
+        // 如果任意需要的队列族没有得到，则失败
+        if (ig == VK_QUEUE_FAMILY_IGNORED && enableGraphics || ip == VK_QUEUE_FAMILY_IGNORED && (mSurface != nullptr) ||
+            ic == VK_QUEUE_FAMILY_IGNORED && enableCompute) {
+            return VK_RESULT_MAX_ENUM;
+        }
+
+        // 记录队列族索引
+        mQueueFamilyIndexGraphics     = ig;
+        mQueueFamilyIndexPresentation = ip;
+        mQueueFamilyIndexCompute      = ic;
+        return VK_SUCCESS;
+    }
+
+    // 在已选定的物理设备上为异步计算挑选队列族
+    void SelectAsyncComputeQueueFamily() {
+        mAsyncComputeDedicated        = false;
+        mQueueFamilyIndexAsyncCompute = VK_QUEUE_FAMILY_IGNORED;
+        mQueueIndexAsyncCompute       = 0;
+        mQueueAsyncCompute            = VK_NULL_HANDLE;
+        if (!mAsyncComputeRequested || mQueueFamilyIndexGraphics == VK_QUEUE_FAMILY_IGNORED) {
+            return;
+        }
+
+        uint32_t queueFamilyCount = 0;
+        vkGetPhysicalDeviceQueueFamilyProperties(mPhysicalDevice, &queueFamilyCount, nullptr);
+        ScratchScope                              scratch;
+        std::pmr::vector<VkQueueFamilyProperties> queueFamilyProperties(queueFamilyCount, scratch.GetMemoryResource());
+        vkGetPhysicalDeviceQueueFamilyProperties(mPhysicalDevice, &queueFamilyCount, queueFamilyProperties.data());
+
+        // 不支持图形的计算队列族通常对应硬件上独立的计算引擎
+        for (uint32_t i = 0; i < queueFamilyCount; i++) {
+            VkQueueFlags queueFlags = queueFamilyProperties[i].queueFlags;
+            if ((queueFlags & VK_QUEUE_COMPUTE_BIT) != 0 && (queueFlags & VK_QUEUE_GRAPHICS_BIT) == 0) {
+                mQueueFamilyIndexAsyncCompute = i;
+                mAsyncComputeDedicated        = true;
+                break;
+            }
+        }
+
+        // 其次使用图形队列族中的第二个队列
+        if (!mAsyncComputeDedicated && queueFamilyProperties[mQueueFamilyIndexGraphics].queueCount > 1) {
+            mQueueFamilyIndexAsyncCompute = mQueueFamilyIndexGraphics;
+            mQueueIndexAsyncCompute       = 1;
+            mAsyncComputeDedicated        = true;
+        }
+
+        // 都没有时退化为图形队列
+        if (!mAsyncComputeDedicated) {
+            mQueueFamilyIndexAsyncCompute = mQueueFamilyIndexGraphics;
+            NOVA_LOG_WARN(RHI, "No separate compute queue is available, async compute falls back to the graphics queue");
+            return;
+        }
+        NOVA_LOG_INFO(RHI, "Async compute queue: family {}, index {}", mQueueFamilyIndexAsyncCompute, mQueueIndexAsyncCompute);
+    }
+
+    // 查找只支持传输(不支持图形和计算)的队列族
+    void SelectTransferQueueFamily() {
+        mQueueFamilyIndexTransfer = VK_QUEUE_FAMILY_IGNORED;
+        mQueueTransfer            = VK_NULL_HANDLE;
+
+        uint32_t queueFamilyCount = 0;
+        vkGetPhysicalDeviceQueueFamilyProperties(mPhysicalDevice, &queueFamilyCount, nullptr);
+        ScratchScope                              scratch;
+        std::pmr::vector<VkQueueFamilyProperties> queueFamilyProperties(queueFamilyCount, scratch.GetMemoryResource());
+        vkGetPhysicalDeviceQueueFamilyProperties(mPhysicalDevice, &queueFamilyCount, queueFamilyProperties.data());
+
+        for (uint32_t i = 0; i < queueFamilyCount; i++) {
+            VkQueueFlags queueFlags = queueFamilyProperties[i].queueFlags;
+            if ((queueFlags & VK_QUEUE_TRANSFER_BIT) != 0 && (queueFlags & (VK_QUEUE_GRAPHICS_BIT | VK_QUEUE_COMPUTE_BIT)) == 0) {
+                mQueueFamilyIndexTransfer = i;
+                NOVA_LOG_INFO(RHI, "Transfer queue: family {}", i);
+                return;
+            }
+        }
+    }
+
+    // 为每个物理设备保存一份所需队列族索引的组合, deviceIndex为实例的可用物理设备索引
+    // 多个设备同时运行时可以直接用它指定物理设备, 例如在另一块GPU上编码
+    VulkanResult DeterminePhysicalDevice(uint32_t deviceIndex = 0, bool enableGraphics = true, bool enableCompute = true) {
+        if (deviceIndex >= mInstance.GetAvailablePhysicalDeviceCount()) {
+            NOVA_LOG_ERROR(RHI, "Physical device index out of range: {}", deviceIndex);
+            return VK_ERROR_INITIALIZATION_FAILED;
+        }
+        if (mQueueFamilyIndicesCache.size() != mInstance.GetAvailablePhysicalDeviceCount()) {
+            mQueueFamilyIndicesCache.assign(mInstance.GetAvailablePhysicalDeviceCount(), {});
+        }
+        auto& [ig, ip, ic] = mQueueFamilyIndicesCache[deviceIndex];
+
+        ig.enable = enableGraphics;
+        ip.enable = mSurface != nullptr;
+        ic.enable = enableCompute;
+
+        // 如果任意队列族索引应该被获取，但是没有得到，则失败
+        if (ig.IsInvalid() || ip.IsInvalid() || ic.IsInvalid()) {
+            return VK_RESULT_MAX_ENUM;
+        }
+
+        // 如果任意队列族应该被获取，但是没有找过，则尝试获取
+        if (ig.ShouldGet() || ip.ShouldGet() || ic.ShouldGet()) {
+            uint32_t indices[3];
+            VkResult result = GetQueueFamilyIndices(mInstance.GetAvailablePhysicalDevice(deviceIndex), enableGraphics, enableCompute, indices);
+            // 如果获取的结果是成功或者VK_RESULT_MAX_ENUM，则有了结果
+            if (result == VK_SUCCESS || result == VK_RESULT_MAX_ENUM) {
+                // 对返回的索引与INT32_MAX做按位与操作
+                // 如果返回的索引为IGNORE，则按位与结果为
+                if (enableGraphics) {
+                    ig.index = indices[0] & INT32_MAX;
+                }
+
+                if (mSurface != nullptr) {
+                    ip.index = indices[1] & INT32_MAX;
+                }
+
+                if (enableCompute) {
+                    ic.index = indices[2] & INT32_MAX;
+                }
+            }
+
+            if (result != VK_SUCCESS) {
+                return result;
+            }
+        }
+        // 如果已经有了结果，则直接使用
+        else {
+            mQueueFamilyIndexGraphics     = enableGraphics ? ig.index : VK_QUEUE_FAMILY_IGNORED;
+            mQueueFamilyIndexPresentation = (mSurface != nullptr) ? ip.index : VK_QUEUE_FAMILY_IGNORED;
+            mQueueFamilyIndexCompute      = enableCompute ? ic.index : VK_QUEUE_FAMILY_IGNORED;
+        }
+
+        mPhysicalDevice = mInstance.GetAvailablePhysicalDevice(deviceIndex);
+        return VK_SUCCESS;
+    }
+
+    // 为所有物理设备打分并选择得分最高的设备, 设置了环境变量NOVA_PHYSICAL_DEVICE时优先使用其指定的设备
+    // 环境变量可以是设备索引、设备名称的一部分(不区分大小写)或deviceUUID的十六进制字符串
+    VulkanResult SelectPhysicalDevice(bool enableGraphics = true, bool enableCompute = true) {
+        // 实例还没有枚举物理设备时先枚举
+        if (mInstance.GetAvailablePhysicalDeviceCount() == 0) {
+            VkResult result = mInstance.EnumeratePhysicalDevices();
+            if (result != VK_SUCCESS) {
+                return result;
+            }
+        }
+        // 设备列表可能变化, 之前的队列族结果不再对应
+        mQueueFamilyIndicesCache.assign(mInstance.GetAvailablePhysicalDeviceCount(), {});
+
+        const char* overrideName = std::getenv(PHYSICAL_DEVICE_ENVIRONMENT_VARIABLE);
+
+        uint32_t bestIndex = UINT32_MAX;
+        int64_t  bestScore = -1;
+        for (uint32_t i = 0; i < mInstance.GetAvailablePhysicalDeviceCount(); i++) {
+            VkPhysicalDeviceProperties properties;
+            vkGetPhysicalDeviceProperties(mInstance.GetAvailablePhysicalDevice(i), &properties);
+
+            int64_t score = ScorePhysicalDevice(i, enableGraphics, enableCompute);
+            NOVA_LOG_INFO(RHI, "Physical device {}: {}, score {}", i, properties.deviceName, score);
+
+            if (overrideName != nullptr && score >= 0 && MatchPhysicalDevice(i, overrideName)) {
+                NOVA_LOG_INFO(RHI, "Physical device selected by {}={}", PHYSICAL_DEVICE_ENVIRONMENT_VARIABLE, overrideName);
+                return DeterminePhysicalDevice(i, enableGraphics, enableCompute);
+            }
+            if (score > bestScore) {
+                bestScore = score;
+                bestIndex = i;
+            }
+        }
+
+        if (overrideName != nullptr) {
+            NOVA_LOG_WARN(
+                RHI, "{}={} does not match any suitable physical device, falling back to scoring", PHYSICAL_DEVICE_ENVIRONMENT_VARIABLE, overrideName
+            );
+        }
+        if (bestIndex == UINT32_MAX) {
+            NOVA_LOG_ERROR(RHI, "Failed to find a suitable physical device");
+            return VK_ERROR_INITIALIZATION_FAILED;
+        }
+        // 打分时已经缓存了队列族索引, 这里只是为选中的设备重新记录
+        return DeterminePhysicalDevice(bestIndex, enableGraphics, enableCompute);
+    }
+
+private:
+    static constexpr const char* PHYSICAL_DEVICE_ENVIRONMENT_VARIABLE = "NOVA_PHYSICAL_DEVICE";
+
+    // 返回负数表示设备不满足要求(缺少队列族、设备扩展或必需特性)
+    // 设备类型的权重最高, 其次是设备本地显存容量, 最后是队列拓扑和可选特性
+    int64_t ScorePhysicalDevice(uint32_t deviceIndex, bool enableGraphics, bool enableCompute) {
+        VkPhysicalDevice           physicalDevice = mInstance.GetAvailablePhysicalDevice(deviceIndex);
+        VkPhysicalDeviceProperties properties;
+        vkGetPhysicalDeviceProperties(physicalDevice, &properties);
+
+        if (DeterminePhysicalDevice(deviceIndex, enableGraphics, enableCompute) != VK_SUCCESS) {
+            return -1;
+        }
+
+        // 设备扩展
+        uint32_t extensionCount = 0;
+        vkEnumerateDeviceExtensionProperties(physicalDevice, nullptr, &extensionCount, nullptr);
+        ScratchScope                            scratch;
+        std::pmr::vector<VkExtensionProperties> extensionProperties(extensionCount, scratch.GetMemoryResource());
+        vkEnumerateDeviceExtensionProperties(physicalDevice, nullptr, &extensionCount, extensionProperties.data());
+        for (auto extensionName: mDeviceExtensionNames) {
+            bool found = false;
+            for (auto& extension: extensionProperties) {
+                if (strcmp(extension.extensionName, extensionName) == 0) {
+                    found = true;
+                    break;
+                }
+            }
+            if (!found) {
+                return -1;
+            }
+        }
+
+        // 必需特性
+        uint32_t           apiVersion = std::min(mInstance.GetApiVersion(), properties.apiVersion);
+        VulkanFeatureChain supportedFeatures(apiVersion);
+        if (apiVersion >= VK_API_VERSION_1_1) {
+            vkGetPhysicalDeviceFeatures2(physicalDevice, &supportedFeatures.features2);
+        } else {
+            vkGetPhysicalDeviceFeatures(physicalDevice, &supportedFeatures.features2.features);
+        }
+        int64_t optionalFeatureCount = 0;
+        for (uint32_t i = 0; i < uint32_t(VulkanFeature::Count); i++) {
+            VulkanFeatureMask mask      = ToFeatureMask(VulkanFeature(i));
+            bool              supported = supportedFeatures.IsSupported(VulkanFeature(i));
+            if ((mRequiredFeatures & mask) && !supported) {
+                return -1;
+            }
+            if ((mOptionalFeatures & mask) && supported) {
+                optionalFeatureCount++;
+            }
+        }
+
+        int64_t typeScore = 0;
+        switch (properties.deviceType) {
+            case VK_PHYSICAL_DEVICE_TYPE_DISCRETE_GPU:
+                typeScore = 4;
+                break;
+            case VK_PHYSICAL_DEVICE_TYPE_INTEGRATED_GPU:
+                typeScore = 3;
+                break;
+            case VK_PHYSICAL_DEVICE_TYPE_VIRTUAL_GPU:
+                typeScore = 2;
+                break;
+            case VK_PHYSICAL_DEVICE_TYPE_CPU:
+                typeScore = 1;
+                break;
+            default:
+                break;
+        }
+
+        // 最大的设备本地堆, 以MB计
+        VkPhysicalDeviceMemoryProperties memoryProperties;
+        vkGetPhysicalDeviceMemoryProperties(physicalDevice, &memoryProperties);
+        VkDeviceSize deviceLocalSize = 0;
+        for (uint32_t i = 0; i < memoryProperties.memoryHeapCount; i++) {
+            if (memoryProperties.memoryHeaps[i].flags & VK_MEMORY_HEAP_DEVICE_LOCAL_BIT) {
+                deviceLocalSize = std::max(deviceLocalSize, memoryProperties.memoryHeaps[i].size);
+            }
+        }
+        int64_t deviceLocalMegabytes = std::min<int64_t>(int64_t(deviceLocalSize >> 20), 999'999);
+
+        // 独立的计算和传输队列族
+        uint32_t queueFamilyCount = 0;
+        vkGetPhysicalDeviceQueueFamilyProperties(physicalDevice, &queueFamilyCount, nullptr);
+        std::pmr::vector<VkQueueFamilyProperties> queueFamilyProperties(queueFamilyCount, scratch.GetMemoryResource());
+        vkGetPhysicalDeviceQueueFamilyProperties(physicalDevice, &queueFamilyCount, queueFamilyProperties.data());
+        bool dedicatedCompute  = false;
+        bool dedicatedTransfer = false;
+        for (auto& queueFamily: queueFamilyProperties) {
+            VkQueueFlags queueFlags = queueFamily.queueFlags;
+            if ((queueFlags & VK_QUEUE_COMPUTE_BIT) && !(queueFlags & VK_QUEUE_GRAPHICS_BIT)) {
+                dedicatedCompute = true;
+            } else if ((queueFlags & VK_QUEUE_TRANSFER_BIT) && !(queueFlags & (VK_QUEUE_GRAPHICS_BIT | VK_QUEUE_COMPUTE_BIT))) {
+                dedicatedTransfer = true;
+            }
+        }
+        int64_t queueScore = (dedicatedCompute ? 100 : 0) + (dedicatedTransfer ? 100 : 0);
+
+        return typeScore * 1'000'000'000 + deviceLocalMegabytes * 1'000 + queueScore + optionalFeatureCount;
+    }
+
+    bool MatchPhysicalDevice(uint32_t deviceIndex, std::string_view overrideName) const {
+        auto toLower = [](std::string_view text) {
+            std::string result(text);
+            for (auto& c: result) {
+                c = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+            }
+            return result;
+        };
+
+        std::string name = toLower(overrideName);
+        if (!name.empty() && std::all_of(name.begin(), name.end(), [](char c) { return std::isdigit(static_cast<unsigned char>(c)); })) {
+            // 超出uint32_t范围的序号不会匹配任何设备
+            uint32_t index        = 0;
+            auto [end, errorCode] = std::from_chars(name.data(), name.data() + name.size(), index);
+            return errorCode == std::errc() && end == name.data() + name.size() && index == deviceIndex;
+        }
+
+        VkPhysicalDevice             physicalDevice = mInstance.GetAvailablePhysicalDevice(deviceIndex);
+        VkPhysicalDeviceIDProperties idProperties   = { .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_ID_PROPERTIES };
+        VkPhysicalDeviceProperties2  properties2    = { .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2 };
+        VkPhysicalDeviceProperties   properties;
+        vkGetPhysicalDeviceProperties(physicalDevice, &properties);
+        if (std::min(mInstance.GetApiVersion(), properties.apiVersion) >= VK_API_VERSION_1_1) {
+            properties2.pNext = &idProperties;
+            vkGetPhysicalDeviceProperties2(physicalDevice, &properties2);
+
+            // UUID比较时忽略连字符
+            std::string uuid;
+            for (uint8_t byte: idProperties.deviceUUID) {
+                uuid += std::format("{:02x}", byte);
+            }
+            std::string compactName;
+            for (char c: name) {
+                if (c != '-') {
+                    compactName.push_back(c);
+                }
+            }
+            if (compactName == uuid) {
+                return true;
+            }
+        }
+        return toLower(properties.deviceName).find(name) != std::string::npos;
+    }
+
+    static bool IsDeviceExtensionSupported(VkPhysicalDevice physicalDevice, const char* extensionName) {
+        uint32_t extensionCount = 0;
+        vkEnumerateDeviceExtensionProperties(physicalDevice, nullptr, &extensionCount, nullptr);
+        ScratchScope                            scratch;
+        std::pmr::vector<VkExtensionProperties> extensionProperties(extensionCount, scratch.GetMemoryResource());
+        vkEnumerateDeviceExtensionProperties(physicalDevice, nullptr, &extensionCount, extensionProperties.data());
+        for (auto& extension: extensionProperties) {
+            if (strcmp(extension.extensionName, extensionName) == 0) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+public:
+    // 在选定的物理设备上创建逻辑设备, 需要先调用SelectPhysicalDevice或DeterminePhysicalDevice
+    VulkanResult Initialize(VkDeviceCreateFlags flags = 0) {
+        // 开启异步计算时, 先确定计算队列所在的队列族
+        SelectAsyncComputeQueueFamily();
+        SelectTransferQueueFamily();
+
+        // 统一使用1.0f的优先级
+        float queuePriorities[2] = { 1.0f, 1.0f };
+
+        // 每个队列族只创建一个队列, 异步计算与图形共用队列族时在该族上创建第二个队列
+        std::vector<VkDeviceQueueCreateInfo> queueCreateInfos;
+        auto addQueueFamily = [&](uint32_t queueFamilyIndex, uint32_t queueCount) {
+            if (queueFamilyIndex == VK_QUEUE_FAMILY_IGNORED) {
+                return;
+            }
+            for (auto& queueCreateInfo: queueCreateInfos) {
+                if (queueCreateInfo.queueFamilyIndex == queueFamilyIndex) {
+                    queueCreateInfo.queueCount = std::max(queueCreateInfo.queueCount, queueCount);
+                    return;
+                }
+            }
+            queueCreateInfos.push_back({
+                .sType            = VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO,
+                .queueFamilyIndex = queueFamilyIndex,
+                .queueCount       = queueCount,
+                .pQueuePriorities = queuePriorities,
+            });
+        };
+        addQueueFamily(mQueueFamilyIndexGraphics, 1);
+        addQueueFamily(mQueueFamilyIndexPresentation, 1);
+        addQueueFamily(mQueueFamilyIndexCompute, 1);
+        if (mAsyncComputeDedicated) {
+            addQueueFamily(mQueueFamilyIndexAsyncCompute, mQueueIndexAsyncCompute + 1);
+        }
+        addQueueFamily(mQueueFamilyIndexTransfer, 1);
+
+        // 协商设备特性: 只启用申请且支持的特性, 不再把vkGetPhysicalDeviceFeatures的结果整体传回
+        VkPhysicalDeviceProperties physicalDeviceProperties;
+        vkGetPhysicalDeviceProperties(mPhysicalDevice, &physicalDeviceProperties);
+        uint32_t apiVersion = std::min(mInstance.GetApiVersion(), physicalDeviceProperties.apiVersion);
+
+        VulkanFeatureChain supportedFeatures(apiVersion);
+        VulkanFeatureChain enabledFeatures(apiVersion);
+        VulkanFeatureMask  requestedFeatures = mRequiredFeatures | mOptionalFeatures;
+
+        // 呈现等待只对交换链有意义, 两个扩展都支持时才申请, 否则帧节奏只等待栅栏
+        std::vector<const char*> deviceExtensionNames = mDeviceExtensionNames;
+
+        bool usePresentWait = mPresentWaitRequested && apiVersion >= VK_API_VERSION_1_1 &&
+                              ContainsName(VK_KHR_SWAPCHAIN_EXTENSION_NAME, mDeviceExtensionNames) &&
+                              IsDeviceExtensionSupported(mPhysicalDevice, VK_KHR_PRESENT_ID_EXTENSION_NAME) &&
+                              IsDeviceExtensionSupported(mPhysicalDevice, VK_KHR_PRESENT_WAIT_EXTENSION_NAME);
+        if (usePresentWait) {
+            supportedFeatures.LinkPresentWait();
+            enabledFeatures.LinkPresentWait();
+            requestedFeatures |= ToFeatureMask(VulkanFeature::PresentId) | ToFeatureMask(VulkanFeature::PresentWait);
+        }
+
+        // 预算通过vkGetPhysicalDeviceMemoryProperties2查询, 需要1.1
+        mMemoryBudgetEnabled = apiVersion >= VK_API_VERSION_1_1 && IsDeviceExtensionSupported(mPhysicalDevice, VK_EXT_MEMORY_BUDGET_EXTENSION_NAME);
+        if (mMemoryBudgetEnabled) {
+            AddNameToContainer(VK_EXT_MEMORY_BUDGET_EXTENSION_NAME, deviceExtensionNames);
+        } else {
+            NOVA_LOG_WARN(RHI, "VK_EXT_memory_budget is not supported, memory budgets are estimated from heap sizes");
+        }
+
+        if (apiVersion >= VK_API_VERSION_1_1) {
+            vkGetPhysicalDeviceFeatures2(mPhysicalDevice, &supportedFeatures.features2);
+        } else {
+            vkGetPhysicalDeviceFeatures(mPhysicalDevice, &supportedFeatures.features2.features);
+        }
+
+        mEnabledFeatures = 0;
+        std::string enabledFeatureNames;
+        for (uint32_t i = 0; i < uint32_t(VulkanFeature::Count); i++) {
+            VulkanFeature     feature = VulkanFeature(i);
+            VulkanFeatureMask mask    = ToFeatureMask(feature);
+            if ((requestedFeatures & mask) == 0) {
+                continue;
+            }
+            if (supportedFeatures.IsSupported(feature)) {
+                enabledFeatures.Enable(feature);
+                mEnabledFeatures |= mask;
+                enabledFeatureNames += std::format(" {}", GetFeatureName(feature));
+            } else if (mRequiredFeatures & mask) {
+                NOVA_LOG_ERROR(RHI, "Required device feature is not supported: {}", GetFeatureName(feature));
+                return VK_ERROR_FEATURE_NOT_PRESENT;
+            } else {
+                NOVA_LOG_WARN(RHI, "Optional device feature is not supported: {}", GetFeatureName(feature));
+            }
+        }
+        NOVA_LOG_INFO(RHI, "Enabled device features:{}", enabledFeatureNames);
+
+        if (!IsSynchronization2Enabled()) {
+            NOVA_LOG_WARN(RHI, "synchronization2 is not enabled, the render graph is unavailable");
+        }
+        if (!IsTimelineSemaphoreEnabled()) {
+            NOVA_LOG_WARN(RHI, "timelineSemaphore is not enabled, cross-queue dependencies need binary semaphores");
+        }
+        if (!IsDescriptorIndexingEnabled()) {
+            NOVA_LOG_WARN(RHI, "descriptor indexing is not enabled, the bindless heap is unavailable");
+        }
+        if (IsFeatureEnabled(VulkanFeature::PresentId) && IsFeatureEnabled(VulkanFeature::PresentWait)) {
+            deviceExtensionNames.push_back(VK_KHR_PRESENT_ID_EXTENSION_NAME);
+            deviceExtensionNames.push_back(VK_KHR_PRESENT_WAIT_EXTENSION_NAME);
+        }
+
+        // 构建设备创建信息
+        VkDeviceCreateInfo deviceCreateInfo = { .sType                   = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO,
+                                                .queueCreateInfoCount    = static_cast<uint32_t>(queueCreateInfos.size()),
+                                                .pQueueCreateInfos       = queueCreateInfos.data(),
+                                                .enabledExtensionCount   = static_cast<uint32_t>(deviceExtensionNames.size()),
+                                                .ppEnabledExtensionNames = deviceExtensionNames.data() };
+        // 1.1起特性链通过pNext传入, 此时pEnabledFeatures必须为空
+        if (apiVersion >= VK_API_VERSION_1_1) {
+            deviceCreateInfo.pNext = &enabledFeatures.features2;
+        } else {
+            deviceCreateInfo.pEnabledFeatures = &enabledFeatures.features2.features;
+        }
+
+        // 创建逻辑设备
+        VkResult result = vkCreateDevice(mPhysicalDevice, &deviceCreateInfo, VulkanHostMemory::GetCallbacks(), &mDevice);
+        if (result != VK_SUCCESS) {
+            NOVA_LOG_ERROR(RHI, "Failed to create vulkan logical device: {}", int32_t(result));
+            return result;
+        }
+
+        // 扩展函数不由加载器导出, 需要从设备获取
+        mVkWaitForPresentKHR = nullptr;
+        if (IsFeatureEnabled(VulkanFeature::PresentWait)) {
+            mVkWaitForPresentKHR = reinterpret_cast<PFN_vkWaitForPresentKHR>(vkGetDeviceProcAddr(mDevice, "vkWaitForPresentKHR"));
+        }
+
+        // 除异步计算外每个队列族只创建了一个队列，因此queueIndex为0
+        if (mQueueFamilyIndexGraphics != VK_QUEUE_FAMILY_IGNORED) {
+            vkGetDeviceQueue(mDevice, mQueueFamilyIndexGraphics, 0, &mQueueGraphics);
+        }
+        if (mQueueFamilyIndexPresentation != VK_QUEUE_FAMILY_IGNORED) {
+            vkGetDeviceQueue(mDevice, mQueueFamilyIndexPresentation, 0, &mQueuePresentation);
+        }
+        if (mQueueFamilyIndexCompute != VK_QUEUE_FAMILY_IGNORED) {
+            vkGetDeviceQueue(mDevice, mQueueFamilyIndexCompute, 0, &mQueueCompute);
+        }
+        if (mAsyncComputeDedicated) {
+            vkGetDeviceQueue(mDevice, mQueueFamilyIndexAsyncCompute, mQueueIndexAsyncCompute, &mQueueAsyncCompute);
+        } else if (mAsyncComputeRequested) {
+            mQueueAsyncCompute = mQueueGraphics;
+        }
+        if (mQueueFamilyIndexTransfer != VK_QUEUE_FAMILY_IGNORED) {
+            vkGetDeviceQueue(mDevice, mQueueFamilyIndexTransfer, 0, &mQueueTransfer);
+        }
+
+        // 为图形队列、异步计算队列和传输队列创建时间线
+        if (mQueueGraphics != VK_NULL_HANDLE) {
+            mGraphicsQueue.Initialize(mDevice, mQueueGraphics, mQueueFamilyIndexGraphics, IsTimelineSemaphoreEnabled()).Ignore();
+        }
+        if (mAsyncComputeDedicated) {
+            mAsyncComputeQueue.Initialize(mDevice, mQueueAsyncCompute, mQueueFamilyIndexAsyncCompute, IsTimelineSemaphoreEnabled()).Ignore();
+        }
+        if (mQueueTransfer != VK_NULL_HANDLE) {
+            mTransferQueue.Initialize(mDevice, mQueueTransfer, mQueueFamilyIndexTransfer, IsTimelineSemaphoreEnabled()).Ignore();
+        }
+        if (mQueuePresentation != mQueueGraphics) {
+            mPresentationQueue.Initialize(mDevice, mQueuePresentation, mQueueFamilyIndexPresentation, false).Ignore();
+        }
+
+        // 获取物理设备属性和内存属性
+        vkGetPhysicalDeviceProperties(mPhysicalDevice, &mPhysicalDeviceProperties);
+        vkGetPhysicalDeviceMemoryProperties(mPhysicalDevice, &mPhysicalDeviceMemoryProperties);
+
+        // 初始化设备内存分配器
+        mMemoryAllocator.Initialize(mDevice, mPhysicalDeviceMemoryProperties, mPhysicalDeviceProperties.limits);
+
+        // 加载磁盘上的管线缓存, 失败时使用空缓存, 不影响设备创建
+        if (mPipelineCachePath.empty()) {
+            mPipelineCachePath = VulkanPipelineCache::GetDefaultPath(mPhysicalDeviceProperties);
+        }
+        mPipelineCache.Initialize(mDevice, mPhysicalDeviceProperties, mPipelineCachePath).Ignore();
+
+        // 上传结果由图形队列使用
+        if (mQueueGraphics != VK_NULL_HANDLE) {
+            mUploader.Initialize(mDevice, mMemoryAllocator, GetTransferQueue(), mQueueFamilyIndexGraphics, mUploadRingCapacity).Ignore();
+        }
+
+        // 无绑定描述符堆的容量受update-after-bind上限约束
+        if (IsDescriptorIndexingEnabled()) {
+            VkPhysicalDeviceVulkan12Properties physicalDeviceVulkan12Properties = { .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_PROPERTIES };
+
+            VkPhysicalDeviceProperties2 physicalDeviceProperties2 = {
+                .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2,
+                .pNext = &physicalDeviceVulkan12Properties,
+            };
+            vkGetPhysicalDeviceProperties2(mPhysicalDevice, &physicalDeviceProperties2);
+            mBindlessHeap.Initialize(mDevice, physicalDeviceVulkan12Properties).Ignore();
+        }
+
+        // 资源注册表在无绑定描述符堆之后初始化, 创建的资源自动登记无绑定索引, 销毁经由延迟销毁队列
+        mResources.Initialize(mDevice, mMemoryAllocator, &mBindlessHeap, &mDeletionQueue);
+
+        // 打印设备名称
+        NOVA_LOG_INFO(RHI, "Physical Device: {}", mPhysicalDeviceProperties.deviceName);
+
+        // 调用设备创建回调
+        for (auto& callback: mCreateDeviceCallbacks) {
+            callback();
+        }
+
+        return VK_SUCCESS;
+    }
+
+    // 仍然登记的子对象会先释放属于设备的对象, 表面等不属于设备的对象由子对象自己销毁
+    void Terminate() {
+        if (mDevice == VK_NULL_HANDLE) {
+            return;
+        }
+        WaitIdle().Ignore();
+
+        for (auto child: mChildren) {
+            child->ReleaseDeviceObjects();
+        }
+        DestroyDevice();
+    }
+
+    VulkanResult WaitIdle() const {
+        // 等待设备空闲
+        VkResult result = vkDeviceWaitIdle(mDevice);
+        if (result != VK_SUCCESS) {
+            NOVA_LOG_ERROR(RHI, "Failed to wait for the device to be idle: {}", int32_t(result));
+        }
+        return result;
+    }
+
+    // 重建逻辑设备, 各个子对象(交换链)随之释放并重新创建属于设备的对象
+    VulkanResult Recreate(VkDeviceCreateFlags flags = 0) {
+        // 等待设备空闲
+        VkResult result = WaitIdle();
+        if (result != VK_SUCCESS) {
+            return result;
+        }
+
+        for (auto child: mChildren) {
+            child->ReleaseDeviceObjects();
+        }
+        DestroyDevice();
+
+        // 重新创建设备
+        result = Initialize(flags);
+        if (result != VK_SUCCESS) {
+            return result;
+        }
+
+        for (auto child: mChildren) {
+            result = child->RestoreDeviceObjects();
+            if (result != VK_SUCCESS) {
+                return result;
+            }
+        }
+        return VK_SUCCESS;
+    }
+
+    // 交换链在帧栅栏等待之后调用, 为本帧分配设备帧编号并写入pendingFrame, 然后回收所有交换链都已越过的退役资源
+    // pendingFrame是调用方记录的该飞行帧的设备帧编号, 在帧锁内写入, GetOldestPendingFrame读取它时不会与写入竞争
+    uint64_t BeginFrame(uint64_t& pendingFrame) {
+        std::lock_guard<std::mutex> lock(mFrameMutex);
+
+        uint64_t frameNumber = mFrameNumber++;
+        pendingFrame         = frameNumber;
+
+        // 编号小于oldestPendingFrame的设备帧都已完成
+        uint64_t oldestPendingFrame = frameNumber;
+        for (auto child: mChildren) {
+            oldestPendingFrame = std::min(oldestPendingFrame, child->GetOldestPendingFrame());
+        }
+
+        // 换算为BeginFrame(frameNumber, framesInFlight)的约定: 编号不大于frameNumber - framesInFlight的帧都已完成
+        // 只有一个交换链时framesInFlight就是它的飞行帧数
+        uint32_t framesInFlight = static_cast<uint32_t>(frameNumber - oldestPendingFrame + 1);
+
+        // 回收已经没有帧引用的无绑定索引
+        if (mBindlessHeap.IsInitialized()) {
+            mBindlessHeap.BeginFrame(frameNumber, framesInFlight);
+        }
+
+        // 销毁GPU已经越过退役点的资源, 多个交换链不会同时执行销毁函数
+        mDeletionQueue.BeginFrame(frameNumber, framesInFlight);
+        return frameNumber;
+    }
+
+    // 飞行帧全部完成(或被销毁)后调用, 这些帧不再推迟设备的延迟销毁
+    void ClearPendingFrames(std::span<uint64_t> pendingFrames) {
+        std::lock_guard<std::mutex> lock(mFrameMutex);
+        for (auto& pendingFrame: pendingFrames) {
+            pendingFrame = NO_PENDING_FRAME;
+        }
+    }
+
+    // 已开始的设备帧总数, 包括该设备所有交换链的帧
+    uint64_t GetFrameNumber() {
+        std::lock_guard<std::mutex> lock(mFrameMutex);
+        return mFrameNumber;
+    }
+
+    // 在图形队列上录制并执行一次性命令, 阻塞到执行完成, 只用于初始化和读回等非逐帧的操作
+    VulkanResult ExecuteImmediate(const std::function<void(VkCommandBuffer)>& record) {
+        std::lock_guard<std::mutex> lock(mImmediateMutex);
+
+        if (mImmediateCommandPool == VK_NULL_HANDLE) {
+            VkCommandPoolCreateInfo commandPoolCreateInfo = {
+                .sType            = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO,
+                .flags            = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT,
+                .queueFamilyIndex = mQueueFamilyIndexGraphics,
+            };
+            VkResult result = vkCreateCommandPool(mDevice, &commandPoolCreateInfo, VulkanHostMemory::GetCallbacks(), &mImmediateCommandPool);
+            if (result != VK_SUCCESS) {
+                NOVA_LOG_ERROR(RHI, "Failed to create the immediate command pool: {}", int32_t(result));
+                return result;
+            }
+        }
+
+        VkCommandBuffer             commandBuffer             = VK_NULL_HANDLE;
+        VkCommandBufferAllocateInfo commandBufferAllocateInfo = {
+            .sType              = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO,
+            .commandPool        = mImmediateCommandPool,
+            .level              = VK_COMMAND_BUFFER_LEVEL_PRIMARY,
+            .commandBufferCount = 1,
+        };
+        VkResult result = vkAllocateCommandBuffers(mDevice, &commandBufferAllocateInfo, &commandBuffer);
+        if (result != VK_SUCCESS) {
+            NOVA_LOG_ERROR(RHI, "Failed to allocate an immediate command buffer: {}", int32_t(result));
+            return result;
+        }
+
+        VkFence           fence           = VK_NULL_HANDLE;
+        VkFenceCreateInfo fenceCreateInfo = { .sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO };
+        result                            = vkCreateFence(mDevice, &fenceCreateInfo, VulkanHostMemory::GetCallbacks(), &fence);
+        if (result == VK_SUCCESS) {
+            VkCommandBufferBeginInfo commandBufferBeginInfo = {
+                .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO,
+                .flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT,
+            };
+            result = vkBeginCommandBuffer(commandBuffer, &commandBufferBeginInfo);
+        }
+        if (result == VK_SUCCESS) {
+            record(commandBuffer);
+            result = vkEndCommandBuffer(commandBuffer);
+        }
+        if (result == VK_SUCCESS) {
+            result = mGraphicsQueue.Submit({ &commandBuffer, 1 }, {}, {}, fence);
+        }
+        if (result == VK_SUCCESS) {
+            result = vkWaitForFences(mDevice, 1, &fence, VK_TRUE, UINT64_MAX);
+        }
+        if (result != VK_SUCCESS) {
+            NOVA_LOG_ERROR(RHI, "Failed to execute immediate commands: {}", int32_t(result));
+        }
+
+        if (fence != VK_NULL_HANDLE) {
+            vkDestroyFence(mDevice, fence, VulkanHostMemory::GetCallbacks());
+        }
+        vkFreeCommandBuffers(mDevice, mImmediateCommandPool, 1, &commandBuffer);
+        return result;
+    }
+
+    // 将二维图像的第0层mip读回到pixels, 紧密排列; layout为图像当前的布局, 读回后恢复
+    // 会等待图形队列上之前提交的所有工作完成
+    VulkanResult ReadbackImage(
+        VkImage               image,
+        VkImageLayout         layout,
+        VkExtent2D            extent,
+        uint32_t              bytesPerPixel,
+        std::vector<uint8_t>& pixels,
+        VkImageAspectFlags    aspectMask = VK_IMAGE_ASPECT_COLOR_BIT
+    ) {
+        VkDeviceSize size = VkDeviceSize(extent.width) * extent.height * bytesPerPixel;
+
+        VkBufferCreateInfo bufferCreateInfo = {
+            .sType       = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO,
+            .size        = size,
+            .usage       = VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+            .sharingMode = VK_SHARING_MODE_EXCLUSIVE,
+        };
+        VkBuffer         buffer     = VK_NULL_HANDLE;
+        VulkanAllocation allocation = {};
+        VkResult         result     = mMemoryAllocator.CreateBuffer(
+            bufferCreateInfo,
+            VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT,
+            buffer,
+            allocation,
+            VK_MEMORY_PROPERTY_HOST_CACHED_BIT
+        );
+        if (result != VK_SUCCESS) {
+            return result;
+        }
+
+        result = ExecuteImmediate([&](VkCommandBuffer commandBuffer) {
+            VkImageMemoryBarrier imageMemoryBarrier = {
+                .sType               = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
+                .srcAccessMask       = VK_ACCESS_MEMORY_WRITE_BIT,
+                .dstAccessMask       = VK_ACCESS_TRANSFER_READ_BIT,
+                .oldLayout           = layout,
+                .newLayout           = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+                .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+                .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+                .image               = image,
+                .subresourceRange    = { aspectMask, 0, 1, 0, 1 },
+            };
+            vkCmdPipelineBarrier(
+                commandBuffer,
+                VK_PIPELINE_STAGE_ALL_COMMANDS_BIT,
+                VK_PIPELINE_STAGE_TRANSFER_BIT,
+                0,
+                0,
+                nullptr,
+                0,
+                nullptr,
+                1,
+                &imageMemoryBarrier
+            );
+
+            VkBufferImageCopy bufferImageCopy = {
+                .imageSubresource = { aspectMask, 0, 0, 1 },
+                .imageExtent      = { extent.width, extent.height, 1 },
+            };
+            vkCmdCopyImageToBuffer(commandBuffer, image, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, buffer, 1, &bufferImageCopy);
+
+            // 恢复原布局, 同时让主机可以读取缓冲
+            imageMemoryBarrier.srcAccessMask = 0;
+            imageMemoryBarrier.dstAccessMask = 0;
+            imageMemoryBarrier.oldLayout     = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+            imageMemoryBarrier.newLayout     = layout;
+
+            VkBufferMemoryBarrier bufferMemoryBarrier = {
+                .sType               = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER,
+                .srcAccessMask       = VK_ACCESS_TRANSFER_WRITE_BIT,
+                .dstAccessMask       = VK_ACCESS_HOST_READ_BIT,
+                .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+                .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+                .buffer              = buffer,
+                .offset              = 0,
+                .size                = VK_WHOLE_SIZE,
+            };
+            vkCmdPipelineBarrier(
+                commandBuffer,
+                VK_PIPELINE_STAGE_TRANSFER_BIT,
+                VK_PIPELINE_STAGE_ALL_COMMANDS_BIT | VK_PIPELINE_STAGE_HOST_BIT,
+                0,
+                0,
+                nullptr,
+                1,
+                &bufferMemoryBarrier,
+                layout == VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL ? 0 : 1,
+                &imageMemoryBarrier
+            );
+        });
+
+        if (result == VK_SUCCESS) {
+            result = mMemoryAllocator.InvalidateAllocation(allocation);
+        }
+        if (result == VK_SUCCESS) {
+            pixels.resize(size);
+            memcpy(pixels.data(), allocation.mappedData, size);
+        }
+
+        mMemoryAllocator.DestroyBuffer(buffer, allocation);
+        return result;
+    }
+
+private:
+    // 调用前需要确保设备空闲且子对象已经释放属于设备的对象
+    void DestroyDevice() {
+        if (mImmediateCommandPool != VK_NULL_HANDLE) {
+            vkDestroyCommandPool(mDevice, mImmediateCommandPool, VulkanHostMemory::GetCallbacks());
+            mImmediateCommandPool = VK_NULL_HANDLE;
+        }
+
+        // 执行销毁设备回调函数
+        for (auto& callback: mDestroyDeviceCallbacks) {
+            callback();
+        }
+
+        // 等待在途的上传并释放暂存缓冲
+        mUploader.Terminate();
+        // 设备已经空闲, 执行所有延迟销毁
+        mDeletionQueue.Flush();
+        // 销毁注册表中剩余的资源和无绑定描述符堆
+        mResources.Terminate();
+        mBindlessHeap.Terminate();
+        // 销毁队列的时间线信号量
+        mPresentationQueue.Terminate();
+        mTransferQueue.Terminate();
+        mAsyncComputeQueue.Terminate();
+        mGraphicsQueue.Terminate();
+        // 保存管线缓存
+        mPipelineCache.Terminate();
+        // 所有资源销毁后再释放内存块
+        mMemoryAllocator.Terminate();
+        // 销毁逻辑设备
+        vkDestroyDevice(mDevice, VulkanHostMemory::GetCallbacks());
+
+        mDevice              = VK_NULL_HANDLE;
+        mQueueGraphics       = VK_NULL_HANDLE;
+        mQueuePresentation   = VK_NULL_HANDLE;
+        mQueueCompute        = VK_NULL_HANDLE;
+        mQueueAsyncCompute   = VK_NULL_HANDLE;
+        mQueueTransfer       = VK_NULL_HANDLE;
+        mVkWaitForPresentKHR = nullptr;
+        mMemoryBudgetEnabled = false;
+    }
+};
+} // namespace Nova
@@ -0,0 +1,191 @@
+#pragma once
+#include "VulkanResult.h"
+
+namespace Nova {
+
+// 可以向设备申请的特性, 每一项可能对应多个VkBool32, 要么全部启用要么全部不启用
+enum class VulkanFeature : uint32_t {
+    // Vulkan 1.0
+    RobustBufferAccess, // 越界访问检查, 部分驱动上有明显的运行时开销, 默认不启用
+    SamplerAnisotropy,
+    FillModeNonSolid,
+    MultiDrawIndirect,
+    PipelineStatisticsQuery,
+    TextureCompressionBC,
+    ShaderInt64,
+    // Vulkan 1.1
+    ShaderDrawParameters,
+    // Vulkan 1.2
+    TimelineSemaphore,
+    BufferDeviceAddress,
+    DescriptorIndexing, // 无绑定描述符堆需要的全部描述符索引特性
+    HostQueryReset,
+    // Vulkan 1.3
+    Synchronization2,
+    DynamicRendering,
+    // VK_KHR_present_id, VK_KHR_present_wait, 设备支持扩展时才会链接对应的结构体
+    PresentId,
+    PresentWait,
+    Count,
+};
+
+using VulkanFeatureMask = uint64_t;
+
+constexpr VulkanFeatureMask ToFeatureMask(VulkanFeature feature) {
+    return VulkanFeatureMask(1) << uint32_t(feature);
+}
+
+// 设备特性结构体链, 按API版本链接, 未链接的结构体保持全零即视为不支持
+// 结构体之间通过pNext互相指向, 不能复制或移动
+struct VulkanFeatureChain {
+    VkPhysicalDeviceFeatures2        features2 = { .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2 };
+    VkPhysicalDeviceVulkan11Features vulkan11  = { .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_1_FEATURES };
+    VkPhysicalDeviceVulkan12Features vulkan12  = { .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES };
+    VkPhysicalDeviceVulkan13Features vulkan13  = { .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_3_FEATURES };
+
+    VkPhysicalDevicePresentIdFeaturesKHR   presentId   = { .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PRESENT_ID_FEATURES_KHR };
+    VkPhysicalDevicePresentWaitFeaturesKHR presentWait = { .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PRESENT_WAIT_FEATURES_KHR };
+
+    explicit VulkanFeatureChain(uint32_t apiVersion) {
+        // VkPhysicalDeviceVulkan11Features在1.2才加入
+        if (apiVersion >= VK_API_VERSION_1_2) {
+            Link(&vulkan11, &vulkan11.pNext);
+            Link(&vulkan12, &vulkan12.pNext);
+        }
+        if (apiVersion >= VK_API_VERSION_1_3) {
+            Link(&vulkan13, &vulkan13.pNext);
+        }
+    }
+
+    // 设备同时支持VK_KHR_present_id和VK_KHR_present_wait时调用, 需要1.1及以上的vkGetPhysicalDeviceFeatures2
+    void LinkPresentWait() {
+        Link(&presentId, &presentId.pNext);
+        Link(&presentWait, &presentWait.pNext);
+    }
+
+    VulkanFeatureChain(const VulkanFeatureChain&)            = delete;
+    VulkanFeatureChain& operator=(const VulkanFeatureChain&) = delete;
+
+    // 特性对应的所有VkBool32, 返回数量
+    uint32_t GetBits(VulkanFeature feature, VkBool32** bits) {
+        VkPhysicalDeviceFeatures& core  = features2.features;
+        uint32_t                  count = 0;
+        switch (feature) {
+            case VulkanFeature::RobustBufferAccess:
+                bits[count++] = &core.robustBufferAccess;
+                break;
+            case VulkanFeature::SamplerAnisotropy:
+                bits[count++] = &core.samplerAnisotropy;
+                break;
+            case VulkanFeature::FillModeNonSolid:
+                bits[count++] = &core.fillModeNonSolid;
+                break;
+            case VulkanFeature::MultiDrawIndirect:
+                bits[count++] = &core.multiDrawIndirect;
+                bits[count++] = &core.drawIndirectFirstInstance;
+                break;
+            case VulkanFeature::PipelineStatisticsQuery:
+                bits[count++] = &core.pipelineStatisticsQuery;
+                break;
+            case VulkanFeature::TextureCompressionBC:
+                bits[count++] = &core.textureCompressionBC;
+                break;
+            case VulkanFeature::ShaderInt64:
+                bits[count++] = &core.shaderInt64;
+                break;
+            case VulkanFeature::ShaderDrawParameters:
+                bits[count++] = &vulkan11.shaderDrawParameters;
+                break;
+            case VulkanFeature::TimelineSemaphore:
+                bits[count++] = &vulkan12.timelineSemaphore;
+                break;
+            case VulkanFeature::BufferDeviceAddress:
+                bits[count++] = &vulkan12.bufferDeviceAddress;
+                break;
+            case VulkanFeature::DescriptorIndexing:
+                bits[count++] = &vulkan12.descriptorIndexing;
+                bits[count++] = &vulkan12.runtimeDescriptorArray;
+                bits[count++] = &vulkan12.descriptorBindingPartiallyBound;
+                bits[count++] = &vulkan12.descriptorBindingUpdateUnusedWhilePending;
+                bits[count++] = &vulkan12.descriptorBindingSampledImageUpdateAfterBind;
+                bits[count++] = &vulkan12.descriptorBindingStorageImageUpdateAfterBind;
+                bits[count++] = &vulkan12.descriptorBindingStorageBufferUpdateAfterBind;
+                bits[count++] = &vulkan12.shaderSampledImageArrayNonUniformIndexing;
+                bits[count++] = &vulkan12.shaderStorageImageArrayNonUniformIndexing;
+                bits[count++] = &vulkan12.shaderStorageBufferArrayNonUniformIndexing;
+                break;
+            case VulkanFeature::HostQueryReset:
+                bits[count++] = &vulkan12.hostQueryReset;
+                break;
+            case VulkanFeature::Synchronization2:
+                bits[count++] = &vulkan13.synchronization2;
+                break;
+            case VulkanFeature::DynamicRendering:
+                bits[count++] = &vulkan13.dynamicRendering;
+                break;
+            case VulkanFeature::PresentId:
+                bits[count++] = &presentId.presentId;
+                break;
+            case VulkanFeature::PresentWait:
+                bits[count++] = &presentWait.presentWait;
+                break;
+            default:
+                break;
+        }
+        return count;
+    }
+
+    bool IsSupported(VulkanFeature feature) {
+        VkBool32* bits[MAX_BITS_PER_FEATURE];
+        uint32_t  count = GetBits(feature, bits);
+        for (uint32_t i = 0; i < count; i++) {
+            if (*bits[i] != VK_TRUE) {
+                return false;
+            }
+        }
+        return count > 0;
+    }
+
+    void Enable(VulkanFeature feature) {
+        VkBool32* bits[MAX_BITS_PER_FEATURE];
+        uint32_t  count = GetBits(feature, bits);
+        for (uint32_t i = 0; i < count; i++) {
+            *bits[i] = VK_TRUE;
+        }
+    }
+
+    static constexpr uint32_t MAX_BITS_PER_FEATURE = 16;
+
+private:
+    // 链表末尾结构体的pNext
+    void** mNext = &features2.pNext;
+
+    void Link(void* structure, void** next) {
+        *mNext = structure;
+        mNext  = next;
+    }
+};
+
+inline const char* GetFeatureName(VulkanFeature feature) {
+    constexpr const char* NAMES[] = {
+        "robustBufferAccess",
+        "samplerAnisotropy",
+        "fillModeNonSolid",
+        "multiDrawIndirect",
+        "pipelineStatisticsQuery",
+        "textureCompressionBC",
+        "shaderInt64",
+        "shaderDrawParameters",
+        "timelineSemaphore",
+        "bufferDeviceAddress",
+        "descriptorIndexing",
+        "hostQueryReset",
+        "synchronization2",
+        "dynamicRendering",
+        "presentId",
+        "presentWait",
+    };
+    static_assert(std::size(NAMES) == size_t(VulkanFeature::Count));
+    return uint32_t(feature) < uint32_t(VulkanFeature::Count) ? NAMES[uint32_t(feature)] : "unknown";
+}
+} // namespace Nova
@@ -2,7 +2,7 @@
 #include "VulkanStart.h"
 
 namespace Nova {
-static inline VkExtent2D DEFAULT_WINDOW_SIZE = { 1280, 720 };
+static inline constexpr VkExtent2D DEFAULT_WINDOW_SIZE = { 1280, 720 };
 
 static inline const char* DEFAULT_WINDOW_TITLE = "LearnVulkan";
 
@@ -17,6 +17,15 @@ static inline void AddNameToContainer(const char* name, std::vector<const char*>
     container.push_back(name);
 }
 
+static inline bool ContainsName(const char* name, const std::vector<const char*>& container) {
+    for (const auto& item: container) {
+        if (strcmp(name, item) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
 static inline VkBool32 ConvertToVkBool32(bool value) {
     return value ? VK_TRUE : VK_FALSE;
 }
@@ -0,0 +1,149 @@
+#pragma once
+#include "VulkanResult.h"
+
+#include "Core/MemoryTracker.h"
+
+#include <array>
+#include <atomic>
+#include <cstring>
+
+// 是否通过VkAllocationCallbacks统计驱动的主机内存, 关闭时所有创建和销毁调用传入nullptr, 由驱动自行分配
+#ifndef NOVA_VULKAN_HOST_MEMORY_TRACKING
+    #define NOVA_VULKAN_HOST_MEMORY_TRACKING 1
+#endif
+
+namespace Nova {
+
+struct VulkanHostMemoryStats {
+    static constexpr uint32_t SCOPE_COUNT = VK_SYSTEM_ALLOCATION_SCOPE_INSTANCE + 1;
+
+    uint64_t                          currentBytes    = 0;
+    uint64_t                          peakBytes       = 0;
+    uint64_t                          liveAllocations = 0;
+    std::array<uint64_t, SCOPE_COUNT> scopeBytes      = {}; // 按VkSystemAllocationScope划分的当前字节数
+    uint64_t                          internalBytes   = 0;  // 驱动自行分配并通知的字节数, 如可执行代码
+};
+
+// 驱动的主机内存分配回调, 所有vkCreate*/vkDestroy*和vkAllocateMemory/vkFreeMemory都传入GetCallbacks()
+// 分配计入MemoryCategory::Driver, 并按分配作用域分别统计; 创建和销毁同一对象必须传入相同的回调,
+// 因此由GLFW创建的表面(无法指定回调)以及与之共用销毁路径的无头表面始终使用nullptr
+class VulkanHostMemory {
+private:
+    // 放在返回给驱动的指针之前, 释放和重新分配时据此得到原始大小和对齐
+    struct Header {
+        size_t                  size;
+        size_t                  alignment;
+        VkSystemAllocationScope scope;
+    };
+
+    struct alignas(64) Counters {
+        std::array<std::atomic<uint64_t>, VulkanHostMemoryStats::SCOPE_COUNT> scopeBytes    = {};
+        std::atomic<uint64_t>                                                internalBytes = 0;
+    };
+
+    // 在类外定义, 嵌套类的默认成员初始化在外层类定义结束之后才可用
+    static Counters counters;
+
+public:
+    static const VkAllocationCallbacks* GetCallbacks() {
+#if NOVA_VULKAN_HOST_MEMORY_TRACKING
+        static const VkAllocationCallbacks callbacks = {
+            .pUserData             = nullptr,
+            .pfnAllocation         = &Allocation,
+            .pfnReallocation       = &Reallocation,
+            .pfnFree               = &Free,
+            .pfnInternalAllocation = &InternalAllocation,
+            .pfnInternalFree       = &InternalFree,
+        };
+        return &callbacks;
+#else
+        return nullptr;
+#endif
+    }
+
+    static VulkanHostMemoryStats GetStats() {
+        MemoryCategoryStats driverStats = MemoryTracker::GetStats(MemoryCategory::Driver);
+
+        VulkanHostMemoryStats stats;
+        stats.currentBytes    = driverStats.currentBytes;
+        stats.peakBytes       = driverStats.peakBytes;
+        stats.liveAllocations = driverStats.liveAllocations;
+        stats.internalBytes   = counters.internalBytes.load(std::memory_order_relaxed);
+        for (uint32_t i = 0; i < VulkanHostMemoryStats::SCOPE_COUNT; i++) {
+            stats.scopeBytes[i] = counters.scopeBytes[i].load(std::memory_order_relaxed);
+        }
+        return stats;
+    }
+
+    static const char* GetScopeName(uint32_t scope) {
+        static constexpr const char* NAMES[VulkanHostMemoryStats::SCOPE_COUNT] = { "Command", "Object", "Cache", "Device", "Instance" };
+        return scope < VulkanHostMemoryStats::SCOPE_COUNT ? NAMES[scope] : "Unknown";
+    }
+
+private:
+    static size_t GetHeaderOffset(size_t alignment) {
+        return (sizeof(Header) + alignment - 1) & ~(alignment - 1);
+    }
+
+    static Header* GetHeader(void* memory) {
+        return static_cast<Header*>(memory) - 1;
+    }
+
+    // 回调中不能抛出异常, 分配失败时返回nullptr, 由驱动返回VK_ERROR_OUT_OF_HOST_MEMORY
+    static VKAPI_ATTR void* VKAPI_CALL Allocation(void*, size_t size, size_t alignment, VkSystemAllocationScope scope) {
+        if (size == 0) {
+            return nullptr;
+        }
+        alignment     = std::max(alignment, alignof(Header));
+        size_t offset = GetHeaderOffset(alignment);
+        auto*  base   = static_cast<std::byte*>(::operator new(offset + size, std::align_val_t(alignment), std::nothrow));
+        if (base == nullptr) {
+            return nullptr;
+        }
+        void* memory = base + offset;
+        new (GetHeader(memory)) Header { size, alignment, scope };
+
+        MemoryTracker::OnAllocate(MemoryCategory::Driver, size);
+        counters.scopeBytes[scope].fetch_add(size, std::memory_order_relaxed);
+        return memory;
+    }
+
+    static VKAPI_ATTR void VKAPI_CALL Free(void*, void* memory) {
+        if (memory == nullptr) {
+            return;
+        }
+        Header header = *GetHeader(memory);
+        MemoryTracker::OnFree(MemoryCategory::Driver, header.size);
+        counters.scopeBytes[header.scope].fetch_sub(header.size, std::memory_order_relaxed);
+        ::operator delete(static_cast<std::byte*>(memory) - GetHeaderOffset(header.alignment), std::align_val_t(header.alignment));
+    }
+
+    // 规范要求保持原有的对齐, 失败时原分配不变
+    static VKAPI_ATTR void* VKAPI_CALL Reallocation(void* userData, void* original, size_t size, size_t alignment, VkSystemAllocationScope scope) {
+        if (original == nullptr) {
+            return Allocation(userData, size, alignment, scope);
+        }
+        if (size == 0) {
+            Free(userData, original);
+            return nullptr;
+        }
+        void* memory = Allocation(userData, size, alignment, scope);
+        if (memory == nullptr) {
+            return nullptr;
+        }
+        std::memcpy(memory, original, std::min(size, GetHeader(original)->size));
+        Free(userData, original);
+        return memory;
+    }
+
+    static VKAPI_ATTR void VKAPI_CALL InternalAllocation(void*, size_t size, VkInternalAllocationType, VkSystemAllocationScope) {
+        counters.internalBytes.fetch_add(size, std::memory_order_relaxed);
+    }
+
+    static VKAPI_ATTR void VKAPI_CALL InternalFree(void*, size_t size, VkInternalAllocationType, VkSystemAllocationScope) {
+        counters.internalBytes.fetch_sub(size, std::memory_order_relaxed);
+    }
+};
+
+inline VulkanHostMemory::Counters VulkanHostMemory::counters;
+} // namespace Nova
@@ -0,0 +1,349 @@
+#pragma once
+#include "VulkanHostMemory.h"
+#include "VulkanResult.h"
+
+#include <mutex>
+
+#ifdef NOVA_DEBUG
+    #define ENABLE_DEBUG_MESSENGER true
+#else
+    #define ENABLE_DEBUG_MESSENGER false
+#endif
+
+namespace Nova {
+
+// Vulkan实例, 包括实例层、实例扩展、调试信使和可用的物理设备
+// 一个实例上可以创建多个VulkanDevice, 实例需要在所有设备和表面销毁之后销毁
+class VulkanInstance {
+private:
+    VkInstance mInstance   = VK_NULL_HANDLE;
+    uint32_t   mApiVersion = VK_API_VERSION_1_0;
+
+    std::vector<const char*> mInstanceLayers;
+    std::vector<const char*> mInstanceExtensions;
+
+    VkDebugUtilsMessengerEXT mDebugMessenger = VK_NULL_HANDLE;
+
+    // 调试信息按消息ID去重, 同一条信息只在第1、2、4、8...次出现时输出
+    std::unordered_map<uint64_t, uint32_t> mDebugMessageCounts;
+    uint64_t                               mSuppressedDebugMessages = 0;
+    std::mutex                             mDebugMessageMutex;
+
+    std::vector<VkPhysicalDevice> mAvailablePhysicalDevices;
+
+public:
+    VulkanInstance() = default;
+
+    VulkanInstance(const VulkanInstance&)            = delete;
+    VulkanInstance& operator=(const VulkanInstance&) = delete;
+
+    ~VulkanInstance() {
+        Terminate();
+    }
+
+    // 获取Vulkan实例句柄
+    VkInstance GetInstance() const {
+        return mInstance;
+    }
+
+    uint32_t GetApiVersion() const {
+        return mApiVersion;
+    }
+
+    // 需要在Initialize之前调用
+    VulkanResult UseLatestApiVersion() {
+        if (vkGetInstanceProcAddr(VK_NULL_HANDLE, "vkEnumerateInstanceVersion") != nullptr) {
+            return vkEnumerateInstanceVersion(&mApiVersion);
+        }
+        return VK_SUCCESS;
+    }
+
+    // 获取实例层名称列表
+    const std::vector<const char*>& GetInstanceLayerNames() const {
+        return mInstanceLayers;
+    }
+
+    // 获取实例扩展名称列表
+    const std::vector<const char*>& GetInstanceExtensionNames() const {
+        return mInstanceExtensions;
+    }
+
+    // 设置实例层名称
+    void SetInstanceLayerNames(const std::vector<const char*>& layerNames) {
+        mInstanceLayers = layerNames;
+    }
+    // 设置实例扩展名称
+    void SetInstanceExtensionNames(const std::vector<const char*>& extensionNames) {
+        mInstanceExtensions = extensionNames;
+    }
+
+    // 添加实例层名称
+    void AddInstanceLayerName(const char* layer) {
+        AddNameToContainer(layer, mInstanceLayers);
+    }
+
+    // 添加实例扩展名称
+    void AddInstanceExtensionName(const char* extension) {
+        AddNameToContainer(extension, mInstanceExtensions);
+    }
+
+    VkPhysicalDevice GetAvailablePhysicalDevice(uint32_t index) const {
+        return mAvailablePhysicalDevices[index];
+    }
+
+    uint32_t GetAvailablePhysicalDeviceCount() const {
+        return static_cast<uint32_t>(mAvailablePhysicalDevices.size());
+    }
+
+public:
+    // 创建Vulkan实例
+    VulkanResult Initialize(VkInstanceCreateFlags flags = 0) {
+        // 在调试模式下自动添加验证层和调试扩展
+        if constexpr (ENABLE_DEBUG_MESSENGER) {
+            AddInstanceLayerName("VK_LAYER_KHRONOS_validation");
+            AddInstanceExtensionName(VK_EXT_DEBUG_UTILS_EXTENSION_NAME);
+        }
+
+        // 配置应用程序信息
+        VkApplicationInfo applicationInfo = {
+            .sType      = VK_STRUCTURE_TYPE_APPLICATION_INFO,
+            .apiVersion = mApiVersion, // 使用存储的API版本
+        };
+
+        // 配置实例创建信息
+        VkInstanceCreateInfo instanceCreateInfo = {
+            .sType                   = VK_STRUCTURE_TYPE_INSTANCE_CREATE_INFO,
+            .flags                   = flags,
+            .pApplicationInfo        = &applicationInfo,
+            .enabledLayerCount       = static_cast<uint32_t>(mInstanceLayers.size()),
+            .ppEnabledLayerNames     = mInstanceLayers.data(),
+            .enabledExtensionCount   = static_cast<uint32_t>(mInstanceExtensions.size()),
+            .ppEnabledExtensionNames = mInstanceExtensions.data(),
+        };
+
+        // 尝试创建Vulkan实例
+        VkResult result = vkCreateInstance(&instanceCreateInfo, VulkanHostMemory::GetCallbacks(), &mInstance);
+        if (result != VK_SUCCESS) {
+            NOVA_LOG_ERROR(RHI, "创建实例失败: {}", int32_t(result));
+            return result;
+        }
+
+        // 打印Vulkan API版本信息
+        NOVA_LOG_INFO(
+            RHI, "Vulkan API Version: {}.{}.{}", VK_VERSION_MAJOR(mApiVersion), VK_VERSION_MINOR(mApiVersion), VK_VERSION_PATCH(mApiVersion)
+        );
+
+        // 在调试模式下创建调试信使
+        if constexpr (ENABLE_DEBUG_MESSENGER) {
+            CreateDebugMessenger().Ignore();
+        }
+
+        return VK_SUCCESS;
+    }
+
+    // 调用前需要销毁在该实例上创建的所有设备和表面
+    void Terminate() {
+        if (mInstance == VK_NULL_HANDLE) {
+            return;
+        }
+
+        // 销毁debug messenger
+        if (mDebugMessenger != VK_NULL_HANDLE) {
+            PFN_vkDestroyDebugUtilsMessengerEXT vkDestroyDebugUtilsMessengerExt =
+                reinterpret_cast<PFN_vkDestroyDebugUtilsMessengerEXT>(vkGetInstanceProcAddr(mInstance, "vkDestroyDebugUtilsMessengerEXT"));
+            if (vkDestroyDebugUtilsMessengerExt != nullptr) {
+                vkDestroyDebugUtilsMessengerExt(mInstance, mDebugMessenger, VulkanHostMemory::GetCallbacks());
+            }
+            mDebugMessenger = VK_NULL_HANDLE;
+        }
+        if (mSuppressedDebugMessages > 0) {
+            NOVA_LOG_INFO(RHI, "{} repeated debug messages were suppressed", mSuppressedDebugMessages);
+        }
+        mDebugMessageCounts.clear();
+        mSuppressedDebugMessages = 0;
+
+        mAvailablePhysicalDevices.resize(0);
+
+        // 销毁Vulkan实例
+        vkDestroyInstance(mInstance, VulkanHostMemory::GetCallbacks());
+        mInstance = VK_NULL_HANDLE;
+    }
+
+    // 枚举物理设备, 在该实例上创建的设备共用枚举结果
+    VulkanResult EnumeratePhysicalDevices() {
+        uint32_t deviceCount = 0;
+        VkResult result      = vkEnumeratePhysicalDevices(mInstance, &deviceCount, nullptr);
+        if (result != VK_SUCCESS) {
+            NOVA_LOG_ERROR(RHI, "Failed to enumerate physical devices: {}", int32_t(result));
+            return result;
+        }
+        if (deviceCount == 0) {
+            NOVA_LOG_ERROR(RHI, "Failed to find any physical devices");
+            abort();
+        }
+
+        mAvailablePhysicalDevices.resize(deviceCount);
+        result = vkEnumeratePhysicalDevices(mInstance, &deviceCount, mAvailablePhysicalDevices.data());
+        if (result != VK_SUCCESS) {
+            NOVA_LOG_ERROR(RHI, "Failed to enumerate physical devices: {}", int32_t(result));
+        }
+        return result;
+    }
+
+    // 检查实例层是否可用
+    VulkanResult CheckInstanceLayers(std::span<const char*> layersToCheck) {
+        uint32_t layerCount;
+        // 获取可用层数量
+        if (VkResult result = vkEnumerateInstanceLayerProperties(&layerCount, nullptr)) {
+            NOVA_LOG_ERROR(RHI, "枚举实例层属性失败: {}", int32_t(result));
+            return result;
+        }
+
+        // 如果没有可用层，清空输入的层列表
+        if (layerCount == 0) {
+            for (auto& layerName: layersToCheck) {
+                layerName = nullptr;
+            }
+            return VK_SUCCESS;
+        }
+
+        // 获取可用层属性
+        std::vector<VkLayerProperties> availableLayers;
+        availableLayers.resize(layerCount);
+        if (VkResult result = vkEnumerateInstanceLayerProperties(&layerCount, availableLayers.data())) {
+            NOVA_LOG_ERROR(RHI, "枚举实例层属性失败: {}", int32_t(result));
+            return result;
+        }
+
+        // 检查每个输入的层是否可用
+        for (auto& layerName: layersToCheck) {
+            bool found = false;
+            for (auto& availableLayer: availableLayers) {
+                if (std::strcmp(layerName, availableLayer.layerName) == 0) {
+                    found = true;
+                    break;
+                }
+            }
+            // 如果层不可用，设置为nullptr
+            if (!found) {
+                layerName = nullptr;
+            }
+        }
+
+        return VK_SUCCESS;
+    }
+
+    // 检查实例扩展名称是否可用
+    VulkanResult CheckInstanceExtensionNames(std::span<const char*> extensionNames) {
+        uint32_t extensionCount;
+        // 获取可用扩展数量
+        if (VkResult result = vkEnumerateInstanceExtensionProperties(nullptr, &extensionCount, nullptr)) {
+            NOVA_LOG_ERROR(RHI, "枚举实例扩展属性失败: {}", int32_t(result));
+            return result;
+        }
+
+        // 如果没有可用扩展，清空输入的扩展列表
+        if (extensionCount == 0) {
+            for (auto& extensionName: extensionNames) {
+                extensionName = nullptr;
+            }
+            return VK_SUCCESS;
+        }
+
+        // 获取可用扩展属性
+        std::vector<VkExtensionProperties> availableExtensions(extensionCount);
+        if (VkResult result = vkEnumerateInstanceExtensionProperties(nullptr, &extensionCount, availableExtensions.data())) {
+            NOVA_LOG_ERROR(RHI, "枚举实例扩展属性失败: {}", int32_t(result));
+            return result;
+        }
+
+        // 检查每个输入的扩展是否可用
+        for (auto& extensionName: extensionNames) {
+            bool found = false;
+            for (auto& availableExtension: availableExtensions) {
+                if (std::strcmp(extensionName, availableExtension.extensionName) == 0) {
+                    found = true;
+                    break;
+                }
+            }
+            // 如果扩展不可用，设置为nullptr
+            if (!found) {
+                extensionName = nullptr;
+            }
+        }
+        return VK_SUCCESS;
+    }
+
+private:
+    VulkanResult CreateDebugMessenger() {
+        static PFN_vkDebugUtilsMessengerCallbackEXT DebugUtilsMessengerCallback = [](VkDebugUtilsMessageSeverityFlagBitsEXT      messageSeverity,
+                                                                                     VkDebugUtilsMessageTypeFlagsEXT             messageTypes,
+                                                                                     const VkDebugUtilsMessengerCallbackDataEXT* pCallbackData,
+                                                                                     void* pUserData) -> VkBool32 {
+            uint32_t count = static_cast<VulkanInstance*>(pUserData)->CountDebugMessage(*pCallbackData);
+            if ((count & (count - 1)) != 0) {
+                return VK_FALSE;
+            }
+
+            spdlog::level::level_enum level = spdlog::level::debug;
+            if (messageSeverity & VK_DEBUG_UTILS_MESSAGE_SEVERITY_ERROR_BIT_EXT) {
+                level = spdlog::level::err;
+            } else if (messageSeverity & VK_DEBUG_UTILS_MESSAGE_SEVERITY_WARNING_BIT_EXT) {
+                level = spdlog::level::warn;
+            } else if (messageSeverity & VK_DEBUG_UTILS_MESSAGE_SEVERITY_INFO_BIT_EXT) {
+                level = spdlog::level::info;
+            }
+
+            const char* messageIdName = pCallbackData->pMessageIdName != nullptr ? pCallbackData->pMessageIdName : "Debug";
+            if (count == 1) {
+                NOVA_LOG(RHI, level, "{}: {}", messageIdName, pCallbackData->pMessage);
+            } else {
+                NOVA_LOG(RHI, level, "{} (seen {} times): {}", messageIdName, count, pCallbackData->pMessage);
+            }
+            return VK_FALSE;
+        };
+
+        VkDebugUtilsMessengerCreateInfoEXT debugUtilsMessengerCreateInfo = {
+            .sType           = VK_STRUCTURE_TYPE_DEBUG_UTILS_MESSENGER_CREATE_INFO_EXT,
+            .messageSeverity = VK_DEBUG_UTILS_MESSAGE_SEVERITY_WARNING_BIT_EXT | VK_DEBUG_UTILS_MESSAGE_SEVERITY_ERROR_BIT_EXT,
+            .messageType     = VK_DEBUG_UTILS_MESSAGE_TYPE_GENERAL_BIT_EXT | VK_DEBUG_UTILS_MESSAGE_TYPE_VALIDATION_BIT_EXT |
+                           VK_DEBUG_UTILS_MESSAGE_TYPE_PERFORMANCE_BIT_EXT,
+            .pfnUserCallback = DebugUtilsMessengerCallback,
+            .pUserData       = this,
+        };
+
+        const auto vkCreateDebugUtilsMessengerExt =
+            reinterpret_cast<PFN_vkCreateDebugUtilsMessengerEXT>(vkGetInstanceProcAddr(mInstance, "vkCreateDebugUtilsMessengerEXT"));
+        if (vkCreateDebugUtilsMessengerExt != nullptr) {
+            VkResult result =
+                vkCreateDebugUtilsMessengerExt(mInstance, &debugUtilsMessengerCreateInfo, VulkanHostMemory::GetCallbacks(), &mDebugMessenger);
+            if (result != VK_SUCCESS) {
+                NOVA_LOG_ERROR(RHI, "Failed to create debug messenger: {}", int32_t(result));
+            }
+            return result;
+        }
+
+        NOVA_LOG_ERROR(RHI, "Failed to get vkCreateDebugUtilsMessengerEXT");
+
+        //没有合适的错误代码时就返回 VK_RESULT_MAX_ENUM
+        return VK_RESULT_MAX_ENUM;
+    }
+
+    // 返回该信息累计出现的次数; 部分信息(如加载器信息)的messageIdNumber为0, 此时以消息名或内容区分
+    // 多个设备可能在不同线程上同时触发回调
+    uint32_t CountDebugMessage(const VkDebugUtilsMessengerCallbackDataEXT& callbackData) {
+        uint64_t key = uint32_t(callbackData.messageIdNumber);
+        if (key == 0) {
+            const char* text = callbackData.pMessageIdName != nullptr ? callbackData.pMessageIdName : callbackData.pMessage;
+            key              = std::hash<std::string_view>()(text != nullptr ? text : "");
+        }
+
+        std::lock_guard<std::mutex> lock(mDebugMessageMutex);
+        uint32_t                    count = ++mDebugMessageCounts[key];
+        if ((count & (count - 1)) != 0) {
+            mSuppressedDebugMessages++;
+        }
+        return count;
+    }
+};
+} // namespace Nova
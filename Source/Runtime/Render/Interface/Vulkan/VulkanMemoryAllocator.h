@@ -0,0 +1,854 @@
+#pragma once
+#include "VulkanHostMemory.h"
+#include "VulkanResult.h"
+
+#include <array>
+#include <atomic>
+#include <bit>
+#include <mutex>
+
+namespace Nova {
+
+static inline VkDeviceSize AlignUp(VkDeviceSize value, VkDeviceSize alignment) {
+    return (value + alignment - 1) & ~(alignment - 1);
+}
+
+//======================================================================================================================================================
+// TLSF, 在[0, capacity)范围内分配偏移量, 分配和释放都是O(1)
+//======================================================================================================================================================
+class TlsfAllocator {
+public:
+    static constexpr uint32_t INVALID_NODE = UINT32_MAX;
+
+    // 最小分配粒度为256字节, 每个一级区间划分为32个二级区间
+    static constexpr uint32_t     MIN_SIZE_LOG2 = 8;
+    static constexpr VkDeviceSize MIN_SIZE      = VkDeviceSize(1) << MIN_SIZE_LOG2;
+    static constexpr uint32_t     SL_LOG2       = 5;
+    static constexpr uint32_t     SL_COUNT      = 1u << SL_LOG2;
+    static constexpr uint32_t     FL_COUNT      = 48;
+
+private:
+    struct Node {
+        VkDeviceSize offset       = 0;
+        VkDeviceSize size         = 0;
+        uint32_t     prevPhysical = INVALID_NODE;
+        uint32_t     nextPhysical = INVALID_NODE;
+        uint32_t     prevFree     = INVALID_NODE;
+        uint32_t     nextFree     = INVALID_NODE;
+        bool         free         = false;
+    };
+
+    std::vector<Node>     mNodes;
+    std::vector<uint32_t> mUnusedNodes;
+
+    uint64_t mFlBitmap           = 0;
+    uint32_t mSlBitmap[FL_COUNT] = {};
+    uint32_t mFreeHeads[FL_COUNT][SL_COUNT];
+
+    VkDeviceSize mCapacity        = 0;
+    VkDeviceSize mUsed            = 0;
+    uint32_t     mAllocationCount = 0;
+
+public:
+    void Initialize(VkDeviceSize capacity) {
+        mNodes.resize(0);
+        mUnusedNodes.resize(0);
+        mFlBitmap = 0;
+        for (uint32_t fl = 0; fl < FL_COUNT; fl++) {
+            mSlBitmap[fl] = 0;
+            for (uint32_t sl = 0; sl < SL_COUNT; sl++) {
+                mFreeHeads[fl][sl] = INVALID_NODE;
+            }
+        }
+
+        // 容量向下对齐到最小粒度, 尾部不足粒度的部分不参与分配
+        mCapacity        = capacity & ~(MIN_SIZE - 1);
+        mUsed            = 0;
+        mAllocationCount = 0;
+
+        uint32_t node       = CreateNode();
+        mNodes[node].offset = 0;
+        mNodes[node].size   = mCapacity;
+        InsertFreeNode(node);
+    }
+
+    VkDeviceSize GetCapacity() const {
+        return mCapacity;
+    }
+
+    VkDeviceSize GetUsed() const {
+        return mUsed;
+    }
+
+    uint32_t GetAllocationCount() const {
+        return mAllocationCount;
+    }
+
+    bool IsEmpty() const {
+        return mAllocationCount == 0;
+    }
+
+    // 最大空闲区间一定位于最高的非空区间中
+    VkDeviceSize GetLargestFreeRange() const {
+        if (mFlBitmap == 0) {
+            return 0;
+        }
+        uint32_t     fl      = 63 - std::countl_zero(mFlBitmap);
+        uint32_t     sl      = 31 - std::countl_zero(mSlBitmap[fl]);
+        VkDeviceSize largest = 0;
+        for (uint32_t node = mFreeHeads[fl][sl]; node != INVALID_NODE; node = mNodes[node].nextFree) {
+            largest = std::max(largest, mNodes[node].size);
+        }
+        return largest;
+    }
+
+    // alignment需要是2的幂
+    bool Allocate(VkDeviceSize size, VkDeviceSize alignment, VkDeviceSize& offset, uint32_t& nodeIndex) {
+        size      = AlignUp(std::max(size, MIN_SIZE), MIN_SIZE);
+        alignment = std::max(alignment, MIN_SIZE);
+
+        // 所有节点偏移都是MIN_SIZE的倍数, 更大的对齐最多需要alignment - MIN_SIZE的前部填充
+        VkDeviceSize searchSize = size + alignment - MIN_SIZE;
+        if (searchSize > mCapacity) {
+            return false;
+        }
+
+        uint32_t fl, sl;
+        MappingSearch(searchSize, fl, sl);
+        uint32_t node = FindSuitableNode(fl, sl);
+        if (node == INVALID_NODE) {
+            return false;
+        }
+        RemoveFreeNode(node);
+
+        // 切出前部填充, 作为新的空闲节点
+        VkDeviceSize alignedOffset = AlignUp(mNodes[node].offset, alignment);
+        if (alignedOffset > mNodes[node].offset) {
+            uint32_t front = SplitFront(node, alignedOffset - mNodes[node].offset);
+            InsertFreeNode(front);
+        }
+
+        // 切出尾部剩余, 作为新的空闲节点
+        if (mNodes[node].size - size >= MIN_SIZE) {
+            uint32_t back = SplitBack(node, size);
+            InsertFreeNode(back);
+        }
+
+        mNodes[node].free = false;
+        mUsed += mNodes[node].size;
+        mAllocationCount++;
+
+        offset    = mNodes[node].offset;
+        nodeIndex = node;
+        return true;
+    }
+
+    void Free(uint32_t node) {
+        mUsed -= mNodes[node].size;
+        mAllocationCount--;
+
+        // 与物理相邻的空闲节点合并
+        uint32_t prev = mNodes[node].prevPhysical;
+        if (prev != INVALID_NODE && mNodes[prev].free) {
+            RemoveFreeNode(prev);
+            node = MergeWithPrevious(node);
+        }
+        uint32_t next = mNodes[node].nextPhysical;
+        if (next != INVALID_NODE && mNodes[next].free) {
+            RemoveFreeNode(next);
+            MergeWithPrevious(next);
+        }
+
+        InsertFreeNode(node);
+    }
+
+private:
+    static void MappingInsert(VkDeviceSize size, uint32_t& fl, uint32_t& sl) {
+        fl = static_cast<uint32_t>(std::bit_width(size)) - 1;
+        sl = static_cast<uint32_t>(size >> (fl - SL_LOG2)) - SL_COUNT;
+    }
+
+    // 向上取整到下一个二级区间, 保证找到的区间中任意节点都足够大
+    static void MappingSearch(VkDeviceSize size, uint32_t& fl, uint32_t& sl) {
+        uint32_t floorLog2 = static_cast<uint32_t>(std::bit_width(size)) - 1;
+        size += (VkDeviceSize(1) << (floorLog2 - SL_LOG2)) - 1;
+        MappingInsert(size, fl, sl);
+    }
+
+    uint32_t FindSuitableNode(uint32_t fl, uint32_t sl) const {
+        if (fl >= FL_COUNT) {
+            return INVALID_NODE;
+        }
+        uint32_t slMap = mSlBitmap[fl] & (~0u << sl);
+        if (slMap == 0) {
+            uint64_t flMap = (fl + 1 < 64) ? mFlBitmap & (~0ull << (fl + 1)) : 0;
+            if (flMap == 0) {
+                return INVALID_NODE;
+            }
+            fl    = static_cast<uint32_t>(std::countr_zero(flMap));
+            slMap = mSlBitmap[fl];
+        }
+        sl = static_cast<uint32_t>(std::countr_zero(slMap));
+        return mFreeHeads[fl][sl];
+    }
+
+    uint32_t CreateNode() {
+        if (!mUnusedNodes.empty()) {
+            uint32_t node = mUnusedNodes.back();
+            mUnusedNodes.pop_back();
+            mNodes[node] = {};
+            return node;
+        }
+        mNodes.emplace_back();
+        return static_cast<uint32_t>(mNodes.size() - 1);
+    }
+
+    void InsertFreeNode(uint32_t node) {
+        uint32_t fl, sl;
+        MappingInsert(mNodes[node].size, fl, sl);
+
+        uint32_t head          = mFreeHeads[fl][sl];
+        mNodes[node].free      = true;
+        mNodes[node].prevFree  = INVALID_NODE;
+        mNodes[node].nextFree  = head;
+        if (head != INVALID_NODE) {
+            mNodes[head].prevFree = node;
+        }
+        mFreeHeads[fl][sl] = node;
+        mSlBitmap[fl] |= 1u << sl;
+        mFlBitmap |= 1ull << fl;
+    }
+
+    void RemoveFreeNode(uint32_t node) {
+        uint32_t fl, sl;
+        MappingInsert(mNodes[node].size, fl, sl);
+
+        uint32_t prev = mNodes[node].prevFree;
+        uint32_t next = mNodes[node].nextFree;
+        if (prev != INVALID_NODE) {
+            mNodes[prev].nextFree = next;
+        } else {
+            mFreeHeads[fl][sl] = next;
+        }
+        if (next != INVALID_NODE) {
+            mNodes[next].prevFree = prev;
+        }
+
+        if (mFreeHeads[fl][sl] == INVALID_NODE) {
+            mSlBitmap[fl] &= ~(1u << sl);
+            if (mSlBitmap[fl] == 0) {
+                mFlBitmap &= ~(1ull << fl);
+            }
+        }
+        mNodes[node].free = false;
+    }
+
+    // 从node前部切出size字节成为新节点, 返回新节点
+    uint32_t SplitFront(uint32_t node, VkDeviceSize size) {
+        uint32_t front = CreateNode();
+        Node&    n     = mNodes[node];
+        Node&    f     = mNodes[front];
+
+        f.offset       = n.offset;
+        f.size         = size;
+        f.prevPhysical = n.prevPhysical;
+        f.nextPhysical = node;
+        if (n.prevPhysical != INVALID_NODE) {
+            mNodes[n.prevPhysical].nextPhysical = front;
+        }
+
+        n.offset += size;
+        n.size -= size;
+        n.prevPhysical = front;
+        return front;
+    }
+
+    // node保留前size字节, 剩余部分成为新节点, 返回新节点
+    uint32_t SplitBack(uint32_t node, VkDeviceSize size) {
+        uint32_t back = CreateNode();
+        Node&    n    = mNodes[node];
+        Node&    b    = mNodes[back];
+
+        b.offset       = n.offset + size;
+        b.size         = n.size - size;
+        b.prevPhysical = node;
+        b.nextPhysical = n.nextPhysical;
+        if (n.nextPhysical != INVALID_NODE) {
+            mNodes[n.nextPhysical].prevPhysical = back;
+        }
+
+        n.size         = size;
+        n.nextPhysical = back;
+        return back;
+    }
+
+    // 将node并入其物理上的前一个节点, 返回合并后的节点
+    uint32_t MergeWithPrevious(uint32_t node) {
+        uint32_t prev = mNodes[node].prevPhysical;
+        uint32_t next = mNodes[node].nextPhysical;
+
+        mNodes[prev].size += mNodes[node].size;
+        mNodes[prev].nextPhysical = next;
+        if (next != INVALID_NODE) {
+            mNodes[next].prevPhysical = prev;
+        }
+
+        mUnusedNodes.push_back(node);
+        return prev;
+    }
+};
+
+//======================================================================================================================================================
+// device memory allocator
+//======================================================================================================================================================
+struct VulkanAllocation {
+    VkDeviceMemory memory          = VK_NULL_HANDLE;
+    VkDeviceSize   offset          = 0;
+    VkDeviceSize   size            = 0;
+    void*          mappedData      = nullptr;
+    uint32_t       memoryTypeIndex = UINT32_MAX;
+
+    // 所属内存池、内存块和TLSF节点, 专用分配时blockIndex为UINT32_MAX
+    uint32_t poolIndex  = UINT32_MAX;
+    uint32_t blockIndex = UINT32_MAX;
+    uint32_t nodeIndex  = TlsfAllocator::INVALID_NODE;
+
+    bool IsValid() const {
+        return memory != VK_NULL_HANDLE;
+    }
+
+    bool IsDedicated() const {
+        return blockIndex == UINT32_MAX;
+    }
+};
+
+struct VulkanMemoryStats {
+    uint32_t     blockCount       = 0; // 大块内存数量
+    uint32_t     dedicatedCount   = 0; // 专用分配数量, 与blockCount之和即vkAllocateMemory的调用次数
+    uint32_t     allocationCount  = 0; // 子分配数量
+    VkDeviceSize bytesAllocated   = 0; // 从驱动申请的总字节数
+    VkDeviceSize bytesUsed        = 0; // 已分配给资源的字节数
+    VkDeviceSize largestFreeRange = 0;
+    float        fragmentation    = 0.0f; // 1 - 最大空闲区间 / 总空闲字节
+};
+
+// 一个内存堆的预算, budget是驱动建议本进程在该堆上使用的上限, usage是本进程在该堆上的实际用量(含驱动内部的分配)
+// 用量接近预算时驱动会开始把内存换出到系统内存, 流式加载应在此之前减少常驻的资源
+struct VulkanHeapBudget {
+    VkDeviceSize      size           = 0;
+    VkMemoryHeapFlags flags          = 0;
+    VkDeviceSize      budget         = 0;
+    VkDeviceSize      usage          = 0;
+    VkDeviceSize      allocatorBytes = 0; // 其中由VulkanMemoryAllocator申请的字节数
+
+    // 距离预算的余量, 已经超出时为0
+    VkDeviceSize GetHeadroom() const {
+        return budget > usage ? budget - usage : 0;
+    }
+};
+
+struct VulkanMemoryBudget {
+    std::array<VulkanHeapBudget, VK_MAX_MEMORY_HEAPS> heaps;
+    uint32_t                                          heapCount  = 0;
+    bool                                              fromDriver = false; // 为false时预算按堆大小估算, 用量只含分配器申请的内存
+
+    // 所有设备本地堆中最小的余量, 流式加载据此决定是否继续加载或开始淘汰
+    VkDeviceSize GetDeviceLocalHeadroom() const {
+        VkDeviceSize headroom = UINT64_MAX;
+        for (uint32_t i = 0; i < heapCount; i++) {
+            if ((heaps[i].flags & VK_MEMORY_HEAP_DEVICE_LOCAL_BIT) != 0) {
+                headroom = std::min(headroom, heaps[i].GetHeadroom());
+            }
+        }
+        return headroom == UINT64_MAX ? 0 : headroom;
+    }
+};
+
+class VulkanMemoryAllocator {
+public:
+    static constexpr VkDeviceSize DEFAULT_BLOCK_SIZE = VkDeviceSize(256) << 20;
+    static constexpr VkDeviceSize SMALL_HEAP_SIZE    = VkDeviceSize(1) << 30;
+
+private:
+    struct MemoryBlock {
+        VkDeviceMemory memory     = VK_NULL_HANDLE;
+        void*          mappedData = nullptr;
+        TlsfAllocator  tlsf;
+    };
+
+    // 每种内存类型两个池, 线性资源与非线性资源分开, 不需要处理bufferImageGranularity的冲突
+    struct MemoryPool {
+        VkDeviceSize                              blockSize = 0;
+        std::vector<std::unique_ptr<MemoryBlock>> blocks;
+    };
+
+    VkDevice                         mDevice             = VK_NULL_HANDLE;
+    VkPhysicalDeviceMemoryProperties mMemoryProperties   = {};
+    VkDeviceSize                     mNonCoherentAtomSize = 1;
+    bool                             mSeparateLinearPools = true;
+
+    MemoryPool mPools[VK_MAX_MEMORY_TYPES * 2];
+
+    uint32_t     mDedicatedCount = 0;
+    VkDeviceSize mDedicatedBytes = 0;
+
+    // 每个堆上从驱动申请的字节数, 没有VK_EXT_memory_budget时用作堆的用量
+    VkDeviceSize mHeapBytes[VK_MAX_MEMORY_HEAPS] = {};
+
+    mutable std::mutex mMutex;
+
+public:
+    VulkanMemoryAllocator() = default;
+
+    VulkanMemoryAllocator(const VulkanMemoryAllocator&)            = delete;
+    VulkanMemoryAllocator& operator=(const VulkanMemoryAllocator&) = delete;
+
+    ~VulkanMemoryAllocator() {
+        Terminate();
+    }
+
+    void Initialize(VkDevice device, const VkPhysicalDeviceMemoryProperties& memoryProperties, const VkPhysicalDeviceLimits& limits) {
+        mDevice              = device;
+        mMemoryProperties    = memoryProperties;
+        mNonCoherentAtomSize = std::max<VkDeviceSize>(limits.nonCoherentAtomSize, 1);
+        // 粒度不超过最小分配粒度时, 线性资源与非线性资源可以共用内存块
+        mSeparateLinearPools = limits.bufferImageGranularity > TlsfAllocator::MIN_SIZE;
+
+        for (uint32_t i = 0; i < mMemoryProperties.memoryTypeCount; i++) {
+            VkDeviceSize heapSize = mMemoryProperties.memoryHeaps[mMemoryProperties.memoryTypes[i].heapIndex].size;
+            // 小堆使用堆大小的1/8作为块大小, 避免一个块占满整个堆
+            VkDeviceSize blockSize = heapSize <= SMALL_HEAP_SIZE ? AlignUp(heapSize / 8, TlsfAllocator::MIN_SIZE) : DEFAULT_BLOCK_SIZE;
+
+            mPools[i * 2].blockSize     = blockSize;
+            mPools[i * 2 + 1].blockSize = blockSize;
+        }
+    }
+
+    // 释放所有内存块, 调用前需要确保设备空闲且资源已销毁
+    void Terminate() {
+        if (mDevice == VK_NULL_HANDLE) {
+            return;
+        }
+        for (uint32_t i = 0; i < std::size(mPools); i++) {
+            for (auto& block: mPools[i].blocks) {
+                if (block != nullptr) {
+                    FreeDeviceMemory(block->memory, mPools[i].blockSize, i / 2);
+                }
+            }
+            mPools[i].blocks.resize(0);
+        }
+        mDedicatedCount = 0;
+        mDedicatedBytes = 0;
+        mDevice         = VK_NULL_HANDLE;
+    }
+
+    // 找到满足requiredFlags的内存类型, 优先同时满足preferredFlags的类型
+    uint32_t FindMemoryType(uint32_t memoryTypeBits, VkMemoryPropertyFlags requiredFlags, VkMemoryPropertyFlags preferredFlags = 0) const {
+        for (VkMemoryPropertyFlags flags: { requiredFlags | preferredFlags, requiredFlags }) {
+            for (uint32_t i = 0; i < mMemoryProperties.memoryTypeCount; i++) {
+                if ((memoryTypeBits & (1u << i)) != 0 && (mMemoryProperties.memoryTypes[i].propertyFlags & flags) == flags) {
+                    return i;
+                }
+            }
+        }
+        return UINT32_MAX;
+    }
+
+    VulkanResult Allocate(
+        const VkMemoryRequirements& requirements,
+        VkMemoryPropertyFlags       requiredFlags,
+        VkMemoryPropertyFlags       preferredFlags,
+        bool                        linearResource,
+        VulkanAllocation&           allocation
+    ) {
+        uint32_t memoryTypeIndex = FindMemoryType(requirements.memoryTypeBits, requiredFlags, preferredFlags);
+        if (memoryTypeIndex == UINT32_MAX) {
+            NOVA_LOG_ERROR(RHI, "Failed to find a suitable memory type: 0x{:x}", requirements.memoryTypeBits);
+            return VK_ERROR_OUT_OF_DEVICE_MEMORY;
+        }
+
+        std::lock_guard<std::mutex> lock(mMutex);
+
+        uint32_t    poolIndex = memoryTypeIndex * 2 + static_cast<uint32_t>(linearResource && mSeparateLinearPools);
+        MemoryPool& pool      = mPools[poolIndex];
+
+        // 超过块大小一半的资源使用专用分配, 不占用内存块
+        if (requirements.size > pool.blockSize / 2) {
+            return AllocateDedicated(requirements.size, memoryTypeIndex, allocation);
+        }
+
+        // 在已有内存块中查找
+        for (uint32_t i = 0; i < pool.blocks.size(); i++) {
+            if (pool.blocks[i] != nullptr && TryAllocateFromBlock(*pool.blocks[i], requirements, allocation)) {
+                allocation.memoryTypeIndex = memoryTypeIndex;
+                allocation.poolIndex       = poolIndex;
+                allocation.blockIndex      = i;
+                return VK_SUCCESS;
+            }
+        }
+
+        // 分配新的内存块, 优先复用空槽位
+        auto     block  = std::make_unique<MemoryBlock>();
+        VkResult result = AllocateDeviceMemory(pool.blockSize, memoryTypeIndex, block->memory, block->mappedData);
+        if (result != VK_SUCCESS) {
+            return result;
+        }
+        block->tlsf.Initialize(pool.blockSize);
+        // 对齐要求很大时空块也可能放不下, 改用专用分配, 专用分配的偏移为0, 满足任意对齐
+        if (!TryAllocateFromBlock(*block, requirements, allocation)) {
+            NOVA_LOG_WARN(
+                RHI, "Allocation of {} bytes aligned to {} does not fit a new memory block", requirements.size, requirements.alignment
+            );
+            FreeDeviceMemory(block->memory, pool.blockSize, memoryTypeIndex);
+            return AllocateDedicated(requirements.size, memoryTypeIndex, allocation);
+        }
+
+        uint32_t blockIndex = 0;
+        while (blockIndex < pool.blocks.size() && pool.blocks[blockIndex] != nullptr) {
+            blockIndex++;
+        }
+        if (blockIndex == pool.blocks.size()) {
+            pool.blocks.emplace_back();
+        }
+        pool.blocks[blockIndex] = std::move(block);
+
+        allocation.memoryTypeIndex = memoryTypeIndex;
+        allocation.poolIndex       = poolIndex;
+        allocation.blockIndex      = blockIndex;
+        return VK_SUCCESS;
+    }
+
+    void Free(VulkanAllocation& allocation) {
+        if (!allocation.IsValid()) {
+            return;
+        }
+
+        std::lock_guard<std::mutex> lock(mMutex);
+
+        if (allocation.IsDedicated()) {
+            FreeDeviceMemory(allocation.memory, allocation.size, allocation.memoryTypeIndex);
+            mDedicatedCount--;
+            mDedicatedBytes -= allocation.size;
+            allocation = {};
+            return;
+        }
+
+        MemoryPool&  pool  = mPools[allocation.poolIndex];
+        MemoryBlock& block = *pool.blocks[allocation.blockIndex];
+        block.tlsf.Free(allocation.nodeIndex);
+
+        // 每个池至多保留一个空块, 避免反复向驱动申请和释放
+        if (block.tlsf.IsEmpty()) {
+            uint32_t emptyBlockCount = 0;
+            for (auto& item: pool.blocks) {
+                emptyBlockCount += static_cast<uint32_t>(item != nullptr && item->tlsf.IsEmpty());
+            }
+            if (emptyBlockCount > 1) {
+                FreeDeviceMemory(block.memory, pool.blockSize, allocation.memoryTypeIndex);
+                pool.blocks[allocation.blockIndex].reset();
+            }
+        }
+
+        allocation = {};
+    }
+
+    VulkanResult CreateBuffer(
+        const VkBufferCreateInfo& createInfo,
+        VkMemoryPropertyFlags     requiredFlags,
+        VkBuffer&                 buffer,
+        VulkanAllocation&         allocation,
+        VkMemoryPropertyFlags     preferredFlags = 0
+    ) {
+        VkResult result = vkCreateBuffer(mDevice, &createInfo, VulkanHostMemory::GetCallbacks(), &buffer);
+        if (result != VK_SUCCESS) {
+            NOVA_LOG_ERROR(RHI, "Failed to create a buffer: {}", int32_t(result));
+            return result;
+        }
+
+        VkMemoryRequirements memoryRequirements;
+        vkGetBufferMemoryRequirements(mDevice, buffer, &memoryRequirements);
+
+        result = Allocate(memoryRequirements, requiredFlags, preferredFlags, true, allocation);
+        if (result != VK_SUCCESS) {
+            vkDestroyBuffer(mDevice, buffer, VulkanHostMemory::GetCallbacks());
+            buffer = VK_NULL_HANDLE;
+            return result;
+        }
+
+        result = vkBindBufferMemory(mDevice, buffer, allocation.memory, allocation.offset);
+        if (result != VK_SUCCESS) {
+            NOVA_LOG_ERROR(RHI, "Failed to bind buffer memory: {}", int32_t(result));
+            DestroyBuffer(buffer, allocation);
+        }
+        return result;
+    }
+
+    VulkanResult CreateImage(
+        const VkImageCreateInfo& createInfo,
+        VkMemoryPropertyFlags    requiredFlags,
+        VkImage&                 image,
+        VulkanAllocation&        allocation,
+        VkMemoryPropertyFlags    preferredFlags = 0
+    ) {
+        VkResult result = vkCreateImage(mDevice, &createInfo, VulkanHostMemory::GetCallbacks(), &image);
+        if (result != VK_SUCCESS) {
+            NOVA_LOG_ERROR(RHI, "Failed to create an image: {}", int32_t(result));
+            return result;
+        }
+
+        VkMemoryRequirements memoryRequirements;
+        vkGetImageMemoryRequirements(mDevice, image, &memoryRequirements);
+
+        bool linearResource = createInfo.tiling == VK_IMAGE_TILING_LINEAR;
+        result              = Allocate(memoryRequirements, requiredFlags, preferredFlags, linearResource, allocation);
+        if (result != VK_SUCCESS) {
+            vkDestroyImage(mDevice, image, VulkanHostMemory::GetCallbacks());
+            image = VK_NULL_HANDLE;
+            return result;
+        }
+
+        result = vkBindImageMemory(mDevice, image, allocation.memory, allocation.offset);
+        if (result != VK_SUCCESS) {
+            NOVA_LOG_ERROR(RHI, "Failed to bind image memory: {}", int32_t(result));
+            DestroyImage(image, allocation);
+        }
+        return result;
+    }
+
+    void DestroyBuffer(VkBuffer& buffer, VulkanAllocation& allocation) {
+        if (buffer != VK_NULL_HANDLE) {
+            vkDestroyBuffer(mDevice, buffer, VulkanHostMemory::GetCallbacks());
+            buffer = VK_NULL_HANDLE;
+        }
+        Free(allocation);
+    }
+
+    void DestroyImage(VkImage& image, VulkanAllocation& allocation) {
+        if (image != VK_NULL_HANDLE) {
+            vkDestroyImage(mDevice, image, VulkanHostMemory::GetCallbacks());
+            image = VK_NULL_HANDLE;
+        }
+        Free(allocation);
+    }
+
+    // 非HOST_COHERENT内存写入后需要刷新, 范围按nonCoherentAtomSize对齐
+    VulkanResult FlushAllocation(const VulkanAllocation& allocation, VkDeviceSize offset = 0, VkDeviceSize size = VK_WHOLE_SIZE) const {
+        if (IsHostCoherent(allocation)) {
+            return VK_SUCCESS;
+        }
+        VkMappedMemoryRange range = MakeMappedRange(allocation, offset, size);
+        return vkFlushMappedMemoryRanges(mDevice, 1, &range);
+    }
+
+    VulkanResult InvalidateAllocation(const VulkanAllocation& allocation, VkDeviceSize offset = 0, VkDeviceSize size = VK_WHOLE_SIZE) const {
+        if (IsHostCoherent(allocation)) {
+            return VK_SUCCESS;
+        }
+        VkMappedMemoryRange range = MakeMappedRange(allocation, offset, size);
+        return vkInvalidateMappedMemoryRanges(mDevice, 1, &range);
+    }
+
+    VulkanMemoryStats GetStats() const {
+        std::lock_guard<std::mutex> lock(mMutex);
+
+        VulkanMemoryStats stats;
+        VkDeviceSize      totalFree = 0;
+        for (auto& pool: mPools) {
+            for (auto& block: pool.blocks) {
+                if (block == nullptr) {
+                    continue;
+                }
+                stats.blockCount++;
+                stats.allocationCount += block->tlsf.GetAllocationCount();
+                stats.bytesAllocated += block->tlsf.GetCapacity();
+                stats.bytesUsed += block->tlsf.GetUsed();
+                stats.largestFreeRange = std::max(stats.largestFreeRange, block->tlsf.GetLargestFreeRange());
+                totalFree += block->tlsf.GetCapacity() - block->tlsf.GetUsed();
+            }
+        }
+        stats.dedicatedCount = mDedicatedCount;
+        stats.allocationCount += mDedicatedCount;
+        stats.bytesAllocated += mDedicatedBytes;
+        stats.bytesUsed += mDedicatedBytes;
+        stats.fragmentation = totalFree > 0 ? 1.0f - float(stats.largestFreeRange) / float(totalFree) : 0.0f;
+        return stats;
+    }
+
+    // 内存块和专用分配在该堆上占用的字节数
+    VkDeviceSize GetHeapBytes(uint32_t heapIndex) const {
+        std::lock_guard<std::mutex> lock(mMutex);
+        return heapIndex < VK_MAX_MEMORY_HEAPS ? mHeapBytes[heapIndex] : 0;
+    }
+
+private:
+    bool IsHostCoherent(const VulkanAllocation& allocation) const {
+        return (mMemoryProperties.memoryTypes[allocation.memoryTypeIndex].propertyFlags & VK_MEMORY_PROPERTY_HOST_COHERENT_BIT) != 0;
+    }
+
+    VkMappedMemoryRange MakeMappedRange(const VulkanAllocation& allocation, VkDeviceSize offset, VkDeviceSize size) const {
+        if (size == VK_WHOLE_SIZE) {
+            size = allocation.size - offset;
+        }
+        VkDeviceSize begin = (allocation.offset + offset) & ~(mNonCoherentAtomSize - 1);
+        VkDeviceSize end   = AlignUp(allocation.offset + offset + size, mNonCoherentAtomSize);
+        return {
+            .sType  = VK_STRUCTURE_TYPE_MAPPED_MEMORY_RANGE,
+            .memory = allocation.memory,
+            .offset = begin,
+            .size   = end - begin,
+        };
+    }
+
+    bool TryAllocateFromBlock(MemoryBlock& block, const VkMemoryRequirements& requirements, VulkanAllocation& allocation) {
+        VkDeviceSize offset;
+        uint32_t     node;
+        if (!block.tlsf.Allocate(requirements.size, requirements.alignment, offset, node)) {
+            return false;
+        }
+        allocation.memory     = block.memory;
+        allocation.offset     = offset;
+        allocation.size       = requirements.size;
+        allocation.mappedData = block.mappedData != nullptr ? static_cast<uint8_t*>(block.mappedData) + offset : nullptr;
+        allocation.nodeIndex  = node;
+        return true;
+    }
+
+    VulkanResult AllocateDedicated(VkDeviceSize size, uint32_t memoryTypeIndex, VulkanAllocation& allocation) {
+        VkResult result = AllocateDeviceMemory(size, memoryTypeIndex, allocation.memory, allocation.mappedData);
+        if (result != VK_SUCCESS) {
+            return result;
+        }
+        allocation.offset          = 0;
+        allocation.size            = size;
+        allocation.memoryTypeIndex = memoryTypeIndex;
+        allocation.poolIndex       = UINT32_MAX;
+        allocation.blockIndex      = UINT32_MAX;
+        mDedicatedCount++;
+        mDedicatedBytes += size;
+        return VK_SUCCESS;
+    }
+
+    // 主机可见的内存在分配后立即持久映射
+    VkResult AllocateDeviceMemory(VkDeviceSize size, uint32_t memoryTypeIndex, VkDeviceMemory& memory, void*& mappedData) {
+        VkMemoryAllocateInfo memoryAllocateInfo = {
+            .sType           = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO,
+            .allocationSize  = size,
+            .memoryTypeIndex = memoryTypeIndex,
+        };
+        VkResult result = vkAllocateMemory(mDevice, &memoryAllocateInfo, VulkanHostMemory::GetCallbacks(), &memory);
+        if (result != VK_SUCCESS) {
+            NOVA_LOG_ERROR(RHI, "Failed to allocate device memory: {}", int32_t(result));
+            return result;
+        }
+
+        mappedData = nullptr;
+        if ((mMemoryProperties.memoryTypes[memoryTypeIndex].propertyFlags & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT) != 0) {
+            result = vkMapMemory(mDevice, memory, 0, VK_WHOLE_SIZE, 0, &mappedData);
+            if (result != VK_SUCCESS) {
+                NOVA_LOG_ERROR(RHI, "Failed to map device memory: {}", int32_t(result));
+                vkFreeMemory(mDevice, memory, VulkanHostMemory::GetCallbacks());
+                memory = VK_NULL_HANDLE;
+                return result;
+            }
+        }
+        mHeapBytes[mMemoryProperties.memoryTypes[memoryTypeIndex].heapIndex] += size;
+        return VK_SUCCESS;
+    }
+
+    void FreeDeviceMemory(VkDeviceMemory memory, VkDeviceSize size, uint32_t memoryTypeIndex) {
+        vkFreeMemory(mDevice, memory, VulkanHostMemory::GetCallbacks());
+        mHeapBytes[mMemoryProperties.memoryTypes[memoryTypeIndex].heapIndex] -= size;
+    }
+};
+
+//======================================================================================================================================================
+// linear allocator, 每个飞行帧一段区域, 用于逐帧的临时数据
+//======================================================================================================================================================
+struct VulkanTransientAllocation {
+    VkBuffer     buffer     = VK_NULL_HANDLE;
+    VkDeviceSize offset     = 0;
+    void*        mappedData = nullptr;
+};
+
+class VulkanLinearAllocator {
+private:
+    VulkanMemoryAllocator* mAllocator = nullptr;
+
+    VkBuffer         mBuffer     = VK_NULL_HANDLE;
+    VulkanAllocation mAllocation = {};
+
+    VkDeviceSize mFrameCapacity = 0;
+    VkDeviceSize mFrameBase     = 0;
+
+    std::atomic<VkDeviceSize> mCursor = 0;
+
+public:
+    VulkanLinearAllocator() = default;
+
+    VulkanLinearAllocator(const VulkanLinearAllocator&)            = delete;
+    VulkanLinearAllocator& operator=(const VulkanLinearAllocator&) = delete;
+
+    VkBuffer GetBuffer() const {
+        return mBuffer;
+    }
+
+    VkDeviceSize GetFrameCapacity() const {
+        return mFrameCapacity;
+    }
+
+    VkDeviceSize GetFrameUsed() const {
+        return mCursor.load(std::memory_order_relaxed);
+    }
+
+    VulkanResult Initialize(VulkanMemoryAllocator& allocator, VkDeviceSize frameCapacity, uint32_t frameCount, VkBufferUsageFlags usage) {
+        mAllocator     = &allocator;
+        mFrameCapacity = AlignUp(frameCapacity, TlsfAllocator::MIN_SIZE);
+
+        VkBufferCreateInfo bufferCreateInfo = {
+            .sType       = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO,
+            .size        = mFrameCapacity * frameCount,
+            .usage       = usage,
+            .sharingMode = VK_SHARING_MODE_EXCLUSIVE,
+        };
+        // 优先选择设备本地且主机可见的内存, CPU直接写入GPU读取
+        return mAllocator->CreateBuffer(
+            bufferCreateInfo,
+            VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+            mBuffer,
+            mAllocation,
+            VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT
+        );
+    }
+
+    void Terminate() {
+        if (mAllocator != nullptr) {
+            mAllocator->DestroyBuffer(mBuffer, mAllocation);
+            mAllocator = nullptr;
+        }
+    }
+
+    // 帧栅栏等待完成后调用, 该帧区域中的数据已不再被GPU使用
+    void BeginFrame(uint32_t frameIndex) {
+        mFrameBase = mFrameCapacity * frameIndex;
+        mCursor.store(0, std::memory_order_relaxed);
+    }
+
+    // 无锁的指针递增分配, 可以在多个线程中同时调用
+    bool Allocate(VkDeviceSize size, VkDeviceSize alignment, VulkanTransientAllocation& allocation) {
+        VkDeviceSize cursor = mCursor.load(std::memory_order_relaxed);
+        VkDeviceSize aligned, end;
+        do {
+            aligned = AlignUp(mFrameBase + cursor, alignment) - mFrameBase;
+            end     = aligned + size;
+            if (end > mFrameCapacity) {
+                return false;
+            }
+        } while (!mCursor.compare_exchange_weak(cursor, end, std::memory_order_relaxed));
+
+        allocation.buffer     = mBuffer;
+        allocation.offset     = mFrameBase + aligned;
+        allocation.mappedData = static_cast<uint8_t*>(mAllocation.mappedData) + allocation.offset;
+        return true;
+    }
+};
+} // namespace Nova
@@ -0,0 +1,202 @@
+#pragma once
+#include "VulkanHostMemory.h"
+#include "VulkanResult.h"
+
+#include "Core/JobSystem.h"
+
+#include <atomic>
+#include <chrono>
+
+namespace Nova {
+
+// 在作业系统上并行录制二级命令缓冲
+// 作业系统的每个线程在每个飞行帧有独立的命令池, 录制时无需加锁; 录制结果按批次顺序在主命令缓冲中执行, 与线程调度无关
+// 作业系统未初始化时批次在调用Record的线程上直接执行, 该线程使用单独的命令池, 不与作业系统的0号线程(主线程)共用
+class VulkanParallelRecorder {
+public:
+    // 录制[begin, end)范围内的绘制, threadIndex为作业系统的线程下标, 不属于作业系统的线程为GetThreadCount()
+    using RecordFunction = std::function<void(VkCommandBuffer commandBuffer, uint32_t threadIndex, uint32_t begin, uint32_t end)>;
+
+    // 每个线程分到的批次数, 批次越多负载越均衡, 但vkCmdExecuteCommands的开销越大
+    static constexpr uint32_t BATCHES_PER_THREAD = 4;
+
+private:
+    struct ThreadContext {
+        VkCommandPool                commandPool = VK_NULL_HANDLE;
+        std::vector<VkCommandBuffer> commandBuffers;
+        uint32_t                     usedCount = 0;
+    };
+
+    VkDevice mDevice      = VK_NULL_HANDLE;
+    uint32_t mFrameCount  = 0;
+    uint32_t mThreadCount = 0;
+    uint32_t mFrameIndex  = 0;
+
+    // 下标为 frameIndex * (threadCount + 1) + threadIndex, 每帧最后一个命令池属于作业系统之外的线程
+    std::vector<ThreadContext> mThreadContexts;
+
+    // 按批次下标保存录制结果
+    std::vector<VkCommandBuffer> mBatchCommandBuffers;
+    std::atomic<int32_t>         mError = VK_SUCCESS;
+
+    double mLastRecordMilliseconds = 0.0;
+
+public:
+    VulkanParallelRecorder() = default;
+
+    VulkanParallelRecorder(const VulkanParallelRecorder&)            = delete;
+    VulkanParallelRecorder& operator=(const VulkanParallelRecorder&) = delete;
+
+    ~VulkanParallelRecorder() {
+        Terminate();
+    }
+
+    uint32_t GetThreadCount() const {
+        return mThreadCount;
+    }
+
+    // 上一次Record从开始到所有批次录制完成的CPU时间
+    double GetLastRecordMilliseconds() const {
+        return mLastRecordMilliseconds;
+    }
+
+    // 需要在作业系统初始化之后调用, 命令池的数量为作业系统的线程数加一; 之后作业系统重新初始化时线程数不能增加
+    VulkanResult Initialize(VkDevice device, uint32_t queueFamilyIndex, uint32_t frameCount) {
+        mDevice      = device;
+        mFrameCount  = frameCount;
+        mThreadCount = std::max(1u, JobSystem::Singleton().GetThreadCount());
+
+        VkCommandPoolCreateInfo commandPoolCreateInfo = {
+            .sType            = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO,
+            .flags            = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT,
+            .queueFamilyIndex = queueFamilyIndex,
+        };
+
+        mThreadContexts.resize(mFrameCount * GetContextsPerFrame());
+        for (auto& context: mThreadContexts) {
+            VkResult result = vkCreateCommandPool(mDevice, &commandPoolCreateInfo, VulkanHostMemory::GetCallbacks(), &context.commandPool);
+            if (result != VK_SUCCESS) {
+                NOVA_LOG_ERROR(RHI, "Failed to create a recording command pool: {}", int32_t(result));
+                return result;
+            }
+        }
+        return VK_SUCCESS;
+    }
+
+    // 调用前需要确保所有帧的命令缓冲都已执行完毕
+    void Terminate() {
+        for (auto& context: mThreadContexts) {
+            if (context.commandPool != VK_NULL_HANDLE) {
+                vkDestroyCommandPool(mDevice, context.commandPool, VulkanHostMemory::GetCallbacks());
+            }
+        }
+        mThreadContexts.resize(0);
+    }
+
+    // 在该帧的栅栏等待完成后调用, 整体重置该帧所有线程的命令池
+    VulkanResult BeginFrame(uint32_t frameIndex) {
+        mFrameIndex = frameIndex;
+        for (uint32_t i = 0; i < GetContextsPerFrame(); i++) {
+            ThreadContext& context = mThreadContexts[mFrameIndex * GetContextsPerFrame() + i];
+
+            VkResult result = vkResetCommandPool(mDevice, context.commandPool, 0);
+            if (result != VK_SUCCESS) {
+                NOVA_LOG_ERROR(RHI, "Failed to reset a recording command pool: {}", int32_t(result));
+                return result;
+            }
+            context.usedCount = 0;
+        }
+        return VK_SUCCESS;
+    }
+
+    // 并行录制itemCount个绘制并在primaryCommandBuffer中按顺序执行
+    // 在渲染通道内录制时primaryCommandBuffer需要已经开始渲染通道(SECONDARY_COMMAND_BUFFERS)或动态渲染(CONTENTS_SECONDARY_COMMAND_BUFFERS_BIT),
+    // 动态渲染时inheritanceInfo.pNext需要链接VkCommandBufferInheritanceRenderingInfo; 两者都没有时按渲染通道外的命令(拷贝、填充等)录制
+    VulkanResult Record(
+        VkCommandBuffer                       primaryCommandBuffer,
+        uint32_t                              itemCount,
+        const VkCommandBufferInheritanceInfo& inheritanceInfo,
+        const RecordFunction&                 recordFunction
+    ) {
+        if (itemCount == 0) {
+            return VK_SUCCESS;
+        }
+
+        auto startTime = std::chrono::steady_clock::now();
+
+        uint32_t batchCount = std::min(itemCount, mThreadCount * BATCHES_PER_THREAD);
+        uint32_t batchSize  = (itemCount + batchCount - 1) / batchCount;
+        batchCount          = (itemCount + batchSize - 1) / batchSize;
+        mBatchCommandBuffers.resize(batchCount);
+        mError.store(VK_SUCCESS, std::memory_order_relaxed);
+
+        VkCommandBufferUsageFlags usageFlags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+        if (inheritanceInfo.renderPass != VK_NULL_HANDLE || inheritanceInfo.pNext != nullptr) {
+            usageFlags |= VK_COMMAND_BUFFER_USAGE_RENDER_PASS_CONTINUE_BIT;
+        }
+        VkCommandBufferBeginInfo commandBufferBeginInfo = {
+            .sType            = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO,
+            .flags            = usageFlags,
+            .pInheritanceInfo = &inheritanceInfo,
+        };
+
+        // 调用线程在等待期间也会领取批次进行录制
+        JobSystem::Singleton().ParallelFor(itemCount, batchSize, [&](uint32_t begin, uint32_t end) {
+            // 作业系统未初始化时作业在调用线程上直接执行
+            uint32_t threadIndex = JobSystem::GetThreadIndex();
+            if (threadIndex == JobSystem::INVALID_THREAD_INDEX) {
+                threadIndex = mThreadCount;
+            }
+
+            VkCommandBuffer commandBuffer = AcquireCommandBuffer(mThreadContexts[mFrameIndex * GetContextsPerFrame() + threadIndex]);
+            if (commandBuffer == VK_NULL_HANDLE) {
+                return;
+            }
+
+            vkBeginCommandBuffer(commandBuffer, &commandBufferBeginInfo);
+            recordFunction(commandBuffer, threadIndex, begin, end);
+            VkResult result = vkEndCommandBuffer(commandBuffer);
+            if (result != VK_SUCCESS) {
+                mError.store(result, std::memory_order_relaxed);
+            }
+
+            mBatchCommandBuffers[begin / batchSize] = commandBuffer;
+        });
+
+        mLastRecordMilliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - startTime).count();
+
+        VkResult result = static_cast<VkResult>(mError.load(std::memory_order_relaxed));
+        if (result != VK_SUCCESS) {
+            return result;
+        }
+
+        vkCmdExecuteCommands(primaryCommandBuffer, batchCount, mBatchCommandBuffers.data());
+        return VK_SUCCESS;
+    }
+
+private:
+    uint32_t GetContextsPerFrame() const {
+        return mThreadCount + 1;
+    }
+
+    VkCommandBuffer AcquireCommandBuffer(ThreadContext& context) {
+        if (context.usedCount == context.commandBuffers.size()) {
+            VkCommandBufferAllocateInfo commandBufferAllocateInfo = {
+                .sType              = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO,
+                .commandPool        = context.commandPool,
+                .level              = VK_COMMAND_BUFFER_LEVEL_SECONDARY,
+                .commandBufferCount = 1,
+            };
+            VkCommandBuffer commandBuffer = VK_NULL_HANDLE;
+            VkResult        result        = vkAllocateCommandBuffers(mDevice, &commandBufferAllocateInfo, &commandBuffer);
+            if (result != VK_SUCCESS) {
+                NOVA_LOG_ERROR(RHI, "Failed to allocate a secondary command buffer: {}", int32_t(result));
+                mError.store(result, std::memory_order_relaxed);
+                return VK_NULL_HANDLE;
+            }
+            context.commandBuffers.push_back(commandBuffer);
+        }
+        return context.commandBuffers[context.usedCount++];
+    }
+};
+} // namespace Nova
@@ -0,0 +1,257 @@
+#pragma once
+#include "VulkanHostMemory.h"
+#include "VulkanResult.h"
+
+#include <chrono>
+#include <filesystem>
+#include <format>
+#include <mutex>
+
+namespace Nova {
+
+// 磁盘上的管线缓存文件 = NovaHeader + 驱动返回的缓存数据
+// 驱动对损坏的缓存数据不一定健壮, 因此额外记录数据大小和校验和
+class VulkanPipelineCache {
+public:
+    // 默认按厂商和设备ID区分缓存文件, 多个GPU同时运行或更换GPU时不会互相覆盖
+    static std::filesystem::path GetDefaultPath(const VkPhysicalDeviceProperties& properties) {
+        return std::format("Cache/PipelineCache_{:04x}_{:04x}.bin", properties.vendorID, properties.deviceID);
+    }
+
+private:
+    struct NovaHeader {
+        uint32_t magic    = MAGIC;
+        uint32_t version  = VERSION;
+        uint64_t dataSize = 0;
+        uint64_t checksum = 0;
+    };
+
+    static constexpr uint32_t MAGIC   = 0x4350564E; // "NVPC"
+    static constexpr uint32_t VERSION = 1;
+
+    VkDevice                   mDevice           = VK_NULL_HANDLE;
+    VkPhysicalDeviceProperties mDeviceProperties = {};
+    std::filesystem::path      mPath;
+
+    VkPipelineCache mCache = VK_NULL_HANDLE;
+
+    // 每个录制线程一个缓存, 创建管线时无需在驱动内部加锁, 保存时合并
+    std::vector<VkPipelineCache> mThreadCaches;
+    std::mutex                   mMutex;
+
+    bool   mLoadedFromDisk   = false;
+    size_t mLoadedBytes      = 0;
+    double mLoadMilliseconds = 0.0;
+
+public:
+    VulkanPipelineCache() = default;
+
+    VulkanPipelineCache(const VulkanPipelineCache&)            = delete;
+    VulkanPipelineCache& operator=(const VulkanPipelineCache&) = delete;
+
+    VkPipelineCache GetCache() const {
+        return mCache;
+    }
+
+    // 是否从磁盘加载了有效的缓存(即热启动)
+    bool IsLoadedFromDisk() const {
+        return mLoadedFromDisk;
+    }
+
+    size_t GetLoadedBytes() const {
+        return mLoadedBytes;
+    }
+
+    double GetLoadMilliseconds() const {
+        return mLoadMilliseconds;
+    }
+
+    VulkanResult Initialize(VkDevice device, const VkPhysicalDeviceProperties& deviceProperties, const std::filesystem::path& path) {
+        mDevice           = device;
+        mDeviceProperties = deviceProperties;
+        mPath             = path;
+
+        auto              startTime = std::chrono::steady_clock::now();
+        std::vector<char> data      = LoadCacheData();
+
+        VkPipelineCacheCreateInfo pipelineCacheCreateInfo = {
+            .sType           = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO,
+            .initialDataSize = data.size(),
+            .pInitialData    = data.empty() ? nullptr : data.data(),
+        };
+        VkResult result = vkCreatePipelineCache(mDevice, &pipelineCacheCreateInfo, VulkanHostMemory::GetCallbacks(), &mCache);
+        // 驱动仍然拒绝缓存数据时, 退回到空缓存
+        if (result != VK_SUCCESS && !data.empty()) {
+            NOVA_LOG_WARN(RHI, "Pipeline cache data rejected by the driver: {}", int32_t(result));
+            data.clear();
+            pipelineCacheCreateInfo.initialDataSize = 0;
+            pipelineCacheCreateInfo.pInitialData    = nullptr;
+
+            result = vkCreatePipelineCache(mDevice, &pipelineCacheCreateInfo, VulkanHostMemory::GetCallbacks(), &mCache);
+        }
+        if (result != VK_SUCCESS) {
+            NOVA_LOG_ERROR(RHI, "Failed to create a pipeline cache: {}", int32_t(result));
+            return result;
+        }
+
+        mLoadedFromDisk   = !data.empty();
+        mLoadedBytes      = data.size();
+        mLoadMilliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - startTime).count();
+
+        NOVA_LOG_INFO(RHI, "Pipeline cache: {} ({} bytes, {:.2f} ms)", mLoadedFromDisk ? "warm" : "cold", mLoadedBytes, mLoadMilliseconds);
+        return VK_SUCCESS;
+    }
+
+    // 获取线程专用的缓存, threadIndex在录制线程之间唯一
+    VkPipelineCache GetThreadCache(uint32_t threadIndex) {
+        std::lock_guard<std::mutex> lock(mMutex);
+
+        if (threadIndex >= mThreadCaches.size()) {
+            mThreadCaches.resize(threadIndex + 1, VK_NULL_HANDLE);
+        }
+        if (mThreadCaches[threadIndex] == VK_NULL_HANDLE) {
+            VkPipelineCacheCreateInfo pipelineCacheCreateInfo = { .sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO };
+            VkResult result = vkCreatePipelineCache(mDevice, &pipelineCacheCreateInfo, VulkanHostMemory::GetCallbacks(), &mThreadCaches[threadIndex]);
+            if (result != VK_SUCCESS) {
+                NOVA_LOG_ERROR(RHI, "Failed to create a thread pipeline cache: {}", int32_t(result));
+                // 退回到共享缓存, 管线缓存本身是线程安全的
+                return mCache;
+            }
+        }
+        return mThreadCaches[threadIndex];
+    }
+
+    // 合并线程缓存并原子地写入磁盘: 先写临时文件再重命名, 中途崩溃不会留下半个文件
+    VulkanResult Save() {
+        if (mCache == VK_NULL_HANDLE) {
+            return VK_SUCCESS;
+        }
+
+        std::lock_guard<std::mutex> lock(mMutex);
+
+        std::vector<VkPipelineCache> sourceCaches;
+        for (auto cache: mThreadCaches) {
+            if (cache != VK_NULL_HANDLE) {
+                sourceCaches.push_back(cache);
+            }
+        }
+        if (!sourceCaches.empty()) {
+            VkResult result = vkMergePipelineCaches(mDevice, mCache, static_cast<uint32_t>(sourceCaches.size()), sourceCaches.data());
+            if (result != VK_SUCCESS) {
+                NOVA_LOG_ERROR(RHI, "Failed to merge pipeline caches: {}", int32_t(result));
+            }
+        }
+
+        size_t   dataSize = 0;
+        VkResult result   = vkGetPipelineCacheData(mDevice, mCache, &dataSize, nullptr);
+        if (result != VK_SUCCESS) {
+            NOVA_LOG_ERROR(RHI, "Failed to get the pipeline cache size: {}", int32_t(result));
+            return result;
+        }
+        std::vector<char> data(dataSize);
+        result = vkGetPipelineCacheData(mDevice, mCache, &dataSize, data.data());
+        if (result != VK_SUCCESS) {
+            NOVA_LOG_ERROR(RHI, "Failed to get the pipeline cache data: {}", int32_t(result));
+            return result;
+        }
+        data.resize(dataSize);
+
+        NovaHeader header = { .dataSize = dataSize, .checksum = Checksum(data) };
+
+        std::error_code errorCode;
+        if (mPath.has_parent_path()) {
+            std::filesystem::create_directories(mPath.parent_path(), errorCode);
+        }
+
+        std::filesystem::path temporaryPath = mPath;
+        temporaryPath += ".tmp";
+        // 关闭时才会把缓冲的数据写出, 关闭失败(如磁盘已满)时不能用不完整的文件替换旧缓存
+        std::ofstream file(temporaryPath, std::ios::binary | std::ios::trunc);
+        file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        file.write(data.data(), static_cast<std::streamsize>(data.size()));
+        file.close();
+        if (file.fail()) {
+            NOVA_LOG_ERROR(RHI, "Failed to write the pipeline cache: {}", temporaryPath.string());
+            std::filesystem::remove(temporaryPath, errorCode);
+            return VK_ERROR_INITIALIZATION_FAILED;
+        }
+
+        std::filesystem::rename(temporaryPath, mPath, errorCode);
+        if (errorCode) {
+            NOVA_LOG_ERROR(RHI, "Failed to replace the pipeline cache: {}", errorCode.message());
+            std::filesystem::remove(temporaryPath, errorCode);
+            return VK_ERROR_INITIALIZATION_FAILED;
+        }
+        return VK_SUCCESS;
+    }
+
+    // 保存并销毁所有缓存, 需要在销毁逻辑设备之前调用
+    void Terminate() {
+        if (mCache == VK_NULL_HANDLE) {
+            return;
+        }
+        Save().Ignore();
+
+        for (auto cache: mThreadCaches) {
+            if (cache != VK_NULL_HANDLE) {
+                vkDestroyPipelineCache(mDevice, cache, VulkanHostMemory::GetCallbacks());
+            }
+        }
+        mThreadCaches.resize(0);
+
+        vkDestroyPipelineCache(mDevice, mCache, VulkanHostMemory::GetCallbacks());
+        mCache  = VK_NULL_HANDLE;
+        mDevice = VK_NULL_HANDLE;
+    }
+
+private:
+    // FNV-1a
+    static uint64_t Checksum(const std::vector<char>& data) {
+        uint64_t hash = 0xcbf29ce484222325ull;
+        for (char c: data) {
+            hash = (hash ^ static_cast<uint8_t>(c)) * 0x100000001b3ull;
+        }
+        return hash;
+    }
+
+    // 读取并校验缓存文件, 任何不匹配都返回空数据
+    std::vector<char> LoadCacheData() const {
+        std::ifstream file(mPath, std::ios::binary | std::ios::ate);
+        if (!file.is_open()) {
+            return {};
+        }
+
+        auto fileSize = static_cast<size_t>(file.tellg());
+        if (fileSize < sizeof(NovaHeader) + sizeof(VkPipelineCacheHeaderVersionOne)) {
+            return {};
+        }
+        file.seekg(0);
+
+        NovaHeader header;
+        file.read(reinterpret_cast<char*>(&header), sizeof(header));
+        if (header.magic != MAGIC || header.version != VERSION || header.dataSize != fileSize - sizeof(NovaHeader)) {
+            NOVA_LOG_WARN(RHI, "Pipeline cache file is corrupted, ignored");
+            return {};
+        }
+
+        std::vector<char> data(header.dataSize);
+        file.read(data.data(), static_cast<std::streamsize>(data.size()));
+        if (!file.good() || Checksum(data) != header.checksum) {
+            NOVA_LOG_WARN(RHI, "Pipeline cache checksum mismatch, ignored");
+            return {};
+        }
+
+        // 校验驱动的缓存头, 换了显卡或驱动后旧缓存无效
+        VkPipelineCacheHeaderVersionOne cacheHeader;
+        std::memcpy(&cacheHeader, data.data(), sizeof(cacheHeader));
+        if (cacheHeader.headerSize < sizeof(cacheHeader) || cacheHeader.headerVersion != VK_PIPELINE_CACHE_HEADER_VERSION_ONE ||
+            cacheHeader.vendorID != mDeviceProperties.vendorID || cacheHeader.deviceID != mDeviceProperties.deviceID ||
+            std::memcmp(cacheHeader.pipelineCacheUUID, mDeviceProperties.pipelineCacheUUID, VK_UUID_SIZE) != 0) {
+            NOVA_LOG_WARN(RHI, "Pipeline cache was created by another device or driver, ignored");
+            return {};
+        }
+
+        return data;
+    }
+};
+} // namespace Nova
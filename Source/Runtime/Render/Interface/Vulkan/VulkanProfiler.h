@@ -0,0 +1,562 @@
+#pragma once
+#include "VulkanHostMemory.h"
+#include "VulkanResult.h"
+
+#include "Core/JobSystem.h"
+#include "Core/ScratchArena.h"
+
+#include <chrono>
+#include <deque>
+#include <filesystem>
+#include <functional>
+#include <mutex>
+#include <string_view>
+
+namespace Nova {
+
+struct VulkanPipelineStatistics {
+    uint64_t inputAssemblyVertices     = 0;
+    uint64_t vertexShaderInvocations   = 0;
+    uint64_t clippingPrimitives        = 0;
+    uint64_t fragmentShaderInvocations = 0;
+    uint64_t computeShaderInvocations  = 0;
+};
+
+struct VulkanGpuScopeResult {
+    std::string_view         name;
+    uint32_t                 depth         = 0;
+    double                   beginMs       = 0.0; // 相对本帧第一个时间戳
+    double                   durationMs    = 0.0;
+    bool                     hasStatistics = false;
+    VulkanPipelineStatistics statistics;
+};
+
+struct VulkanCpuScopeResult {
+    std::string_view name;
+    uint32_t         threadIndex = 0;
+    double           beginMs     = 0.0; // 相对BeginFrame
+    double           durationMs  = 0.0;
+};
+
+struct VulkanProfileFrame {
+    uint64_t                          frameNumber = 0;
+    double                            gpuMs       = 0.0;
+    double                            cpuMs       = 0.0;
+    std::vector<VulkanGpuScopeResult> gpuScopes;
+    std::vector<VulkanCpuScopeResult> cpuScopes;
+};
+
+// GPU时间戳和管线统计分析器
+// 每个飞行帧有独立的查询池, BeginFrame在帧栅栏等待之后读取该飞行帧上一次的结果, 因此结果总是滞后飞行帧数个帧, 读取不会阻塞
+// 管线统计查询不能嵌套, 只对最外层的作用域收集
+class VulkanProfiler {
+public:
+    static constexpr uint32_t MAX_SCOPES = 256;
+
+private:
+    // 每帧的开始和结束时间戳占用最后两个查询
+    static constexpr uint32_t FRAME_QUERY       = MAX_SCOPES * 2;
+    static constexpr uint32_t TIMESTAMP_QUERIES = MAX_SCOPES * 2 + 2;
+    static constexpr uint32_t STATISTICS_COUNT  = 5;
+    static constexpr uint32_t INVALID_SCOPE     = UINT32_MAX;
+
+    static constexpr VkQueryPipelineStatisticFlags STATISTICS_FLAGS =
+        VK_QUERY_PIPELINE_STATISTIC_INPUT_ASSEMBLY_VERTICES_BIT | VK_QUERY_PIPELINE_STATISTIC_VERTEX_SHADER_INVOCATIONS_BIT |
+        VK_QUERY_PIPELINE_STATISTIC_CLIPPING_PRIMITIVES_BIT | VK_QUERY_PIPELINE_STATISTIC_FRAGMENT_SHADER_INVOCATIONS_BIT |
+        VK_QUERY_PIPELINE_STATISTIC_COMPUTE_SHADER_INVOCATIONS_BIT;
+
+    struct GpuScope {
+        uint32_t nameId          = 0;
+        uint32_t depth           = 0;
+        uint32_t statisticsQuery = INVALID_SCOPE;
+    };
+
+    struct CpuScope {
+        uint32_t                              nameId      = 0;
+        uint32_t                              threadIndex = 0;
+        std::chrono::steady_clock::time_point begin;
+        std::chrono::steady_clock::time_point end;
+    };
+
+    struct FrameSlot {
+        VkQueryPool timestampPool  = VK_NULL_HANDLE;
+        VkQueryPool statisticsPool = VK_NULL_HANDLE;
+
+        std::vector<GpuScope> gpuScopes;
+        uint32_t              statisticsCount = 0;
+        std::vector<CpuScope> cpuScopes;
+
+        uint64_t                              frameNumber = 0;
+        std::chrono::steady_clock::time_point cpuBegin;
+        std::chrono::steady_clock::time_point cpuEnd;
+        bool                                  submitted = false;
+    };
+
+    static constexpr uint64_t NO_FRAME_NUMBER = UINT64_MAX;
+
+    struct TraceEvent {
+        uint32_t nameId;
+        uint32_t pid;
+        uint32_t tid;
+        double   beginUs;
+        double   durationUs;
+        uint64_t frameNumber = NO_FRAME_NUMBER; // 帧事件的帧号, 作为事件参数写出, 不为每帧驻留一个名称
+    };
+
+    // 查找时直接使用string_view, 已经驻留的名称不再构造std::string
+    struct NameHash {
+        using is_transparent = void;
+
+        size_t operator()(std::string_view name) const noexcept {
+            return std::hash<std::string_view> {}(name);
+        }
+    };
+
+    VkDevice mDevice              = VK_NULL_HANDLE;
+    double   mTimestampPeriod     = 1.0; // 每个时间戳刻度的纳秒数
+    uint64_t mTimestampMask       = 0;
+    bool     mStatisticsRequested = false;
+    bool     mStatisticsEnabled   = false;
+
+    std::vector<FrameSlot> mSlots;
+    FrameSlot*             mCurrentSlot = nullptr;
+    std::vector<uint32_t>  mScopeStack;
+
+    // 作用域名称驻留在这里, 结果中的string_view在分析器销毁前一直有效
+    std::deque<std::string>                                              mNames;
+    std::unordered_map<std::string, uint32_t, NameHash, std::equal_to<>> mNameIds;
+
+    // 由mMutex保护, 渲染线程在Resolve中写入, 其他线程通过GetLastFrame读取
+    VulkanProfileFrame mLastFrame;
+
+    // Chrome trace采集, 由mMutex保护
+    bool                                  mCapturing = false;
+    std::vector<TraceEvent>               mTraceEvents;
+    std::chrono::steady_clock::time_point mCaptureBegin;
+    uint64_t                              mCaptureGpuBase      = 0;
+    double                                mCaptureGpuOffsetUs  = 0.0;
+    bool                                  mCaptureGpuBaseValid = false;
+
+    mutable std::mutex mMutex;
+
+public:
+    VulkanProfiler() = default;
+
+    VulkanProfiler(const VulkanProfiler&)            = delete;
+    VulkanProfiler& operator=(const VulkanProfiler&) = delete;
+
+    ~VulkanProfiler() {
+        Terminate();
+    }
+
+    // 需要设备启用VulkanFeature::PipelineStatisticsQuery, 在Initialize之前调用
+    void SetPipelineStatisticsEnabled(bool enable) {
+        mStatisticsRequested = enable;
+    }
+
+    // timestampValidBits来自帧所在队列族的属性, 为0表示该队列不支持时间戳, 分析器不工作
+    // statisticsSupported表示设备是否启用了管线统计查询特性
+    VulkanResult
+    Initialize(VkDevice device, const VkPhysicalDeviceLimits& limits, uint32_t timestampValidBits, uint32_t frameCount, bool statisticsSupported) {
+        mDevice            = device;
+        mTimestampPeriod   = limits.timestampPeriod;
+        mTimestampMask     = timestampValidBits >= 64 ? UINT64_MAX : (uint64_t(1) << timestampValidBits) - 1;
+        mStatisticsEnabled = mStatisticsRequested && statisticsSupported;
+        if (mStatisticsRequested && !statisticsSupported) {
+            NOVA_LOG_WARN(RHI, "pipelineStatisticsQuery is not enabled, pipeline statistics are not collected");
+        }
+        if (timestampValidBits == 0) {
+            NOVA_LOG_WARN(RHI, "The graphics queue does not support timestamps, the GPU profiler is disabled");
+            return VK_SUCCESS;
+        }
+
+        mSlots.resize(frameCount);
+        for (auto& slot: mSlots) {
+            VkQueryPoolCreateInfo queryPoolCreateInfo = {
+                .sType      = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO,
+                .queryType  = VK_QUERY_TYPE_TIMESTAMP,
+                .queryCount = TIMESTAMP_QUERIES,
+            };
+            VkResult result = vkCreateQueryPool(mDevice, &queryPoolCreateInfo, VulkanHostMemory::GetCallbacks(), &slot.timestampPool);
+            if (result != VK_SUCCESS) {
+                NOVA_LOG_ERROR(RHI, "Failed to create a timestamp query pool: {}", int32_t(result));
+                return result;
+            }
+
+            if (mStatisticsEnabled) {
+                queryPoolCreateInfo.queryType          = VK_QUERY_TYPE_PIPELINE_STATISTICS;
+                queryPoolCreateInfo.queryCount         = MAX_SCOPES;
+                queryPoolCreateInfo.pipelineStatistics = STATISTICS_FLAGS;
+
+                result = vkCreateQueryPool(mDevice, &queryPoolCreateInfo, VulkanHostMemory::GetCallbacks(), &slot.statisticsPool);
+                if (result != VK_SUCCESS) {
+                    NOVA_LOG_ERROR(RHI, "Failed to create a pipeline statistics query pool: {}", int32_t(result));
+                    return result;
+                }
+            }
+            slot.gpuScopes.reserve(MAX_SCOPES);
+        }
+        return VK_SUCCESS;
+    }
+
+    void Terminate() {
+        for (auto& slot: mSlots) {
+            if (slot.timestampPool != VK_NULL_HANDLE) {
+                vkDestroyQueryPool(mDevice, slot.timestampPool, VulkanHostMemory::GetCallbacks());
+            }
+            if (slot.statisticsPool != VK_NULL_HANDLE) {
+                vkDestroyQueryPool(mDevice, slot.statisticsPool, VulkanHostMemory::GetCallbacks());
+            }
+        }
+        mSlots.resize(0);
+        mCurrentSlot = nullptr;
+        mScopeStack.resize(0);
+    }
+
+    bool IsEnabled() const {
+        return !mSlots.empty();
+    }
+
+    // 最近一次解析完成的帧, 返回副本, 可以在任意线程调用
+    VulkanProfileFrame GetLastFrame() const {
+        std::lock_guard<std::mutex> lock(mMutex);
+        return mLastFrame;
+    }
+
+    // 只需要帧耗时时使用, 不复制作用域列表
+    double GetLastFrameGpuMilliseconds() const {
+        std::lock_guard<std::mutex> lock(mMutex);
+        return mLastFrame.gpuMs;
+    }
+
+    // 在帧栅栏等待之后, 帧命令缓冲开始录制时调用
+    void BeginFrame(VkCommandBuffer commandBuffer, uint32_t frameIndex, uint64_t frameNumber) {
+        if (!IsEnabled()) {
+            return;
+        }
+
+        FrameSlot& slot = mSlots[frameIndex];
+        if (slot.submitted) {
+            Resolve(slot);
+        }
+
+        vkCmdResetQueryPool(commandBuffer, slot.timestampPool, 0, TIMESTAMP_QUERIES);
+        if (slot.statisticsPool != VK_NULL_HANDLE) {
+            vkCmdResetQueryPool(commandBuffer, slot.statisticsPool, 0, MAX_SCOPES);
+        }
+        vkCmdWriteTimestamp(commandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, slot.timestampPool, FRAME_QUERY);
+
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            slot.cpuScopes.resize(0);
+        }
+        slot.gpuScopes.resize(0);
+        slot.statisticsCount = 0;
+        slot.frameNumber     = frameNumber;
+        slot.cpuBegin        = std::chrono::steady_clock::now();
+        slot.submitted       = false;
+        mCurrentSlot         = &slot;
+        mScopeStack.resize(0);
+    }
+
+    // 在帧命令缓冲结束录制之前调用
+    void EndFrame(VkCommandBuffer commandBuffer) {
+        if (mCurrentSlot == nullptr) {
+            return;
+        }
+        while (!mScopeStack.empty()) {
+            NOVA_LOG_WARN(RHI, "Profiler scope is not closed before the end of the frame");
+            EndScope(commandBuffer);
+        }
+        vkCmdWriteTimestamp(commandBuffer, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, mCurrentSlot->timestampPool, FRAME_QUERY + 1);
+        mCurrentSlot->cpuEnd    = std::chrono::steady_clock::now();
+        mCurrentSlot->submitted = true;
+        mCurrentSlot            = nullptr;
+    }
+
+    // 作用域不能跨越渲染通道的边界
+    void BeginScope(VkCommandBuffer commandBuffer, std::string_view name) {
+        if (mCurrentSlot == nullptr) {
+            return;
+        }
+        FrameSlot& slot = *mCurrentSlot;
+        if (slot.gpuScopes.size() >= MAX_SCOPES) {
+            mScopeStack.push_back(INVALID_SCOPE);
+            return;
+        }
+
+        uint32_t scopeIndex = static_cast<uint32_t>(slot.gpuScopes.size());
+
+        GpuScope scope = {
+            .nameId = InternName(name),
+            .depth  = static_cast<uint32_t>(mScopeStack.size()),
+        };
+        vkCmdWriteTimestamp(commandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, slot.timestampPool, scopeIndex * 2);
+        if (slot.statisticsPool != VK_NULL_HANDLE && scope.depth == 0) {
+            scope.statisticsQuery = slot.statisticsCount++;
+            vkCmdBeginQuery(commandBuffer, slot.statisticsPool, scope.statisticsQuery, 0);
+        }
+        slot.gpuScopes.push_back(scope);
+        mScopeStack.push_back(scopeIndex);
+    }
+
+    void EndScope(VkCommandBuffer commandBuffer) {
+        if (mCurrentSlot == nullptr || mScopeStack.empty()) {
+            return;
+        }
+        uint32_t scopeIndex = mScopeStack.back();
+        mScopeStack.pop_back();
+        if (scopeIndex == INVALID_SCOPE) {
+            return;
+        }
+
+        FrameSlot&      slot  = *mCurrentSlot;
+        const GpuScope& scope = slot.gpuScopes[scopeIndex];
+        if (scope.statisticsQuery != INVALID_SCOPE) {
+            vkCmdEndQuery(commandBuffer, slot.statisticsPool, scope.statisticsQuery);
+        }
+        vkCmdWriteTimestamp(commandBuffer, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, slot.timestampPool, scopeIndex * 2 + 1);
+    }
+
+    // 记录一段已经结束的CPU时间, 可以在任意线程调用
+    void AddCpuScope(std::string_view name, std::chrono::steady_clock::time_point begin, std::chrono::steady_clock::time_point end) {
+        std::lock_guard<std::mutex> lock(mMutex);
+        if (mCurrentSlot == nullptr) {
+            return;
+        }
+        uint32_t threadIndex = JobSystem::GetThreadIndex();
+        mCurrentSlot->cpuScopes.push_back({
+            .nameId      = InternNameLocked(name),
+            .threadIndex = threadIndex == JobSystem::INVALID_THREAD_INDEX ? 0 : threadIndex,
+            .begin       = begin,
+            .end         = end,
+        });
+    }
+
+    // 开始采集, 之后解析的每一帧都会记录下来, 直到StopCapture写入文件
+    void StartCapture() {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mCapturing           = true;
+        mCaptureBegin        = std::chrono::steady_clock::now();
+        mCaptureGpuBaseValid = false;
+        mTraceEvents.resize(0);
+    }
+
+    // 写入Chrome trace格式(chrome://tracing或Perfetto可以打开), pid 0为CPU, pid 1为GPU
+    // GPU时间戳没有与CPU时钟校准, GPU轨道以采集到的第一帧对齐, 帧内和帧间的相对时间是准确的
+    VulkanResult StopCapture(const std::filesystem::path& path) {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mCapturing = false;
+
+        std::ofstream file(path, std::ios::binary | std::ios::trunc);
+        if (!file) {
+            NOVA_LOG_ERROR(RHI, "Failed to open the trace file: {}", path.string());
+            return VK_ERROR_INITIALIZATION_FAILED;
+        }
+
+        file << "{\"traceEvents\":[\n";
+        file << "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":0,\"args\":{\"name\":\"CPU\"}},\n";
+        file << "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"args\":{\"name\":\"GPU\"}}";
+        for (auto& event: mTraceEvents) {
+            file << std::format(
+                ",\n{{\"name\":\"{}\",\"ph\":\"X\",\"pid\":{},\"tid\":{},\"ts\":{:.3f},\"dur\":{:.3f}",
+                EscapeJson(mNames[event.nameId]),
+                event.pid,
+                event.tid,
+                event.beginUs,
+                event.durationUs
+            );
+            if (event.frameNumber != NO_FRAME_NUMBER) {
+                file << std::format(",\"args\":{{\"frame\":{}}}", event.frameNumber);
+            }
+            file << "}";
+        }
+        file << "\n],\"displayTimeUnit\":\"ms\"}\n";
+
+        NOVA_LOG_INFO(RHI, "Wrote {} profiler events to {}", mTraceEvents.size(), path.string());
+        mTraceEvents.resize(0);
+        return VK_SUCCESS;
+    }
+
+private:
+    uint32_t InternName(std::string_view name) {
+        std::lock_guard<std::mutex> lock(mMutex);
+        return InternNameLocked(name);
+    }
+
+    uint32_t InternNameLocked(std::string_view name) {
+        auto iterator = mNameIds.find(name);
+        if (iterator != mNameIds.end()) {
+            return iterator->second;
+        }
+        uint32_t id = static_cast<uint32_t>(mNames.size());
+        mNames.emplace_back(name);
+        mNameIds.emplace(mNames.back(), id);
+        return id;
+    }
+
+    static std::string EscapeJson(std::string_view text) {
+        std::string result;
+        result.reserve(text.size());
+        for (char c: text) {
+            if (c == '"' || c == '\\') {
+                result.push_back('\\');
+            }
+            result.push_back(c);
+        }
+        return result;
+    }
+
+    double TicksToMilliseconds(uint64_t begin, uint64_t end) const {
+        return double((end - begin) & mTimestampMask) * mTimestampPeriod * 1e-6;
+    }
+
+    // 帧栅栏已经等待过, 查询结果一定可用
+    void Resolve(FrameSlot& slot) {
+        slot.submitted = false;
+
+        // 每帧都会解析, 查询结果放在线程的临时分配栈上, 不访问堆
+        ScratchScope               scratch;
+        uint32_t                   scopeCount = static_cast<uint32_t>(slot.gpuScopes.size());
+        std::pmr::vector<uint64_t> timestamps(TIMESTAMP_QUERIES, scratch.GetMemoryResource());
+        VkResult                   result = vkGetQueryPoolResults(
+            mDevice,
+            slot.timestampPool,
+            0,
+            TIMESTAMP_QUERIES,
+            timestamps.size() * sizeof(uint64_t),
+            timestamps.data(),
+            sizeof(uint64_t),
+            VK_QUERY_RESULT_64_BIT
+        );
+        if (result != VK_SUCCESS) {
+            return;
+        }
+
+        std::pmr::vector<uint64_t> statistics(size_t(slot.statisticsCount) * STATISTICS_COUNT, scratch.GetMemoryResource());
+        if (slot.statisticsCount > 0) {
+            result = vkGetQueryPoolResults(
+                mDevice,
+                slot.statisticsPool,
+                0,
+                slot.statisticsCount,
+                statistics.size() * sizeof(uint64_t),
+                statistics.data(),
+                STATISTICS_COUNT * sizeof(uint64_t),
+                VK_QUERY_RESULT_64_BIT
+            );
+            if (result != VK_SUCCESS) {
+                statistics.assign(statistics.size(), 0);
+            }
+        }
+
+        uint64_t frameBegin = timestamps[FRAME_QUERY] & mTimestampMask;
+
+        std::lock_guard<std::mutex> lock(mMutex);
+        mLastFrame.frameNumber = slot.frameNumber;
+        mLastFrame.gpuMs       = TicksToMilliseconds(frameBegin, timestamps[FRAME_QUERY + 1]);
+        mLastFrame.cpuMs       = std::chrono::duration<double, std::milli>(slot.cpuEnd - slot.cpuBegin).count();
+        mLastFrame.gpuScopes.resize(scopeCount);
+        for (uint32_t i = 0; i < scopeCount; i++) {
+            const GpuScope&       scope  = slot.gpuScopes[i];
+            VulkanGpuScopeResult& output = mLastFrame.gpuScopes[i];
+            output.name                  = mNames[scope.nameId];
+            output.depth                 = scope.depth;
+            output.beginMs               = TicksToMilliseconds(frameBegin, timestamps[i * 2]);
+            output.durationMs            = TicksToMilliseconds(timestamps[i * 2], timestamps[i * 2 + 1]);
+            output.hasStatistics         = scope.statisticsQuery != INVALID_SCOPE;
+            if (output.hasStatistics) {
+                const uint64_t* values                       = &statistics[size_t(scope.statisticsQuery) * STATISTICS_COUNT];
+                output.statistics.inputAssemblyVertices     = values[0];
+                output.statistics.vertexShaderInvocations   = values[1];
+                output.statistics.clippingPrimitives        = values[2];
+                output.statistics.fragmentShaderInvocations = values[3];
+                output.statistics.computeShaderInvocations  = values[4];
+            }
+        }
+
+        mLastFrame.cpuScopes.resize(slot.cpuScopes.size());
+        for (size_t i = 0; i < slot.cpuScopes.size(); i++) {
+            const CpuScope&       scope  = slot.cpuScopes[i];
+            VulkanCpuScopeResult& output = mLastFrame.cpuScopes[i];
+            output.name                  = mNames[scope.nameId];
+            output.threadIndex           = scope.threadIndex;
+            output.beginMs               = std::chrono::duration<double, std::milli>(scope.begin - slot.cpuBegin).count();
+            output.durationMs            = std::chrono::duration<double, std::milli>(scope.end - scope.begin).count();
+        }
+
+        if (mCapturing) {
+            RecordTraceEvents(slot, timestamps);
+        }
+    }
+
+    // 调用时持有mMutex
+    void RecordTraceEvents(const FrameSlot& slot, std::span<const uint64_t> timestamps) {
+        double frameBeginUs = std::chrono::duration<double, std::micro>(slot.cpuBegin - mCaptureBegin).count();
+        if (frameBeginUs < 0.0) {
+            return;
+        }
+
+        uint64_t frameBegin = timestamps[FRAME_QUERY] & mTimestampMask;
+        if (!mCaptureGpuBaseValid) {
+            mCaptureGpuBase      = frameBegin;
+            mCaptureGpuOffsetUs  = frameBeginUs;
+            mCaptureGpuBaseValid = true;
+        }
+        double gpuFrameBeginUs = mCaptureGpuOffsetUs + TicksToMilliseconds(mCaptureGpuBase, frameBegin) * 1000.0;
+
+        uint32_t frameId = InternNameLocked("Frame");
+        mTraceEvents.push_back({ frameId, 0, 0, frameBeginUs, mLastFrame.cpuMs * 1000.0, slot.frameNumber });
+        mTraceEvents.push_back({ frameId, 1, 0, gpuFrameBeginUs, mLastFrame.gpuMs * 1000.0, slot.frameNumber });
+
+        // GPU作用域按嵌套深度放在不同的轨道上
+        for (size_t i = 0; i < slot.gpuScopes.size(); i++) {
+            const VulkanGpuScopeResult& scope = mLastFrame.gpuScopes[i];
+            mTraceEvents.push_back({ slot.gpuScopes[i].nameId, 1, scope.depth + 1, gpuFrameBeginUs + scope.beginMs * 1000.0, scope.durationMs * 1000.0 });
+        }
+        for (size_t i = 0; i < slot.cpuScopes.size(); i++) {
+            const VulkanCpuScopeResult& scope = mLastFrame.cpuScopes[i];
+            mTraceEvents.push_back({ slot.cpuScopes[i].nameId, 0, scope.threadIndex, frameBeginUs + scope.beginMs * 1000.0, scope.durationMs * 1000.0 });
+        }
+    }
+};
+
+// 在作用域结束时记录CPU耗时
+class VulkanCpuProfileScope {
+private:
+    VulkanProfiler&                       mProfiler;
+    std::string_view                      mName;
+    std::chrono::steady_clock::time_point mBegin;
+
+public:
+    VulkanCpuProfileScope(VulkanProfiler& profiler, std::string_view name):
+        mProfiler(profiler), mName(name), mBegin(std::chrono::steady_clock::now()) {}
+
+    VulkanCpuProfileScope(const VulkanCpuProfileScope&)            = delete;
+    VulkanCpuProfileScope& operator=(const VulkanCpuProfileScope&) = delete;
+
+    ~VulkanCpuProfileScope() {
+        mProfiler.AddCpuScope(mName, mBegin, std::chrono::steady_clock::now());
+    }
+};
+
+// 在作用域结束时关闭GPU作用域
+class VulkanGpuProfileScope {
+private:
+    VulkanProfiler& mProfiler;
+    VkCommandBuffer mCommandBuffer;
+
+public:
+    VulkanGpuProfileScope(VulkanProfiler& profiler, VkCommandBuffer commandBuffer, std::string_view name):
+        mProfiler(profiler), mCommandBuffer(commandBuffer) {
+        mProfiler.BeginScope(mCommandBuffer, name);
+    }
+
+    VulkanGpuProfileScope(const VulkanGpuProfileScope&)            = delete;
+    VulkanGpuProfileScope& operator=(const VulkanGpuProfileScope&) = delete;
+
+    ~VulkanGpuProfileScope() {
+        mProfiler.EndScope(mCommandBuffer);
+    }
+};
+} // namespace Nova
@@ -0,0 +1,315 @@
+#pragma once
+#include "VulkanHostMemory.h"
+#include "VulkanResult.h"
+
+#include <mutex>
+#include <span>
+
+namespace Nova {
+
+// 一次提交需要等待的信号量, 二值信号量的value会被忽略
+struct VulkanQueueWait {
+    VkSemaphore          semaphore = VK_NULL_HANDLE;
+    uint64_t             value     = 0;
+    VkPipelineStageFlags stage     = VK_PIPELINE_STAGE_ALL_COMMANDS_BIT;
+};
+
+// 队列和它的时间线信号量
+// 每次提交都会把时间线推进到新的值, 其他队列等待这个值即可建立跨队列依赖, CPU也可以查询或等待它
+class VulkanQueue {
+private:
+    VkDevice    mDevice      = VK_NULL_HANDLE;
+    VkQueue     mQueue       = VK_NULL_HANDLE;
+    uint32_t    mFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    VkSemaphore mTimeline    = VK_NULL_HANDLE;
+
+    uint64_t   mLastSubmittedValue = 0;
+    std::mutex mMutex;
+
+    // 提交时复用, 避免每次分配
+    std::vector<VkSemaphore>          mWaitSemaphores;
+    std::vector<uint64_t>             mWaitValues;
+    std::vector<VkPipelineStageFlags> mWaitStages;
+    std::vector<VkSemaphore>          mSignalSemaphores;
+    std::vector<uint64_t>             mSignalValues;
+
+public:
+    VulkanQueue() = default;
+
+    VulkanQueue(const VulkanQueue&)            = delete;
+    VulkanQueue& operator=(const VulkanQueue&) = delete;
+
+    VkQueue GetQueue() const {
+        return mQueue;
+    }
+
+    uint32_t GetFamilyIndex() const {
+        return mFamilyIndex;
+    }
+
+    VkSemaphore GetTimelineSemaphore() const {
+        return mTimeline;
+    }
+
+    bool HasTimeline() const {
+        return mTimeline != VK_NULL_HANDLE;
+    }
+
+    uint64_t GetLastSubmittedValue() const {
+        return mLastSubmittedValue;
+    }
+
+    // 其他队列等待本队列执行到value
+    VulkanQueueWait MakeWait(uint64_t value, VkPipelineStageFlags stage) const {
+        return { mTimeline, value, stage };
+    }
+
+    // useTimeline为false时(设备不支持timelineSemaphore)只包装队列, 跨队列依赖需要调用者使用二值信号量
+    VulkanResult Initialize(VkDevice device, VkQueue queue, uint32_t familyIndex, bool useTimeline) {
+        mDevice             = device;
+        mQueue              = queue;
+        mFamilyIndex        = familyIndex;
+        mLastSubmittedValue = 0;
+
+        if (!useTimeline) {
+            return VK_SUCCESS;
+        }
+
+        VkSemaphoreTypeCreateInfo semaphoreTypeCreateInfo = {
+            .sType         = VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO,
+            .semaphoreType = VK_SEMAPHORE_TYPE_TIMELINE,
+            .initialValue  = 0,
+        };
+        VkSemaphoreCreateInfo semaphoreCreateInfo = {
+            .sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO,
+            .pNext = &semaphoreTypeCreateInfo,
+        };
+        VkResult result = vkCreateSemaphore(mDevice, &semaphoreCreateInfo, VulkanHostMemory::GetCallbacks(), &mTimeline);
+        if (result != VK_SUCCESS) {
+            NOVA_LOG_ERROR(RHI, "Failed to create a timeline semaphore: {}", int32_t(result));
+        }
+        return result;
+    }
+
+    void Terminate() {
+        if (mTimeline != VK_NULL_HANDLE) {
+            vkDestroySemaphore(mDevice, mTimeline, VulkanHostMemory::GetCallbacks());
+            mTimeline = VK_NULL_HANDLE;
+        }
+        mQueue              = VK_NULL_HANDLE;
+        mFamilyIndex        = VK_QUEUE_FAMILY_IGNORED;
+        mLastSubmittedValue = 0;
+    }
+
+    // 提交命令缓冲, 完成时本队列的时间线到达signalValue
+    // binarySignals用于呈现等仍然需要二值信号量的场合
+    VulkanResult Submit(
+        std::span<const VkCommandBuffer> commandBuffers,
+        std::span<const VulkanQueueWait> waits         = {},
+        std::span<const VkSemaphore>     binarySignals = {},
+        VkFence                          fence         = VK_NULL_HANDLE,
+        uint64_t*                        signalValue   = nullptr
+    ) {
+        std::lock_guard<std::mutex> lock(mMutex);
+
+        mWaitSemaphores.resize(0);
+        mWaitValues.resize(0);
+        mWaitStages.resize(0);
+        for (auto& wait: waits) {
+            mWaitSemaphores.push_back(wait.semaphore);
+            mWaitValues.push_back(wait.value);
+            mWaitStages.push_back(wait.stage);
+        }
+
+        mSignalSemaphores.assign(binarySignals.begin(), binarySignals.end());
+        mSignalValues.assign(binarySignals.size(), 0);
+        uint64_t value = mLastSubmittedValue + 1;
+        if (mTimeline != VK_NULL_HANDLE) {
+            mSignalSemaphores.push_back(mTimeline);
+            mSignalValues.push_back(value);
+        }
+
+        VkTimelineSemaphoreSubmitInfo timelineSemaphoreSubmitInfo = {
+            .sType                     = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO,
+            .waitSemaphoreValueCount   = static_cast<uint32_t>(mWaitValues.size()),
+            .pWaitSemaphoreValues      = mWaitValues.data(),
+            .signalSemaphoreValueCount = static_cast<uint32_t>(mSignalValues.size()),
+            .pSignalSemaphoreValues    = mSignalValues.data(),
+        };
+        VkSubmitInfo submitInfo = {
+            .sType                = VK_STRUCTURE_TYPE_SUBMIT_INFO,
+            .pNext                = mTimeline != VK_NULL_HANDLE ? &timelineSemaphoreSubmitInfo : nullptr,
+            .waitSemaphoreCount   = static_cast<uint32_t>(mWaitSemaphores.size()),
+            .pWaitSemaphores      = mWaitSemaphores.data(),
+            .pWaitDstStageMask    = mWaitStages.data(),
+            .commandBufferCount   = static_cast<uint32_t>(commandBuffers.size()),
+            .pCommandBuffers      = commandBuffers.data(),
+            .signalSemaphoreCount = static_cast<uint32_t>(mSignalSemaphores.size()),
+            .pSignalSemaphores    = mSignalSemaphores.data(),
+        };
+        VkResult result = vkQueueSubmit(mQueue, 1, &submitInfo, fence);
+        if (result != VK_SUCCESS) {
+            NOVA_LOG_ERROR(RHI, "Failed to submit to queue family {}: {}", mFamilyIndex, int32_t(result));
+            return result;
+        }
+
+        if (mTimeline != VK_NULL_HANDLE) {
+            mLastSubmittedValue = value;
+        }
+        if (signalValue != nullptr) {
+            *signalValue = mLastSubmittedValue;
+        }
+        return VK_SUCCESS;
+    }
+
+    // 呈现同样需要外部同步队列, 多个交换链共用呈现队列时与提交共用同一把锁
+    VkResult Present(const VkPresentInfoKHR& presentInfo) {
+        std::lock_guard<std::mutex> lock(mMutex);
+        return vkQueuePresentKHR(mQueue, &presentInfo);
+    }
+
+    uint64_t GetCompletedValue() const {
+        uint64_t value = 0;
+        if (mTimeline != VK_NULL_HANDLE) {
+            vkGetSemaphoreCounterValue(mDevice, mTimeline, &value);
+        }
+        return value;
+    }
+
+    bool IsCompleted(uint64_t value) const {
+        return GetCompletedValue() >= value;
+    }
+
+    // 在CPU上等待时间线到达value
+    VulkanResult WaitForValue(uint64_t value, uint64_t timeout = UINT64_MAX) const {
+        if (mTimeline == VK_NULL_HANDLE) {
+            return VK_SUCCESS;
+        }
+        VkSemaphoreWaitInfo semaphoreWaitInfo = {
+            .sType          = VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO,
+            .semaphoreCount = 1,
+            .pSemaphores    = &mTimeline,
+            .pValues        = &value,
+        };
+        VkResult result = vkWaitSemaphores(mDevice, &semaphoreWaitInfo, timeout);
+        if (result != VK_SUCCESS && result != VK_TIMEOUT) {
+            NOVA_LOG_ERROR(RHI, "Failed to wait for a timeline semaphore: {}", int32_t(result));
+        }
+        return result;
+    }
+};
+
+// 队列族所有权转移(QFOT)
+// 释放屏障录制在源队列上, 获取屏障录制在目标队列上, 两者的队列族和布局必须一致, 之间用信号量同步;
+// 获取端的等待阶段需要包含dstStage. 两个队列属于同一队列族时不需要转移, 释放为空操作, 获取只做布局转换
+static inline void CmdReleaseImageOwnership(
+    VkCommandBuffer                commandBuffer,
+    VkImage                        image,
+    const VkImageSubresourceRange& subresourceRange,
+    uint32_t                       srcQueueFamilyIndex,
+    uint32_t                       dstQueueFamilyIndex,
+    VkPipelineStageFlags           srcStage,
+    VkAccessFlags                  srcAccess,
+    VkImageLayout                  oldLayout,
+    VkImageLayout                  newLayout
+) {
+    if (srcQueueFamilyIndex == dstQueueFamilyIndex) {
+        return;
+    }
+    VkImageMemoryBarrier barrier = {
+        .sType               = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
+        .srcAccessMask       = srcAccess,
+        .dstAccessMask       = 0,
+        .oldLayout           = oldLayout,
+        .newLayout           = newLayout,
+        .srcQueueFamilyIndex = srcQueueFamilyIndex,
+        .dstQueueFamilyIndex = dstQueueFamilyIndex,
+        .image               = image,
+        .subresourceRange    = subresourceRange,
+    };
+    vkCmdPipelineBarrier(commandBuffer, srcStage, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, 0, 0, nullptr, 0, nullptr, 1, &barrier);
+}
+
+static inline void CmdAcquireImageOwnership(
+    VkCommandBuffer                commandBuffer,
+    VkImage                        image,
+    const VkImageSubresourceRange& subresourceRange,
+    uint32_t                       srcQueueFamilyIndex,
+    uint32_t                       dstQueueFamilyIndex,
+    VkPipelineStageFlags           dstStage,
+    VkAccessFlags                  dstAccess,
+    VkImageLayout                  oldLayout,
+    VkImageLayout                  newLayout
+) {
+    bool sameFamily = srcQueueFamilyIndex == dstQueueFamilyIndex;
+    if (sameFamily && oldLayout == newLayout) {
+        return;
+    }
+    VkImageMemoryBarrier barrier = {
+        .sType               = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
+        .srcAccessMask       = 0,
+        .dstAccessMask       = dstAccess,
+        .oldLayout           = oldLayout,
+        .newLayout           = newLayout,
+        .srcQueueFamilyIndex = sameFamily ? VK_QUEUE_FAMILY_IGNORED : srcQueueFamilyIndex,
+        .dstQueueFamilyIndex = sameFamily ? VK_QUEUE_FAMILY_IGNORED : dstQueueFamilyIndex,
+        .image               = image,
+        .subresourceRange    = subresourceRange,
+    };
+    // 源阶段与信号量的等待阶段衔接, 布局转换才会发生在信号量等待之后
+    vkCmdPipelineBarrier(commandBuffer, dstStage, dstStage, 0, 0, nullptr, 0, nullptr, 1, &barrier);
+}
+
+static inline void CmdReleaseBufferOwnership(
+    VkCommandBuffer      commandBuffer,
+    VkBuffer             buffer,
+    VkDeviceSize         offset,
+    VkDeviceSize         size,
+    uint32_t             srcQueueFamilyIndex,
+    uint32_t             dstQueueFamilyIndex,
+    VkPipelineStageFlags srcStage,
+    VkAccessFlags        srcAccess
+) {
+    if (srcQueueFamilyIndex == dstQueueFamilyIndex) {
+        return;
+    }
+    VkBufferMemoryBarrier barrier = {
+        .sType               = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER,
+        .srcAccessMask       = srcAccess,
+        .dstAccessMask       = 0,
+        .srcQueueFamilyIndex = srcQueueFamilyIndex,
+        .dstQueueFamilyIndex = dstQueueFamilyIndex,
+        .buffer              = buffer,
+        .offset              = offset,
+        .size                = size,
+    };
+    vkCmdPipelineBarrier(commandBuffer, srcStage, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, 0, 0, nullptr, 1, &barrier, 0, nullptr);
+}
+
+static inline void CmdAcquireBufferOwnership(
+    VkCommandBuffer      commandBuffer,
+    VkBuffer             buffer,
+    VkDeviceSize         offset,
+    VkDeviceSize         size,
+    uint32_t             srcQueueFamilyIndex,
+    uint32_t             dstQueueFamilyIndex,
+    VkPipelineStageFlags dstStage,
+    VkAccessFlags        dstAccess
+) {
+    // 同一队列族时信号量已经提供了内存依赖
+    if (srcQueueFamilyIndex == dstQueueFamilyIndex) {
+        return;
+    }
+    VkBufferMemoryBarrier barrier = {
+        .sType               = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER,
+        .srcAccessMask       = 0,
+        .dstAccessMask       = dstAccess,
+        .srcQueueFamilyIndex = srcQueueFamilyIndex,
+        .dstQueueFamilyIndex = dstQueueFamilyIndex,
+        .buffer              = buffer,
+        .offset              = offset,
+        .size                = size,
+    };
+    vkCmdPipelineBarrier(commandBuffer, dstStage, dstStage, 0, 0, nullptr, 1, &barrier, 0, nullptr);
+}
+} // namespace Nova
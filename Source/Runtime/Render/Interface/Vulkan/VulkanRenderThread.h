@@ -0,0 +1,128 @@
+#pragma once
+#include "Core/DoubleBuffer.h"
+#include "Core/JobSystem.h"
+#include "Render/FramePacket.h"
+#include "VulkanSwapchain.h"
+
+#include <functional>
+#include <mutex>
+#include <thread>
+
+namespace Nova {
+
+// 渲染线程的统计, 每帧提交后更新, 供主线程刷新窗口标题
+struct RenderThreadStats {
+    uint64_t                      frameCount       = 0; // 已提交的帧数
+    double                        gpuMs            = 0.0;
+    bool                          gpuTimingEnabled = false;
+    VulkanSwapchain::PresentStats presentStats;
+};
+
+// 独占一个交换链的提交和呈现的渲染线程
+// 模拟线程通过BeginPacket/SubmitPacket逐帧交付帧包, 渲染线程取出帧包后录制并提交; 帧包双缓冲, 模拟最多领先渲染一帧
+// 渲染线程不调用任何GLFW函数, 主线程处理窗口事件时不会阻塞提交
+// 渲染线程在运行期间加入作业系统, 录制时提交的作业使用自己的作业池, 等待作业时也会执行其他作业
+class VulkanRenderThread {
+public:
+    // 在渲染线程上调用, 在交换链的当前命令缓冲中录制一帧
+    using RecordFunction = std::function<void(VulkanSwapchain& swapchain, const FramePacket& packet)>;
+
+private:
+    VulkanSwapchain*          mSwapchain = nullptr;
+    RecordFunction            mRecord;
+    DoubleBuffer<FramePacket> mPackets;
+    std::thread               mThread;
+
+    mutable std::mutex mStatsMutex;
+    RenderThreadStats  mStats;
+
+public:
+    VulkanRenderThread() = default;
+
+    VulkanRenderThread(const VulkanRenderThread&)            = delete;
+    VulkanRenderThread& operator=(const VulkanRenderThread&) = delete;
+
+    ~VulkanRenderThread() {
+        Stop();
+    }
+
+    // 启动后交换链的BeginFrame/EndFrame只能由渲染线程调用, 直到Stop返回; 作业系统Terminate之前需要先Stop
+    void Start(VulkanSwapchain& swapchain, RecordFunction record) {
+        mSwapchain = &swapchain;
+        mRecord    = std::move(record);
+        mThread    = std::thread([this] { Run(); });
+    }
+
+    // 关闭帧包队列并等待渲染线程退出, 返回时交换链的飞行帧已经全部完成
+    void Stop() {
+        if (!mThread.joinable()) {
+            return;
+        }
+        mPackets.Close();
+        mThread.join();
+    }
+
+    // 模拟线程调用, 渲染线程还没取走上上帧的帧包时等待; 已停止时返回nullptr
+    FramePacket* BeginPacket() {
+        return mPackets.BeginWrite();
+    }
+
+    void SubmitPacket() {
+        mPackets.EndWrite();
+    }
+
+    RenderThreadStats GetStats() const {
+        std::lock_guard lock(mStatsMutex);
+        return mStats;
+    }
+
+private:
+    void Run() {
+        VulkanSwapchain& swapchain  = *mSwapchain;
+        bool             idle       = false;
+        bool             registered = JobSystem::Singleton().RegisterThread();
+
+        while (const FramePacket* packet = mPackets.BeginRead()) {
+            // 窗口最小化时不提交帧, 只在第一次时等待飞行帧完成, 不再推迟设备的延迟销毁
+            if (packet->width == 0 || packet->height == 0) {
+                if (!idle) {
+                    swapchain.WaitIdle().Ignore();
+                    idle = true;
+                }
+                mPackets.EndRead();
+                continue;
+            }
+            idle = false;
+
+            // 表面没有当前尺寸时交换链按窗口的帧缓冲尺寸重建
+            swapchain.SetFallbackExtent({ packet->width, packet->height });
+
+            // 录制只读取帧包, 录制完成即可归还, 提交和呈现期间模拟线程可以写入下一帧
+            bool recorded = swapchain.BeginFrame() == VK_SUCCESS;
+            if (recorded) {
+                mRecord(swapchain, *packet);
+            }
+            mPackets.EndRead();
+            if (!recorded) {
+                continue;
+            }
+            swapchain.EndFrame().Ignore();
+
+            // 时间戳查询滞后几帧
+            const auto& profiler     = swapchain.GetProfiler();
+            auto        presentStats = swapchain.GetPresentStats();
+
+            std::lock_guard lock(mStatsMutex);
+            mStats.frameCount++;
+            mStats.gpuTimingEnabled = profiler.IsEnabled();
+            mStats.gpuMs            = mStats.gpuTimingEnabled ? profiler.GetLastFrameGpuMilliseconds() : 0.0;
+            mStats.presentStats     = presentStats;
+        }
+        swapchain.WaitIdle().Ignore();
+
+        if (registered) {
+            JobSystem::Singleton().UnregisterThread();
+        }
+    }
+};
+} // namespace Nova
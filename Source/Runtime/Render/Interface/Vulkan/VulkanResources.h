@@ -0,0 +1,345 @@
+#pragma once
+#include "VulkanBindlessHeap.h"
+#include "VulkanDeletionQueue.h"
+#include "VulkanMemoryAllocator.h"
+
+#include "Core/HandlePool.h"
+
+namespace Nova {
+
+using VulkanBufferHandle   = Handle<struct VulkanBufferTag>;
+using VulkanImageHandle    = Handle<struct VulkanImageTag>;
+using VulkanSamplerHandle  = Handle<struct VulkanSamplerTag>;
+using VulkanPipelineHandle = Handle<struct VulkanPipelineTag>;
+
+struct VulkanBufferRecord {
+    VkBuffer           buffer = VK_NULL_HANDLE;
+    VulkanAllocation   allocation;
+    VkDeviceSize       size          = 0;
+    VkBufferUsageFlags usage         = 0;
+    uint32_t           bindlessIndex = VulkanBindlessHeap::INVALID_INDEX; // 存储缓冲的无绑定索引
+};
+
+struct VulkanImageRecord {
+    VkImage           image     = VK_NULL_HANDLE;
+    VkImageView       imageView = VK_NULL_HANDLE;
+    VulkanAllocation  allocation;
+    VkFormat          format       = VK_FORMAT_UNDEFINED;
+    VkExtent3D        extent       = {};
+    uint32_t          mipLevels    = 1;
+    uint32_t          arrayLayers  = 1;
+    VkImageUsageFlags usage        = 0;
+    uint32_t          sampledIndex = VulkanBindlessHeap::INVALID_INDEX;
+    uint32_t          storageIndex = VulkanBindlessHeap::INVALID_INDEX;
+    bool              owned        = true; // 导入的图像(如交换链图像)不由注册表销毁
+};
+
+struct VulkanSamplerRecord {
+    VkSampler sampler       = VK_NULL_HANDLE;
+    uint32_t  bindlessIndex = VulkanBindlessHeap::INVALID_INDEX;
+};
+
+struct VulkanPipelineRecord {
+    VkPipeline          pipeline          = VK_NULL_HANDLE;
+    VkPipelineLayout    pipelineLayout    = VK_NULL_HANDLE;
+    VkPipelineBindPoint pipelineBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS;
+};
+
+// GPU资源注册表, 缓冲、图像、采样器和管线以代数句柄表示
+// 句柄只有32位, 可以直接写入命令流; 创建和销毁可以在任意线程并发进行
+// 启用了无绑定描述符堆时, 创建的资源按用途自动登记无绑定索引
+// Destroy*立即释放句柄; 设置了延迟销毁队列时Vulkan对象在GPU完成当前帧后才销毁, 否则立即销毁, 调用方需要确保GPU不再使用该资源
+class VulkanResourceRegistry {
+private:
+    VkDevice               mDevice        = VK_NULL_HANDLE;
+    VulkanMemoryAllocator* mAllocator     = nullptr;
+    VulkanBindlessHeap*    mBindlessHeap  = nullptr;
+    VulkanDeletionQueue*   mDeletionQueue = nullptr;
+
+    HandlePool<VulkanBufferRecord, VulkanBufferTag>     mBuffers;
+    HandlePool<VulkanImageRecord, VulkanImageTag>       mImages;
+    HandlePool<VulkanSamplerRecord, VulkanSamplerTag>   mSamplers;
+    HandlePool<VulkanPipelineRecord, VulkanPipelineTag> mPipelines;
+
+public:
+    VulkanResourceRegistry() = default;
+
+    VulkanResourceRegistry(const VulkanResourceRegistry&)            = delete;
+    VulkanResourceRegistry& operator=(const VulkanResourceRegistry&) = delete;
+
+    // bindlessHeap为nullptr或未初始化时不登记无绑定索引, deletionQueue为nullptr时Destroy*立即销毁
+    void Initialize(
+        VkDevice               device,
+        VulkanMemoryAllocator& allocator,
+        VulkanBindlessHeap*    bindlessHeap,
+        VulkanDeletionQueue*   deletionQueue = nullptr
+    ) {
+        mDevice        = device;
+        mAllocator     = &allocator;
+        mBindlessHeap  = bindlessHeap != nullptr && bindlessHeap->IsInitialized() ? bindlessHeap : nullptr;
+        mDeletionQueue = deletionQueue;
+    }
+
+    // 销毁所有仍然存活的资源并报告数量, 调用前需要确保设备空闲, 且延迟销毁队列已经Flush
+    void Terminate() {
+        if (mDevice == VK_NULL_HANDLE) {
+            return;
+        }
+
+        uint32_t leaked = mBuffers.GetLiveCount() + mImages.GetLiveCount() + mSamplers.GetLiveCount() + mPipelines.GetLiveCount();
+        if (leaked > 0) {
+            NOVA_LOG_WARN(RHI, "{} resources were not destroyed before the registry was terminated", leaked);
+        }
+
+        mBuffers.ForEach([this](VulkanBufferHandle, VulkanBufferRecord& record) { DestroyRecord(record); });
+        mImages.ForEach([this](VulkanImageHandle, VulkanImageRecord& record) { DestroyRecord(record); });
+        mSamplers.ForEach([this](VulkanSamplerHandle, VulkanSamplerRecord& record) { DestroyRecord(record); });
+        mPipelines.ForEach([this](VulkanPipelineHandle, VulkanPipelineRecord& record) { DestroyRecord(record); });
+        mBuffers.Clear();
+        mImages.Clear();
+        mSamplers.Clear();
+        mPipelines.Clear();
+
+        mDevice        = VK_NULL_HANDLE;
+        mAllocator     = nullptr;
+        mBindlessHeap  = nullptr;
+        mDeletionQueue = nullptr;
+    }
+
+    //==================================================================================================================================================
+    // buffer
+    //==================================================================================================================================================
+
+    VulkanBufferHandle CreateBuffer(const VkBufferCreateInfo& createInfo, VkMemoryPropertyFlags requiredFlags, VkMemoryPropertyFlags preferredFlags = 0) {
+        VulkanBufferRecord record = { .size = createInfo.size, .usage = createInfo.usage };
+        if (mAllocator->CreateBuffer(createInfo, requiredFlags, record.buffer, record.allocation, preferredFlags) != VK_SUCCESS) {
+            return {};
+        }
+        if (mBindlessHeap != nullptr && (createInfo.usage & VK_BUFFER_USAGE_STORAGE_BUFFER_BIT)) {
+            record.bindlessIndex = mBindlessHeap->AllocateStorageBuffer(record.buffer);
+        }
+
+        VulkanBufferHandle handle = mBuffers.Allocate(record);
+        if (!handle) {
+            DestroyRecord(record);
+        }
+        return handle;
+    }
+
+    void DestroyBuffer(VulkanBufferHandle handle) {
+        if (VulkanBufferRecord* record = mBuffers.TryGet(handle)) {
+            Retire(*record, record->allocation.size);
+            mBuffers.Free(handle);
+        }
+    }
+
+    VulkanBufferRecord* GetBuffer(VulkanBufferHandle handle) {
+        return mBuffers.Get(handle);
+    }
+
+    //==================================================================================================================================================
+    // image
+    //==================================================================================================================================================
+
+    // 同时创建覆盖所有mip和层的图像视图
+    VulkanImageHandle CreateImage(
+        const VkImageCreateInfo& createInfo,
+        VkImageAspectFlags       aspectMask,
+        VkMemoryPropertyFlags    requiredFlags  = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+        VkMemoryPropertyFlags    preferredFlags = 0
+    ) {
+        VulkanImageRecord record = {
+            .format      = createInfo.format,
+            .extent      = createInfo.extent,
+            .mipLevels   = createInfo.mipLevels,
+            .arrayLayers = createInfo.arrayLayers,
+            .usage       = createInfo.usage,
+        };
+        if (mAllocator->CreateImage(createInfo, requiredFlags, record.image, record.allocation, preferredFlags) != VK_SUCCESS) {
+            return {};
+        }
+
+        VkImageViewCreateInfo imageViewCreateInfo = {
+            .sType            = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO,
+            .image            = record.image,
+            .viewType         = GetImageViewType(createInfo),
+            .format           = createInfo.format,
+            .subresourceRange = { aspectMask, 0, createInfo.mipLevels, 0, createInfo.arrayLayers },
+        };
+        VkResult result = vkCreateImageView(mDevice, &imageViewCreateInfo, VulkanHostMemory::GetCallbacks(), &record.imageView);
+        if (result != VK_SUCCESS) {
+            NOVA_LOG_ERROR(RHI, "Failed to create an image view: {}", int32_t(result));
+            DestroyRecord(record);
+            return {};
+        }
+
+        if (mBindlessHeap != nullptr && (createInfo.usage & VK_IMAGE_USAGE_SAMPLED_BIT)) {
+            record.sampledIndex = mBindlessHeap->AllocateSampledImage(record.imageView);
+        }
+        if (mBindlessHeap != nullptr && (createInfo.usage & VK_IMAGE_USAGE_STORAGE_BIT)) {
+            record.storageIndex = mBindlessHeap->AllocateStorageImage(record.imageView);
+        }
+
+        VulkanImageHandle handle = mImages.Allocate(record);
+        if (!handle) {
+            DestroyRecord(record);
+        }
+        return handle;
+    }
+
+    // 登记外部创建的图像, 注册表只释放句柄, 不销毁图像和视图
+    VulkanImageHandle ImportImage(VkImage image, VkImageView imageView, VkFormat format, VkExtent3D extent) {
+        return mImages.Allocate(VulkanImageRecord{
+            .image     = image,
+            .imageView = imageView,
+            .format    = format,
+            .extent    = extent,
+            .owned     = false,
+        });
+    }
+
+    void DestroyImage(VulkanImageHandle handle) {
+        if (VulkanImageRecord* record = mImages.TryGet(handle)) {
+            Retire(*record, record->owned ? record->allocation.size : 0);
+            mImages.Free(handle);
+        }
+    }
+
+    VulkanImageRecord* GetImage(VulkanImageHandle handle) {
+        return mImages.Get(handle);
+    }
+
+    //==================================================================================================================================================
+    // sampler
+    //==================================================================================================================================================
+
+    VulkanSamplerHandle CreateSampler(const VkSamplerCreateInfo& createInfo) {
+        VulkanSamplerRecord record;
+        VkResult            result = vkCreateSampler(mDevice, &createInfo, VulkanHostMemory::GetCallbacks(), &record.sampler);
+        if (result != VK_SUCCESS) {
+            NOVA_LOG_ERROR(RHI, "Failed to create a sampler: {}", int32_t(result));
+            return {};
+        }
+        if (mBindlessHeap != nullptr) {
+            record.bindlessIndex = mBindlessHeap->AllocateSampler(record.sampler);
+        }
+
+        VulkanSamplerHandle handle = mSamplers.Allocate(record);
+        if (!handle) {
+            DestroyRecord(record);
+        }
+        return handle;
+    }
+
+    void DestroySampler(VulkanSamplerHandle handle) {
+        if (VulkanSamplerRecord* record = mSamplers.TryGet(handle)) {
+            Retire(*record);
+            mSamplers.Free(handle);
+        }
+    }
+
+    VulkanSamplerRecord* GetSampler(VulkanSamplerHandle handle) {
+        return mSamplers.Get(handle);
+    }
+
+    //==================================================================================================================================================
+    // pipeline
+    //==================================================================================================================================================
+
+    // 接管管线的所有权, 管线布局由创建方管理(通常是无绑定堆的共享布局)
+    VulkanPipelineHandle RegisterPipeline(VkPipeline pipeline, VkPipelineLayout pipelineLayout, VkPipelineBindPoint pipelineBindPoint) {
+        VulkanPipelineRecord record = {
+            .pipeline          = pipeline,
+            .pipelineLayout    = pipelineLayout,
+            .pipelineBindPoint = pipelineBindPoint,
+        };
+        VulkanPipelineHandle handle = mPipelines.Allocate(record);
+        if (!handle) {
+            DestroyRecord(record);
+        }
+        return handle;
+    }
+
+    void DestroyPipeline(VulkanPipelineHandle handle) {
+        if (VulkanPipelineRecord* record = mPipelines.TryGet(handle)) {
+            Retire(*record);
+            mPipelines.Free(handle);
+        }
+    }
+
+    VulkanPipelineRecord* GetPipeline(VulkanPipelineHandle handle) {
+        return mPipelines.Get(handle);
+    }
+
+    void BindPipeline(VkCommandBuffer commandBuffer, VulkanPipelineHandle handle) {
+        if (VulkanPipelineRecord* record = mPipelines.Get(handle)) {
+            vkCmdBindPipeline(commandBuffer, record->pipelineBindPoint, record->pipeline);
+        }
+    }
+
+private:
+    static VkImageViewType GetImageViewType(const VkImageCreateInfo& createInfo) {
+        switch (createInfo.imageType) {
+            case VK_IMAGE_TYPE_1D:
+                return createInfo.arrayLayers > 1 ? VK_IMAGE_VIEW_TYPE_1D_ARRAY : VK_IMAGE_VIEW_TYPE_1D;
+            case VK_IMAGE_TYPE_3D:
+                return VK_IMAGE_VIEW_TYPE_3D;
+            default:
+                if ((createInfo.flags & VK_IMAGE_CREATE_CUBE_COMPATIBLE_BIT) && createInfo.arrayLayers % 6 == 0) {
+                    return createInfo.arrayLayers > 6 ? VK_IMAGE_VIEW_TYPE_CUBE_ARRAY : VK_IMAGE_VIEW_TYPE_CUBE;
+                }
+                return createInfo.arrayLayers > 1 ? VK_IMAGE_VIEW_TYPE_2D_ARRAY : VK_IMAGE_VIEW_TYPE_2D;
+        }
+    }
+
+    // 记录复制到销毁函数中, 句柄可以立即释放
+    template<typename Record>
+    void Retire(const Record& record, VkDeviceSize bytes = 0) {
+        if (mDeletionQueue == nullptr) {
+            Record copy = record;
+            DestroyRecord(copy);
+            return;
+        }
+        mDeletionQueue->Retire([this, copy = record]() mutable { DestroyRecord(copy); }, bytes);
+    }
+
+    void DestroyRecord(VulkanBufferRecord& record) {
+        if (mBindlessHeap != nullptr) {
+            mBindlessHeap->Free(VulkanBindlessType::StorageBuffer, record.bindlessIndex);
+        }
+        mAllocator->DestroyBuffer(record.buffer, record.allocation);
+    }
+
+    void DestroyRecord(VulkanImageRecord& record) {
+        if (!record.owned) {
+            return;
+        }
+        if (mBindlessHeap != nullptr) {
+            mBindlessHeap->Free(VulkanBindlessType::SampledImage, record.sampledIndex);
+            mBindlessHeap->Free(VulkanBindlessType::StorageImage, record.storageIndex);
+        }
+        if (record.imageView != VK_NULL_HANDLE) {
+            vkDestroyImageView(mDevice, record.imageView, VulkanHostMemory::GetCallbacks());
+            record.imageView = VK_NULL_HANDLE;
+        }
+        mAllocator->DestroyImage(record.image, record.allocation);
+    }
+
+    void DestroyRecord(VulkanSamplerRecord& record) {
+        if (mBindlessHeap != nullptr) {
+            mBindlessHeap->Free(VulkanBindlessType::Sampler, record.bindlessIndex);
+        }
+        if (record.sampler != VK_NULL_HANDLE) {
+            vkDestroySampler(mDevice, record.sampler, VulkanHostMemory::GetCallbacks());
+            record.sampler = VK_NULL_HANDLE;
+        }
+    }
+
+    void DestroyRecord(VulkanPipelineRecord& record) {
+        if (record.pipeline != VK_NULL_HANDLE) {
+            vkDestroyPipeline(mDevice, record.pipeline, VulkanHostMemory::GetCallbacks());
+            record.pipeline = VK_NULL_HANDLE;
+        }
+    }
+};
+} // namespace Nova
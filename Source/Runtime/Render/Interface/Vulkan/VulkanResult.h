@@ -0,0 +1,144 @@
+#pragma once
+#include "VulkanHelper.hpp"
+
+#include <cstdlib>
+#include <exception>
+
+// 编译期选择未检查错误码的处理策略, 未指定时使用VK_RESULT_NODISCARD, 其余策略需要在构建配置中显式定义
+//   VK_RESULT_THROW     析构时错误码仍未被读取则抛出VkResult; 栈展开期间只记录日志, 不会因二次抛出而std::terminate
+//   VK_RESULT_ABORT     析构时错误码仍未被读取则记录日志并终止程序
+//   VK_RESULT_NODISCARD 只依靠[[nodiscard]]在编译期提示
+//   VK_RESULT_PROPAGATE 不做任何检查, 行为与VkResult相同
+#if !defined(VK_RESULT_THROW) && !defined(VK_RESULT_ABORT) && !defined(VK_RESULT_NODISCARD) && !defined(VK_RESULT_PROPAGATE)
+    #define VK_RESULT_NODISCARD
+#endif
+
+#if defined(_MSC_VER)
+    #define NOVA_COLD_PATH __declspec(noinline)
+#else
+    #define NOVA_COLD_PATH __attribute__((noinline, cold))
+#endif
+
+namespace Nova {
+
+enum class VulkanResultPolicy {
+    Throw,
+    Abort,
+    NoDiscard,
+    Propagate,
+};
+
+// 负值错误码以及没有合适错误码时使用的VK_RESULT_MAX_ENUM视为错误, 转换为无符号数后只需一次比较
+constexpr bool IsVulkanError(VkResult result) noexcept {
+    return uint32_t(result) >= uint32_t(VK_RESULT_MAX_ENUM);
+}
+
+// 需要检查的结果: 读取(转换为VkResult)后即视为已处理, 析构时错误仍未被读取才会进入处理函数
+// 成功路径上只有一次比较, 处理函数不会被内联
+template<VulkanResultPolicy Policy>
+class [[nodiscard]] BasicVulkanResult {
+private:
+    VkResult result;
+
+public:
+    using VkResultCallback = void (*)(VkResult);
+
+private:
+    static inline VkResultCallback callbackUnchecked = nullptr;
+
+public:
+    constexpr BasicVulkanResult(VkResult result) noexcept: result(result) {}
+    constexpr BasicVulkanResult(BasicVulkanResult&& other) noexcept: result(other.result) {
+        other.result = VK_SUCCESS;
+    }
+
+    BasicVulkanResult(const BasicVulkanResult&)            = delete;
+    BasicVulkanResult& operator=(const BasicVulkanResult&) = delete;
+    BasicVulkanResult& operator=(BasicVulkanResult&&)      = delete;
+
+    ~BasicVulkanResult() noexcept(Policy != VulkanResultPolicy::Throw) {
+        if (IsVulkanError(result)) [[unlikely]] {
+            OnUnchecked(result);
+        }
+    }
+
+    constexpr operator VkResult() noexcept {
+        VkResult temp = result;
+        result        = VK_SUCCESS;
+        return temp;
+    }
+
+    // 明确放弃检查, 用于错误已在内部记录的尽力而为的调用
+    constexpr void Ignore() noexcept {
+        result = VK_SUCCESS;
+    }
+
+    // 在抛出或终止之前调用, 用于记录现场
+    static void SetUncheckedCallback(VkResultCallback callback) {
+        callbackUnchecked = callback;
+    }
+
+private:
+    NOVA_COLD_PATH static void OnUnchecked(VkResult result) noexcept(Policy != VulkanResultPolicy::Throw) {
+        if (callbackUnchecked != nullptr) {
+            callbackUnchecked(result);
+        }
+        if constexpr (Policy == VulkanResultPolicy::Throw) {
+            // 其他异常引起的栈展开中析构时再抛出会直接std::terminate, 此时保留正在传播的异常
+            if (std::uncaught_exceptions() > 0) {
+                NOVA_LOG_ERROR(RHI, "Unchecked Vulkan error during stack unwinding: {}", int32_t(result));
+                return;
+            }
+            throw result;
+        } else {
+            NOVA_LOG_CRITICAL(RHI, "Unchecked Vulkan error: {}", int32_t(result));
+            // 终止前输出队列中的日志
+            Log::Shutdown();
+            std::abort();
+        }
+    }
+};
+
+// 不检查的结果是平凡类型, 与VkResult一样通过寄存器返回; 需要检查的结果有非平凡析构函数, 跨越函数调用时只能通过内存返回
+template<>
+class [[nodiscard]] BasicVulkanResult<VulkanResultPolicy::NoDiscard> {
+private:
+    VkResult result;
+
+public:
+    constexpr BasicVulkanResult(VkResult result) noexcept: result(result) {}
+
+    constexpr operator VkResult() const noexcept {
+        return result;
+    }
+
+    constexpr void Ignore() const noexcept {}
+};
+
+template<>
+class BasicVulkanResult<VulkanResultPolicy::Propagate> {
+private:
+    VkResult result;
+
+public:
+    constexpr BasicVulkanResult(VkResult result) noexcept: result(result) {}
+
+    constexpr operator VkResult() const noexcept {
+        return result;
+    }
+
+    constexpr void Ignore() const noexcept {}
+};
+
+#if defined(VK_RESULT_THROW)
+inline constexpr VulkanResultPolicy VULKAN_RESULT_POLICY = VulkanResultPolicy::Throw;
+#elif defined(VK_RESULT_ABORT)
+inline constexpr VulkanResultPolicy VULKAN_RESULT_POLICY = VulkanResultPolicy::Abort;
+#elif defined(VK_RESULT_NODISCARD)
+inline constexpr VulkanResultPolicy VULKAN_RESULT_POLICY = VulkanResultPolicy::NoDiscard;
+#else
+inline constexpr VulkanResultPolicy VULKAN_RESULT_POLICY = VulkanResultPolicy::Propagate;
+#endif
+
+using VulkanResult = BasicVulkanResult<VULKAN_RESULT_POLICY>;
+} // namespace Nova
@@ -28,4 +28,6 @@
     #define NOMINMAX // 定义该宏可避免windows.h中的min和max两个宏与标准库中的函数名冲突
 #endif
 
-#include <vulkan/vulkan.h>
\ No newline at end of file
+#include <vulkan/vulkan.h>
+
+#include "Core/Log.h"
@@ -0,0 +1,1306 @@
+#pragma once
+#include "VulkanDevice.h"
+#include "VulkanParallelRecorder.h"
+#include "VulkanProfiler.h"
+
+#include "Core/LinearArena.h"
+#include "Core/ScratchArena.h"
+
+namespace Nova {
+
+// 一个表面(窗口)上的交换链及其飞行帧, 没有表面时以离屏图像代替交换链图像
+// 一个设备上可以有多个交换链, 各自的帧循环可以在不同线程上运行; 交换链拥有构造时传入的表面, 在Terminate中销毁
+class VulkanSwapchain: public VulkanDeviceChild {
+    //======================================================================================================================================================
+    // surface, device
+    //======================================================================================================================================================
+private:
+    VulkanDevice& mDevice;
+    VkSurfaceKHR  mSurface = VK_NULL_HANDLE;
+
+public:
+    explicit VulkanSwapchain(VulkanDevice& device, VkSurfaceKHR surface = VK_NULL_HANDLE): mDevice(device), mSurface(surface) {
+        mDevice.AttachChild(this);
+    }
+
+    VulkanSwapchain(const VulkanSwapchain&)            = delete;
+    VulkanSwapchain& operator=(const VulkanSwapchain&) = delete;
+
+    ~VulkanSwapchain() override {
+        Terminate();
+    }
+
+    VulkanDevice& GetDevice() const {
+        return mDevice;
+    }
+
+    VkSurfaceKHR GetSurface() const {
+        return mSurface;
+    }
+
+    //======================================================================================================================================================
+    // swap chain，image, image view
+    //======================================================================================================================================================
+private:
+    std::vector<VkSurfaceFormatKHR> mAvailableSurfaceFormats;
+    std::vector<VkPresentModeKHR>   mAvailablePresentModes;
+
+    VkSwapchainKHR           mSwapChain = VK_NULL_HANDLE;
+    std::vector<VkImage>     mSwapChainImages;
+    std::vector<VkImageView> mSwapChainImageViews;
+
+    VkSwapchainCreateInfoKHR mSwapChainCreateInfo = {};
+
+    // 表面的当前尺寸未定时使用的尺寸, 每个交换链独立设置, 会被限制在表面支持的范围内
+    VkExtent2D mFallbackExtent = DEFAULT_WINDOW_SIZE;
+    // 交换链的尺寸来自备用尺寸, 即表面没有当前尺寸
+    bool mExtentFromFallback = false;
+
+private:
+    std::vector<void (*)()> mCreateSwapChainCallbacks;
+    std::vector<void (*)()> mDestroySwapChainCallbacks;
+
+public:
+    const VkFormat& GetAvailableSurfaceFormat(uint32_t index) const {
+        return mAvailableSurfaceFormats[index].format;
+    }
+
+    const VkColorSpaceKHR& GetAvailableSurfaceColorSpace(uint32_t index) const {
+        return mAvailableSurfaceFormats[index].colorSpace;
+    }
+
+    uint32_t GetAvailableSurfaceFormatCount() const {
+        return static_cast<uint32_t>(mAvailableSurfaceFormats.size());
+    }
+
+    VkSwapchainKHR GetSwapChain() const {
+        return mSwapChain;
+    }
+
+    VkImage GetSwapChainImage(uint32_t index) const {
+        return mSwapChainImages[index];
+    }
+
+    uint32_t GetSwapChainImageCount() const {
+        return static_cast<uint32_t>(mSwapChainImages.size());
+    }
+
+    VkImageView GetSwapChainImageView(uint32_t index) const {
+        return mSwapChainImageViews[index];
+    }
+
+    const VkSwapchainCreateInfoKHR& GetSwapChainCreateInfo() const {
+        return mSwapChainCreateInfo;
+    }
+
+    // 表面没有当前尺寸(如无头表面和Wayland)时交换链使用的尺寸, 通常为窗口的帧缓冲尺寸或离屏尺寸
+    // 交换链已经按备用尺寸创建且尺寸改变时, 在下一次呈现之后重建
+    void SetFallbackExtent(VkExtent2D extent) {
+        if (mExtentFromFallback && mSwapChain != VK_NULL_HANDLE
+            && (extent.width != mFallbackExtent.width || extent.height != mFallbackExtent.height)) {
+            mSwapChainOutdated = true;
+        }
+        mFallbackExtent = extent;
+    }
+
+public:
+    void AddCreateSwapChainCallback(void (*function)()) {
+        mCreateSwapChainCallbacks.push_back(function);
+    }
+
+    void AddDestroySwapChainCallback(void (*function)()) {
+        mDestroySwapChainCallbacks.push_back(function);
+    }
+
+private:
+    VulkanResult CreateSwapchainInternal() {
+        VkDevice device = mDevice.GetDevice();
+
+        // 创建交换链
+        VkResult result = vkCreateSwapchainKHR(device, &mSwapChainCreateInfo, VulkanHostMemory::GetCallbacks(), &mSwapChain);
+        if (result != VK_SUCCESS) {
+            NOVA_LOG_ERROR(RHI, "Failed to create swap chain: {}", int32_t(result));
+            // 失败时输出的句柄内容未定义
+            mSwapChain = VK_NULL_HANDLE;
+            return result;
+        }
+
+        // 获取交换链图像
+        uint32_t swapChainImageCount = 0;
+
+        result = vkGetSwapchainImagesKHR(device, mSwapChain, &swapChainImageCount, nullptr);
+        if (result != VK_SUCCESS) {
+            NOVA_LOG_ERROR(RHI, "Failed to get swap chain images: {}", int32_t(result));
+            return result;
+        }
+
+        // 获取交换链图像
+        mSwapChainImages.resize(swapChainImageCount);
+        result = vkGetSwapchainImagesKHR(device, mSwapChain, &swapChainImageCount, mSwapChainImages.data());
+        if (result != VK_SUCCESS) {
+            NOVA_LOG_ERROR(RHI, "Failed to get swap chain images: {}", int32_t(result));
+            return result;
+        }
+
+        mSwapChainImageViews.resize(swapChainImageCount);
+        // 交换链图像视图创建信息
+        VkImageViewCreateInfo imageViewCreateInfo = { .sType            = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO,
+                                                      .viewType         = VK_IMAGE_VIEW_TYPE_2D,
+                                                      .format           = mSwapChainCreateInfo.imageFormat,
+                                                      .subresourceRange = { VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1 } };
+
+        for (size_t i = 0; i < swapChainImageCount; i++) {
+            imageViewCreateInfo.image = mSwapChainImages[i];
+
+            result = vkCreateImageView(device, &imageViewCreateInfo, VulkanHostMemory::GetCallbacks(), &mSwapChainImageViews[i]);
+            if (result != VK_SUCCESS) {
+                NOVA_LOG_ERROR(RHI, "Failed to create a swapch image view: {}", int32_t(result));
+                return result;
+            }
+        }
+
+        // 呈现ID在交换链之间连续递增, 只能等待在新交换链上呈现过的ID
+        mSwapChainFirstPresentId = mLastPresentId + 1;
+
+        // 每张交换链图像对应一个渲染完成信号量
+        return EnsureRenderFinishedSemaphores(swapChainImageCount);
+    }
+
+public:
+    VulkanResult TryGetSurfaceFormats() {
+        uint32_t surfaceFormatCount = 0;
+
+        VkResult result = vkGetPhysicalDeviceSurfaceFormatsKHR(mDevice.GetPhysicalDevice(), mSurface, &surfaceFormatCount, nullptr);
+        if (result != VK_SUCCESS) {
+            NOVA_LOG_ERROR(RHI, "Failed to get the count of surface formats: {}", int32_t(result));
+            return result;
+        }
+
+        if (surfaceFormatCount == 0) {
+            NOVA_LOG_ERROR(RHI, "Failed to find any surface formats");
+            abort();
+        }
+
+        // 获取surface formats
+        mAvailableSurfaceFormats.resize(surfaceFormatCount);
+        result = vkGetPhysicalDeviceSurfaceFormatsKHR(mDevice.GetPhysicalDevice(), mSurface, &surfaceFormatCount, mAvailableSurfaceFormats.data());
+        if (result != VK_SUCCESS) {
+            NOVA_LOG_ERROR(RHI, "Failed to get surface formats: {}", int32_t(result));
+        }
+
+        return VK_SUCCESS;
+    }
+
+    VulkanResult TrySetSurfaceFormat(VkSurfaceFormatKHR surfaceFormat) {
+        bool formatIsAvailable = false;
+        bool needCheckFormat   = (surfaceFormat.format != VK_FORMAT_UNDEFINED);
+        for (auto& item: mAvailableSurfaceFormats) {
+            if (item.colorSpace == surfaceFormat.colorSpace && (!needCheckFormat || item.format == surfaceFormat.format)) {
+                mSwapChainCreateInfo.imageFormat     = item.format;
+                mSwapChainCreateInfo.imageColorSpace = item.colorSpace;
+                formatIsAvailable                    = true;
+                break;
+            }
+        }
+
+        // 如果没有符合的格式,返回指定错误码
+        if (formatIsAvailable == false) {
+            return VK_ERROR_FORMAT_NOT_SUPPORTED;
+        }
+
+        // 如果交换链已经存在,则重新创建交换链
+        if (mSwapChain != nullptr) {
+            return TryRecreateSwapChain();
+        }
+
+        return VK_SUCCESS;
+    }
+
+    VulkanResult TryCreateSwapchain(bool limitFrameRate = true, VkSwapchainCreateFlagsKHR flags = 0) {
+        VkPhysicalDevice physicalDevice = mDevice.GetPhysicalDevice();
+
+        // 设备的呈现队列族是按另一个表面选出的, 需要确认它也能在这个表面上呈现
+        if (!mDevice.IsSurfaceSupported(mSurface)) {
+            NOVA_LOG_ERROR(RHI, "The presentation queue family does not support the surface");
+            return VK_ERROR_INITIALIZATION_FAILED;
+        }
+
+        // 获取surface capabilities
+        VkSurfaceCapabilitiesKHR surfaceCapabilities = {};
+        if (VkResult result = vkGetPhysicalDeviceSurfaceCapabilitiesKHR(physicalDevice, mSurface, &surfaceCapabilities)) {
+            NOVA_LOG_ERROR(RHI, "Failed to get physical device surface capabilities: {}", int32_t(result));
+            return result;
+        }
+
+        mSwapChainCreateInfo.minImageCount = SelectImageCount(surfaceCapabilities);
+
+        mSwapChainCreateInfo.imageExtent = SelectImageExtent(surfaceCapabilities);
+
+        // 视点数
+        mSwapChainCreateInfo.imageArrayLayers = 1;
+        // 使用当前变换
+        mSwapChainCreateInfo.preTransform = surfaceCapabilities.currentTransform;
+
+        // 指定处理swapchia图形的透明通道的方式
+        // window可能会指定，此时应选择继承方式
+        if ((surfaceCapabilities.supportedCompositeAlpha & VK_COMPOSITE_ALPHA_INHERIT_BIT_KHR) != 0u) {
+            mSwapChainCreateInfo.compositeAlpha = VK_COMPOSITE_ALPHA_INHERIT_BIT_KHR;
+        } else {
+            for (size_t i = 0; i < 4; i++) {
+                if ((surfaceCapabilities.supportedCompositeAlpha & 1 << i) != 0u) {
+                    mSwapChainCreateInfo.compositeAlpha = VkCompositeAlphaFlagBitsKHR(surfaceCapabilities.supportedCompositeAlpha & 1 << i);
+                    break;
+                }
+            }
+        }
+
+        // 设置交换链图像格式,默认为color attachment
+        mSwapChainCreateInfo.imageUsage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT;
+        // 如果支持传输目标，则添加传输目标标志,这样可以执行清屏以及blit操作
+        if ((surfaceCapabilities.supportedUsageFlags & VK_IMAGE_USAGE_TRANSFER_DST_BIT) != 0u) {
+            mSwapChainCreateInfo.imageUsage |= VK_IMAGE_USAGE_TRANSFER_DST_BIT;
+        }
+        // 如果支持传输源，则添加传输源标志,可以实现窗口截屏
+        if ((surfaceCapabilities.supportedUsageFlags & VK_IMAGE_USAGE_TRANSFER_SRC_BIT) != 0u) {
+            mSwapChainCreateInfo.imageUsage |= VK_IMAGE_USAGE_TRANSFER_SRC_BIT;
+        } else {
+            NOVA_LOG_ERROR(RHI, "VK_IMAGE_USAGE_TRANSFER_SRC_BIT is not supported");
+        }
+
+        // 如果没有可用的surface format, 则尝试获取
+        if (mAvailableSurfaceFormats.empty()) {
+            // 如果没有失败,那么availableSurfaceFormats肯定有值
+            VkResult result = TryGetSurfaceFormats();
+            if (result != VK_SUCCESS) {
+                return result;
+            }
+        }
+
+        // 如果没有指定图像格式,则尝试选择一个
+        if (mSwapChainCreateInfo.imageFormat == VK_FORMAT_UNDEFINED) {
+            // 尝试选择一个四分量UNORM格式,通常R8G8B8A8或者B8G8R8A8肯定是可用的
+            if (TrySetSurfaceFormat({ VK_FORMAT_R8G8B8A8_UNORM, VK_COLOR_SPACE_SRGB_NONLINEAR_KHR }) != VK_SUCCESS &&
+                TrySetSurfaceFormat({ VK_FORMAT_B8G8R8A8_UNORM, VK_COLOR_SPACE_SRGB_NONLINEAR_KHR }) != VK_SUCCESS) {
+                // 如果真的没有找到, 那么就选择第一个可用的格式
+                mSwapChainCreateInfo.imageFormat     = mAvailableSurfaceFormats[0].format;
+                mSwapChainCreateInfo.imageColorSpace = mAvailableSurfaceFormats[0].colorSpace;
+                NOVA_LOG_ERROR(RHI, "Failed to select a four-component UNORM surface format");
+            }
+        }
+
+        // 获取surface present mode数量
+        uint32_t surfacePresentModeCount = 0;
+
+        VkResult result = vkGetPhysicalDeviceSurfacePresentModesKHR(physicalDevice, mSurface, &surfacePresentModeCount, nullptr);
+        if (result != VK_SUCCESS) {
+            NOVA_LOG_ERROR(RHI, "Failed to get the count of surface present modes: {}", int32_t(result));
+            return result;
+        }
+        if (surfacePresentModeCount == 0) {
+            NOVA_LOG_ERROR(RHI, "Failed to find any surface present modes");
+            abort();
+        }
+
+        // 获取surface present modes
+        mAvailablePresentModes.resize(surfacePresentModeCount);
+        result = vkGetPhysicalDeviceSurfacePresentModesKHR(physicalDevice, mSurface, &surfacePresentModeCount, mAvailablePresentModes.data());
+        if (result != VK_SUCCESS) {
+            NOVA_LOG_ERROR(RHI, "Failed to get surface present modes: {}", int32_t(result));
+            return result;
+        }
+
+        // 设置交换链呈现模式, 默认为FIFO, 即垂直同步; 不限制帧率且没有通过SetPresentMode指定时选择MAILBOX
+        if (limitFrameRate == false && mRequestedPresentMode == VK_PRESENT_MODE_FIFO_KHR) {
+            mRequestedPresentMode = VK_PRESENT_MODE_MAILBOX_KHR;
+        }
+        mSwapChainCreateInfo.presentMode = SelectPresentMode(mRequestedPresentMode);
+        NOVA_LOG_INFO(
+            RHI, "Present mode: {}, swap chain images: {}", GetPresentModeName(mSwapChainCreateInfo.presentMode), mSwapChainCreateInfo.minImageCount
+        );
+
+        // 设置其他交换链信息
+        mSwapChainCreateInfo.sType            = VK_STRUCTURE_TYPE_SWAPCHAIN_CREATE_INFO_KHR;
+        mSwapChainCreateInfo.flags            = flags;
+        mSwapChainCreateInfo.surface          = mSurface;
+        mSwapChainCreateInfo.imageSharingMode = VK_SHARING_MODE_EXCLUSIVE; // 独占模式
+        mSwapChainCreateInfo.clipped          = VK_TRUE; // 裁剪不可见区域
+
+        // 创建交换链
+        result = CreateSwapchainInternal();
+        if (result != VK_SUCCESS) {
+            return result;
+        }
+
+        // 交换链创建成功后,调用回调函数
+        for (auto& callback: mCreateSwapChainCallbacks) {
+            callback();
+        }
+
+        return VK_SUCCESS;
+    }
+
+    VulkanResult TryRecreateSwapChain() {
+        VkSurfaceCapabilitiesKHR surfaceCapabilities = {};
+        // 获取surface capabilities
+        VkResult result = vkGetPhysicalDeviceSurfaceCapabilitiesKHR(mDevice.GetPhysicalDevice(), mSurface, &surfaceCapabilities);
+        if (result != VK_SUCCESS) {
+            NOVA_LOG_ERROR(RHI, "Failed to get physical device surface capabilities: {}", int32_t(result));
+            return result;
+        }
+
+        // 窗口最小化时尺寸为0, 无法创建交换链, 保留旧的交换链等待下次重建
+        VkExtent2D imageExtent = SelectImageExtent(surfaceCapabilities);
+        if (imageExtent.width == 0 || imageExtent.height == 0) {
+            return VK_SUBOPTIMAL_KHR;
+        }
+
+        mSwapChainCreateInfo.imageExtent   = imageExtent;
+        mSwapChainCreateInfo.minImageCount = SelectImageCount(surfaceCapabilities);
+        // 设置旧的交换链, 驱动可以复用其资源, 已经提交的呈现仍会在旧交换链上完成
+        mSwapChainCreateInfo.oldSwapchain = mSwapChain;
+
+        // 调用销毁交换链回调函数, 回调中的资源应通过DeferDestroy退役而不是立即销毁
+        // 上一次重建失败时回调已经调用过
+        if (mSwapChain != VK_NULL_HANDLE) {
+            for (auto& callback: mDestroySwapChainCallbacks) {
+                callback();
+            }
+        }
+
+        // 旧交换链、图像视图和渲染完成信号量可能仍被在途的帧和呈现使用, 不等待队列空闲,
+        // 以当前设备帧退役, 该设备所有交换链在途的帧都越过当前帧后再销毁
+        VkSwapchainKHR           oldSwapChain      = mSwapChain;
+        std::vector<VkImageView> oldImageViews     = std::move(mSwapChainImageViews);
+        std::vector<VkSemaphore> oldRenderFinished = std::move(mRenderFinishedSemaphores);
+        mSwapChainImageViews.resize(0);
+        mRenderFinishedSemaphores.resize(0);
+
+        // 创建新的交换链, 即使创建失败旧交换链也已经退役
+        mSwapChain                        = VK_NULL_HANDLE;
+        result                            = CreateSwapchainInternal();
+        mSwapChainCreateInfo.oldSwapchain = VK_NULL_HANDLE;
+        RetireSwapChainObjects(oldSwapChain, oldImageViews, oldRenderFinished);
+
+        if (result != VK_SUCCESS) {
+            // 交换链本身创建成功而之后的步骤失败时, 新的交换链和已经创建的视图同样退役; 下一次BeginFrame会再次尝试重建
+            RetireSwapChainObjects(mSwapChain, mSwapChainImageViews, mRenderFinishedSemaphores);
+            mSwapChain = VK_NULL_HANDLE;
+            mSwapChainImageViews.resize(0);
+            mRenderFinishedSemaphores.resize(0);
+            return result;
+        }
+
+        // 交换链创建成功后,调用回调函数
+        for (auto& callback: mCreateSwapChainCallbacks) {
+            callback();
+        }
+
+        return VK_SUCCESS;
+    }
+
+private:
+    // 以当前设备帧退役, 跳过尚未创建的对象
+    void RetireSwapChainObjects(
+        VkSwapchainKHR                  swapChain,
+        const std::vector<VkImageView>& imageViews,
+        const std::vector<VkSemaphore>& renderFinished
+    ) {
+        mDevice.DeferDestroy([device = mDevice.GetDevice(), swapChain, imageViews, renderFinished]() {
+            for (auto& imageView: imageViews) {
+                if (imageView != VK_NULL_HANDLE) {
+                    vkDestroyImageView(device, imageView, VulkanHostMemory::GetCallbacks());
+                }
+            }
+            for (auto& semaphore: renderFinished) {
+                vkDestroySemaphore(device, semaphore, VulkanHostMemory::GetCallbacks());
+            }
+            if (swapChain != VK_NULL_HANDLE) {
+                vkDestroySwapchainKHR(device, swapChain, VulkanHostMemory::GetCallbacks());
+            }
+        });
+    }
+
+    //======================================================================================================================================================
+    // present mode, frame pacing
+    //======================================================================================================================================================
+public:
+    // 呈现间隔统计, 单位毫秒
+    // 启用呈现等待且设置了最大帧延迟时为图像实际显示的间隔, 否则为CPU调用vkQueuePresentKHR的间隔
+    struct PresentStats {
+        double   lastIntervalMs    = 0.0;
+        double   averageIntervalMs = 0.0;
+        double   minIntervalMs     = 0.0;
+        double   maxIntervalMs     = 0.0;
+        double   jitterMs          = 0.0; // 间隔的标准差
+        uint32_t sampleCount       = 0;
+        bool     measuredOnDisplay = false;
+    };
+
+    static constexpr uint32_t PRESENT_INTERVAL_HISTORY = 128;
+
+    // 呈现等待的超时, 超时不视为错误, 呈现引擎异常时不会卡住帧循环
+    static constexpr uint64_t PRESENT_WAIT_TIMEOUT = 100'000'000;
+
+private:
+    // 申请的呈现模式和交换链图像数, 表面不支持时回退, 实际使用的值见mSwapChainCreateInfo
+    VkPresentModeKHR mRequestedPresentMode = VK_PRESENT_MODE_FIFO_KHR;
+    uint32_t         mRequestedImageCount  = 0; // 0表示最小图像数加一
+
+    // 同时在途的最大帧数, 0表示不额外限制(即飞行帧数)
+    // 开始第G帧之前第G - latency帧必须已经完成, 启用呈现等待时必须已经显示, 从而限制输入到显示的延迟
+    uint32_t mMaxFrameLatency = 0;
+
+    // 呈现ID为该交换链的帧编号加一, 单调递增
+    uint64_t mLastPresentId           = 0;
+    uint64_t mSwapChainFirstPresentId = 1;
+
+    // 环形缓冲, mPresentIntervalCount为累计样本数
+    std::array<double, PRESENT_INTERVAL_HISTORY> mPresentIntervals     = {};
+    uint32_t                                     mPresentIntervalCount = 0;
+    uint64_t                                     mLastTimedPresentId   = 0;
+    std::chrono::steady_clock::time_point        mLastPresentTime;
+    bool                                         mPresentTimedOnDisplay = false;
+
+public:
+    // 交换链已经存在时以新的模式重建, 不支持的模式回退: IMMEDIATE -> MAILBOX -> FIFO, MAILBOX -> FIFO, FIFO_RELAXED -> FIFO
+    VulkanResult SetPresentMode(VkPresentModeKHR presentMode) {
+        mRequestedPresentMode = presentMode;
+        if (mSwapChain == VK_NULL_HANDLE) {
+            return VK_SUCCESS;
+        }
+        VkPresentModeKHR selectedPresentMode = SelectPresentMode(presentMode);
+        if (selectedPresentMode == mSwapChainCreateInfo.presentMode) {
+            return VK_SUCCESS;
+        }
+        mSwapChainCreateInfo.presentMode = selectedPresentMode;
+        NOVA_LOG_INFO(RHI, "Present mode: {}", GetPresentModeName(selectedPresentMode));
+        return TryRecreateSwapChain();
+    }
+
+    VkPresentModeKHR GetPresentMode() const {
+        return mSwapChainCreateInfo.presentMode;
+    }
+
+    // 交换链图像数, 会被限制在表面支持的范围内, 0表示最小图像数加一; 交换链已经存在时重建
+    VulkanResult SetSwapChainImageCount(uint32_t imageCount) {
+        mRequestedImageCount = imageCount;
+        if (mSwapChain == VK_NULL_HANDLE) {
+            return VK_SUCCESS;
+        }
+        return TryRecreateSwapChain();
+    }
+
+    void SetMaxFrameLatency(uint32_t latency) {
+        mMaxFrameLatency = latency;
+        // 测量方式可能改变, 丢弃之前的样本
+        mPresentIntervalCount = 0;
+        mLastTimedPresentId   = 0;
+    }
+
+    uint32_t GetMaxFrameLatency() const {
+        return mMaxFrameLatency;
+    }
+
+    PresentStats GetPresentStats() const {
+        PresentStats stats       = { .measuredOnDisplay = mPresentTimedOnDisplay };
+        uint32_t     sampleCount = std::min(mPresentIntervalCount, PRESENT_INTERVAL_HISTORY);
+        if (sampleCount == 0) {
+            return stats;
+        }
+
+        double sum = 0.0, sumOfSquares = 0.0;
+        stats.minIntervalMs = mPresentIntervals[0];
+        for (uint32_t i = 0; i < sampleCount; i++) {
+            double interval = mPresentIntervals[i];
+
+            sum          += interval;
+            sumOfSquares += interval * interval;
+
+            stats.minIntervalMs = std::min(stats.minIntervalMs, interval);
+            stats.maxIntervalMs = std::max(stats.maxIntervalMs, interval);
+        }
+        stats.sampleCount       = sampleCount;
+        stats.lastIntervalMs    = mPresentIntervals[(mPresentIntervalCount - 1) % PRESENT_INTERVAL_HISTORY];
+        stats.averageIntervalMs = sum / sampleCount;
+        stats.jitterMs          = std::sqrt(std::max(sumOfSquares / sampleCount - stats.averageIntervalMs * stats.averageIntervalMs, 0.0));
+        return stats;
+    }
+
+    // 最近的呈现间隔, 按时间先后排列
+    std::vector<double> GetPresentIntervals() const {
+        uint32_t            sampleCount = std::min(mPresentIntervalCount, PRESENT_INTERVAL_HISTORY);
+        std::vector<double> intervals(sampleCount);
+        for (uint32_t i = 0; i < sampleCount; i++) {
+            intervals[i] = mPresentIntervals[(mPresentIntervalCount - sampleCount + i) % PRESENT_INTERVAL_HISTORY];
+        }
+        return intervals;
+    }
+
+    static const char* GetPresentModeName(VkPresentModeKHR presentMode) {
+        switch (presentMode) {
+            case VK_PRESENT_MODE_IMMEDIATE_KHR:
+                return "IMMEDIATE";
+            case VK_PRESENT_MODE_MAILBOX_KHR:
+                return "MAILBOX";
+            case VK_PRESENT_MODE_FIFO_KHR:
+                return "FIFO";
+            case VK_PRESENT_MODE_FIFO_RELAXED_KHR:
+                return "FIFO_RELAXED";
+            default:
+                return "unknown";
+        }
+    }
+
+private:
+    VkPresentModeKHR SelectPresentMode(VkPresentModeKHR presentMode) const {
+        auto isAvailable = [this](VkPresentModeKHR mode) {
+            return std::find(mAvailablePresentModes.begin(), mAvailablePresentModes.end(), mode) != mAvailablePresentModes.end();
+        };
+        if (isAvailable(presentMode)) {
+            return presentMode;
+        }
+        // IMMEDIATE不可用时MAILBOX同样不受垂直同步限制; 其余情况回退到总是支持的FIFO, 不会引入撕裂
+        if (presentMode == VK_PRESENT_MODE_IMMEDIATE_KHR && isAvailable(VK_PRESENT_MODE_MAILBOX_KHR)) {
+            return VK_PRESENT_MODE_MAILBOX_KHR;
+        }
+        return VK_PRESENT_MODE_FIFO_KHR;
+    }
+
+    // 如果当前尺寸已经存在, 则使用当前尺寸, 否则使用最小尺寸和最大尺寸之间的备用尺寸
+    VkExtent2D SelectImageExtent(const VkSurfaceCapabilitiesKHR& surfaceCapabilities) {
+        // 如果尺寸未定, 当前尺寸的值会是-1
+        mExtentFromFallback = surfaceCapabilities.currentExtent.width == UINT32_MAX;
+        if (!mExtentFromFallback) {
+            return surfaceCapabilities.currentExtent;
+        }
+        return {
+            glm::clamp(mFallbackExtent.width, surfaceCapabilities.minImageExtent.width, surfaceCapabilities.maxImageExtent.width),
+            glm::clamp(mFallbackExtent.height, surfaceCapabilities.minImageExtent.height, surfaceCapabilities.maxImageExtent.height),
+        };
+    }
+
+    uint32_t SelectImageCount(const VkSurfaceCapabilitiesKHR& surfaceCapabilities) const {
+        uint32_t imageCount = mRequestedImageCount != 0 ? mRequestedImageCount : surfaceCapabilities.minImageCount + 1;
+        imageCount          = std::max(imageCount, surfaceCapabilities.minImageCount);
+        // maxImageCount为0表示没有上限
+        if (surfaceCapabilities.maxImageCount != 0) {
+            imageCount = std::min(imageCount, surfaceCapabilities.maxImageCount);
+        }
+        return imageCount;
+    }
+
+    bool UsePresentWaitPacing() const {
+        return mDevice.IsPresentWaitEnabled() && mMaxFrameLatency != 0 && !mHeadless;
+    }
+
+    // 在当前飞行帧的栅栏等待之后调用, 限制同时在途的帧数
+    VulkanResult PaceFrame() {
+        uint32_t latency = mMaxFrameLatency == 0 ? mFramesInFlight : std::min(mMaxFrameLatency, mFramesInFlight);
+        if (mFrameNumber < latency) {
+            return VK_SUCCESS;
+        }
+        uint64_t targetFrame = mFrameNumber - latency;
+
+        // 等待目标帧显示, 呈现ID为帧编号加一
+        uint64_t presentId = targetFrame + 1;
+        if (UsePresentWaitPacing() && mSwapChain != VK_NULL_HANDLE && presentId >= mSwapChainFirstPresentId && presentId <= mLastPresentId) {
+            VkResult result = mDevice.WaitForPresent(mSwapChain, presentId, PRESENT_WAIT_TIMEOUT);
+            if (result == VK_SUCCESS) {
+                RecordPresentInterval(presentId, true);
+            } else if (result != VK_TIMEOUT && result != VK_SUBOPTIMAL_KHR && result != VK_ERROR_OUT_OF_DATE_KHR) {
+                NOVA_LOG_ERROR(RHI, "Failed to wait for present {}: {}", presentId, int32_t(result));
+                return result;
+            }
+        }
+
+        // 当前飞行帧的栅栏对应第G - framesInFlight帧, 已经等待过
+        if (latency < mFramesInFlight) {
+            uint32_t frameIndex = (mCurrentFrame + mFramesInFlight - latency) % mFramesInFlight;
+            VkResult result     = vkWaitForFences(mDevice.GetDevice(), 1, &mFrames[frameIndex].inFlightFence, VK_TRUE, UINT64_MAX);
+            if (result != VK_SUCCESS) {
+                NOVA_LOG_ERROR(RHI, "Failed to wait for the frame fence: {}", int32_t(result));
+                return result;
+            }
+        }
+        return VK_SUCCESS;
+    }
+
+    // 相邻两次呈现都被计时才记录间隔
+    void RecordPresentInterval(uint64_t presentId, bool measuredOnDisplay) {
+        auto now = std::chrono::steady_clock::now();
+        if (mLastTimedPresentId != 0 && presentId == mLastTimedPresentId + 1) {
+            double interval = std::chrono::duration<double, std::milli>(now - mLastPresentTime).count();
+
+            mPresentIntervals[mPresentIntervalCount % PRESENT_INTERVAL_HISTORY] = interval;
+            mPresentIntervalCount++;
+        }
+        mLastTimedPresentId    = presentId;
+        mLastPresentTime       = now;
+        mPresentTimedOnDisplay = measuredOnDisplay;
+    }
+
+    //======================================================================================================================================================
+    // headless, offscreen swap chain
+    //======================================================================================================================================================
+private:
+    // 没有窗口表面时用普通图像代替交换链图像, 帧循环和交换链回调保持不变, 只是不再获取和呈现
+    bool                          mHeadless = false;
+    std::vector<VulkanAllocation> mOffscreenAllocations;
+
+public:
+    bool IsHeadless() const {
+        return mHeadless;
+    }
+
+    // 帧结束时交换链图像应处于的布局, 无头模式下没有呈现, 图像留在传输源布局以便读回
+    VkImageLayout GetSwapChainFinalLayout() const {
+        return mHeadless ? VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL : VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
+    }
+
+    // 创建离屏图像作为交换链图像, imageCount为0时与飞行帧数一致
+    VulkanResult CreateOffscreenSwapChain(VkExtent2D extent, VkFormat format = VK_FORMAT_R8G8B8A8_UNORM, uint32_t imageCount = 0) {
+        if (imageCount == 0) {
+            imageCount = mFramesInFlight;
+        }
+
+        mSwapChainCreateInfo                  = { .sType = VK_STRUCTURE_TYPE_SWAPCHAIN_CREATE_INFO_KHR };
+        mSwapChainCreateInfo.minImageCount    = imageCount;
+        mSwapChainCreateInfo.imageFormat      = format;
+        mSwapChainCreateInfo.imageColorSpace  = VK_COLOR_SPACE_SRGB_NONLINEAR_KHR;
+        mSwapChainCreateInfo.imageExtent      = extent;
+        mSwapChainCreateInfo.imageArrayLayers = 1;
+        mSwapChainCreateInfo.imageUsage       = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT;
+        mSwapChainCreateInfo.imageSharingMode = VK_SHARING_MODE_EXCLUSIVE;
+        mHeadless                             = true;
+
+        VkResult result = CreateOffscreenImages();
+        if (result != VK_SUCCESS) {
+            return result;
+        }
+
+        for (auto& callback: mCreateSwapChainCallbacks) {
+            callback();
+        }
+
+        NOVA_LOG_INFO(RHI, "Offscreen swap chain: {} x {}, {} images", extent.width, extent.height, imageCount);
+        return VK_SUCCESS;
+    }
+
+private:
+    VkResult CreateOffscreenImages() {
+        uint32_t imageCount = mSwapChainCreateInfo.minImageCount;
+
+        VkImageCreateInfo imageCreateInfo = {
+            .sType         = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO,
+            .imageType     = VK_IMAGE_TYPE_2D,
+            .format        = mSwapChainCreateInfo.imageFormat,
+            .extent        = { mSwapChainCreateInfo.imageExtent.width, mSwapChainCreateInfo.imageExtent.height, 1 },
+            .mipLevels     = 1,
+            .arrayLayers   = 1,
+            .samples       = VK_SAMPLE_COUNT_1_BIT,
+            .tiling        = VK_IMAGE_TILING_OPTIMAL,
+            .usage         = mSwapChainCreateInfo.imageUsage,
+            .sharingMode   = VK_SHARING_MODE_EXCLUSIVE,
+            .initialLayout = VK_IMAGE_LAYOUT_UNDEFINED,
+        };
+        VkImageViewCreateInfo imageViewCreateInfo = { .sType            = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO,
+                                                      .viewType         = VK_IMAGE_VIEW_TYPE_2D,
+                                                      .format           = mSwapChainCreateInfo.imageFormat,
+                                                      .subresourceRange = { VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1 } };
+
+        mSwapChainImages.resize(imageCount);
+        mSwapChainImageViews.resize(imageCount);
+        mOffscreenAllocations.resize(imageCount);
+        for (uint32_t i = 0; i < imageCount; i++) {
+            VkResult result = mDevice.GetMemoryAllocator().CreateImage(
+                imageCreateInfo,
+                VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+                mSwapChainImages[i],
+                mOffscreenAllocations[i]
+            );
+            if (result != VK_SUCCESS) {
+                return result;
+            }
+
+            imageViewCreateInfo.image = mSwapChainImages[i];
+
+            result = vkCreateImageView(mDevice.GetDevice(), &imageViewCreateInfo, VulkanHostMemory::GetCallbacks(), &mSwapChainImageViews[i]);
+            if (result != VK_SUCCESS) {
+                NOVA_LOG_ERROR(RHI, "Failed to create an offscreen image view: {}", int32_t(result));
+                return result;
+            }
+        }
+        return VK_SUCCESS;
+    }
+
+    // 销毁离屏图像, 交换链的创建信息保留, 重建设备后可以按原样重新创建
+    void DestroyOffscreenImages() {
+        for (uint32_t i = 0; i < mSwapChainImages.size(); i++) {
+            if (mSwapChainImageViews[i] != VK_NULL_HANDLE) {
+                vkDestroyImageView(mDevice.GetDevice(), mSwapChainImageViews[i], VulkanHostMemory::GetCallbacks());
+            }
+            mDevice.GetMemoryAllocator().DestroyImage(mSwapChainImages[i], mOffscreenAllocations[i]);
+        }
+        mSwapChainImages.resize(0);
+        mSwapChainImageViews.resize(0);
+        mOffscreenAllocations.resize(0);
+    }
+
+    //======================================================================================================================================================
+    // frames in flight, command pool, synchronization
+    //======================================================================================================================================================
+public:
+    static constexpr uint32_t DEFAULT_FRAMES_IN_FLIGHT = 2;
+    static constexpr uint32_t MAX_FRAMES_IN_FLIGHT     = 3;
+
+    // 每帧临时数据(常量、顶点等)的默认容量
+    static constexpr VkDeviceSize DEFAULT_TRANSIENT_FRAME_CAPACITY = VkDeviceSize(4) << 20;
+
+    // 每个飞行帧独占的资源, GPU执行第N帧时CPU可以录制第N+1帧
+    struct FrameContext {
+        VkCommandPool   commandPool             = VK_NULL_HANDLE;
+        VkCommandBuffer commandBuffer           = VK_NULL_HANDLE;
+        VkFence         inFlightFence           = VK_NULL_HANDLE;
+        VkSemaphore     imageAvailableSemaphore = VK_NULL_HANDLE;
+    };
+
+private:
+    uint32_t mFramesInFlight    = DEFAULT_FRAMES_IN_FLIGHT;
+    uint32_t mCurrentFrame      = 0;
+    uint32_t mCurrentImageIndex = 0;
+    uint64_t mFrameNumber       = 0;
+
+    std::vector<FrameContext> mFrames;
+
+    // 每个飞行帧最近一次提交的设备帧编号, 没有在途的提交时为VulkanDevice::NO_PENDING_FRAME
+    // 由设备在帧锁内读写, 设备据此推迟延迟销毁和无绑定索引的回收
+    std::vector<uint64_t> mPendingDeviceFrames;
+
+    // 渲染完成信号量按交换链图像索引分配, 呈现引擎持有信号量期间不会被下一次提交复用
+    std::vector<VkSemaphore> mRenderFinishedSemaphores;
+
+    // 获取图像时返回VK_SUBOPTIMAL_KHR, 在本帧呈现后重建交换链
+    bool mSwapChainOutdated = false;
+
+    // 本帧图形提交额外等待的信号量(如异步计算的时间线), EndFrame提交后清空
+    std::vector<VulkanQueueWait> mFrameWaits;
+
+    // 按飞行帧划分的线性分配器, 帧栅栏等待完成后整体重置
+    VulkanLinearAllocator mTransientAllocator;
+
+    // CPU端的逐帧临时数据, 与mTransientAllocator同时重置
+    FrameArena mFrameArena;
+
+    // 帧命令缓冲上的GPU时间戳, 结果滞后飞行帧数个帧
+    VulkanProfiler mProfiler;
+
+    // 在作业系统上录制本帧的二级命令缓冲, 命令池随帧栅栏整体重置
+    VulkanParallelRecorder mParallelRecorder;
+
+    // 设备重建时记录飞行帧资源是否存在, 重建后按原样恢复
+    bool mRestoreFrameContexts = false;
+
+public:
+    uint32_t GetFramesInFlight() const {
+        return mFramesInFlight;
+    }
+
+    uint32_t GetCurrentFrameIndex() const {
+        return mCurrentFrame;
+    }
+
+    uint32_t GetCurrentImageIndex() const {
+        return mCurrentImageIndex;
+    }
+
+    // 该交换链已开始的帧总数, 单调递增; 设备上所有交换链的帧总数见VulkanDevice::GetFrameNumber
+    uint64_t GetFrameNumber() const {
+        return mFrameNumber;
+    }
+
+    bool HasFrameContexts() const {
+        return !mFrames.empty();
+    }
+
+    const FrameContext& GetCurrentFrame() const {
+        return mFrames[mCurrentFrame];
+    }
+
+    VkCommandBuffer GetCurrentCommandBuffer() const {
+        return mFrames[mCurrentFrame].commandBuffer;
+    }
+
+    VulkanLinearAllocator& GetTransientAllocator() {
+        return mTransientAllocator;
+    }
+
+    // 当前飞行帧的CPU临时分配, 只能在调用BeginFrame/EndFrame的线程上使用
+    LinearArena& GetFrameArena() {
+        return mFrameArena.GetCurrent();
+    }
+
+    VulkanProfiler& GetProfiler() {
+        return mProfiler;
+    }
+
+    // 录制结果在当前帧的命令缓冲中执行, 只能在调用BeginFrame/EndFrame的线程上调用Record
+    VulkanParallelRecorder& GetParallelRecorder() {
+        return mParallelRecorder;
+    }
+
+    // 设置飞行帧数量, 需要在CreateFrameContexts之前调用
+    void SetFramesInFlight(uint32_t count) {
+        mFramesInFlight = glm::clamp(count, 1u, MAX_FRAMES_IN_FLIGHT);
+    }
+
+    // 让本帧的图形提交在wait.stage等待, 例如GetAsyncComputeQueue().MakeWait(value, stage)
+    void AddFrameWait(const VulkanQueueWait& wait) {
+        mFrameWaits.push_back(wait);
+    }
+
+private:
+    VulkanResult EnsureRenderFinishedSemaphores(uint32_t count) {
+        VkSemaphoreCreateInfo semaphoreCreateInfo = { .sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO };
+
+        // 只增不减, 交换链图像数量变少时多余的信号量保留复用
+        while (mRenderFinishedSemaphores.size() < count) {
+            VkSemaphore semaphore = VK_NULL_HANDLE;
+            VkResult    result    = vkCreateSemaphore(mDevice.GetDevice(), &semaphoreCreateInfo, VulkanHostMemory::GetCallbacks(), &semaphore);
+            if (result != VK_SUCCESS) {
+                NOVA_LOG_ERROR(RHI, "Failed to create a render finished semaphore: {}", int32_t(result));
+                return result;
+            }
+            mRenderFinishedSemaphores.push_back(semaphore);
+        }
+        return VK_SUCCESS;
+    }
+
+    void DestroyRenderFinishedSemaphores() {
+        for (auto& semaphore: mRenderFinishedSemaphores) {
+            vkDestroySemaphore(mDevice.GetDevice(), semaphore, VulkanHostMemory::GetCallbacks());
+        }
+        mRenderFinishedSemaphores.resize(0);
+    }
+
+public:
+    VulkanResult CreateFrameContexts() {
+        VkDevice device = mDevice.GetDevice();
+
+        VkCommandPoolCreateInfo commandPoolCreateInfo = {
+            .sType            = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO,
+            .flags            = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT, // 每帧整体重置, 不单独重置命令缓冲
+            .queueFamilyIndex = mDevice.GetQueueFamilyIndexGraphics(),
+        };
+        // 初始为置位状态, 第一次等待时不会阻塞
+        VkFenceCreateInfo     fenceCreateInfo     = { .sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO, .flags = VK_FENCE_CREATE_SIGNALED_BIT };
+        VkSemaphoreCreateInfo semaphoreCreateInfo = { .sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO };
+
+        mFrames.resize(mFramesInFlight);
+        for (auto& frame: mFrames) {
+            VkResult result = vkCreateCommandPool(device, &commandPoolCreateInfo, VulkanHostMemory::GetCallbacks(), &frame.commandPool);
+            if (result != VK_SUCCESS) {
+                NOVA_LOG_ERROR(RHI, "Failed to create a frame command pool: {}", int32_t(result));
+                return result;
+            }
+
+            VkCommandBufferAllocateInfo commandBufferAllocateInfo = {
+                .sType              = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO,
+                .commandPool        = frame.commandPool,
+                .level              = VK_COMMAND_BUFFER_LEVEL_PRIMARY,
+                .commandBufferCount = 1,
+            };
+            result = vkAllocateCommandBuffers(device, &commandBufferAllocateInfo, &frame.commandBuffer);
+            if (result != VK_SUCCESS) {
+                NOVA_LOG_ERROR(RHI, "Failed to allocate a frame command buffer: {}", int32_t(result));
+                return result;
+            }
+
+            result = vkCreateFence(device, &fenceCreateInfo, VulkanHostMemory::GetCallbacks(), &frame.inFlightFence);
+            if (result != VK_SUCCESS) {
+                NOVA_LOG_ERROR(RHI, "Failed to create a frame fence: {}", int32_t(result));
+                return result;
+            }
+
+            result = vkCreateSemaphore(device, &semaphoreCreateInfo, VulkanHostMemory::GetCallbacks(), &frame.imageAvailableSemaphore);
+            if (result != VK_SUCCESS) {
+                NOVA_LOG_ERROR(RHI, "Failed to create an image available semaphore: {}", int32_t(result));
+                return result;
+            }
+        }
+
+        mCurrentFrame = 0;
+        mPendingDeviceFrames.resize(mFramesInFlight);
+        mDevice.ClearPendingFrames(mPendingDeviceFrames);
+        mFrameArena.Initialize(mFramesInFlight);
+
+        // 时间戳写在图形队列上, 有效位数为0表示不支持
+        uint32_t queueFamilyCount = 0;
+        vkGetPhysicalDeviceQueueFamilyProperties(mDevice.GetPhysicalDevice(), &queueFamilyCount, nullptr);
+        ScratchScope                              scratch;
+        std::pmr::vector<VkQueueFamilyProperties> queueFamilyProperties(queueFamilyCount, scratch.GetMemoryResource());
+        vkGetPhysicalDeviceQueueFamilyProperties(mDevice.GetPhysicalDevice(), &queueFamilyCount, queueFamilyProperties.data());
+        VkResult result = mProfiler.Initialize(
+            device,
+            mDevice.GetPhysicalDeviceProperties().limits,
+            queueFamilyProperties[mDevice.GetQueueFamilyIndexGraphics()].timestampValidBits,
+            mFramesInFlight,
+            mDevice.IsFeatureEnabled(VulkanFeature::PipelineStatisticsQuery)
+        );
+        if (result != VK_SUCCESS) {
+            return result;
+        }
+
+        result = mParallelRecorder.Initialize(device, mDevice.GetQueueFamilyIndexGraphics(), mFramesInFlight);
+        if (result != VK_SUCCESS) {
+            return result;
+        }
+
+        VkBufferUsageFlags transientUsage = VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT |
+                                            VK_BUFFER_USAGE_INDEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_SRC_BIT;
+        return mTransientAllocator.Initialize(mDevice.GetMemoryAllocator(), DEFAULT_TRANSIENT_FRAME_CAPACITY, mFramesInFlight, transientUsage);
+    }
+
+    // 调用前需要确保该交换链的帧都已完成
+    void DestroyFrameContexts() {
+        VkDevice device = mDevice.GetDevice();
+
+        mProfiler.Terminate();
+        mParallelRecorder.Terminate();
+        mTransientAllocator.Terminate();
+        mFrameArena.Terminate();
+
+        for (auto& frame: mFrames) {
+            if (frame.imageAvailableSemaphore != nullptr) {
+                vkDestroySemaphore(device, frame.imageAvailableSemaphore, VulkanHostMemory::GetCallbacks());
+            }
+            if (frame.inFlightFence != nullptr) {
+                vkDestroyFence(device, frame.inFlightFence, VulkanHostMemory::GetCallbacks());
+            }
+            // 销毁命令池会一并释放其中的命令缓冲
+            if (frame.commandPool != nullptr) {
+                vkDestroyCommandPool(device, frame.commandPool, VulkanHostMemory::GetCallbacks());
+            }
+        }
+        mFrames.resize(0);
+
+        // 不再推迟设备的延迟销毁
+        mDevice.ClearPendingFrames(mPendingDeviceFrames);
+    }
+
+    // 等待该交换链所有飞行帧完成, 之后它不再推迟设备的延迟销毁
+    // 窗口最小化等长时间不提交帧时调用, 其他交换链的延迟销毁不会因此积压
+    VulkanResult WaitIdle() {
+        for (auto& frame: mFrames) {
+            VkResult result = vkWaitForFences(mDevice.GetDevice(), 1, &frame.inFlightFence, VK_TRUE, UINT64_MAX);
+            if (result != VK_SUCCESS) {
+                NOVA_LOG_ERROR(RHI, "Failed to wait for the frame fence: {}", int32_t(result));
+                return result;
+            }
+        }
+        mDevice.ClearPendingFrames(mPendingDeviceFrames);
+        return VK_SUCCESS;
+    }
+
+    // 等待当前飞行帧的上一次提交完成, 获取交换链图像并开始录制命令缓冲
+    // 返回VK_ERROR_OUT_OF_DATE_KHR时交换链已重建(或暂时无法重建, 下一帧重试), 调用方应跳过本帧
+    VulkanResult BeginFrame() {
+        VkDevice      device = mDevice.GetDevice();
+        FrameContext& frame  = mFrames[mCurrentFrame];
+
+        // 只等待同一飞行帧上一次的提交, 不会排空整个队列
+        VkResult result = vkWaitForFences(device, 1, &frame.inFlightFence, VK_TRUE, UINT64_MAX);
+        if (result != VK_SUCCESS) {
+            NOVA_LOG_ERROR(RHI, "Failed to wait for the frame fence: {}", int32_t(result));
+            return result;
+        }
+
+        // 设置了最大帧延迟时再等待更早的帧完成或显示
+        result = PaceFrame();
+        if (result != VK_SUCCESS) {
+            return result;
+        }
+
+        // GPU已不再读取该帧的临时数据
+        mTransientAllocator.BeginFrame(mCurrentFrame);
+        mFrameArena.BeginFrame(mCurrentFrame);
+        result = mParallelRecorder.BeginFrame(mCurrentFrame);
+        if (result != VK_SUCCESS) {
+            return result;
+        }
+
+        // 无头模式下依次轮换离屏图像, 图像数不少于飞行帧数时不会与在途的帧冲突
+        if (mHeadless) {
+            mCurrentImageIndex = static_cast<uint32_t>(mFrameNumber % mSwapChainImages.size());
+        } else if (mSwapChain == VK_NULL_HANDLE) {
+            // 上一次重建失败(如窗口最小化), 没有可获取的图像
+            result = VK_ERROR_OUT_OF_DATE_KHR;
+        } else {
+            result = vkAcquireNextImageKHR(device, mSwapChain, UINT64_MAX, frame.imageAvailableSemaphore, VK_NULL_HANDLE, &mCurrentImageIndex);
+        }
+        if (result == VK_ERROR_OUT_OF_DATE_KHR) {
+            // 栅栏尚未重置, 信号量未被置位, 跳过本帧不会造成死锁
+            TryRecreateSwapChain().Ignore();
+            return result;
+        }
+        if (result == VK_SUBOPTIMAL_KHR) {
+            mSwapChainOutdated = true;
+        } else if (result != VK_SUCCESS) {
+            NOVA_LOG_ERROR(RHI, "Failed to acquire the next swap chain image: {}", int32_t(result));
+            return result;
+        }
+
+        // 确认本帧一定会提交后才重置栅栏
+        result = vkResetFences(device, 1, &frame.inFlightFence);
+        if (result != VK_SUCCESS) {
+            NOVA_LOG_ERROR(RHI, "Failed to reset the frame fence: {}", int32_t(result));
+            AbandonFrame(frame, false);
+            return result;
+        }
+
+        // 整体重置命令池, 比逐个重置命令缓冲开销更小
+        result = vkResetCommandPool(device, frame.commandPool, 0);
+        if (result != VK_SUCCESS) {
+            NOVA_LOG_ERROR(RHI, "Failed to reset the frame command pool: {}", int32_t(result));
+            AbandonFrame(frame);
+            return result;
+        }
+
+        VkCommandBufferBeginInfo commandBufferBeginInfo = {
+            .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO,
+            .flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT,
+        };
+        result = vkBeginCommandBuffer(frame.commandBuffer, &commandBufferBeginInfo);
+        if (result != VK_SUCCESS) {
+            NOVA_LOG_ERROR(RHI, "Failed to begin the frame command buffer: {}", int32_t(result));
+            AbandonFrame(frame);
+            return result;
+        }
+
+        // 获取已完成上传的所有权, 对应的时间线值已经到达, 等待不会阻塞GPU
+        uint64_t uploadValue = mDevice.GetUploader().BeginFrame(frame.commandBuffer);
+        if (uploadValue != 0) {
+            AddFrameWait(mDevice.GetTransferQueue().MakeWait(uploadValue, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT));
+        }
+
+        // 栅栏已经等待过, 该飞行帧上一次的查询结果可以直接读取
+        mProfiler.BeginFrame(frame.commandBuffer, mCurrentFrame, mFrameNumber);
+
+        // 为本帧分配设备帧编号, 回收无绑定索引并销毁GPU已经越过退役点的资源
+        mDevice.BeginFrame(mPendingDeviceFrames[mCurrentFrame]);
+
+        mFrameNumber++;
+        return VK_SUCCESS;
+    }
+
+    // 结束录制, 提交到图形队列并呈现, 之后切换到下一个飞行帧
+    VulkanResult EndFrame() {
+        FrameContext& frame = mFrames[mCurrentFrame];
+
+        mProfiler.EndFrame(frame.commandBuffer);
+
+        VkResult result = vkEndCommandBuffer(frame.commandBuffer);
+        if (result != VK_SUCCESS) {
+            NOVA_LOG_ERROR(RHI, "Failed to end the frame command buffer: {}", int32_t(result));
+            AbandonFrame(frame);
+            return result;
+        }
+
+        // 无头模式下没有获取和呈现, 只需要提交
+        if (mHeadless) {
+            result = mDevice.GetGraphicsQueue().Submit({ &frame.commandBuffer, 1 }, mFrameWaits, {}, frame.inFlightFence);
+            if (result != VK_SUCCESS) {
+                AbandonFrame(frame);
+                return result;
+            }
+            mFrameWaits.resize(0);
+            mCurrentFrame = (mCurrentFrame + 1) % mFramesInFlight;
+            return result;
+        }
+
+        // 只有写入交换链图像的阶段需要等待图像可用, 之前的工作可以提前开始
+        VkSemaphore renderFinished = mRenderFinishedSemaphores[mCurrentImageIndex];
+        mFrameWaits.push_back({
+            .semaphore = frame.imageAvailableSemaphore,
+            .stage     = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT | VK_PIPELINE_STAGE_TRANSFER_BIT,
+        });
+        result = mDevice.GetGraphicsQueue().Submit({ &frame.commandBuffer, 1 }, mFrameWaits, { &renderFinished, 1 }, frame.inFlightFence);
+        if (result != VK_SUCCESS) {
+            AbandonFrame(frame);
+            return result;
+        }
+        mFrameWaits.resize(0);
+
+        // 本帧的呈现ID, mFrameNumber在BeginFrame中已经递增, 即帧编号加一
+        uint64_t       presentId     = mFrameNumber;
+        VkPresentIdKHR presentIdInfo = {
+            .sType          = VK_STRUCTURE_TYPE_PRESENT_ID_KHR,
+            .swapchainCount = 1,
+            .pPresentIds    = &presentId,
+        };
+        VkPresentInfoKHR presentInfo = {
+            .sType              = VK_STRUCTURE_TYPE_PRESENT_INFO_KHR,
+            .pNext              = mDevice.IsFeatureEnabled(VulkanFeature::PresentId) ? &presentIdInfo : nullptr,
+            .waitSemaphoreCount = 1,
+            .pWaitSemaphores    = &renderFinished,
+            .swapchainCount     = 1,
+            .pSwapchains        = &mSwapChain,
+            .pImageIndices      = &mCurrentImageIndex,
+        };
+        // 多个交换链可能在不同线程上同时呈现, 经由队列包装加锁
+        result = mDevice.GetPresentationQueue().Present(presentInfo);
+        if (result == VK_SUCCESS || result == VK_SUBOPTIMAL_KHR) {
+            mLastPresentId = presentId;
+            // 没有呈现等待时以CPU提交呈现的时刻计时
+            if (!UsePresentWaitPacing()) {
+                RecordPresentInterval(presentId, false);
+            }
+        }
+
+        // 无论呈现结果如何都切换到下一帧, 本帧的栅栏已经随提交进入队列
+        mCurrentFrame = (mCurrentFrame + 1) % mFramesInFlight;
+
+        if (result == VK_ERROR_OUT_OF_DATE_KHR || result == VK_SUBOPTIMAL_KHR || mSwapChainOutdated) {
+            mSwapChainOutdated = false;
+            return TryRecreateSwapChain();
+        }
+        if (result != VK_SUCCESS) {
+            NOVA_LOG_ERROR(RHI, "Failed to present the swap chain image: {}", int32_t(result));
+        }
+        return result;
+    }
+
+private:
+    // 获取图像之后本帧的命令缓冲没能开始或提交: 不补上信号下一次等待该飞行帧时会永远阻塞
+    // 先尝试一次空提交来置位栅栏, 同时消耗获取图像时置位的信号量; 空提交也失败时(如设备丢失)重建一个已置位的栅栏
+    // fenceReset为false表示重置栅栏失败, 其状态未知, 先换成一个未置位的栅栏再提交
+    void AbandonFrame(FrameContext& frame, bool fenceReset = true) {
+        VulkanQueueWait imageAvailable = {
+            .semaphore = frame.imageAvailableSemaphore,
+            .stage     = VK_PIPELINE_STAGE_ALL_COMMANDS_BIT,
+        };
+        std::span<const VulkanQueueWait> waits = mHeadless ? std::span<const VulkanQueueWait>() : std::span(&imageAvailable, 1);
+        if ((!fenceReset && RecreateFence(frame, 0) != VK_SUCCESS)
+            || mDevice.GetGraphicsQueue().Submit({}, waits, {}, frame.inFlightFence) != VK_SUCCESS) {
+            RecreateFence(frame, VK_FENCE_CREATE_SIGNALED_BIT).Ignore();
+        }
+
+        // 获取的图像没有呈现, 下一次EndFrame时重建交换链将其归还
+        if (!mHeadless) {
+            mSwapChainOutdated = true;
+        }
+        mFrameWaits.resize(0);
+        mCurrentFrame = (mCurrentFrame + 1) % mFramesInFlight;
+    }
+
+    VulkanResult RecreateFence(FrameContext& frame, VkFenceCreateFlags flags) {
+        VkFenceCreateInfo fenceCreateInfo = {
+            .sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO,
+            .flags = flags,
+        };
+        vkDestroyFence(mDevice.GetDevice(), frame.inFlightFence, VulkanHostMemory::GetCallbacks());
+        frame.inFlightFence = VK_NULL_HANDLE;
+        VkResult result     = vkCreateFence(mDevice.GetDevice(), &fenceCreateInfo, VulkanHostMemory::GetCallbacks(), &frame.inFlightFence);
+        if (result != VK_SUCCESS) {
+            NOVA_LOG_ERROR(RHI, "Failed to recreate the frame fence: {}", int32_t(result));
+        }
+        return result;
+    }
+
+    //======================================================================================================================================================
+    // device child, destroy
+    //======================================================================================================================================================
+public:
+    uint64_t GetOldestPendingFrame() const override {
+        uint64_t oldestPendingFrame = VulkanDevice::NO_PENDING_FRAME;
+        for (uint64_t pendingFrame: mPendingDeviceFrames) {
+            oldestPendingFrame = std::min(oldestPendingFrame, pendingFrame);
+        }
+        return oldestPendingFrame;
+    }
+
+    // 销毁属于设备的对象, 表面、创建信息和呈现设置保留, RestoreDeviceObjects按原样重新创建
+    void ReleaseDeviceObjects() override {
+        VkDevice device = mDevice.GetDevice();
+
+        mRestoreFrameContexts = mRestoreFrameContexts || !mFrames.empty();
+        DestroyFrameContexts();
+
+        if (mSwapChain != VK_NULL_HANDLE) {
+            // 执行销毁交换链回调函数
+            for (auto& callback: mDestroySwapChainCallbacks) {
+                callback();
+            }
+
+            // 销毁image view
+            for (auto& imageView: mSwapChainImageViews) {
+                if (imageView != nullptr) {
+                    vkDestroyImageView(device, imageView, VulkanHostMemory::GetCallbacks());
+                }
+            }
+            mSwapChainImageViews.resize(0);
+            mSwapChainImages.resize(0);
+
+            // 销毁交换链
+            vkDestroySwapchainKHR(device, mSwapChain, VulkanHostMemory::GetCallbacks());
+            mSwapChain = VK_NULL_HANDLE;
+        } else if (mHeadless && !mSwapChainImages.empty()) {
+            for (auto& callback: mDestroySwapChainCallbacks) {
+                callback();
+            }
+            DestroyOffscreenImages();
+        }
+        DestroyRenderFinishedSemaphores();
+
+        // 新设备可能对应另一个物理设备, 表面格式需要重新查询
+        mAvailableSurfaceFormats.resize(0);
+        mAvailablePresentModes.resize(0);
+    }
+
+    VulkanResult RestoreDeviceObjects() override {
+        VkResult result = VK_SUCCESS;
+        if (mHeadless) {
+            // 离屏图像属于设备, 按原来的创建信息重新创建
+            result = CreateOffscreenImages();
+            if (result != VK_SUCCESS) {
+                return result;
+            }
+            for (auto& callback: mCreateSwapChainCallbacks) {
+                callback();
+            }
+        } else if (mSurface != VK_NULL_HANDLE && mSwapChainCreateInfo.sType == VK_STRUCTURE_TYPE_SWAPCHAIN_CREATE_INFO_KHR) {
+            // 呈现模式和图像格式保留在创建信息中, 在新设备上重新协商
+            result = TryCreateSwapchain(true, mSwapChainCreateInfo.flags);
+            if (result != VK_SUCCESS) {
+                return result;
+            }
+        }
+
+        if (mRestoreFrameContexts) {
+            mRestoreFrameContexts = false;
+            return CreateFrameContexts();
+        }
+        return VK_SUCCESS;
+    }
+
+    // 等待设备空闲后销毁交换链和表面, 并从设备注销; 设备已经销毁时属于设备的对象已由设备释放
+    // 等待设备空闲需要同步所有队列, 调用时同一设备上的其他交换链不能在其他线程上提交
+    void Terminate() {
+        if (mDevice.GetDevice() != VK_NULL_HANDLE) {
+            mDevice.WaitIdle().Ignore();
+            ReleaseDeviceObjects();
+        }
+        mRestoreFrameContexts = false;
+        mSwapChainCreateInfo  = {};
+        mHeadless             = false;
+        mCurrentFrame         = 0;
+        mFrameNumber          = 0;
+
+        // 销毁窗口表面
+        if (mSurface != VK_NULL_HANDLE) {
+            vkDestroySurfaceKHR(mDevice.GetInstance().GetInstance(), mSurface, nullptr);
+            mSurface = VK_NULL_HANDLE;
+        }
+        mDevice.DetachChild(this);
+    }
+};
+} // namespace Nova
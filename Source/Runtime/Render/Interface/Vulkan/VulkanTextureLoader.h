@@ -0,0 +1,573 @@
+#pragma once
+#include "VulkanDevice.h"
+
+#include "Core/JobSystem.h"
+#include "Core/MappedFile.h"
+#include "Render/TextureContainer.h"
+
+#include <bit>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <string>
+
+namespace Nova {
+
+using VulkanTextureHandle = Handle<struct VulkanTextureTag>;
+
+enum class VulkanTextureState : uint32_t {
+    Decoding,   // 在工作线程上读取和解码, 或映射烘焙过的纹理容器
+    Uploading,  // 已写入暂存环形缓冲, 等待上传完成
+    Generating, // mip链已录制到帧命令缓冲, 等待该帧完成
+    Resident,
+    Failed,
+};
+
+struct VulkanTextureInfo {
+    VulkanTextureState state = VulkanTextureState::Failed;
+    VulkanImageHandle  image;
+    VkExtent2D         extent       = {};
+    uint32_t           mipLevels    = 0;
+    bool               gpuMips      = false; // 为false时mip链在CPU上生成或来自纹理容器
+    bool               cooked       = false; // 来自.ntex纹理容器, 没有解码过程
+    uint64_t           fileBytes    = 0;
+    uint64_t           decodedBytes = 0; // mip 0的字节数
+    uint64_t           imageBytes   = 0; // 所有mip的字节数, 即纹理数据占用的显存
+    double             decodeMs     = 0.0; // 纹理容器为映射和校验的耗时
+    double             residentMs   = 0.0; // 从Load到mip链在GPU上生成完毕
+};
+
+struct VulkanTextureLoaderStats {
+    uint32_t requested = 0;
+    uint32_t pending   = 0;
+    uint32_t resident  = 0;
+    uint32_t failed    = 0;
+};
+
+// 异步纹理加载
+// 文件读取和stb_image解码在作业系统的工作线程上进行, 解码后创建图像并经由上传器写入mip 0, 渲染线程不会等待;
+// 上传完成后在图形队列上用vkCmdBlitImage逐级生成mip链并转换为SHADER_READ_ONLY_OPTIMAL.
+// 格式不支持线性过滤的blit时, 在工作线程上用盒式滤波生成全部mip, 随mip 0一起上传.
+// 扩展名为.ntex的文件是TextureCooker烘焙的纹理容器, 映射文件后直接上传预先生成的块压缩mip链, 不经过解码.
+// 其余纹理统一解码为RGBA8, 单张纹理的数据量不能超过上传器的暂存环形缓冲
+class VulkanTextureLoader {
+public:
+    // 每帧最多为多少张纹理录制mip链, 避免大量纹理同时完成时单帧的GPU时间突增
+    static constexpr uint32_t MAX_MIP_GENERATIONS_PER_FRAME = 16;
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    struct TextureRecord {
+        std::string       path;
+        VkFormat          format = VK_FORMAT_R8G8B8A8_SRGB;
+        VulkanTextureInfo info;
+        uint64_t          uploadTicket    = 0;
+        uint64_t          completionValue = 0; // 录制mip链的帧在图形队列时间线上的值, 为0表示该帧还未提交
+        Clock::time_point requestTime;
+    };
+
+    VulkanDevice* mDevice = nullptr;
+
+    HandlePool<TextureRecord, VulkanTextureTag> mTextures;
+
+    // mUploading为等待上传完成的纹理, mGenerating为已录制mip链、等待所在帧完成的纹理
+    std::vector<VulkanTextureHandle> mUploading;
+    std::vector<VulkanTextureHandle> mGenerating;
+    VulkanTextureLoaderStats         mStats;
+    mutable std::mutex               mMutex;
+
+    // 未完成的解码作业
+    JobCounter mJobs;
+
+public:
+    VulkanTextureLoader() = default;
+
+    VulkanTextureLoader(const VulkanTextureLoader&)            = delete;
+    VulkanTextureLoader& operator=(const VulkanTextureLoader&) = delete;
+
+    ~VulkanTextureLoader() {
+        Terminate();
+    }
+
+    void Initialize(VulkanDevice& device) {
+        mDevice = &device;
+        mStats  = {};
+    }
+
+    // 等待解码作业结束并销毁所有纹理, 需要在设备销毁之前调用
+    void Terminate() {
+        if (mDevice == nullptr) {
+            return;
+        }
+        JobSystem::Singleton().Wait(mJobs);
+
+        auto& resources = mDevice->GetResources();
+        mTextures.ForEach([&resources](VulkanTextureHandle, TextureRecord& record) { resources.DestroyImage(record.info.image); });
+        mTextures.Clear();
+        mUploading.resize(0);
+        mGenerating.resize(0);
+        mDevice = nullptr;
+    }
+
+    // 任意线程调用, 立即返回; srgb为false时按线性数据(如法线贴图)读取, 纹理容器的色彩空间由烘焙时决定
+    VulkanTextureHandle Load(const std::filesystem::path& path, bool srgb = true) {
+        VulkanTextureHandle handle = mTextures.Allocate();
+        if (!handle) {
+            NOVA_LOG_ERROR(RHI, "Too many textures, failed to load {}", path.string());
+            return {};
+        }
+        TextureRecord& record = *mTextures.Get(handle);
+        record.path           = path.string();
+        record.format         = srgb ? VK_FORMAT_R8G8B8A8_SRGB : VK_FORMAT_R8G8B8A8_UNORM;
+        record.info.state     = VulkanTextureState::Decoding;
+        record.requestTime    = Clock::now();
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            mStats.requested++;
+            mStats.pending++;
+        }
+        if (path.extension() == ".ntex") {
+            JobSystem::Singleton().Run([this, handle] { LoadContainer(handle); }, &mJobs);
+        } else {
+            JobSystem::Singleton().Run([this, handle] { Decode(handle); }, &mJobs);
+        }
+        return handle;
+    }
+
+    // 只能释放已经常驻或加载失败的纹理, 图像经由设备的延迟销毁队列销毁
+    bool Release(VulkanTextureHandle handle) {
+        std::lock_guard<std::mutex> lock(mMutex);
+        TextureRecord* record = mTextures.TryGet(handle);
+        if (record == nullptr || !IsDone(record->info.state)) {
+            return false;
+        }
+        mDevice->GetResources().DestroyImage(record->info.image);
+        mTextures.Free(handle);
+        return true;
+    }
+
+    VulkanTextureInfo GetInfo(VulkanTextureHandle handle) {
+        std::lock_guard<std::mutex> lock(mMutex);
+        const TextureRecord* record = mTextures.TryGet(handle);
+        return record != nullptr ? record->info : VulkanTextureInfo {};
+    }
+
+    VulkanTextureLoaderStats GetStats() const {
+        std::lock_guard<std::mutex> lock(mMutex);
+        return mStats;
+    }
+
+    // 渲染线程在交换链的BeginFrame之后调用, 此时上传器已经录制了所有权获取屏障
+    // 更新上一帧录制的纹理的完成情况, 为已经上传完成的纹理录制mip链
+    void BeginFrame(VkCommandBuffer commandBuffer) {
+        std::lock_guard<std::mutex> lock(mMutex);
+
+        // 上一帧已经提交, 其时间线值不大于图形队列最后提交的值; 不支持时间线时提交之后即视为完成
+        VulkanQueue& graphicsQueue = mDevice->GetGraphicsQueue();
+        std::erase_if(mGenerating, [this, &graphicsQueue](VulkanTextureHandle handle) {
+            TextureRecord& record = *mTextures.Get(handle);
+            if (record.completionValue == 0) {
+                record.completionValue = std::max<uint64_t>(graphicsQueue.GetLastSubmittedValue(), 1);
+            }
+            if (graphicsQueue.HasTimeline() && !graphicsQueue.IsCompleted(record.completionValue)) {
+                return false;
+            }
+            record.info.state      = VulkanTextureState::Resident;
+            record.info.residentMs = std::chrono::duration<double, std::milli>(Clock::now() - record.requestTime).count();
+            mStats.pending--;
+            mStats.resident++;
+            return true;
+        });
+
+        VulkanUploader& uploader    = mDevice->GetUploader();
+        uint32_t        generations = 0;
+        std::erase_if(mUploading, [&](VulkanTextureHandle handle) {
+            TextureRecord& record = *mTextures.Get(handle);
+            if (generations == MAX_MIP_GENERATIONS_PER_FRAME || !uploader.IsReady(record.uploadTicket)) {
+                return false;
+            }
+            // CPU生成的mip链随上传已经转换为SHADER_READ_ONLY_OPTIMAL
+            if (record.info.gpuMips) {
+                VulkanImageRecord* image = mDevice->GetResources().GetImage(record.info.image);
+                CmdGenerateMips(commandBuffer, image->image, record.info.extent, record.info.mipLevels);
+                generations++;
+            }
+            record.info.state      = VulkanTextureState::Generating;
+            record.completionValue = 0;
+            mGenerating.push_back(handle);
+            return true;
+        });
+    }
+
+    // 以linear过滤逐级blit, 调用前所有mip处于TRANSFER_DST_OPTIMAL, 之后处于SHADER_READ_ONLY_OPTIMAL
+    static void CmdGenerateMips(VkCommandBuffer commandBuffer, VkImage image, VkExtent2D extent, uint32_t mipLevels) {
+        VkImageMemoryBarrier barrier = {
+            .sType               = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
+            .srcAccessMask       = VK_ACCESS_TRANSFER_WRITE_BIT,
+            .dstAccessMask       = VK_ACCESS_TRANSFER_READ_BIT,
+            .oldLayout           = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+            .newLayout           = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+            .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+            .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+            .image               = image,
+            .subresourceRange    = { VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1 },
+        };
+
+        int32_t width  = static_cast<int32_t>(extent.width);
+        int32_t height = static_cast<int32_t>(extent.height);
+        for (uint32_t level = 1; level < mipLevels; level++) {
+            // 上一级写入完成后转为源布局
+            barrier.subresourceRange.baseMipLevel = level - 1;
+            vkCmdPipelineBarrier(
+                commandBuffer,
+                VK_PIPELINE_STAGE_TRANSFER_BIT,
+                VK_PIPELINE_STAGE_TRANSFER_BIT,
+                0,
+                0,
+                nullptr,
+                0,
+                nullptr,
+                1,
+                &barrier
+            );
+
+            int32_t nextWidth  = std::max(width / 2, 1);
+            int32_t nextHeight = std::max(height / 2, 1);
+
+            VkImageBlit imageBlit = {
+                .srcSubresource = { VK_IMAGE_ASPECT_COLOR_BIT, level - 1, 0, 1 },
+                .srcOffsets     = { { 0, 0, 0 }, { width, height, 1 } },
+                .dstSubresource = { VK_IMAGE_ASPECT_COLOR_BIT, level, 0, 1 },
+                .dstOffsets     = { { 0, 0, 0 }, { nextWidth, nextHeight, 1 } },
+            };
+            vkCmdBlitImage(
+                commandBuffer,
+                image,
+                VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+                image,
+                VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                1,
+                &imageBlit,
+                VK_FILTER_LINEAR
+            );
+            width  = nextWidth;
+            height = nextHeight;
+        }
+
+        // 除最后一级外都处于源布局, 最后一级仍是目标布局
+        VkImageMemoryBarrier finalBarriers[2] = { barrier, barrier };
+        finalBarriers[0].subresourceRange     = { VK_IMAGE_ASPECT_COLOR_BIT, 0, mipLevels - 1, 0, 1 };
+        finalBarriers[0].srcAccessMask        = VK_ACCESS_TRANSFER_READ_BIT;
+        finalBarriers[0].dstAccessMask        = VK_ACCESS_SHADER_READ_BIT;
+        finalBarriers[0].oldLayout            = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+        finalBarriers[0].newLayout            = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+        finalBarriers[1].subresourceRange     = { VK_IMAGE_ASPECT_COLOR_BIT, mipLevels - 1, 1, 0, 1 };
+        finalBarriers[1].srcAccessMask        = VK_ACCESS_TRANSFER_WRITE_BIT;
+        finalBarriers[1].dstAccessMask        = VK_ACCESS_SHADER_READ_BIT;
+        finalBarriers[1].oldLayout            = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+        finalBarriers[1].newLayout            = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+
+        uint32_t barrierCount = mipLevels > 1 ? 2 : 1;
+        vkCmdPipelineBarrier(
+            commandBuffer,
+            VK_PIPELINE_STAGE_TRANSFER_BIT,
+            VK_PIPELINE_STAGE_ALL_COMMANDS_BIT,
+            0,
+            0,
+            nullptr,
+            0,
+            nullptr,
+            barrierCount,
+            mipLevels > 1 ? finalBarriers : &finalBarriers[1]
+        );
+    }
+
+private:
+    static bool IsDone(VulkanTextureState state) {
+        return state == VulkanTextureState::Resident || state == VulkanTextureState::Failed;
+    }
+
+    // vkCmdBlitImage生成mip需要格式在最优平铺下同时支持blit的源和目标以及线性过滤
+    bool IsBlitSupported(VkFormat format) const {
+        constexpr VkFormatFeatureFlags REQUIRED_FEATURES =
+            VK_FORMAT_FEATURE_BLIT_SRC_BIT | VK_FORMAT_FEATURE_BLIT_DST_BIT | VK_FORMAT_FEATURE_SAMPLED_IMAGE_FILTER_LINEAR_BIT;
+
+        VkFormatProperties formatProperties;
+        vkGetPhysicalDeviceFormatProperties(mDevice->GetPhysicalDevice(), format, &formatProperties);
+        return (formatProperties.optimalTilingFeatures & REQUIRED_FEATURES) == REQUIRED_FEATURES;
+    }
+
+    void Fail(VulkanTextureHandle handle) {
+        std::lock_guard<std::mutex> lock(mMutex);
+        TextureRecord& record = *mTextures.Get(handle);
+        record.info.state     = VulkanTextureState::Failed;
+        mStats.pending--;
+        mStats.failed++;
+    }
+
+    // 在工作线程上执行
+    void Decode(VulkanTextureHandle handle) {
+        TextureRecord& record = *mTextures.Get(handle);
+
+        std::ifstream file(record.path, std::ios::binary | std::ios::ate);
+        if (!file) {
+            NOVA_LOG_ERROR(RHI, "Failed to open texture {}", record.path);
+            Fail(handle);
+            return;
+        }
+        std::vector<stbi_uc> fileData(static_cast<size_t>(file.tellg()));
+        file.seekg(0);
+        file.read(reinterpret_cast<char*>(fileData.data()), static_cast<std::streamsize>(fileData.size()));
+
+        // 统一解码为4通道
+        int      width       = 0;
+        int      height      = 0;
+        int      channels    = 0;
+        auto     decodeStart = Clock::now();
+        stbi_uc* pixels      = stbi_load_from_memory(fileData.data(), int(fileData.size()), &width, &height, &channels, STBI_rgb_alpha);
+        if (pixels == nullptr) {
+            NOVA_LOG_ERROR(RHI, "Failed to decode texture {}: {}", record.path, stbi_failure_reason());
+            Fail(handle);
+            return;
+        }
+        double decodeMs = std::chrono::duration<double, std::milli>(Clock::now() - decodeStart).count();
+
+        VkExtent2D   extent    = { static_cast<uint32_t>(width), static_cast<uint32_t>(height) };
+        uint32_t     mipLevels = std::bit_width(std::max(extent.width, extent.height));
+        VkDeviceSize baseSize  = VkDeviceSize(extent.width) * extent.height * 4;
+        bool         gpuMips   = IsBlitSupported(record.format);
+
+        // 超出预算时不再创建, 由上层的流式加载决定淘汰哪些纹理
+        VkDeviceSize imageBytes = GetImageBytes(TextureContainerFormat::RGBA8, extent, mipLevels);
+        if (mDevice->QueryMemoryBudget().GetDeviceLocalHeadroom() < imageBytes) {
+            NOVA_LOG_WARN(RHI, "Texture {} ({} bytes) does not fit in the device memory budget", record.path, imageBytes);
+            stbi_image_free(pixels);
+            Fail(handle);
+            return;
+        }
+
+        VkImageCreateInfo imageCreateInfo = {
+            .sType       = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO,
+            .imageType   = VK_IMAGE_TYPE_2D,
+            .format      = record.format,
+            .extent      = { extent.width, extent.height, 1 },
+            .mipLevels   = mipLevels,
+            .arrayLayers = 1,
+            .samples     = VK_SAMPLE_COUNT_1_BIT,
+            .tiling      = VK_IMAGE_TILING_OPTIMAL,
+            .usage       = VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT,
+        };
+        VulkanImageHandle image = mDevice->GetResources().CreateImage(imageCreateInfo, VK_IMAGE_ASPECT_COLOR_BIT);
+        if (!image) {
+            stbi_image_free(pixels);
+            Fail(handle);
+            return;
+        }
+
+        std::vector<VulkanImageUploadRegion> regions;
+        std::vector<stbi_uc>                 mipData;
+        regions.push_back({ .data = pixels, .size = baseSize, .extent = { extent.width, extent.height, 1 } });
+        if (!gpuMips) {
+            BuildMipChain(pixels, extent, mipLevels, mipData, regions);
+        }
+
+        // GPU生成mip时所有级别停留在TRANSFER_DST_OPTIMAL, 由BeginFrame中的blit链转换
+        uint64_t      ticket      = 0;
+        VkImage       vkImage     = mDevice->GetResources().GetImage(image)->image;
+        VkImageLayout finalLayout = gpuMips ? VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL : VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+
+        VkResult result = mDevice->GetUploader().UploadImage(vkImage, VK_IMAGE_ASPECT_COLOR_BIT, mipLevels, 1, regions, finalLayout, 4, &ticket);
+        stbi_image_free(pixels);
+        if (result != VK_SUCCESS) {
+            mDevice->GetResources().DestroyImage(image);
+            Fail(handle);
+            return;
+        }
+
+        std::lock_guard<std::mutex> lock(mMutex);
+        record.uploadTicket      = ticket;
+        record.info.state        = VulkanTextureState::Uploading;
+        record.info.image        = image;
+        record.info.extent       = extent;
+        record.info.mipLevels    = mipLevels;
+        record.info.gpuMips      = gpuMips;
+        record.info.fileBytes    = fileData.size();
+        record.info.decodedBytes = baseSize;
+        record.info.imageBytes   = imageBytes;
+        record.info.decodeMs     = decodeMs;
+        mUploading.push_back(handle);
+    }
+
+    // 在工作线程上执行, 文件只在复制到暂存环形缓冲期间保持映射
+    void LoadContainer(VulkanTextureHandle handle) {
+        TextureRecord& record = *mTextures.Get(handle);
+
+        auto                 mapStart = Clock::now();
+        MappedFile           file;
+        TextureContainerView container;
+        if (!file.Open(record.path) || !container.Parse(file.GetData())) {
+            NOVA_LOG_ERROR(RHI, "Invalid texture container {}", record.path);
+            Fail(handle);
+            return;
+        }
+        double mapMs = std::chrono::duration<double, std::milli>(Clock::now() - mapStart).count();
+
+        const TextureContainerHeader& header = container.GetHeader();
+        VkFormat                      format = GetContainerFormat(header.format, container.IsSrgb());
+        if (!IsSampledFormatSupported(format)) {
+            NOVA_LOG_ERROR(RHI, "Texture {} uses {} which the device cannot sample", record.path, GetTextureContainerFormatName(header.format));
+            Fail(handle);
+            return;
+        }
+
+        VkExtent2D   extent     = { header.width, header.height };
+        VkDeviceSize imageBytes = GetImageBytes(header.format, extent, header.mipLevels);
+        if (mDevice->QueryMemoryBudget().GetDeviceLocalHeadroom() < imageBytes) {
+            NOVA_LOG_WARN(RHI, "Texture {} ({} bytes) does not fit in the device memory budget", record.path, imageBytes);
+            Fail(handle);
+            return;
+        }
+
+        VkImageCreateInfo imageCreateInfo = {
+            .sType       = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO,
+            .imageType   = VK_IMAGE_TYPE_2D,
+            .format      = format,
+            .extent      = { extent.width, extent.height, 1 },
+            .mipLevels   = header.mipLevels,
+            .arrayLayers = 1,
+            .samples     = VK_SAMPLE_COUNT_1_BIT,
+            .tiling      = VK_IMAGE_TILING_OPTIMAL,
+            .usage       = VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT,
+        };
+        VulkanImageHandle image = mDevice->GetResources().CreateImage(imageCreateInfo, VK_IMAGE_ASPECT_COLOR_BIT);
+        if (!image) {
+            Fail(handle);
+            return;
+        }
+
+        // 区域的尺寸以像素为单位, 边缘不足一个块的部分由拷贝命令处理
+        std::vector<VulkanImageUploadRegion> regions;
+        for (uint32_t level = 0; level < header.mipLevels; level++) {
+            std::span<const std::byte> mip = container.GetMip(level);
+            regions.push_back({
+                .data     = mip.data(),
+                .size     = mip.size(),
+                .mipLevel = level,
+                .extent   = { container.GetMipWidth(level), container.GetMipHeight(level), 1 },
+            });
+        }
+
+        uint64_t ticket         = 0;
+        VkImage  vkImage        = mDevice->GetResources().GetImage(image)->image;
+        uint32_t texelBlockSize = GetTextureBlockBytes(header.format);
+
+        VkResult result = mDevice->GetUploader().UploadImage(
+            vkImage,
+            VK_IMAGE_ASPECT_COLOR_BIT,
+            header.mipLevels,
+            1,
+            regions,
+            VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+            texelBlockSize,
+            &ticket
+        );
+        if (result != VK_SUCCESS) {
+            mDevice->GetResources().DestroyImage(image);
+            Fail(handle);
+            return;
+        }
+
+        std::lock_guard<std::mutex> lock(mMutex);
+        record.uploadTicket      = ticket;
+        record.info.state        = VulkanTextureState::Uploading;
+        record.info.image        = image;
+        record.info.extent       = extent;
+        record.info.mipLevels    = header.mipLevels;
+        record.info.cooked       = true;
+        record.info.fileBytes    = file.GetSize();
+        record.info.decodedBytes = regions[0].size;
+        record.info.imageBytes   = imageBytes;
+        record.info.decodeMs     = mapMs;
+        mUploading.push_back(handle);
+    }
+
+    static VkFormat GetContainerFormat(TextureContainerFormat format, bool srgb) {
+        switch (format) {
+            case TextureContainerFormat::BC1:
+                return srgb ? VK_FORMAT_BC1_RGBA_SRGB_BLOCK : VK_FORMAT_BC1_RGBA_UNORM_BLOCK;
+            case TextureContainerFormat::BC3:
+                return srgb ? VK_FORMAT_BC3_SRGB_BLOCK : VK_FORMAT_BC3_UNORM_BLOCK;
+            case TextureContainerFormat::BC5:
+                return VK_FORMAT_BC5_UNORM_BLOCK;
+            case TextureContainerFormat::BC7:
+                return srgb ? VK_FORMAT_BC7_SRGB_BLOCK : VK_FORMAT_BC7_UNORM_BLOCK;
+            default:
+                return srgb ? VK_FORMAT_R8G8B8A8_SRGB : VK_FORMAT_R8G8B8A8_UNORM;
+        }
+    }
+
+    // 块压缩格式还需要设备启用textureCompressionBC特性
+    bool IsSampledFormatSupported(VkFormat format) const {
+        bool blockCompressed = format >= VK_FORMAT_BC1_RGB_UNORM_BLOCK && format <= VK_FORMAT_BC7_SRGB_BLOCK;
+        if (blockCompressed && !mDevice->IsFeatureEnabled(VulkanFeature::TextureCompressionBC)) {
+            return false;
+        }
+        VkFormatProperties formatProperties;
+        vkGetPhysicalDeviceFormatProperties(mDevice->GetPhysicalDevice(), format, &formatProperties);
+        return (formatProperties.optimalTilingFeatures & VK_FORMAT_FEATURE_SAMPLED_IMAGE_BIT) != 0;
+    }
+
+    static VkDeviceSize GetImageBytes(TextureContainerFormat format, VkExtent2D extent, uint32_t mipLevels) {
+        VkDeviceSize size = 0;
+        for (uint32_t level = 0; level < mipLevels; level++) {
+            size += GetTextureMipSize(format, std::max(extent.width >> level, 1u), std::max(extent.height >> level, 1u));
+        }
+        return size;
+    }
+
+    // 2x2盒式滤波逐级缩小, 奇数边长时最后一行或一列被截断; 直接对sRGB编码的值取平均, 只作为不能blit时的退路
+    static void BuildMipChain(
+        const stbi_uc*                        base,
+        VkExtent2D                            extent,
+        uint32_t                              mipLevels,
+        std::vector<stbi_uc>&                 mipData,
+        std::vector<VulkanImageUploadRegion>& regions
+    ) {
+        VkDeviceSize totalSize = 0;
+        for (uint32_t level = 1; level < mipLevels; level++) {
+            totalSize += VkDeviceSize(std::max(extent.width >> level, 1u)) * std::max(extent.height >> level, 1u) * 4;
+        }
+        mipData.resize(totalSize);
+
+        const stbi_uc* source       = base;
+        uint32_t       sourceWidth  = extent.width;
+        uint32_t       sourceHeight = extent.height;
+        stbi_uc*       destination  = mipData.data();
+        for (uint32_t level = 1; level < mipLevels; level++) {
+            uint32_t width  = std::max(sourceWidth / 2, 1u);
+            uint32_t height = std::max(sourceHeight / 2, 1u);
+            for (uint32_t y = 0; y < height; y++) {
+                uint32_t y0 = std::min(y * 2, sourceHeight - 1);
+                uint32_t y1 = std::min(y * 2 + 1, sourceHeight - 1);
+                for (uint32_t x = 0; x < width; x++) {
+                    uint32_t x0 = std::min(x * 2, sourceWidth - 1);
+                    uint32_t x1 = std::min(x * 2 + 1, sourceWidth - 1);
+                    for (uint32_t c = 0; c < 4; c++) {
+                        uint32_t sum = source[(y0 * sourceWidth + x0) * 4 + c] + source[(y0 * sourceWidth + x1) * 4 + c] +
+                                       source[(y1 * sourceWidth + x0) * 4 + c] + source[(y1 * sourceWidth + x1) * 4 + c];
+                        destination[(y * width + x) * 4 + c] = static_cast<stbi_uc>((sum + 2) / 4);
+                    }
+                }
+            }
+            VkDeviceSize size = VkDeviceSize(width) * height * 4;
+            regions.push_back({ .data = destination, .size = size, .mipLevel = level, .extent = { width, height, 1 } });
+
+            source       = destination;
+            sourceWidth  = width;
+            sourceHeight = height;
+            destination += size;
+        }
+    }
+};
+} // namespace Nova
@@ -0,0 +1,673 @@
+#pragma once
+#include "VulkanMemoryAllocator.h"
+#include "VulkanQueue.h"
+
+#include <chrono>
+#include <cstring>
+#include <numeric>
+
+namespace Nova {
+
+// 图像的一个子资源区域, data为紧密排列的像素数据
+struct VulkanImageUploadRegion {
+    const void*  data           = nullptr;
+    VkDeviceSize size           = 0;
+    uint32_t     mipLevel       = 0;
+    uint32_t     baseArrayLayer = 0;
+    uint32_t     layerCount     = 1;
+    VkExtent3D   extent         = {};
+};
+
+struct VulkanUploadStats {
+    uint64_t     bytesUploaded    = 0; // 已完成的字节数
+    uint64_t     batchCount       = 0; // 已完成的批次数
+    uint64_t     stallCount       = 0; // 暂存环形缓冲或批次用尽, 上传线程等待GPU的次数
+    VkDeviceSize ringCapacity     = 0;
+    VkDeviceSize ringUsed         = 0;
+    VkDeviceSize ringPeakUsed     = 0;
+    VkDeviceSize frameBytes       = 0; // 本帧已提交的字节数
+    double       throughputMBps   = 0.0;
+    double       averageLatencyMs = 0.0;
+};
+
+// 异步上传服务
+// 数据先写入持久映射的暂存环形缓冲, 再在传输队列上批量录制拷贝, 完成情况由传输队列的时间线跟踪;
+// 传输队列与图形队列属于不同队列族时, 上传结束释放所有权, 图形队列在BeginFrame中只获取已经完成的批次, 渲染线程不会等待上传
+class VulkanUploader {
+public:
+    static constexpr VkDeviceSize DEFAULT_CAPACITY = VkDeviceSize(32) << 20;
+
+    // 同时在途的批次数
+    static constexpr uint32_t BATCH_COUNT = 8;
+
+    // 单个批次的数据量超过环形缓冲的该比例时立即提交, 让环形缓冲尽早回收
+    static constexpr uint32_t BATCH_FLUSH_DIVISOR = 4;
+
+private:
+    struct PendingAcquire {
+        VkImage                 image  = VK_NULL_HANDLE;
+        VkImageSubresourceRange range  = {};
+        VkImageLayout           layout = VK_IMAGE_LAYOUT_UNDEFINED;
+        VkBuffer                buffer = VK_NULL_HANDLE;
+        VkDeviceSize            offset = 0;
+        VkDeviceSize            size   = 0;
+    };
+
+    struct Batch {
+        VkCommandPool   commandPool   = VK_NULL_HANDLE;
+        VkCommandBuffer commandBuffer = VK_NULL_HANDLE;
+        VkFence         fence         = VK_NULL_HANDLE; // 设备不支持时间线信号量时使用
+
+        uint64_t     ticket        = 0;
+        uint64_t     timelineValue = 0;
+        uint64_t     ringEnd       = 0;
+        VkDeviceSize bytes         = 0;
+        bool         copiedBuffer  = false;
+
+        std::vector<PendingAcquire>           acquires;
+        std::chrono::steady_clock::time_point submitTime;
+    };
+
+    VkDevice               mDevice    = VK_NULL_HANDLE;
+    VulkanMemoryAllocator* mAllocator = nullptr;
+    VulkanQueue*           mQueue     = nullptr;
+    uint32_t               mDstFamily = VK_QUEUE_FAMILY_IGNORED;
+
+    // 暂存环形缓冲, mHead和mTail是单调递增的绝对位置, 对容量取模得到缓冲内的偏移
+    VkBuffer         mStagingBuffer     = VK_NULL_HANDLE;
+    VulkanAllocation mStagingAllocation = {};
+    VkDeviceSize     mCapacity          = 0;
+    uint64_t         mHead              = 0;
+    uint64_t         mTail              = 0;
+
+    // mBatches按环形使用, [mBatchBegin, mBatchBegin + mBatchCount)为已提交未回收的批次
+    Batch    mBatches[BATCH_COUNT];
+    uint32_t mBatchBegin = 0;
+    uint32_t mBatchCount = 0;
+    bool     mBatchOpen  = false;
+
+    uint64_t mNextTicket      = 1;
+    uint64_t mCompletedTicket = 0;
+    uint64_t mReadyTicket     = 0;
+
+    // 已完成但还未在图形队列上获取所有权的资源, 以及图形提交需要等待的时间线值
+    std::vector<PendingAcquire> mPendingAcquires;
+    uint64_t                    mPendingAcquireValue = 0;
+
+    VkDeviceSize mFrameBudget = 0;
+    VkDeviceSize mFrameBytes  = 0;
+
+    VulkanUploadStats                     mStats;
+    double                                mBusySeconds    = 0.0;
+    double                                mLatencySeconds = 0.0;
+    std::chrono::steady_clock::time_point mLastRetireTime;
+
+    mutable std::mutex mMutex;
+
+public:
+    VulkanUploader() = default;
+
+    VulkanUploader(const VulkanUploader&)            = delete;
+    VulkanUploader& operator=(const VulkanUploader&) = delete;
+
+    ~VulkanUploader() {
+        Terminate();
+    }
+
+    // dstFamily为使用上传结果的队列族(图形队列族)
+    VulkanResult Initialize(VkDevice device, VulkanMemoryAllocator& allocator, VulkanQueue& queue, uint32_t dstFamily, VkDeviceSize capacity) {
+        mDevice    = device;
+        mAllocator = &allocator;
+        mQueue     = &queue;
+        mDstFamily = dstFamily;
+        mCapacity  = AlignUp(capacity, TlsfAllocator::MIN_SIZE);
+        mHead = mTail = 0;
+
+        VkBufferCreateInfo bufferCreateInfo = {
+            .sType       = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO,
+            .size        = mCapacity,
+            .usage       = VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+            .sharingMode = VK_SHARING_MODE_EXCLUSIVE,
+        };
+        VkResult result = mAllocator->CreateBuffer(
+            bufferCreateInfo,
+            VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+            mStagingBuffer,
+            mStagingAllocation
+        );
+        if (result != VK_SUCCESS) {
+            return result;
+        }
+
+        VkCommandPoolCreateInfo commandPoolCreateInfo = {
+            .sType            = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO,
+            .flags            = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT,
+            .queueFamilyIndex = mQueue->GetFamilyIndex(),
+        };
+        VkFenceCreateInfo fenceCreateInfo = { .sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO };
+        for (auto& batch: mBatches) {
+            result = vkCreateCommandPool(mDevice, &commandPoolCreateInfo, VulkanHostMemory::GetCallbacks(), &batch.commandPool);
+            if (result != VK_SUCCESS) {
+                NOVA_LOG_ERROR(RHI, "Failed to create an upload command pool: {}", int32_t(result));
+                return result;
+            }
+
+            VkCommandBufferAllocateInfo commandBufferAllocateInfo = {
+                .sType              = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO,
+                .commandPool        = batch.commandPool,
+                .level              = VK_COMMAND_BUFFER_LEVEL_PRIMARY,
+                .commandBufferCount = 1,
+            };
+            result = vkAllocateCommandBuffers(mDevice, &commandBufferAllocateInfo, &batch.commandBuffer);
+            if (result != VK_SUCCESS) {
+                NOVA_LOG_ERROR(RHI, "Failed to allocate an upload command buffer: {}", int32_t(result));
+                return result;
+            }
+
+            if (!mQueue->HasTimeline()) {
+                result = vkCreateFence(mDevice, &fenceCreateInfo, VulkanHostMemory::GetCallbacks(), &batch.fence);
+                if (result != VK_SUCCESS) {
+                    NOVA_LOG_ERROR(RHI, "Failed to create an upload fence: {}", int32_t(result));
+                    return result;
+                }
+            }
+        }
+
+        mStats              = {};
+        mStats.ringCapacity = mCapacity;
+        mLastRetireTime     = std::chrono::steady_clock::now();
+        return VK_SUCCESS;
+    }
+
+    // 等待所有在途批次完成后销毁
+    void Terminate() {
+        if (mAllocator == nullptr) {
+            return;
+        }
+
+        std::unique_lock<std::mutex> lock(mMutex);
+        if (mBatchOpen) {
+            vkEndCommandBuffer(mBatches[OpenBatchIndex()].commandBuffer);
+            mBatchOpen = false;
+        }
+        while (mBatchCount > 0) {
+            WaitOldestBatch(lock);
+            RetireCompletedBatches();
+        }
+        mPendingAcquires.resize(0);
+
+        for (auto& batch: mBatches) {
+            if (batch.fence != VK_NULL_HANDLE) {
+                vkDestroyFence(mDevice, batch.fence, VulkanHostMemory::GetCallbacks());
+            }
+            if (batch.commandPool != VK_NULL_HANDLE) {
+                vkDestroyCommandPool(mDevice, batch.commandPool, VulkanHostMemory::GetCallbacks());
+            }
+            batch = {};
+        }
+        mAllocator->DestroyBuffer(mStagingBuffer, mStagingAllocation);
+        mAllocator = nullptr;
+        mQueue     = nullptr;
+    }
+
+    VulkanQueue& GetQueue() const {
+        return *mQueue;
+    }
+
+    // 传输队列与图形队列不属于同一队列族时需要转移所有权
+    bool IsOwnershipTransferRequired() const {
+        return mQueue->GetFamilyIndex() != mDstFamily;
+    }
+
+    // ticket对应的上传已经可以在图形队列上使用
+    bool IsReady(uint64_t ticket) const {
+        std::lock_guard<std::mutex> lock(mMutex);
+        return ticket <= mReadyTicket;
+    }
+
+    // 每帧上传量的软上限, 为0时不限制; 流式加载逻辑据此决定是否推迟本帧的请求
+    void SetFrameBudget(VkDeviceSize bytes) {
+        mFrameBudget = bytes;
+    }
+
+    VkDeviceSize GetFrameBudgetRemaining() const {
+        std::lock_guard<std::mutex> lock(mMutex);
+        if (mFrameBudget == 0) {
+            return UINT64_MAX;
+        }
+        return mFrameBudget > mFrameBytes ? mFrameBudget - mFrameBytes : 0;
+    }
+
+    // 吞吐量按批次提交到完成的时间累计, 完成情况在上传和BeginFrame时轮询, 延迟包含轮询的误差
+    VulkanUploadStats GetStats() const {
+        std::lock_guard<std::mutex> lock(mMutex);
+        VulkanUploadStats stats = mStats;
+        stats.ringUsed          = mHead - mTail;
+        stats.frameBytes        = mFrameBytes;
+        stats.throughputMBps    = mBusySeconds > 0.0 ? double(mStats.bytesUploaded) / (1024.0 * 1024.0) / mBusySeconds : 0.0;
+        stats.averageLatencyMs  = mStats.batchCount > 0 ? mLatencySeconds * 1000.0 / double(mStats.batchCount) : 0.0;
+        return stats;
+    }
+
+    // 上传到缓冲, 超过环形缓冲一半的数据会拆分为多次拷贝
+    VulkanResult UploadBuffer(VkBuffer buffer, VkDeviceSize dstOffset, const void* data, VkDeviceSize size, uint64_t* ticket = nullptr) {
+        std::unique_lock<std::mutex> lock(mMutex);
+
+        VkDeviceSize maxChunk = mCapacity / 2;
+        for (VkDeviceSize copied = 0; copied < size;) {
+            VkDeviceSize chunk  = std::min(size - copied, maxChunk);
+            VkDeviceSize offset = 0;
+            VkResult     result = AllocateStaging(lock, chunk, 16, offset);
+            if (result != VK_SUCCESS) {
+                return result;
+            }
+            memcpy(static_cast<uint8_t*>(mStagingAllocation.mappedData) + offset, static_cast<const uint8_t*>(data) + copied, chunk);
+
+            Batch& batch = mBatches[OpenBatchIndex()];
+
+            VkBufferCopy bufferCopy = {
+                .srcOffset = offset,
+                .dstOffset = dstOffset + copied,
+                .size      = chunk,
+            };
+            vkCmdCopyBuffer(batch.commandBuffer, mStagingBuffer, buffer, 1, &bufferCopy);
+
+            if (IsOwnershipTransferRequired()) {
+                CmdReleaseBufferOwnership(
+                    batch.commandBuffer,
+                    buffer,
+                    dstOffset + copied,
+                    chunk,
+                    mQueue->GetFamilyIndex(),
+                    mDstFamily,
+                    VK_PIPELINE_STAGE_TRANSFER_BIT,
+                    VK_ACCESS_TRANSFER_WRITE_BIT
+                );
+                batch.acquires.push_back({ .buffer = buffer, .offset = dstOffset + copied, .size = chunk });
+            }
+            batch.copiedBuffer = true;
+            if (ticket != nullptr) {
+                *ticket = batch.ticket;
+            }
+
+            copied += chunk;
+            result = AccountBytes(chunk);
+            if (result != VK_SUCCESS) {
+                return result;
+            }
+        }
+        return VK_SUCCESS;
+    }
+
+    // 上传图像的若干子资源, 整个图像从UNDEFINED开始, 完成后处于finalLayout
+    // 所有区域需要一次放入环形缓冲, texelBlockSize为每个像素(压缩格式为每个块)的字节数
+    VulkanResult UploadImage(
+        VkImage                                  image,
+        VkImageAspectFlags                       aspectMask,
+        uint32_t                                 mipLevels,
+        uint32_t                                 arrayLayers,
+        std::span<const VulkanImageUploadRegion> regions,
+        VkImageLayout                            finalLayout,
+        uint32_t                                 texelBlockSize = 4,
+        uint64_t*                                ticket         = nullptr
+    ) {
+        std::unique_lock<std::mutex> lock(mMutex);
+
+        // 拷贝的缓冲偏移需要是4和像素大小的倍数
+        VkDeviceSize alignment = std::lcm(VkDeviceSize(4), VkDeviceSize(texelBlockSize));
+        VkDeviceSize totalSize = 0;
+        for (auto& region: regions) {
+            totalSize = AlignUpAny(totalSize, alignment) + region.size;
+        }
+        if (totalSize > mCapacity) {
+            NOVA_LOG_ERROR(RHI, "Image upload of {} bytes exceeds the staging ring capacity {}", totalSize, mCapacity);
+            return VK_ERROR_OUT_OF_DEVICE_MEMORY;
+        }
+
+        VkDeviceSize baseOffset = 0;
+        VkResult     result     = AllocateStaging(lock, totalSize, alignment, baseOffset);
+        if (result != VK_SUCCESS) {
+            return result;
+        }
+
+        Batch& batch = mBatches[OpenBatchIndex()];
+
+        std::vector<VkBufferImageCopy> bufferImageCopies;
+        bufferImageCopies.reserve(regions.size());
+        VkDeviceSize offset = baseOffset;
+        for (auto& region: regions) {
+            offset = AlignUpAny(offset, alignment);
+            memcpy(static_cast<uint8_t*>(mStagingAllocation.mappedData) + offset, region.data, region.size);
+            bufferImageCopies.push_back({
+                .bufferOffset     = offset,
+                .imageSubresource = { aspectMask, region.mipLevel, region.baseArrayLayer, region.layerCount },
+                .imageExtent      = region.extent,
+            });
+            offset += region.size;
+        }
+
+        VkImageSubresourceRange range = { aspectMask, 0, mipLevels, 0, arrayLayers };
+
+        VkImageMemoryBarrier imageMemoryBarrier = {
+            .sType               = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
+            .srcAccessMask       = 0,
+            .dstAccessMask       = VK_ACCESS_TRANSFER_WRITE_BIT,
+            .oldLayout           = VK_IMAGE_LAYOUT_UNDEFINED,
+            .newLayout           = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+            .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+            .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+            .image               = image,
+            .subresourceRange    = range,
+        };
+        vkCmdPipelineBarrier(
+            batch.commandBuffer,
+            VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT,
+            VK_PIPELINE_STAGE_TRANSFER_BIT,
+            0,
+            0,
+            nullptr,
+            0,
+            nullptr,
+            1,
+            &imageMemoryBarrier
+        );
+
+        vkCmdCopyBufferToImage(
+            batch.commandBuffer,
+            mStagingBuffer,
+            image,
+            VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+            static_cast<uint32_t>(bufferImageCopies.size()),
+            bufferImageCopies.data()
+        );
+
+        if (IsOwnershipTransferRequired()) {
+            // 布局转换随所有权转移一起完成
+            CmdReleaseImageOwnership(
+                batch.commandBuffer,
+                image,
+                range,
+                mQueue->GetFamilyIndex(),
+                mDstFamily,
+                VK_PIPELINE_STAGE_TRANSFER_BIT,
+                VK_ACCESS_TRANSFER_WRITE_BIT,
+                VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                finalLayout
+            );
+            batch.acquires.push_back({ .image = image, .range = range, .layout = finalLayout });
+        } else {
+            imageMemoryBarrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+            imageMemoryBarrier.dstAccessMask = VK_ACCESS_MEMORY_READ_BIT;
+            imageMemoryBarrier.oldLayout     = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+            imageMemoryBarrier.newLayout     = finalLayout;
+            vkCmdPipelineBarrier(
+                batch.commandBuffer,
+                VK_PIPELINE_STAGE_TRANSFER_BIT,
+                VK_PIPELINE_STAGE_ALL_COMMANDS_BIT,
+                0,
+                0,
+                nullptr,
+                0,
+                nullptr,
+                1,
+                &imageMemoryBarrier
+            );
+        }
+
+        if (ticket != nullptr) {
+            *ticket = batch.ticket;
+        }
+        return AccountBytes(totalSize);
+    }
+
+    // 提交当前批次
+    VulkanResult Flush() {
+        std::lock_guard<std::mutex> lock(mMutex);
+        return SubmitOpenBatch();
+    }
+
+    // 每帧在图形命令缓冲开始录制后调用: 提交积累的上传, 为已完成的批次录制所有权获取屏障
+    // 返回图形提交需要等待的传输队列时间线值, 为0表示不需要等待; 返回的值已经完成, 等待不会阻塞GPU
+    uint64_t BeginFrame(VkCommandBuffer commandBuffer) {
+        std::lock_guard<std::mutex> lock(mMutex);
+
+        mFrameBytes = 0;
+        SubmitOpenBatch();
+        RetireCompletedBatches();
+
+        for (auto& acquire: mPendingAcquires) {
+            if (acquire.image != VK_NULL_HANDLE) {
+                CmdAcquireImageOwnership(
+                    commandBuffer,
+                    acquire.image,
+                    acquire.range,
+                    mQueue->GetFamilyIndex(),
+                    mDstFamily,
+                    VK_PIPELINE_STAGE_ALL_COMMANDS_BIT,
+                    VK_ACCESS_MEMORY_READ_BIT,
+                    VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                    acquire.layout
+                );
+            } else {
+                CmdAcquireBufferOwnership(
+                    commandBuffer,
+                    acquire.buffer,
+                    acquire.offset,
+                    acquire.size,
+                    mQueue->GetFamilyIndex(),
+                    mDstFamily,
+                    VK_PIPELINE_STAGE_ALL_COMMANDS_BIT,
+                    VK_ACCESS_MEMORY_READ_BIT
+                );
+            }
+        }
+        mPendingAcquires.resize(0);
+        // 不需要转移所有权时批次完成即可用, mReadyTicket已经在回收时更新
+        if (IsOwnershipTransferRequired()) {
+            mReadyTicket = mCompletedTicket;
+        }
+
+        uint64_t waitValue   = mPendingAcquireValue;
+        mPendingAcquireValue = 0;
+        return waitValue;
+    }
+
+private:
+    static VkDeviceSize AlignUpAny(VkDeviceSize value, VkDeviceSize alignment) {
+        return (value + alignment - 1) / alignment * alignment;
+    }
+
+    uint32_t OpenBatchIndex() const {
+        return (mBatchBegin + mBatchCount) % BATCH_COUNT;
+    }
+
+    VkResult AccountBytes(VkDeviceSize bytes) {
+        Batch& batch = mBatches[OpenBatchIndex()];
+        batch.bytes += bytes;
+        mFrameBytes += bytes;
+        if (batch.bytes >= mCapacity / BATCH_FLUSH_DIVISOR) {
+            return SubmitOpenBatch();
+        }
+        return VK_SUCCESS;
+    }
+
+    VkResult OpenBatch(std::unique_lock<std::mutex>& lock) {
+        if (mBatchOpen) {
+            return VK_SUCCESS;
+        }
+
+        // 所有批次都在途时等待最早的批次
+        RetireCompletedBatches();
+        while (mBatchCount == BATCH_COUNT) {
+            mStats.stallCount++;
+            WaitOldestBatch(lock);
+            RetireCompletedBatches();
+            if (mBatchOpen) {
+                return VK_SUCCESS;
+            }
+        }
+
+        Batch&   batch  = mBatches[OpenBatchIndex()];
+        VkResult result = vkResetCommandPool(mDevice, batch.commandPool, 0);
+        if (result != VK_SUCCESS) {
+            NOVA_LOG_ERROR(RHI, "Failed to reset an upload command pool: {}", int32_t(result));
+            return result;
+        }
+
+        VkCommandBufferBeginInfo commandBufferBeginInfo = {
+            .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO,
+            .flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT,
+        };
+        result = vkBeginCommandBuffer(batch.commandBuffer, &commandBufferBeginInfo);
+        if (result != VK_SUCCESS) {
+            NOVA_LOG_ERROR(RHI, "Failed to begin an upload command buffer: {}", int32_t(result));
+            return result;
+        }
+
+        batch.ticket        = mNextTicket++;
+        batch.timelineValue = 0;
+        batch.bytes         = 0;
+        batch.copiedBuffer  = false;
+        batch.acquires.resize(0);
+        mBatchOpen = true;
+        return VK_SUCCESS;
+    }
+
+    VkResult SubmitOpenBatch() {
+        if (!mBatchOpen) {
+            return VK_SUCCESS;
+        }
+        mBatchOpen = false;
+
+        Batch& batch  = mBatches[OpenBatchIndex()];
+        batch.ringEnd = mHead;
+
+        // 同一队列族时让后续提交可以看到缓冲的写入, 图像已经在拷贝后单独转换
+        if (batch.copiedBuffer && !IsOwnershipTransferRequired()) {
+            VkMemoryBarrier memoryBarrier = {
+                .sType         = VK_STRUCTURE_TYPE_MEMORY_BARRIER,
+                .srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT,
+                .dstAccessMask = VK_ACCESS_MEMORY_READ_BIT,
+            };
+            vkCmdPipelineBarrier(
+                batch.commandBuffer,
+                VK_PIPELINE_STAGE_TRANSFER_BIT,
+                VK_PIPELINE_STAGE_ALL_COMMANDS_BIT,
+                0,
+                1,
+                &memoryBarrier,
+                0,
+                nullptr,
+                0,
+                nullptr
+            );
+        }
+
+        VkResult result = vkEndCommandBuffer(batch.commandBuffer);
+        if (result != VK_SUCCESS) {
+            NOVA_LOG_ERROR(RHI, "Failed to end an upload command buffer: {}", int32_t(result));
+            return result;
+        }
+
+        if (batch.fence != VK_NULL_HANDLE) {
+            vkResetFences(mDevice, 1, &batch.fence);
+        }
+        result = mQueue->Submit({ &batch.commandBuffer, 1 }, {}, {}, batch.fence, &batch.timelineValue);
+        if (result != VK_SUCCESS) {
+            return result;
+        }
+        batch.submitTime = std::chrono::steady_clock::now();
+        mBatchCount++;
+        return VK_SUCCESS;
+    }
+
+    bool IsBatchCompleted(const Batch& batch) const {
+        if (batch.fence != VK_NULL_HANDLE) {
+            return vkGetFenceStatus(mDevice, batch.fence) == VK_SUCCESS;
+        }
+        return mQueue->IsCompleted(batch.timelineValue);
+    }
+
+    // 在等待期间释放锁, 图形线程的BeginFrame不会被上传线程阻塞
+    void WaitOldestBatch(std::unique_lock<std::mutex>& lock) {
+        if (mBatchCount == 0) {
+            return;
+        }
+
+        Batch&   batch         = mBatches[mBatchBegin];
+        VkFence  fence         = batch.fence;
+        uint64_t timelineValue = batch.timelineValue;
+        lock.unlock();
+        if (fence != VK_NULL_HANDLE) {
+            vkWaitForFences(mDevice, 1, &fence, VK_TRUE, UINT64_MAX);
+        } else {
+            mQueue->WaitForValue(timelineValue).Ignore();
+        }
+        lock.lock();
+    }
+
+    // 按提交顺序回收已完成的批次, 释放它们占用的环形缓冲
+    void RetireCompletedBatches() {
+        auto now = std::chrono::steady_clock::now();
+        while (mBatchCount > 0 && IsBatchCompleted(mBatches[mBatchBegin])) {
+            Batch& batch = mBatches[mBatchBegin];
+            mTail        = std::max(mTail, batch.ringEnd); // 环形缓冲清空后尾部可能已经跳到下一圈
+
+            mStats.bytesUploaded += batch.bytes;
+            mStats.batchCount++;
+            mBusySeconds += std::chrono::duration<double>(now - std::max(batch.submitTime, mLastRetireTime)).count();
+            mLatencySeconds += std::chrono::duration<double>(now - batch.submitTime).count();
+            mLastRetireTime = now;
+
+            // 需要转移所有权时, 等图形队列获取之后才算可用
+            if (IsOwnershipTransferRequired()) {
+                mPendingAcquires.insert(mPendingAcquires.end(), batch.acquires.begin(), batch.acquires.end());
+                mPendingAcquireValue = batch.timelineValue;
+                mCompletedTicket     = batch.ticket;
+            } else {
+                mReadyTicket = batch.ticket;
+            }
+            mBatchBegin = (mBatchBegin + 1) % BATCH_COUNT;
+            mBatchCount--;
+        }
+    }
+
+    // 在环形缓冲中分配, 空间不足时先提交当前批次再等待最早的批次完成
+    VkResult AllocateStaging(std::unique_lock<std::mutex>& lock, VkDeviceSize size, VkDeviceSize alignment, VkDeviceSize& offset) {
+        while (true) {
+            // OpenBatch可能在等待时释放锁, 之后到分配完成之间不再释放
+            VkResult result = OpenBatch(lock);
+            if (result != VK_SUCCESS) {
+                return result;
+            }
+
+            // 尾部放不下时跳到下一圈的开头
+            uint64_t wrap     = mHead - mHead % mCapacity;
+            uint64_t position = wrap + AlignUpAny(mHead % mCapacity, alignment);
+            if (position + size > wrap + mCapacity) {
+                position = wrap + mCapacity;
+                // 环形缓冲已经清空时头尾一起跳到下一圈的开头, 否则超过剩余空间的分配永远放不下
+                if (mHead == mTail) {
+                    mHead = mTail = position;
+                }
+            }
+
+            if (position + size - mTail <= mCapacity) {
+                mHead               = position + size;
+                offset              = position % mCapacity;
+                mStats.ringPeakUsed = std::max(mStats.ringPeakUsed, mHead - mTail);
+                return VK_SUCCESS;
+            }
+
+            // 正在录制的批次也占用环形缓冲, 需要先提交才能被回收
+            result = SubmitOpenBatch();
+            if (result != VK_SUCCESS) {
+                return result;
+            }
+            mStats.stallCount++;
+            WaitOldestBatch(lock);
+            RetireCompletedBatches();
+        }
+    }
+};
+} // namespace Nova
@@ -0,0 +1,228 @@
+#pragma once
+
+#include "Core/SpscQueue.h"
+#include "Render/Interface/Vulkan/VulkanHelper.hpp"
+
+#define GLFW_INCLUDE_VULKAN
+#include <GLFW/glfw3.h>
+
+namespace Nova {
+
+enum class InputEventType : uint8_t {
+    Key,
+    MouseButton,
+    CursorPosition,
+    Scroll,
+    Iconify,
+    Close,
+};
+
+// GLFW回调中记录的输入事件, 由主线程写入窗口的输入队列, 由模拟线程取出
+struct InputEvent {
+    InputEventType type;
+    int32_t        code     = 0; // 键码或鼠标按键, Iconify时为是否最小化
+    int32_t        scancode = 0;
+    int32_t        action   = 0;
+    int32_t        mods     = 0;
+    double         x        = 0.0; // 光标位置或滚动偏移
+    double         y        = 0.0;
+};
+
+// 一个GLFW窗口, 多个窗口可以同时存在, 第一个窗口初始化GLFW, 最后一个窗口终止GLFW
+// GLFW的窗口函数只能在主线程调用, 渲染可以在其他线程上进行
+// 主线程处理事件时, 回调只把输入事件写入无锁队列, 由模拟线程通过PopInputEvent取出, 事件处理不会阻塞模拟和渲染
+// 帧缓冲尺寸不进入队列, 只保留最新的值, 队列已满时也不会丢失最终的尺寸
+class WindowSystem {
+public:
+    static constexpr size_t INPUT_QUEUE_CAPACITY = 1024;
+
+private:
+    GLFWwindow*  mWindow  = nullptr;
+    GLFWmonitor* mMonitor = nullptr;
+
+    // 主线程生产, 模拟线程消费
+    SpscQueue<InputEvent, INPUT_QUEUE_CAPACITY> mInputQueue;
+    // 队列已满而丢弃的事件数
+    std::atomic<uint64_t> mDroppedInputEvents = 0;
+    // 最新的帧缓冲尺寸, 高32位为宽度, 低32位为高度
+    std::atomic<uint64_t> mFramebufferSize = 0;
+
+    // 该窗口是否计入windowCount
+    bool mCounted = false;
+
+    // 存活的窗口数
+    static inline uint32_t windowCount = 0;
+
+public:
+    WindowSystem() = default;
+
+    WindowSystem(const WindowSystem&)            = delete;
+    WindowSystem& operator=(const WindowSystem&) = delete;
+
+    ~WindowSystem() {
+        Terminate();
+    }
+
+    GLFWwindow* GetWindow() const {
+        return mWindow;
+    }
+
+    GLFWmonitor* GetMonitor() const {
+        return mMonitor;
+    }
+
+    bool Initialize(const VkExtent2D size, const bool fullScreen = false, const bool isResizable = true, const char* title = DEFAULT_WINDOW_TITLE) {
+        if (windowCount == 0 && glfwInit() == 0) {
+            NOVA_LOG_ERROR(Window, "Failed to initialize GLFW!");
+            return false;
+        }
+        windowCount++;
+        mCounted = true;
+
+        // 设置窗口属性
+        glfwWindowHint(GLFW_CLIENT_API, GLFW_NO_API);
+        glfwWindowHint(GLFW_RESIZABLE, static_cast<int>(isResizable));
+
+        // 获取显示器
+        mMonitor = glfwGetPrimaryMonitor();
+
+        // 获取视频模式
+        const GLFWvidmode* pMode = glfwGetVideoMode(mMonitor);
+
+        // 根据模式创建窗口
+        mWindow = fullScreen ? glfwCreateWindow(pMode->width, pMode->height, title, mMonitor, nullptr)
+                             : glfwCreateWindow(static_cast<int>(size.width), static_cast<int>(size.height), title, nullptr, nullptr);
+        if (mWindow == nullptr) {
+            NOVA_LOG_ERROR(Window, "Failed to create GLFW window!");
+            Terminate();
+            return false;
+        }
+        glfwSetWindowUserPointer(mWindow, this);
+        InstallInputCallbacks();
+
+        // 之后的尺寸变化通过回调得到
+        int width = 0, height = 0;
+        glfwGetFramebufferSize(mWindow, &width, &height);
+        StoreFramebufferSize(width, height);
+        return true;
+    }
+
+    // 终止窗口前应该确保在该窗口上呈现的交换链已经销毁
+    void Terminate() {
+        if (mWindow != nullptr) {
+            glfwDestroyWindow(mWindow);
+            mWindow = nullptr;
+        }
+        mMonitor = nullptr;
+        if (mCounted) {
+            mCounted = false;
+            if (--windowCount == 0) {
+                glfwTerminate();
+            }
+        }
+    }
+
+    bool ShouldClose() const {
+        return glfwWindowShouldClose(mWindow) != 0;
+    }
+
+    VkExtent2D GetFramebufferSize() const {
+        int width = 0, height = 0;
+        glfwGetFramebufferSize(mWindow, &width, &height);
+        return { static_cast<uint32_t>(width), static_cast<uint32_t>(height) };
+    }
+
+    // 可以在任意线程调用, 返回回调记录的最新尺寸, 最小化时为0
+    VkExtent2D GetLatestFramebufferSize() const {
+        uint64_t size = mFramebufferSize.load(std::memory_order_relaxed);
+        return { static_cast<uint32_t>(size >> 32), static_cast<uint32_t>(size) };
+    }
+
+    void SetTitle(const char* title) {
+        glfwSetWindowTitle(mWindow, title);
+    }
+
+    // 只能由一个消费者线程调用, 队列为空时返回false
+    bool PopInputEvent(InputEvent& event) {
+        return mInputQueue.Pop(event);
+    }
+
+    uint64_t GetDroppedInputEventCount() const {
+        return mDroppedInputEvents.load(std::memory_order_relaxed);
+    }
+
+    // GLFW所需的实例扩展, 其中包含VK_KHR_surface和当前平台的窗口表面扩展, 必须在创建实例之前添加
+    // 需要在第一个窗口初始化之后调用
+    static std::span<const char*> GetRequiredInstanceExtensions() {
+        uint32_t     extensionCount = 0;
+        const char** extensionNames = glfwGetRequiredInstanceExtensions(&extensionCount);
+        if (extensionNames == nullptr) {
+            NOVA_LOG_ERROR(Window, "Failed to get GLFW required extensions!");
+            return {};
+        }
+        return { extensionNames, extensionCount };
+    }
+
+    // 表面归调用方所有, 通常交给VulkanSwapchain
+    VkResult CreateSurface(VkInstance instance, VkSurfaceKHR& surface) const {
+        VkResult result = glfwCreateWindowSurface(instance, mWindow, nullptr, &surface);
+        if (result != VK_SUCCESS) {
+            NOVA_LOG_ERROR(Window, "Failed to create GLFW surface: {}", int32_t(result));
+        }
+        return result;
+    }
+
+    void MakeFullScreen() {
+        const GLFWvidmode* mode = glfwGetVideoMode(mMonitor);
+        glfwSetWindowMonitor(mWindow, mMonitor, 0, 0, mode->width, mode->height, mode->refreshRate);
+    }
+
+    void Restore(const VkOffset2D position, const VkExtent2D size) {
+        const GLFWvidmode* mode = glfwGetVideoMode(mMonitor);
+        glfwSetWindowMonitor(
+            mWindow, mMonitor, position.x, position.y, static_cast<int>(size.width), static_cast<int>(size.height), mode->refreshRate
+        );
+    }
+
+private:
+    //======================================================================================================================================================
+    // input
+    //======================================================================================================================================================
+    void PushInputEvent(const InputEvent& event) {
+        if (!mInputQueue.Push(event)) {
+            mDroppedInputEvents.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    void StoreFramebufferSize(int width, int height) {
+        mFramebufferSize.store(uint64_t(uint32_t(width)) << 32 | uint32_t(height), std::memory_order_relaxed);
+    }
+
+    static WindowSystem& FromWindow(GLFWwindow* window) {
+        return *static_cast<WindowSystem*>(glfwGetWindowUserPointer(window));
+    }
+
+    // 回调在主线程的glfwPollEvents/glfwWaitEvents中调用
+    void InstallInputCallbacks() {
+        glfwSetKeyCallback(mWindow, [](GLFWwindow* window, int key, int scancode, int action, int mods) {
+            FromWindow(window).PushInputEvent({ .type = InputEventType::Key, .code = key, .scancode = scancode, .action = action, .mods = mods });
+        });
+        glfwSetMouseButtonCallback(mWindow, [](GLFWwindow* window, int button, int action, int mods) {
+            FromWindow(window).PushInputEvent({ .type = InputEventType::MouseButton, .code = button, .action = action, .mods = mods });
+        });
+        glfwSetCursorPosCallback(mWindow, [](GLFWwindow* window, double x, double y) {
+            FromWindow(window).PushInputEvent({ .type = InputEventType::CursorPosition, .x = x, .y = y });
+        });
+        glfwSetScrollCallback(mWindow, [](GLFWwindow* window, double x, double y) {
+            FromWindow(window).PushInputEvent({ .type = InputEventType::Scroll, .x = x, .y = y });
+        });
+        glfwSetFramebufferSizeCallback(mWindow, [](GLFWwindow* window, int width, int height) {
+            FromWindow(window).StoreFramebufferSize(width, height);
+        });
+        glfwSetWindowIconifyCallback(mWindow, [](GLFWwindow* window, int iconified) {
+            FromWindow(window).PushInputEvent({ .type = InputEventType::Iconify, .code = iconified });
+        });
+        glfwSetWindowCloseCallback(mWindow, [](GLFWwindow* window) { FromWindow(window).PushInputEvent({ .type = InputEventType::Close }); });
+    }
+};
+} // namespace Nova
@@ -0,0 +1,656 @@
+#include "RenderPipeline.h"
+
+#include <algorithm>
+#include <map>
+
+namespace Nova {
+
+static VkImageUsageFlags GetImageUsage(VkAccessFlags2 access) {
+    VkImageUsageFlags usage = 0;
+    if (access & VK_ACCESS_2_SHADER_SAMPLED_READ_BIT) {
+        usage |= VK_IMAGE_USAGE_SAMPLED_BIT;
+    }
+    if (access & (VK_ACCESS_2_SHADER_STORAGE_READ_BIT | VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT)) {
+        usage |= VK_IMAGE_USAGE_STORAGE_BIT;
+    }
+    if (access & (VK_ACCESS_2_COLOR_ATTACHMENT_READ_BIT | VK_ACCESS_2_COLOR_ATTACHMENT_WRITE_BIT)) {
+        usage |= VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT;
+    }
+    if (access & (VK_ACCESS_2_DEPTH_STENCIL_ATTACHMENT_READ_BIT | VK_ACCESS_2_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT)) {
+        usage |= VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT;
+    }
+    if (access & VK_ACCESS_2_INPUT_ATTACHMENT_READ_BIT) {
+        usage |= VK_IMAGE_USAGE_INPUT_ATTACHMENT_BIT;
+    }
+    if (access & VK_ACCESS_2_TRANSFER_READ_BIT) {
+        usage |= VK_IMAGE_USAGE_TRANSFER_SRC_BIT;
+    }
+    if (access & VK_ACCESS_2_TRANSFER_WRITE_BIT) {
+        usage |= VK_IMAGE_USAGE_TRANSFER_DST_BIT;
+    }
+    return usage;
+}
+
+static VkBufferUsageFlags GetBufferUsage(VkAccessFlags2 access) {
+    VkBufferUsageFlags usage = 0;
+    if (access & VK_ACCESS_2_VERTEX_ATTRIBUTE_READ_BIT) {
+        usage |= VK_BUFFER_USAGE_VERTEX_BUFFER_BIT;
+    }
+    if (access & VK_ACCESS_2_INDEX_READ_BIT) {
+        usage |= VK_BUFFER_USAGE_INDEX_BUFFER_BIT;
+    }
+    if (access & VK_ACCESS_2_UNIFORM_READ_BIT) {
+        usage |= VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT;
+    }
+    if (access & (VK_ACCESS_2_SHADER_STORAGE_READ_BIT | VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT)) {
+        usage |= VK_BUFFER_USAGE_STORAGE_BUFFER_BIT;
+    }
+    if (access & VK_ACCESS_2_INDIRECT_COMMAND_READ_BIT) {
+        usage |= VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT;
+    }
+    if (access & VK_ACCESS_2_TRANSFER_READ_BIT) {
+        usage |= VK_BUFFER_USAGE_TRANSFER_SRC_BIT;
+    }
+    if (access & VK_ACCESS_2_TRANSFER_WRITE_BIT) {
+        usage |= VK_BUFFER_USAGE_TRANSFER_DST_BIT;
+    }
+    return usage;
+}
+
+// 只保留写访问, 读访问放在源访问掩码中没有意义
+static VkAccessFlags2 GetWriteAccess(VkAccessFlags2 access) {
+    constexpr VkAccessFlags2 WRITE_ACCESS = VK_ACCESS_2_SHADER_WRITE_BIT | VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT |
+                                            VK_ACCESS_2_COLOR_ATTACHMENT_WRITE_BIT | VK_ACCESS_2_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT |
+                                            VK_ACCESS_2_TRANSFER_WRITE_BIT | VK_ACCESS_2_HOST_WRITE_BIT | VK_ACCESS_2_MEMORY_WRITE_BIT;
+    return access & WRITE_ACCESS;
+}
+
+void RenderGraphPassBuilder::Read(RenderGraphImage image, const RenderGraphAccess& access) {
+    mGraph.AddUse(mPassIndex, image.index, access, false);
+}
+
+void RenderGraphPassBuilder::Write(RenderGraphImage image, const RenderGraphAccess& access) {
+    mGraph.AddUse(mPassIndex, image.index, access, true);
+}
+
+void RenderGraphPassBuilder::Read(RenderGraphBuffer buffer, const RenderGraphAccess& access) {
+    mGraph.AddUse(mPassIndex, buffer.index, access, false);
+}
+
+void RenderGraphPassBuilder::Write(RenderGraphBuffer buffer, const RenderGraphAccess& access) {
+    mGraph.AddUse(mPassIndex, buffer.index, access, true);
+}
+
+void RenderGraphPassBuilder::SetSideEffect() {
+    mGraph.mPasses[mPassIndex].sideEffect = true;
+}
+
+void RenderGraph::Reset() {
+    DestroyTransientResources();
+    mPasses.resize(0);
+    mResources.resize(0);
+    mBarrierBatches.resize(0);
+    mCompiled = false;
+    mStats    = {};
+}
+
+RenderGraphImage RenderGraph::CreateImage(const std::string& name, const RenderGraphImageDesc& desc) {
+    Resource resource  = {};
+    resource.name      = name;
+    resource.isImage   = true;
+    resource.imageDesc = desc;
+    mResources.push_back(resource);
+    mCompiled = false;
+    return { static_cast<uint32_t>(mResources.size() - 1) };
+}
+
+RenderGraphBuffer RenderGraph::CreateBuffer(const std::string& name, const RenderGraphBufferDesc& desc) {
+    Resource resource   = {};
+    resource.name       = name;
+    resource.isImage    = false;
+    resource.bufferDesc = desc;
+    mResources.push_back(resource);
+    mCompiled = false;
+    return { static_cast<uint32_t>(mResources.size() - 1) };
+}
+
+RenderGraphImage RenderGraph::ImportImage(
+    const std::string&          name,
+    VkImage                     image,
+    VkImageView                 imageView,
+    const RenderGraphImageDesc& desc,
+    const RenderGraphAccess&    initialAccess,
+    const RenderGraphAccess&    finalAccess
+) {
+    Resource resource      = {};
+    resource.name          = name;
+    resource.isImage       = true;
+    resource.imported      = true;
+    resource.imageDesc     = desc;
+    resource.image         = image;
+    resource.imageView     = imageView;
+    resource.initialAccess = initialAccess;
+    resource.finalAccess   = finalAccess;
+    mResources.push_back(resource);
+    mCompiled = false;
+    return { static_cast<uint32_t>(mResources.size() - 1) };
+}
+
+RenderGraphBuffer RenderGraph::ImportBuffer(
+    const std::string&           name,
+    VkBuffer                     buffer,
+    const RenderGraphBufferDesc& desc,
+    const RenderGraphAccess&     initialAccess,
+    const RenderGraphAccess&     finalAccess
+) {
+    Resource resource      = {};
+    resource.name          = name;
+    resource.isImage       = false;
+    resource.imported      = true;
+    resource.bufferDesc    = desc;
+    resource.buffer        = buffer;
+    resource.initialAccess = initialAccess;
+    resource.finalAccess   = finalAccess;
+    mResources.push_back(resource);
+    mCompiled = false;
+    return { static_cast<uint32_t>(mResources.size() - 1) };
+}
+
+void RenderGraph::SetImportedImage(RenderGraphImage handle, VkImage image, VkImageView imageView) {
+    mResources[handle.index].image     = image;
+    mResources[handle.index].imageView = imageView;
+}
+
+void RenderGraph::SetImportedBuffer(RenderGraphBuffer handle, VkBuffer buffer) {
+    mResources[handle.index].buffer = buffer;
+}
+
+void RenderGraph::AddPass(const std::string& name, const SetupFunction& setup, ExecuteFunction execute) {
+    mPasses.push_back({ .name = name, .execute = std::move(execute) });
+    mCompiled = false;
+
+    RenderGraphPassBuilder builder(*this, static_cast<uint32_t>(mPasses.size() - 1));
+    setup(builder);
+}
+
+void RenderGraph::AddUse(uint32_t passIndex, uint32_t resourceIndex, const RenderGraphAccess& access, bool write) {
+    // 同一通道对同一资源的多次声明合并为一次使用
+    for (auto& use: mPasses[passIndex].uses) {
+        if (use.resourceIndex == resourceIndex) {
+            use.access.stage |= access.stage;
+            use.access.access |= access.access;
+            if (write) {
+                use.access.layout = access.layout;
+            }
+            use.read |= !write;
+            use.write |= write;
+            return;
+        }
+    }
+    mPasses[passIndex].uses.push_back({ resourceIndex, access, !write, write });
+}
+
+VulkanResult RenderGraph::Compile() {
+    DestroyTransientResources();
+    mBarrierBatches.resize(0);
+    mStats = {};
+
+    CullPasses();
+    ComputeLifetimes();
+
+    VkResult result = CreateTransientResources();
+    if (result != VK_SUCCESS) {
+        return result;
+    }
+    result = AliasTransientResources();
+    if (result != VK_SUCCESS) {
+        return result;
+    }
+
+    BuildBarriers();
+
+    mCompiled = true;
+    return VK_SUCCESS;
+}
+
+// 从输出反向遍历: 通道只有在写入了后续仍然需要的资源, 或者有副作用时才会保留
+void RenderGraph::CullPasses() {
+    std::vector<bool> needed(mResources.size());
+    for (size_t i = 0; i < mResources.size(); i++) {
+        needed[i] = mResources[i].imported;
+    }
+
+    for (size_t i = mPasses.size(); i-- > 0;) {
+        Pass& pass  = mPasses[i];
+        bool  alive = pass.sideEffect;
+        for (auto& use: pass.uses) {
+            alive = alive || (use.write && needed[use.resourceIndex]);
+        }
+
+        pass.culled = !alive;
+        if (!alive) {
+            mStats.culledPassCount++;
+            continue;
+        }
+
+        // 只写入的资源在更早的通道中不再需要, 同时读写的资源(例如加载后继续绘制)仍然需要
+        for (auto& use: pass.uses) {
+            needed[use.resourceIndex] = use.read;
+        }
+    }
+    mStats.passCount = static_cast<uint32_t>(mPasses.size());
+}
+
+void RenderGraph::ComputeLifetimes() {
+    for (auto& resource: mResources) {
+        resource.firstPass = UINT32_MAX;
+        resource.lastPass  = 0;
+        resource.allStages = VK_PIPELINE_STAGE_2_NONE;
+        resource.allWrites = VK_ACCESS_2_NONE;
+        resource.heapIndex = UINT32_MAX;
+    }
+
+    for (uint32_t i = 0; i < mPasses.size(); i++) {
+        if (mPasses[i].culled) {
+            continue;
+        }
+        for (auto& use: mPasses[i].uses) {
+            Resource& resource = mResources[use.resourceIndex];
+            resource.firstPass = std::min(resource.firstPass, i);
+            resource.lastPass  = std::max(resource.lastPass, i);
+            resource.allStages |= use.access.stage;
+            resource.allWrites |= GetWriteAccess(use.access.access);
+            if (resource.isImage) {
+                resource.imageDesc.usage |= GetImageUsage(use.access.access);
+            } else {
+                resource.bufferDesc.usage |= GetBufferUsage(use.access.access);
+            }
+        }
+    }
+}
+
+VulkanResult RenderGraph::CreateTransientResources() {
+    for (auto& resource: mResources) {
+        if (resource.imported || resource.firstPass == UINT32_MAX) {
+            continue;
+        }
+
+        if (resource.isImage) {
+            const RenderGraphImageDesc& desc            = resource.imageDesc;
+            VkImageCreateInfo           imageCreateInfo = {
+                          .sType         = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO,
+                          .imageType     = VK_IMAGE_TYPE_2D,
+                          .format        = desc.format,
+                          .extent        = { desc.extent.width, desc.extent.height, 1 },
+                          .mipLevels     = desc.mipLevels,
+                          .arrayLayers   = desc.arrayLayers,
+                          .samples       = desc.samples,
+                          .tiling        = VK_IMAGE_TILING_OPTIMAL,
+                          .usage         = desc.usage,
+                          .sharingMode   = VK_SHARING_MODE_EXCLUSIVE,
+                          .initialLayout = VK_IMAGE_LAYOUT_UNDEFINED,
+            };
+            VkResult result = vkCreateImage(mDevice, &imageCreateInfo, VulkanHostMemory::GetCallbacks(), &resource.image);
+            if (result != VK_SUCCESS) {
+                NOVA_LOG_ERROR(Render, "Failed to create transient image {}: {}", resource.name, int32_t(result));
+                return result;
+            }
+            vkGetImageMemoryRequirements(mDevice, resource.image, &resource.memoryRequirements);
+        } else {
+            VkBufferCreateInfo bufferCreateInfo = {
+                .sType       = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO,
+                .size        = resource.bufferDesc.size,
+                .usage       = resource.bufferDesc.usage,
+                .sharingMode = VK_SHARING_MODE_EXCLUSIVE,
+            };
+            VkResult result = vkCreateBuffer(mDevice, &bufferCreateInfo, VulkanHostMemory::GetCallbacks(), &resource.buffer);
+            if (result != VK_SUCCESS) {
+                NOVA_LOG_ERROR(Render, "Failed to create transient buffer {}: {}", resource.name, int32_t(result));
+                return result;
+            }
+            vkGetBufferMemoryRequirements(mDevice, resource.buffer, &resource.memoryRequirements);
+        }
+        mStats.transientBytes += resource.memoryRequirements.size;
+    }
+    return VK_SUCCESS;
+}
+
+// 按(是否图像, 内存类型)分组, 每组共享一块内存
+// 组内按大小从大到小放置, 每个资源放在与它生命周期重叠的资源都不冲突的最低偏移处
+VulkanResult RenderGraph::AliasTransientResources() {
+    std::map<std::pair<bool, uint32_t>, std::vector<uint32_t>> groups;
+    for (uint32_t i = 0; i < mResources.size(); i++) {
+        const Resource& resource = mResources[i];
+        if (!resource.imported && resource.firstPass != UINT32_MAX) {
+            groups[{ resource.isImage, resource.memoryRequirements.memoryTypeBits }].push_back(i);
+        }
+    }
+
+    for (auto& [key, indices]: groups) {
+        std::sort(indices.begin(), indices.end(), [this](uint32_t a, uint32_t b) {
+            return mResources[a].memoryRequirements.size > mResources[b].memoryRequirements.size;
+        });
+
+        uint32_t              heapIndex     = static_cast<uint32_t>(mTransientHeaps.size());
+        VkDeviceSize          heapSize      = 0;
+        VkDeviceSize          heapAlignment = 1;
+        std::vector<uint32_t> placed;
+
+        for (uint32_t index: indices) {
+            Resource&                   resource     = mResources[index];
+            const VkMemoryRequirements& requirements = resource.memoryRequirements;
+
+            // 候选偏移: 0以及每个冲突资源的末尾
+            std::vector<VkDeviceSize> candidates = { 0 };
+            for (uint32_t other: placed) {
+                const Resource& placedResource = mResources[other];
+                if (placedResource.firstPass <= resource.lastPass && resource.firstPass <= placedResource.lastPass) {
+                    candidates.push_back(AlignUp(placedResource.heapOffset + placedResource.memoryRequirements.size, requirements.alignment));
+                }
+            }
+            std::sort(candidates.begin(), candidates.end());
+
+            for (VkDeviceSize offset: candidates) {
+                bool overlapped = false;
+                for (uint32_t other: placed) {
+                    const Resource& placedResource = mResources[other];
+                    bool lifetimeOverlapped = placedResource.firstPass <= resource.lastPass && resource.firstPass <= placedResource.lastPass;
+                    bool memoryOverlapped   = offset < placedResource.heapOffset + placedResource.memoryRequirements.size &&
+                                            placedResource.heapOffset < offset + requirements.size;
+                    if (lifetimeOverlapped && memoryOverlapped) {
+                        overlapped = true;
+                        break;
+                    }
+                }
+                if (!overlapped) {
+                    resource.heapOffset = offset;
+                    break;
+                }
+            }
+
+            resource.heapIndex = heapIndex;
+            heapSize           = std::max(heapSize, resource.heapOffset + requirements.size);
+            heapAlignment      = std::max(heapAlignment, requirements.alignment);
+            placed.push_back(index);
+        }
+
+        TransientHeap        heap         = { .size = heapSize };
+        VkMemoryRequirements requirements = { heapSize, heapAlignment, key.second };
+        VkResult result = mAllocator->Allocate(requirements, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, 0, !key.first, heap.allocation);
+        if (result != VK_SUCCESS) {
+            NOVA_LOG_ERROR(Render, "Failed to allocate a transient heap of {} bytes: {}", heapSize, int32_t(result));
+            return result;
+        }
+        mTransientHeaps.push_back(heap);
+        mStats.aliasedBytes += heapSize;
+
+        for (uint32_t index: indices) {
+            Resource&    resource = mResources[index];
+            VkDeviceSize offset   = heap.allocation.offset + resource.heapOffset;
+            if (resource.isImage) {
+                result = vkBindImageMemory(mDevice, resource.image, heap.allocation.memory, offset);
+            } else {
+                result = vkBindBufferMemory(mDevice, resource.buffer, heap.allocation.memory, offset);
+            }
+            if (result != VK_SUCCESS) {
+                NOVA_LOG_ERROR(Render, "Failed to bind memory for {}: {}", resource.name, int32_t(result));
+                return result;
+            }
+
+            if (resource.isImage) {
+                const RenderGraphImageDesc& desc                = resource.imageDesc;
+                VkImageViewCreateInfo       imageViewCreateInfo = {
+                          .sType            = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO,
+                          .image            = resource.image,
+                          .viewType         = desc.arrayLayers > 1 ? VK_IMAGE_VIEW_TYPE_2D_ARRAY : VK_IMAGE_VIEW_TYPE_2D,
+                          .format           = desc.format,
+                          .subresourceRange = { desc.aspect, 0, desc.mipLevels, 0, desc.arrayLayers },
+                };
+                result = vkCreateImageView(mDevice, &imageViewCreateInfo, VulkanHostMemory::GetCallbacks(), &resource.imageView);
+                if (result != VK_SUCCESS) {
+                    NOVA_LOG_ERROR(Render, "Failed to create image view for {}: {}", resource.name, int32_t(result));
+                    return result;
+                }
+            }
+        }
+    }
+    mStats.transientHeapCount = static_cast<uint32_t>(mTransientHeaps.size());
+    return VK_SUCCESS;
+}
+
+// 按执行顺序模拟每个资源的状态, 只在存在真实冒险或布局变化时插入屏障
+// 同一布局下的同步使用全局内存屏障, 只有布局转换才使用图像屏障
+void RenderGraph::BuildBarriers() {
+    struct State {
+        VkImageLayout         layout       = VK_IMAGE_LAYOUT_UNDEFINED;
+        VkPipelineStageFlags2 writeStage   = VK_PIPELINE_STAGE_2_NONE; // 上一次写入
+        VkAccessFlags2        writeAccess  = VK_ACCESS_2_NONE;
+        VkPipelineStageFlags2 readStages   = VK_PIPELINE_STAGE_2_NONE; // 上一次写入之后的读取
+        VkPipelineStageFlags2 syncedStages = VK_PIPELINE_STAGE_2_NONE; // 已经对上一次写入可见的读取
+        VkAccessFlags2        syncedAccess = VK_ACCESS_2_NONE;
+    };
+
+    std::vector<State> states(mResources.size());
+    for (size_t i = 0; i < mResources.size(); i++) {
+        const Resource& resource = mResources[i];
+        State&          state    = states[i];
+
+        if (resource.imported) {
+            state.layout      = resource.initialAccess.layout;
+            state.writeStage  = resource.initialAccess.stage;
+            state.writeAccess = GetWriteAccess(resource.initialAccess.access);
+            continue;
+        }
+        if (resource.heapIndex == UINT32_MAX) {
+            continue;
+        }
+
+        // 瞬态资源的首次使用需要等待上一帧对它的使用, 以及与它共享内存的其他资源
+        for (const Resource& other: mResources) {
+            if (other.heapIndex != resource.heapIndex) {
+                continue;
+            }
+            if (other.heapOffset < resource.heapOffset + resource.memoryRequirements.size &&
+                resource.heapOffset < other.heapOffset + other.memoryRequirements.size) {
+                state.writeStage |= other.allStages;
+                state.writeAccess |= other.allWrites;
+            }
+        }
+    }
+
+    auto getBatch = [this](uint32_t passIndex) -> BarrierBatch& {
+        if (mBarrierBatches.empty() || mBarrierBatches.back().passIndex != passIndex) {
+            mBarrierBatches.push_back({ .passIndex = passIndex });
+        }
+        return mBarrierBatches.back();
+    };
+
+    auto addMemoryBarrier = [&](uint32_t passIndex, VkPipelineStageFlags2 srcStage, VkAccessFlags2 srcAccess, const RenderGraphAccess& dst) {
+        VkMemoryBarrier2& barrier = getBatch(passIndex).memoryBarrier;
+        barrier.srcStageMask |= srcStage;
+        barrier.srcAccessMask |= srcAccess;
+        barrier.dstStageMask |= dst.stage;
+        barrier.dstAccessMask |= dst.access;
+    };
+
+    auto transition = [&](uint32_t passIndex, uint32_t resourceIndex, State& state, const RenderGraphAccess& dst) {
+        getBatch(passIndex).imageBarriers.push_back({
+            .resourceIndex = resourceIndex,
+            .srcStage      = state.writeStage | state.readStages,
+            .srcAccess     = state.writeAccess,
+            .dstStage      = dst.stage,
+            .dstAccess     = dst.access,
+            .oldLayout     = state.layout,
+            .newLayout     = dst.layout,
+        });
+    };
+
+    for (uint32_t i = 0; i < mPasses.size(); i++) {
+        if (mPasses[i].culled) {
+            continue;
+        }
+
+        for (auto& use: mPasses[i].uses) {
+            const Resource&          resource = mResources[use.resourceIndex];
+            const RenderGraphAccess& access   = use.access;
+            State&                   state    = states[use.resourceIndex];
+            bool                     write    = use.write || access.IsWrite();
+
+            if (resource.isImage && state.layout != access.layout) {
+                transition(i, use.resourceIndex, state, access);
+                // 布局转换本身相当于一次写入, 之后的读取需要等待它
+                state.layout       = access.layout;
+                state.writeStage   = access.stage;
+                state.writeAccess  = write ? GetWriteAccess(access.access) : VK_ACCESS_2_NONE;
+                state.readStages   = write ? VK_PIPELINE_STAGE_2_NONE : access.stage;
+                state.syncedStages = write ? VK_PIPELINE_STAGE_2_NONE : access.stage;
+                state.syncedAccess = write ? VK_ACCESS_2_NONE : access.access;
+            } else if (write) {
+                // 写后写, 读后写
+                VkPipelineStageFlags2 srcStage = state.writeStage | state.readStages;
+                if (srcStage != VK_PIPELINE_STAGE_2_NONE) {
+                    addMemoryBarrier(i, srcStage, state.writeAccess, access);
+                }
+                state.writeStage   = access.stage;
+                state.writeAccess  = GetWriteAccess(access.access);
+                state.readStages   = VK_PIPELINE_STAGE_2_NONE;
+                state.syncedStages = VK_PIPELINE_STAGE_2_NONE;
+                state.syncedAccess = VK_ACCESS_2_NONE;
+            } else {
+                // 写后读, 已经对同样的阶段和访问可见时不需要再次同步
+                bool synced = (access.stage & ~state.syncedStages) == 0 && (access.access & ~state.syncedAccess) == 0;
+                if (state.writeStage != VK_PIPELINE_STAGE_2_NONE && !synced) {
+                    addMemoryBarrier(i, state.writeStage, state.writeAccess, access);
+                    state.syncedStages |= access.stage;
+                    state.syncedAccess |= access.access;
+                }
+                state.readStages |= access.stage;
+            }
+        }
+    }
+
+    // 导入资源转换到渲染图之后需要的状态
+    uint32_t endPass = static_cast<uint32_t>(mPasses.size());
+    for (uint32_t i = 0; i < mResources.size(); i++) {
+        const Resource& resource = mResources[i];
+        State&          state    = states[i];
+        if (!resource.imported) {
+            continue;
+        }
+
+        const RenderGraphAccess& access = resource.finalAccess;
+        if (resource.isImage && state.layout != access.layout && access.layout != VK_IMAGE_LAYOUT_UNDEFINED) {
+            transition(endPass, i, state, access);
+        } else if (access.stage != VK_PIPELINE_STAGE_2_NONE && state.writeAccess != VK_ACCESS_2_NONE) {
+            addMemoryBarrier(endPass, state.writeStage, state.writeAccess, access);
+        }
+    }
+
+    for (auto& batch: mBarrierBatches) {
+        mStats.imageBarrierCount += static_cast<uint32_t>(batch.imageBarriers.size());
+    }
+    mStats.barrierBatchCount = static_cast<uint32_t>(mBarrierBatches.size());
+}
+
+void RenderGraph::Execute(VkCommandBuffer commandBuffer) {
+    if (!mCompiled) {
+        NOVA_LOG_ERROR(Render, "Execute called before Compile");
+        return;
+    }
+
+    size_t batchIndex  = 0;
+    auto   flushBatch = [&](uint32_t passIndex) {
+        if (batchIndex >= mBarrierBatches.size() || mBarrierBatches[batchIndex].passIndex != passIndex) {
+            return;
+        }
+        const BarrierBatch& batch = mBarrierBatches[batchIndex++];
+
+        mImageBarrierScratch.resize(0);
+        for (auto& barrier: batch.imageBarriers) {
+            const Resource& resource = mResources[barrier.resourceIndex];
+            mImageBarrierScratch.push_back({
+                .sType               = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER_2,
+                .srcStageMask        = barrier.srcStage,
+                .srcAccessMask       = barrier.srcAccess,
+                .dstStageMask        = barrier.dstStage,
+                .dstAccessMask       = barrier.dstAccess,
+                .oldLayout           = barrier.oldLayout,
+                .newLayout           = barrier.newLayout,
+                .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+                .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+                .image               = resource.image,
+                .subresourceRange    = { resource.imageDesc.aspect, 0, VK_REMAINING_MIP_LEVELS, 0, VK_REMAINING_ARRAY_LAYERS },
+            });
+        }
+
+        bool             hasMemoryBarrier = batch.memoryBarrier.srcStageMask != 0 || batch.memoryBarrier.dstStageMask != 0;
+        VkDependencyInfo dependencyInfo   = {
+              .sType                   = VK_STRUCTURE_TYPE_DEPENDENCY_INFO,
+              .memoryBarrierCount      = hasMemoryBarrier ? 1u : 0u,
+              .pMemoryBarriers         = &batch.memoryBarrier,
+              .imageMemoryBarrierCount = static_cast<uint32_t>(mImageBarrierScratch.size()),
+              .pImageMemoryBarriers    = mImageBarrierScratch.data(),
+        };
+        vkCmdPipelineBarrier2(commandBuffer, &dependencyInfo);
+    };
+
+    for (uint32_t i = 0; i < mPasses.size(); i++) {
+        if (mPasses[i].culled) {
+            continue;
+        }
+        flushBatch(i);
+        if (mProfiler != nullptr) {
+            mProfiler->BeginScope(commandBuffer, mPasses[i].name);
+        }
+        if (mPasses[i].execute) {
+            mPasses[i].execute(commandBuffer, *this);
+        }
+        if (mProfiler != nullptr) {
+            mProfiler->EndScope(commandBuffer);
+        }
+    }
+    flushBatch(static_cast<uint32_t>(mPasses.size()));
+}
+
+void RenderGraph::DestroyTransientResources() {
+    // 句柄按值捕获, 渲染图可以立即清空或重新Compile
+    auto retire = [this](VulkanDeletionQueue::DestroyFunction destroy, VkDeviceSize bytes) {
+        if (mDeletionQueue != nullptr) {
+            mDeletionQueue->Retire(std::move(destroy), bytes);
+        } else {
+            destroy();
+        }
+    };
+
+    for (auto& resource: mResources) {
+        if (resource.imported) {
+            continue;
+        }
+        if (resource.image == VK_NULL_HANDLE && resource.imageView == VK_NULL_HANDLE && resource.buffer == VK_NULL_HANDLE) {
+            continue;
+        }
+        retire(
+            [device = mDevice, image = resource.image, imageView = resource.imageView, buffer = resource.buffer]() {
+                if (imageView != VK_NULL_HANDLE) {
+                    vkDestroyImageView(device, imageView, VulkanHostMemory::GetCallbacks());
+                }
+                if (image != VK_NULL_HANDLE) {
+                    vkDestroyImage(device, image, VulkanHostMemory::GetCallbacks());
+                }
+                if (buffer != VK_NULL_HANDLE) {
+                    vkDestroyBuffer(device, buffer, VulkanHostMemory::GetCallbacks());
+                }
+            },
+            0
+        );
+        resource.imageView = VK_NULL_HANDLE;
+        resource.image     = VK_NULL_HANDLE;
+        resource.buffer    = VK_NULL_HANDLE;
+    }
+    // 内存块的字节数计入统计, 资源本身只是别名在其上
+    for (auto& heap: mTransientHeaps) {
+        retire([allocator = mAllocator, allocation = heap.allocation]() mutable { allocator->Free(allocation); }, heap.size);
+    }
+    mTransientHeaps.resize(0);
+}
+} // namespace Nova
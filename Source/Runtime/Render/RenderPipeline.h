@@ -0,0 +1,335 @@
+#pragma once
+
+#include "Render/Interface/Vulkan/VulkanDeletionQueue.h"
+#include "Render/Interface/Vulkan/VulkanMemoryAllocator.h"
+#include "Render/Interface/Vulkan/VulkanProfiler.h"
+
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace Nova {
+
+// 资源在某个通道中的使用方式, 决定屏障的阶段/访问掩码以及图像布局
+struct RenderGraphAccess {
+    VkPipelineStageFlags2 stage  = VK_PIPELINE_STAGE_2_NONE;
+    VkAccessFlags2        access = VK_ACCESS_2_NONE;
+    VkImageLayout         layout = VK_IMAGE_LAYOUT_UNDEFINED;
+
+    bool IsWrite() const {
+        constexpr VkAccessFlags2 WRITE_ACCESS = VK_ACCESS_2_SHADER_WRITE_BIT | VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT |
+                                                VK_ACCESS_2_COLOR_ATTACHMENT_WRITE_BIT | VK_ACCESS_2_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT |
+                                                VK_ACCESS_2_TRANSFER_WRITE_BIT | VK_ACCESS_2_HOST_WRITE_BIT | VK_ACCESS_2_MEMORY_WRITE_BIT;
+        return (access & WRITE_ACCESS) != 0;
+    }
+};
+
+// 常用的使用方式
+namespace RenderGraphAccesses {
+    inline constexpr RenderGraphAccess ColorAttachmentWrite = {
+        VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT,
+        VK_ACCESS_2_COLOR_ATTACHMENT_READ_BIT | VK_ACCESS_2_COLOR_ATTACHMENT_WRITE_BIT,
+        VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
+    };
+    inline constexpr RenderGraphAccess DepthAttachmentWrite = {
+        VK_PIPELINE_STAGE_2_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_2_LATE_FRAGMENT_TESTS_BIT,
+        VK_ACCESS_2_DEPTH_STENCIL_ATTACHMENT_READ_BIT | VK_ACCESS_2_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT,
+        VK_IMAGE_LAYOUT_DEPTH_ATTACHMENT_OPTIMAL,
+    };
+    inline constexpr RenderGraphAccess DepthAttachmentRead = {
+        VK_PIPELINE_STAGE_2_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_2_LATE_FRAGMENT_TESTS_BIT,
+        VK_ACCESS_2_DEPTH_STENCIL_ATTACHMENT_READ_BIT,
+        VK_IMAGE_LAYOUT_DEPTH_READ_ONLY_OPTIMAL,
+    };
+    inline constexpr RenderGraphAccess FragmentShaderSampled = {
+        VK_PIPELINE_STAGE_2_FRAGMENT_SHADER_BIT,
+        VK_ACCESS_2_SHADER_SAMPLED_READ_BIT,
+        VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+    };
+    inline constexpr RenderGraphAccess ComputeShaderSampled = {
+        VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT,
+        VK_ACCESS_2_SHADER_SAMPLED_READ_BIT,
+        VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+    };
+    inline constexpr RenderGraphAccess ComputeShaderStorageRead = {
+        VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT,
+        VK_ACCESS_2_SHADER_STORAGE_READ_BIT,
+        VK_IMAGE_LAYOUT_GENERAL,
+    };
+    inline constexpr RenderGraphAccess ComputeShaderStorageWrite = {
+        VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT,
+        VK_ACCESS_2_SHADER_STORAGE_READ_BIT | VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT,
+        VK_IMAGE_LAYOUT_GENERAL,
+    };
+    inline constexpr RenderGraphAccess TransferRead = {
+        VK_PIPELINE_STAGE_2_TRANSFER_BIT,
+        VK_ACCESS_2_TRANSFER_READ_BIT,
+        VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+    };
+    inline constexpr RenderGraphAccess TransferWrite = {
+        VK_PIPELINE_STAGE_2_TRANSFER_BIT,
+        VK_ACCESS_2_TRANSFER_WRITE_BIT,
+        VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+    };
+    inline constexpr RenderGraphAccess VertexInput = {
+        VK_PIPELINE_STAGE_2_VERTEX_INPUT_BIT,
+        VK_ACCESS_2_VERTEX_ATTRIBUTE_READ_BIT | VK_ACCESS_2_INDEX_READ_BIT,
+    };
+    inline constexpr RenderGraphAccess IndirectCommand = {
+        VK_PIPELINE_STAGE_2_DRAW_INDIRECT_BIT,
+        VK_ACCESS_2_INDIRECT_COMMAND_READ_BIT,
+    };
+    inline constexpr RenderGraphAccess Present = {
+        VK_PIPELINE_STAGE_2_NONE,
+        VK_ACCESS_2_NONE,
+        VK_IMAGE_LAYOUT_PRESENT_SRC_KHR,
+    };
+} // namespace RenderGraphAccesses
+
+struct RenderGraphImageDesc {
+    VkFormat              format      = VK_FORMAT_UNDEFINED;
+    VkExtent2D            extent      = {};
+    uint32_t              mipLevels   = 1;
+    uint32_t              arrayLayers = 1;
+    VkSampleCountFlagBits samples     = VK_SAMPLE_COUNT_1_BIT;
+    VkImageAspectFlags    aspect      = VK_IMAGE_ASPECT_COLOR_BIT;
+    VkImageUsageFlags     usage       = 0; // 瞬态图像的用途由各通道的使用方式推导, 这里只需填写额外的用途
+};
+
+struct RenderGraphBufferDesc {
+    VkDeviceSize       size  = 0;
+    VkBufferUsageFlags usage = 0;
+};
+
+// 资源句柄, 只在创建它的渲染图内有效
+struct RenderGraphImage {
+    uint32_t index = UINT32_MAX;
+
+    bool IsValid() const {
+        return index != UINT32_MAX;
+    }
+};
+
+struct RenderGraphBuffer {
+    uint32_t index = UINT32_MAX;
+
+    bool IsValid() const {
+        return index != UINT32_MAX;
+    }
+};
+
+struct RenderGraphStats {
+    uint32_t     passCount          = 0;
+    uint32_t     culledPassCount    = 0;
+    uint32_t     barrierBatchCount  = 0; // vkCmdPipelineBarrier2的调用次数
+    uint32_t     imageBarrierCount  = 0;
+    VkDeviceSize transientBytes     = 0; // 不做别名时瞬态资源需要的内存
+    VkDeviceSize aliasedBytes       = 0; // 别名后实际分配的内存
+    uint32_t     transientHeapCount = 0;
+};
+
+class RenderGraph;
+
+// 在通道的声明阶段使用, 声明通道读写的资源
+class RenderGraphPassBuilder {
+    friend class RenderGraph;
+
+    RenderGraph& mGraph;
+    uint32_t     mPassIndex;
+
+    RenderGraphPassBuilder(RenderGraph& graph, uint32_t passIndex): mGraph(graph), mPassIndex(passIndex) {}
+
+public:
+    void Read(RenderGraphImage image, const RenderGraphAccess& access);
+    void Write(RenderGraphImage image, const RenderGraphAccess& access);
+    void Read(RenderGraphBuffer buffer, const RenderGraphAccess& access);
+    void Write(RenderGraphBuffer buffer, const RenderGraphAccess& access);
+
+    // 通道有渲染图之外可见的副作用(例如写入回读缓冲), 不会被剔除
+    void SetSideEffect();
+};
+
+// 帧渲染图
+// 通道声明对图像和缓冲的读写, Compile时剔除对输出没有贡献的通道, 按执行顺序推导最少的屏障,
+// 每个通道之前的所有屏障合并为一次vkCmdPipelineBarrier2; 生命周期不重叠的瞬态资源共享同一块内存
+//
+// 渲染图在结构不变时只需Compile一次, 每帧调用Execute; 导入的资源(例如交换链图像)可以在每帧Execute之前替换
+class RenderGraph {
+public:
+    using SetupFunction   = std::function<void(RenderGraphPassBuilder& builder)>;
+    using ExecuteFunction = std::function<void(VkCommandBuffer commandBuffer, const RenderGraph& graph)>;
+
+private:
+    friend class RenderGraphPassBuilder;
+
+    struct ResourceUse {
+        uint32_t          resourceIndex;
+        RenderGraphAccess access;
+        bool              read;
+        bool              write;
+    };
+
+    struct Pass {
+        std::string              name;
+        ExecuteFunction          execute;
+        std::vector<ResourceUse> uses;
+        bool                     sideEffect = false;
+        bool                     culled     = false;
+    };
+
+    struct Resource {
+        std::string name;
+        bool        isImage  = true;
+        bool        imported = false;
+
+        RenderGraphImageDesc  imageDesc;
+        RenderGraphBufferDesc bufferDesc;
+
+        VkImage     image     = VK_NULL_HANDLE;
+        VkImageView imageView = VK_NULL_HANDLE;
+        VkBuffer    buffer    = VK_NULL_HANDLE;
+
+        // 导入资源在渲染图之前和之后的状态
+        RenderGraphAccess initialAccess;
+        RenderGraphAccess finalAccess;
+
+        // Compile时计算
+        uint32_t              firstPass          = UINT32_MAX;
+        uint32_t              lastPass           = 0;
+        VkPipelineStageFlags2 allStages          = VK_PIPELINE_STAGE_2_NONE;
+        VkAccessFlags2        allWrites          = VK_ACCESS_2_NONE;
+        uint32_t              heapIndex          = UINT32_MAX;
+        VkDeviceSize          heapOffset         = 0;
+        VkMemoryRequirements  memoryRequirements = {};
+    };
+
+    struct Barrier {
+        uint32_t              resourceIndex;
+        VkPipelineStageFlags2 srcStage;
+        VkAccessFlags2        srcAccess;
+        VkPipelineStageFlags2 dstStage;
+        VkAccessFlags2        dstAccess;
+        VkImageLayout         oldLayout;
+        VkImageLayout         newLayout;
+    };
+
+    // 一个屏障点, 在passIndex对应的通道之前(passIndex为通道数时表示所有通道之后)执行
+    struct BarrierBatch {
+        uint32_t             passIndex;
+        std::vector<Barrier> imageBarriers;
+        VkMemoryBarrier2     memoryBarrier = { .sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER_2 };
+    };
+
+    struct TransientHeap {
+        VulkanAllocation allocation;
+        VkDeviceSize     size;
+    };
+
+    VkDevice               mDevice        = VK_NULL_HANDLE;
+    VulkanMemoryAllocator* mAllocator     = nullptr;
+    VulkanProfiler*        mProfiler      = nullptr;
+    VulkanDeletionQueue*   mDeletionQueue = nullptr;
+
+    std::vector<Pass>          mPasses;
+    std::vector<Resource>      mResources;
+    std::vector<BarrierBatch>  mBarrierBatches;
+    std::vector<TransientHeap> mTransientHeaps;
+    bool                       mCompiled = false;
+    RenderGraphStats           mStats;
+
+    // Execute时复用, 避免每帧分配
+    std::vector<VkImageMemoryBarrier2> mImageBarrierScratch;
+
+public:
+    RenderGraph() = default;
+
+    RenderGraph(const RenderGraph&)            = delete;
+    RenderGraph& operator=(const RenderGraph&) = delete;
+
+    ~RenderGraph() {
+        Reset();
+    }
+
+    void Initialize(VkDevice device, VulkanMemoryAllocator& allocator) {
+        mDevice    = device;
+        mAllocator = &allocator;
+    }
+
+    // 设置后Execute为每个未剔除的通道记录一个以通道名命名的GPU作用域, 传入nullptr关闭
+    void SetProfiler(VulkanProfiler* profiler) {
+        mProfiler = profiler;
+    }
+
+    // 设置后瞬态资源退役到延迟销毁队列, 重新Compile(如窗口尺寸变化)不需要等待GPU空闲; 传入nullptr时立即销毁
+    void SetDeletionQueue(VulkanDeletionQueue* deletionQueue) {
+        mDeletionQueue = deletionQueue;
+    }
+
+    // 销毁瞬态资源并清空所有通道和资源, 没有设置延迟销毁队列时调用前需要确保GPU不再使用这些资源
+    void Reset();
+
+    RenderGraphImage  CreateImage(const std::string& name, const RenderGraphImageDesc& desc);
+    RenderGraphBuffer CreateBuffer(const std::string& name, const RenderGraphBufferDesc& desc);
+
+    // 导入外部资源, initialAccess为渲染图执行之前的状态, finalAccess为执行之后需要转换到的状态
+    // 导入的资源视为渲染图的输出, 写入它们的通道不会被剔除
+    RenderGraphImage ImportImage(
+        const std::string&          name,
+        VkImage                     image,
+        VkImageView                 imageView,
+        const RenderGraphImageDesc& desc,
+        const RenderGraphAccess&    initialAccess,
+        const RenderGraphAccess&    finalAccess
+    );
+    RenderGraphBuffer ImportBuffer(
+        const std::string&           name,
+        VkBuffer                     buffer,
+        const RenderGraphBufferDesc& desc,
+        const RenderGraphAccess&     initialAccess,
+        const RenderGraphAccess&     finalAccess
+    );
+
+    // 替换导入资源的句柄, 不需要重新Compile
+    void SetImportedImage(RenderGraphImage handle, VkImage image, VkImageView imageView);
+    void SetImportedBuffer(RenderGraphBuffer handle, VkBuffer buffer);
+
+    void AddPass(const std::string& name, const SetupFunction& setup, ExecuteFunction execute);
+
+    VulkanResult Compile();
+    void         Execute(VkCommandBuffer commandBuffer);
+
+    VkImage GetImage(RenderGraphImage handle) const {
+        return mResources[handle.index].image;
+    }
+
+    VkImageView GetImageView(RenderGraphImage handle) const {
+        return mResources[handle.index].imageView;
+    }
+
+    const RenderGraphImageDesc& GetImageDesc(RenderGraphImage handle) const {
+        return mResources[handle.index].imageDesc;
+    }
+
+    VkBuffer GetBuffer(RenderGraphBuffer handle) const {
+        return mResources[handle.index].buffer;
+    }
+
+    bool IsPassCulled(uint32_t passIndex) const {
+        return mPasses[passIndex].culled;
+    }
+
+    const RenderGraphStats& GetStats() const {
+        return mStats;
+    }
+
+private:
+    void AddUse(uint32_t passIndex, uint32_t resourceIndex, const RenderGraphAccess& access, bool write);
+
+    void         CullPasses();
+    void         ComputeLifetimes();
+    VulkanResult CreateTransientResources();
+    VulkanResult AliasTransientResources();
+    void         BuildBarriers();
+    void         DestroyTransientResources();
+};
+} // namespace Nova
@@ -0,0 +1,3 @@
+// stb_image的实现只能在一个翻译单元中展开
+#define STB_IMAGE_IMPLEMENTATION
+#include <stb/stb_image.h>
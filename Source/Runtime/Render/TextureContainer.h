@@ -0,0 +1,144 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <span>
+
+namespace Nova {
+
+// Nova纹理容器(.ntex), 由TextureCooker离线生成, 小端序
+// 文件头 | mip表 | 各级mip数据; 数据按16字节对齐, 块行紧密排列, 与vkCmdCopyBufferToImage要求的布局一致,
+// 运行时映射文件后直接作为上传的源数据, 不需要解码或重新排列
+enum class TextureContainerFormat : uint32_t {
+    RGBA8,
+    BC1, // RGB, 1位alpha, 每块8字节
+    BC3, // RGBA, 每块16字节
+    BC5, // 两个独立通道, 用于切线空间法线
+    BC7, // RGBA, 质量最高, 每块16字节
+    Count,
+};
+
+struct TextureContainerHeader {
+    static constexpr uint32_t MAGIC     = 0x5845544E; // "NTEX"
+    static constexpr uint32_t VERSION   = 1;
+    static constexpr uint32_t FLAG_SRGB = 1 << 0;
+
+    uint32_t               magic     = MAGIC;
+    uint32_t               version   = VERSION;
+    TextureContainerFormat format    = TextureContainerFormat::RGBA8;
+    uint32_t               flags     = 0;
+    uint32_t               width     = 0;
+    uint32_t               height    = 0;
+    uint32_t               mipLevels = 0;
+    uint32_t               reserved  = 0;
+};
+
+// 偏移从文件起始处计算
+struct TextureContainerMip {
+    uint64_t offset = 0;
+    uint64_t size   = 0;
+};
+
+static_assert(sizeof(TextureContainerHeader) == 32 && sizeof(TextureContainerMip) == 16);
+
+inline constexpr uint64_t TEXTURE_CONTAINER_DATA_ALIGNMENT = 16;
+
+// 块的边长, 非压缩格式为1
+inline uint32_t GetTextureBlockDimension(TextureContainerFormat format) {
+    return format == TextureContainerFormat::RGBA8 ? 1 : 4;
+}
+
+// 每个块(非压缩格式为每个像素)的字节数
+inline uint32_t GetTextureBlockBytes(TextureContainerFormat format) {
+    switch (format) {
+        case TextureContainerFormat::RGBA8:
+            return 4;
+        case TextureContainerFormat::BC1:
+            return 8;
+        case TextureContainerFormat::BC3:
+        case TextureContainerFormat::BC5:
+        case TextureContainerFormat::BC7:
+            return 16;
+        default:
+            return 0;
+    }
+}
+
+inline uint64_t GetTextureMipSize(TextureContainerFormat format, uint32_t width, uint32_t height) {
+    uint32_t blockDimension = GetTextureBlockDimension(format);
+    uint64_t blocksX        = (width + blockDimension - 1) / blockDimension;
+    uint64_t blocksY        = (height + blockDimension - 1) / blockDimension;
+    return blocksX * blocksY * GetTextureBlockBytes(format);
+}
+
+inline const char* GetTextureContainerFormatName(TextureContainerFormat format) {
+    static constexpr const char* NAMES[] = { "RGBA8", "BC1", "BC3", "BC5", "BC7" };
+    return uint32_t(format) < uint32_t(TextureContainerFormat::Count) ? NAMES[uint32_t(format)] : "Unknown";
+}
+
+// 只读视图, 不拥有数据; Parse检查文件头和每一级mip的范围, 通过后GetMip返回的数据都在输入范围之内
+class TextureContainerView {
+private:
+    std::span<const std::byte> mData;
+    TextureContainerHeader     mHeader;
+
+public:
+    bool Parse(std::span<const std::byte> data) {
+        mData = {};
+        if (data.size() < sizeof(TextureContainerHeader)) {
+            return false;
+        }
+        std::memcpy(&mHeader, data.data(), sizeof(mHeader));
+        if (mHeader.magic != TextureContainerHeader::MAGIC || mHeader.version != TextureContainerHeader::VERSION ||
+            uint32_t(mHeader.format) >= uint32_t(TextureContainerFormat::Count) || mHeader.width == 0 || mHeader.height == 0 ||
+            mHeader.mipLevels == 0 || mHeader.mipLevels > 32) {
+            return false;
+        }
+        if (data.size() < sizeof(TextureContainerHeader) + sizeof(TextureContainerMip) * mHeader.mipLevels) {
+            return false;
+        }
+
+        for (uint32_t level = 0; level < mHeader.mipLevels; level++) {
+            TextureContainerMip mip      = ReadMip(data, level);
+            uint64_t            expected = GetTextureMipSize(mHeader.format, GetMipWidth(level), GetMipHeight(level));
+            if (mip.size != expected || mip.offset % TEXTURE_CONTAINER_DATA_ALIGNMENT != 0 || mip.offset > data.size() ||
+                mip.size > data.size() - mip.offset) {
+                return false;
+            }
+        }
+        mData = data;
+        return true;
+    }
+
+    const TextureContainerHeader& GetHeader() const {
+        return mHeader;
+    }
+
+    bool IsSrgb() const {
+        return (mHeader.flags & TextureContainerHeader::FLAG_SRGB) != 0;
+    }
+
+    uint32_t GetMipWidth(uint32_t level) const {
+        return std::max(mHeader.width >> level, 1u);
+    }
+
+    uint32_t GetMipHeight(uint32_t level) const {
+        return std::max(mHeader.height >> level, 1u);
+    }
+
+    std::span<const std::byte> GetMip(uint32_t level) const {
+        TextureContainerMip mip = ReadMip(mData, level);
+        return mData.subspan(mip.offset, mip.size);
+    }
+
+private:
+    // mip表紧跟文件头, 输入数据不保证按结构体对齐, 逐项拷贝读取
+    static TextureContainerMip ReadMip(std::span<const std::byte> data, uint32_t level) {
+        TextureContainerMip mip;
+        std::memcpy(&mip, data.data() + sizeof(TextureContainerHeader) + sizeof(TextureContainerMip) * level, sizeof(mip));
+        return mip;
+    }
+};
+} // namespace Nova
@@ -0,0 +1,346 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+
+namespace Nova {
+
+// 4x4像素块, 按行排列的RGBA8
+struct RgbaBlock {
+    uint8_t pixels[16][4];
+};
+
+// BC1/BC3/BC5/BC7块编码, 只在离线烘焙中使用, 以质量稳定为主而不追求极限压缩质量:
+// 端点取块内颜色的主成分方向上的两个极值, 再为每个像素选择最近的调色板项
+// BC7只使用模式6(单分区, RGBA端点7位加独立p位, 4位索引), 对不透明和带alpha的纹理都适用
+class BlockCompression {
+public:
+    // alpha小于128的像素使用3色模式中的透明项
+    static void EncodeBC1(const RgbaBlock& block, uint8_t* output) {
+        bool hasAlpha = false;
+        for (auto& pixel: block.pixels) {
+            hasAlpha |= pixel[3] < 128;
+        }
+        EncodeColor(block, hasAlpha, output);
+    }
+
+    static void EncodeBC3(const RgbaBlock& block, uint8_t* output) {
+        uint8_t alpha[16];
+        for (uint32_t i = 0; i < 16; i++) {
+            alpha[i] = block.pixels[i][3];
+        }
+        EncodeBC4(alpha, output);
+        // BC3的颜色块总是按4色模式解码
+        EncodeColor(block, false, output + 8);
+    }
+
+    // 只编码R和G通道
+    static void EncodeBC5(const RgbaBlock& block, uint8_t* output) {
+        uint8_t red[16];
+        uint8_t green[16];
+        for (uint32_t i = 0; i < 16; i++) {
+            red[i]   = block.pixels[i][0];
+            green[i] = block.pixels[i][1];
+        }
+        EncodeBC4(red, output);
+        EncodeBC4(green, output + 8);
+    }
+
+    static void EncodeBC7(const RgbaBlock& block, uint8_t* output) {
+        float points[16][4];
+        for (uint32_t i = 0; i < 16; i++) {
+            for (uint32_t c = 0; c < 4; c++) {
+                points[i][c] = block.pixels[i][c];
+            }
+        }
+        float endpoints[2][4];
+        ComputeEndpoints<4>(points, endpoints[0], endpoints[1]);
+
+        // 每个端点的4个通道共用一个p位, 分别尝试0和1
+        uint32_t quantized[2][4];
+        uint32_t pBits[2];
+        for (uint32_t e = 0; e < 2; e++) {
+            float bestError = INFINITY;
+            for (uint32_t p = 0; p < 2; p++) {
+                uint32_t candidate[4];
+                float    error = 0.0f;
+                for (uint32_t c = 0; c < 4; c++) {
+                    candidate[c] = uint32_t(std::clamp(std::lround((endpoints[e][c] - float(p)) * 0.5f), 0L, 127L));
+                    float delta  = float(candidate[c] * 2 + p) - endpoints[e][c];
+                    error       += delta * delta;
+                }
+                if (error < bestError) {
+                    bestError = error;
+                    pBits[e]  = p;
+                    std::memcpy(quantized[e], candidate, sizeof(candidate));
+                }
+            }
+        }
+
+        uint32_t indices[16];
+        SelectBC7Indices(block, quantized, pBits, indices);
+
+        // 像素0的索引最高位隐含为0, 不满足时交换端点并翻转索引
+        if (indices[0] & 8) {
+            std::swap(quantized[0], quantized[1]);
+            std::swap(pBits[0], pBits[1]);
+            for (auto& index: indices) {
+                index = 15 - index;
+            }
+        }
+
+        BitWriter writer(output);
+        writer.Write(1 << 6, 7);
+        for (uint32_t c = 0; c < 4; c++) {
+            writer.Write(quantized[0][c], 7);
+            writer.Write(quantized[1][c], 7);
+        }
+        writer.Write(pBits[0], 1);
+        writer.Write(pBits[1], 1);
+        writer.Write(indices[0], 3);
+        for (uint32_t i = 1; i < 16; i++) {
+            writer.Write(indices[i], 4);
+        }
+    }
+
+private:
+    // 从低位开始依次写入, 输出需要预先清零
+    class BitWriter {
+        uint8_t* mOutput;
+        uint32_t mPosition = 0;
+
+    public:
+        explicit BitWriter(uint8_t* output): mOutput(output) {
+            std::memset(output, 0, 16);
+        }
+
+        void Write(uint32_t value, uint32_t bitCount) {
+            for (uint32_t i = 0; i < bitCount; i++, mPosition++) {
+                mOutput[mPosition / 8] |= uint8_t(((value >> i) & 1) << (mPosition % 8));
+            }
+        }
+    };
+
+    // 沿主成分方向取投影的最小和最大值作为端点, 主成分由协方差矩阵的幂迭代得到
+    template<uint32_t N>
+    static void ComputeEndpoints(const float (&points)[16][N], float (&minimum)[N], float (&maximum)[N]) {
+        float mean[N] = {};
+        for (auto& point: points) {
+            for (uint32_t c = 0; c < N; c++) {
+                mean[c] += point[c] / 16.0f;
+            }
+        }
+
+        float covariance[N][N] = {};
+        for (auto& point: points) {
+            for (uint32_t i = 0; i < N; i++) {
+                for (uint32_t j = 0; j < N; j++) {
+                    covariance[i][j] += (point[i] - mean[i]) * (point[j] - mean[j]);
+                }
+            }
+        }
+
+        // 从方差最大的通道对应的协方差列开始迭代, 该列不为0时与主成分不会正交
+        uint32_t dominant = 0;
+        for (uint32_t c = 1; c < N; c++) {
+            if (covariance[c][c] > covariance[dominant][dominant]) {
+                dominant = c;
+            }
+        }
+        float axis[N];
+        std::memcpy(axis, covariance[dominant], sizeof(axis));
+        for (uint32_t iteration = 0; iteration < 8; iteration++) {
+            float length = 0.0f;
+            for (uint32_t c = 0; c < N; c++) {
+                length += axis[c] * axis[c];
+            }
+            // 块内颜色完全相同时协方差为0, 两个端点都取均值
+            if (length < 1e-6f) {
+                std::memcpy(minimum, mean, sizeof(mean));
+                std::memcpy(maximum, mean, sizeof(mean));
+                return;
+            }
+            length = 1.0f / std::sqrt(length);
+            for (uint32_t c = 0; c < N; c++) {
+                axis[c] *= length;
+            }
+            if (iteration == 7) {
+                break;
+            }
+
+            float next[N] = {};
+            for (uint32_t i = 0; i < N; i++) {
+                for (uint32_t j = 0; j < N; j++) {
+                    next[i] += covariance[i][j] * axis[j];
+                }
+            }
+            std::memcpy(axis, next, sizeof(axis));
+        }
+
+        float minProjection = INFINITY;
+        float maxProjection = -INFINITY;
+        for (auto& point: points) {
+            float projection = 0.0f;
+            for (uint32_t c = 0; c < N; c++) {
+                projection += (point[c] - mean[c]) * axis[c];
+            }
+            minProjection = std::min(minProjection, projection);
+            maxProjection = std::max(maxProjection, projection);
+        }
+        for (uint32_t c = 0; c < N; c++) {
+            minimum[c] = std::clamp(mean[c] + axis[c] * minProjection, 0.0f, 255.0f);
+            maximum[c] = std::clamp(mean[c] + axis[c] * maxProjection, 0.0f, 255.0f);
+        }
+    }
+
+    static uint16_t PackRgb565(const float (&color)[3]) {
+        uint32_t r = uint32_t(std::lround(color[0] * 31.0f / 255.0f));
+        uint32_t g = uint32_t(std::lround(color[1] * 63.0f / 255.0f));
+        uint32_t b = uint32_t(std::lround(color[2] * 31.0f / 255.0f));
+        return uint16_t(r << 11 | g << 5 | b);
+    }
+
+    static void UnpackRgb565(uint16_t packed, int32_t (&color)[3]) {
+        int32_t r = packed >> 11;
+        int32_t g = (packed >> 5) & 63;
+        int32_t b = packed & 31;
+        color[0]  = r << 3 | r >> 2;
+        color[1]  = g << 2 | g >> 4;
+        color[2]  = b << 3 | b >> 2;
+    }
+
+    // BC1颜色块: 两个565端点和每像素2位索引; color0 > color1为4色模式, 否则为3色加透明
+    static void EncodeColor(const RgbaBlock& block, bool transparent, uint8_t* output) {
+        // 透明像素不参与端点的选择, 用一个不透明像素代替
+        uint32_t opaque = 0;
+        while (transparent && opaque < 15 && block.pixels[opaque][3] < 128) {
+            opaque++;
+        }
+        float points[16][3];
+        for (uint32_t i = 0; i < 16; i++) {
+            uint32_t source = transparent && block.pixels[i][3] < 128 ? opaque : i;
+            for (uint32_t c = 0; c < 3; c++) {
+                points[i][c] = block.pixels[source][c];
+            }
+        }
+        float endpoints[2][3];
+        ComputeEndpoints<3>(points, endpoints[0], endpoints[1]);
+
+        uint16_t color0 = PackRgb565(endpoints[1]);
+        uint16_t color1 = PackRgb565(endpoints[0]);
+        if ((color0 < color1) != transparent) {
+            std::swap(color0, color1);
+        }
+
+        int32_t palette[4][3];
+        UnpackRgb565(color0, palette[0]);
+        UnpackRgb565(color1, palette[1]);
+        uint32_t paletteSize = 4;
+        if (color0 > color1) {
+            for (uint32_t c = 0; c < 3; c++) {
+                palette[2][c] = (2 * palette[0][c] + palette[1][c]) / 3;
+                palette[3][c] = (palette[0][c] + 2 * palette[1][c]) / 3;
+            }
+        } else {
+            // 端点相同时也按3色模式解码, 索引3为透明黑
+            for (uint32_t c = 0; c < 3; c++) {
+                palette[2][c] = (palette[0][c] + palette[1][c]) / 2;
+            }
+            paletteSize = 3;
+        }
+
+        uint32_t indices = 0;
+        for (uint32_t i = 0; i < 16; i++) {
+            uint32_t index = 3;
+            if (!transparent || block.pixels[i][3] >= 128) {
+                index = FindNearest(block.pixels[i], palette, paletteSize);
+            }
+            indices |= index << (i * 2);
+        }
+
+        output[0] = uint8_t(color0);
+        output[1] = uint8_t(color0 >> 8);
+        output[2] = uint8_t(color1);
+        output[3] = uint8_t(color1 >> 8);
+        std::memcpy(output + 4, &indices, 4);
+    }
+
+    static uint32_t FindNearest(const uint8_t (&pixel)[4], const int32_t (&palette)[4][3], uint32_t paletteSize) {
+        uint32_t bestIndex = 0;
+        int32_t  bestError = INT32_MAX;
+        for (uint32_t i = 0; i < paletteSize; i++) {
+            int32_t error = 0;
+            for (uint32_t c = 0; c < 3; c++) {
+                int32_t delta  = int32_t(pixel[c]) - palette[i][c];
+                error         += delta * delta;
+            }
+            if (error < bestError) {
+                bestError = error;
+                bestIndex = i;
+            }
+        }
+        return bestIndex;
+    }
+
+    // BC4单通道块: 两个8位端点和每像素3位索引, 端点0大于端点1时为8值插值模式
+    static void EncodeBC4(const uint8_t (&values)[16], uint8_t* output) {
+        uint8_t maximum = *std::max_element(values, values + 16);
+        uint8_t minimum = *std::min_element(values, values + 16);
+
+        int32_t palette[8] = { maximum, minimum };
+        for (int32_t i = 1; i < 7; i++) {
+            palette[i + 1] = ((7 - i) * maximum + i * minimum) / 7;
+        }
+
+        uint64_t indices = 0;
+        for (uint32_t i = 0; i < 16; i++) {
+            uint64_t bestIndex = 0;
+            int32_t  bestError = INT32_MAX;
+            for (uint32_t j = 0; j < 8; j++) {
+                int32_t error = std::abs(int32_t(values[i]) - palette[j]);
+                if (error < bestError) {
+                    bestError = error;
+                    bestIndex = j;
+                }
+            }
+            indices |= bestIndex << (i * 3);
+        }
+
+        output[0] = maximum;
+        output[1] = minimum;
+        for (uint32_t i = 0; i < 6; i++) {
+            output[2 + i] = uint8_t(indices >> (i * 8));
+        }
+    }
+
+    static void SelectBC7Indices(const RgbaBlock& block, const uint32_t (&quantized)[2][4], const uint32_t (&pBits)[2], uint32_t (&indices)[16]) {
+        static constexpr int32_t WEIGHTS[16] = { 0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64 };
+
+        int32_t palette[16][4];
+        for (uint32_t c = 0; c < 4; c++) {
+            int32_t endpoint0 = int32_t(quantized[0][c] << 1 | pBits[0]);
+            int32_t endpoint1 = int32_t(quantized[1][c] << 1 | pBits[1]);
+            for (uint32_t i = 0; i < 16; i++) {
+                palette[i][c] = ((64 - WEIGHTS[i]) * endpoint0 + WEIGHTS[i] * endpoint1 + 32) >> 6;
+            }
+        }
+
+        for (uint32_t i = 0; i < 16; i++) {
+            int32_t bestError = INT32_MAX;
+            for (uint32_t j = 0; j < 16; j++) {
+                int32_t error = 0;
+                for (uint32_t c = 0; c < 4; c++) {
+                    int32_t delta  = int32_t(block.pixels[i][c]) - palette[j][c];
+                    error         += delta * delta;
+                }
+                if (error < bestError) {
+                    bestError  = error;
+                    indices[i] = j;
+                }
+            }
+        }
+    }
+};
+} // namespace Nova
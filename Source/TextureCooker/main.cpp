@@ -0,0 +1,297 @@
+#include "BlockCompression.h"
+
+#include <Runtime/Core/Core.h>
+#include <Runtime/Render/TextureContainer.h>
+
+#include <stb/stb_image.h>
+
+#include <algorithm>
+#include <array>
+#include <cctype>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+// 离线纹理烘焙: 解码PNG/JPG, 生成完整的mip链并编码为块压缩格式, 写入运行时可以直接映射上传的.ntex容器
+struct CookOptions {
+    Nova::TextureContainerFormat format = Nova::TextureContainerFormat::BC7;
+    bool                         srgb   = true;
+};
+
+struct CookStats {
+    uint64_t textureCount  = 0;
+    uint64_t failedCount   = 0;
+    uint64_t originalBytes = 0; // 以RGBA8加完整mip链上传时的显存占用
+    uint64_t cookedBytes   = 0;
+};
+
+static float SrgbToLinear(uint8_t value) {
+    static const std::array<float, 256> table = [] {
+        std::array<float, 256> result;
+        for (uint32_t i = 0; i < 256; i++) {
+            float c   = float(i) / 255.0f;
+            result[i] = c <= 0.04045f ? c / 12.92f : std::pow((c + 0.055f) / 1.055f, 2.4f);
+        }
+        return result;
+    }();
+    return table[value];
+}
+
+static uint8_t LinearToSrgb(float value) {
+    float c = value <= 0.0031308f ? value * 12.92f : 1.055f * std::pow(value, 1.0f / 2.4f) - 0.055f;
+    return uint8_t(std::clamp(std::lround(c * 255.0f), 0L, 255L));
+}
+
+// 2x2盒式滤波逐级缩小到1x1, 奇数边长时最后一行或一列被截断; sRGB纹理的颜色通道在线性空间中平均, alpha总是线性的
+static std::vector<std::vector<uint8_t>> BuildMipChain(const uint8_t* pixels, uint32_t width, uint32_t height, bool srgb) {
+    std::vector<std::vector<uint8_t>> levels;
+    levels.emplace_back(pixels, pixels + size_t(width) * height * 4);
+
+    while (width > 1 || height > 1) {
+        const std::vector<uint8_t>& source       = levels.back();
+        uint32_t                    sourceWidth  = width;
+        uint32_t                    sourceHeight = height;
+
+        width  = std::max(width / 2, 1u);
+        height = std::max(height / 2, 1u);
+
+        std::vector<uint8_t> level(size_t(width) * height * 4);
+        for (uint32_t y = 0; y < height; y++) {
+            uint32_t rows[2] = { std::min(y * 2, sourceHeight - 1), std::min(y * 2 + 1, sourceHeight - 1) };
+            for (uint32_t x = 0; x < width; x++) {
+                uint32_t columns[2] = { std::min(x * 2, sourceWidth - 1), std::min(x * 2 + 1, sourceWidth - 1) };
+                for (uint32_t c = 0; c < 4; c++) {
+                    bool  gamma = srgb && c < 3;
+                    float sum   = 0.0f;
+                    for (uint32_t row: rows) {
+                        for (uint32_t column: columns) {
+                            uint8_t value  = source[(size_t(row) * sourceWidth + column) * 4 + c];
+                            sum           += gamma ? SrgbToLinear(value) : float(value);
+                        }
+                    }
+                    uint8_t* output = &level[(size_t(y) * width + x) * 4 + c];
+                    *output         = gamma ? LinearToSrgb(sum * 0.25f) : uint8_t(std::lround(sum * 0.25f));
+                }
+            }
+        }
+        levels.push_back(std::move(level));
+    }
+    return levels;
+}
+
+// 按块行在作业系统上并行编码, 图像边缘不足4x4的块重复最后一行或一列
+static std::vector<uint8_t> EncodeMip(const std::vector<uint8_t>& pixels, uint32_t width, uint32_t height, Nova::TextureContainerFormat format) {
+    if (format == Nova::TextureContainerFormat::RGBA8) {
+        return pixels;
+    }
+
+    uint32_t             blocksX    = (width + 3) / 4;
+    uint32_t             blocksY    = (height + 3) / 4;
+    uint32_t             blockBytes = Nova::GetTextureBlockBytes(format);
+    std::vector<uint8_t> output(size_t(blocksX) * blocksY * blockBytes);
+
+    Nova::JobSystem::Singleton().ParallelFor(blocksY, 4, [&](uint32_t begin, uint32_t end) {
+        for (uint32_t blockY = begin; blockY < end; blockY++) {
+            for (uint32_t blockX = 0; blockX < blocksX; blockX++) {
+                Nova::RgbaBlock block;
+                for (uint32_t i = 0; i < 16; i++) {
+                    uint32_t x = std::min(blockX * 4 + i % 4, width - 1);
+                    uint32_t y = std::min(blockY * 4 + i / 4, height - 1);
+                    std::memcpy(block.pixels[i], &pixels[(size_t(y) * width + x) * 4], 4);
+                }
+
+                uint8_t* blockOutput = &output[(size_t(blockY) * blocksX + blockX) * blockBytes];
+                switch (format) {
+                    case Nova::TextureContainerFormat::BC1:
+                        Nova::BlockCompression::EncodeBC1(block, blockOutput);
+                        break;
+                    case Nova::TextureContainerFormat::BC3:
+                        Nova::BlockCompression::EncodeBC3(block, blockOutput);
+                        break;
+                    case Nova::TextureContainerFormat::BC5:
+                        Nova::BlockCompression::EncodeBC5(block, blockOutput);
+                        break;
+                    default:
+                        Nova::BlockCompression::EncodeBC7(block, blockOutput);
+                        break;
+                }
+            }
+        }
+    });
+    return output;
+}
+
+// 文件头之后是mip表, 每级数据按TEXTURE_CONTAINER_DATA_ALIGNMENT对齐
+static bool WriteContainer(
+    const std::filesystem::path&             path,
+    const Nova::TextureContainerHeader&      header,
+    const std::vector<std::vector<uint8_t>>& mips
+) {
+    constexpr uint64_t ALIGNMENT = Nova::TEXTURE_CONTAINER_DATA_ALIGNMENT;
+
+    std::vector<Nova::TextureContainerMip> mipTable(mips.size());
+    uint64_t                               offset = sizeof(Nova::TextureContainerHeader) + sizeof(Nova::TextureContainerMip) * mips.size();
+    for (size_t i = 0; i < mips.size(); i++) {
+        offset      = (offset + ALIGNMENT - 1) / ALIGNMENT * ALIGNMENT;
+        mipTable[i] = { .offset = offset, .size = mips[i].size() };
+        offset     += mips[i].size();
+    }
+
+    std::ofstream file(path, std::ios::binary);
+    if (!file) {
+        NOVA_LOG_ERROR(Assets, "Failed to create {}", path.string());
+        return false;
+    }
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    file.write(reinterpret_cast<const char*>(mipTable.data()), std::streamsize(sizeof(Nova::TextureContainerMip) * mipTable.size()));
+    for (size_t i = 0; i < mips.size(); i++) {
+        // 补齐到该级的偏移
+        static constexpr char PADDING[ALIGNMENT] = {};
+        file.write(PADDING, std::streamsize(mipTable[i].offset - uint64_t(file.tellp())));
+        file.write(reinterpret_cast<const char*>(mips[i].data()), std::streamsize(mips[i].size()));
+    }
+    return file.good();
+}
+
+static bool CookTexture(const std::filesystem::path& input, const std::filesystem::path& output, const CookOptions& options, CookStats& stats) {
+    auto startTime = std::chrono::steady_clock::now();
+    stats.textureCount++;
+
+    int      width    = 0;
+    int      height   = 0;
+    int      channels = 0;
+    stbi_uc* pixels   = stbi_load(input.string().c_str(), &width, &height, &channels, STBI_rgb_alpha);
+    if (pixels == nullptr) {
+        NOVA_LOG_ERROR(Assets, "Failed to decode {}: {}", input.string(), stbi_failure_reason());
+        stats.failedCount++;
+        return false;
+    }
+    std::vector<std::vector<uint8_t>> levels = BuildMipChain(pixels, uint32_t(width), uint32_t(height), options.srgb);
+    stbi_image_free(pixels);
+
+    Nova::TextureContainerHeader header = {
+        .format    = options.format,
+        .flags     = options.srgb ? Nova::TextureContainerHeader::FLAG_SRGB : 0,
+        .width     = uint32_t(width),
+        .height    = uint32_t(height),
+        .mipLevels = uint32_t(levels.size()),
+    };
+
+    uint64_t                          originalBytes = 0;
+    uint64_t                          cookedBytes   = 0;
+    std::vector<std::vector<uint8_t>> mips;
+    for (uint32_t level = 0; level < header.mipLevels; level++) {
+        uint32_t mipWidth   = std::max(header.width >> level, 1u);
+        uint32_t mipHeight  = std::max(header.height >> level, 1u);
+        originalBytes      += levels[level].size();
+        mips.push_back(EncodeMip(levels[level], mipWidth, mipHeight, options.format));
+        cookedBytes        += mips.back().size();
+    }
+
+    if (!WriteContainer(output, header, mips)) {
+        stats.failedCount++;
+        return false;
+    }
+    stats.originalBytes += originalBytes;
+    stats.cookedBytes   += cookedBytes;
+
+    double cookMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - startTime).count();
+    NOVA_LOG_INFO(
+        Assets,
+        "{} -> {}: {}x{} {}{}, {} mips, {:.1f} KB -> {:.1f} KB ({:.1f}x) in {:.1f} ms",
+        input.filename().string(),
+        output.filename().string(),
+        header.width,
+        header.height,
+        Nova::GetTextureContainerFormatName(options.format),
+        options.srgb ? " sRGB" : "",
+        header.mipLevels,
+        double(originalBytes) / 1024.0,
+        double(cookedBytes) / 1024.0,
+        double(originalBytes) / double(cookedBytes),
+        cookMs
+    );
+    return true;
+}
+
+static bool ParseFormat(const char* name, Nova::TextureContainerFormat& format) {
+    for (uint32_t i = 0; i < uint32_t(Nova::TextureContainerFormat::Count); i++) {
+        std::string formatName = Nova::GetTextureContainerFormatName(Nova::TextureContainerFormat(i));
+        std::transform(formatName.begin(), formatName.end(), formatName.begin(), [](unsigned char c) { return char(std::tolower(c)); });
+        if (formatName == name) {
+            format = Nova::TextureContainerFormat(i);
+            return true;
+        }
+    }
+    return false;
+}
+
+static bool IsSourceImage(const std::filesystem::path& path) {
+    std::string extension = path.extension().string();
+    std::transform(extension.begin(), extension.end(), extension.begin(), [](unsigned char c) { return char(std::tolower(c)); });
+    return extension == ".png" || extension == ".jpg" || extension == ".jpeg";
+}
+
+// TextureCooker [--format bc1|bc3|bc5|bc7|rgba8] [--linear] <input> <output>
+// input为目录时烘焙其中所有PNG/JPG, 输出到output目录下的同名.ntex文件
+int main(int argc, char** argv) {
+    CookOptions                        options;
+    std::vector<std::filesystem::path> arguments;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--format") == 0 && i + 1 < argc) {
+            if (!ParseFormat(argv[++i], options.format)) {
+                NOVA_LOG_ERROR(Assets, "Unknown texture format {}", argv[i]);
+                Nova::Log::Shutdown();
+                return -1;
+            }
+        } else if (strcmp(argv[i], "--linear") == 0) {
+            options.srgb = false;
+        } else {
+            arguments.emplace_back(argv[i]);
+        }
+    }
+    if (arguments.size() != 2) {
+        NOVA_LOG_ERROR(Assets, "Usage: TextureCooker [--format bc1|bc3|bc5|bc7|rgba8] [--linear] <input> <output>");
+        Nova::Log::Shutdown();
+        return -1;
+    }
+    // BC5只有UNORM格式, 通常存放法线
+    if (options.format == Nova::TextureContainerFormat::BC5) {
+        options.srgb = false;
+    }
+
+    Nova::JobSystem::Singleton().Initialize();
+
+    CookStats stats;
+    if (std::filesystem::is_directory(arguments[0])) {
+        std::filesystem::create_directories(arguments[1]);
+        for (const auto& entry: std::filesystem::directory_iterator(arguments[0])) {
+            if (entry.is_regular_file() && IsSourceImage(entry.path())) {
+                std::filesystem::path output = arguments[1] / entry.path().filename().replace_extension(".ntex");
+                CookTexture(entry.path(), output, options, stats);
+            }
+        }
+    } else {
+        CookTexture(arguments[0], arguments[1], options, stats);
+    }
+
+    if (stats.cookedBytes > 0) {
+        NOVA_LOG_INFO(
+            Assets,
+            "Cooked {} textures ({} failed): {:.1f} MB -> {:.1f} MB, {:.1f}x smaller in video memory",
+            stats.textureCount - stats.failedCount,
+            stats.failedCount,
+            double(stats.originalBytes) / (1024.0 * 1024.0),
+            double(stats.cookedBytes) / (1024.0 * 1024.0),
+            double(stats.originalBytes) / double(stats.cookedBytes)
+        );
+    }
+
+    Nova::JobSystem::Singleton().Terminate();
+    Nova::Log::Shutdown();
+    return stats.failedCount == 0 && stats.textureCount > 0 ? 0 : 1;
+}
@@ -47,4 +47,22 @@ target("Editor")
     add_files("Source/Editor/**.cpp")
     add_includedirs("Source", {public = true})
     --add_headerfiles("Source/Editor/**.h", "Source/Editor/**.hpp")
-target_end()
\ No newline at end of file
+target_end()
+
+
+-- 离线纹理烘焙工具, 将PNG/JPG编码为块压缩的.ntex纹理容器
+target("TextureCooker")
+    -- 基础配置
+    set_kind("binary")
+
+    -- 依赖包
+    add_packages("vulkansdk", "spdlog", "glfw", "glm", "stb")
+
+    -- 依赖关系
+    add_deps("Runtime")
+
+    -- 源文件和头文件
+    add_files("Source/TextureCooker/**.cpp")
+    add_includedirs("Source", {public = true})
+    add_headerfiles("Source/TextureCooker/**.h")
+target_end()